@@ -0,0 +1,445 @@
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <linux/ublkdrv/cmd.h>
+#include <linux/ublkdrv/cmd_ack.h>
+
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <random>
+#include <ranges>
+#include <span>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+
+#include "mm/mem.hpp"
+#include "mm/mem_types.hpp"
+
+#include "sys/file.hpp"
+
+#include "utils/random.hpp"
+#include "utils/size_units.hpp"
+
+#include "cache/rw_handler.hpp"
+#include "def/rdq_submitter.hpp"
+#include "def/target.hpp"
+#include "def/uring.hpp"
+#include "def/wrq_submitter.hpp"
+#include "emu/ring.hpp"
+#include "inmem/rdq_submitter.hpp"
+#include "inmem/target.hpp"
+#include "inmem/wrq_submitter.hpp"
+#include "null/rdq_submitter.hpp"
+#include "null/wrq_submitter.hpp"
+#include "raid0/rdq_submitter.hpp"
+#include "raid0/target.hpp"
+#include "raid0/wrq_submitter.hpp"
+#include "raid1/rdq_submitter.hpp"
+#include "raid1/target.hpp"
+#include "raid1/wrq_submitter.hpp"
+#include "raid5/rdq_submitter.hpp"
+#include "raid5/target.hpp"
+#include "raid5/wrq_submitter.hpp"
+
+#include "cmd_acknowledger.hpp"
+#include "cmd_handler.hpp"
+#include "cmd_read_handler.hpp"
+#include "cmd_read_handler_adaptor.hpp"
+#include "cmd_write_handler.hpp"
+#include "cmd_write_handler_adaptor.hpp"
+#include "handler.hpp"
+#include "rdq_submitter.hpp"
+#include "rdq_submitter_interface.hpp"
+#include "rw_handler.hpp"
+#include "rw_handler_interface.hpp"
+#include "sector.hpp"
+#include "ublk_req_handler_interface.hpp"
+#include "wrq_submitter.hpp"
+#include "wrq_submitter_interface.hpp"
+
+namespace ublk::bench {
+
+namespace {
+
+constexpr auto kCapacity{64_MiB};
+constexpr auto kStripSz{64_KiB};
+constexpr auto kCacheSz{16_MiB};
+
+enum class target_kind {
+  null,
+  inmem,
+  def,
+  raid0,
+  raid1,
+  raid5,
+  cached_def,
+  cached_raid5,
+  def_uring,
+  raid0_uring,
+};
+
+constexpr std::string_view to_string_view(target_kind kind) noexcept {
+  switch (kind) {
+  case target_kind::null:
+    return "null";
+  case target_kind::inmem:
+    return "inmem";
+  case target_kind::def:
+    return "def";
+  case target_kind::raid0:
+    return "raid0";
+  case target_kind::raid1:
+    return "raid1";
+  case target_kind::raid5:
+    return "raid5";
+  case target_kind::cached_def:
+    return "cached_def";
+  case target_kind::cached_raid5:
+    return "cached_raid5";
+  case target_kind::def_uring:
+    return "def_uring";
+  case target_kind::raid0_uring:
+    return "raid0_uring";
+  }
+  return "unknown";
+}
+
+struct workload {
+  std::string_view name;
+  bool random;
+  /* percentage of reads, the rest are writes */
+  unsigned read_pct;
+  uint32_t bs;
+  uint32_t qd;
+};
+
+struct ops {
+  std::shared_ptr<IRDQSubmitter> reader;
+  std::shared_ptr<IWRQSubmitter> writer;
+};
+
+/* def targets are backed by unnamed tmpfs files, nothing is left behind */
+auto tmpfs_file_open(size_t sz) {
+  auto fd{sys::open("/dev/shm", O_RDWR | O_TMPFILE, S_IRUSR | S_IWUSR)};
+  if (ftruncate(*fd, static_cast<off_t>(sz)) < 0)
+    throw std::system_error(errno, std::generic_category());
+  return fd;
+}
+
+std::unique_ptr<IRWHandler>
+def_rw_handler_make(boost::asio::io_context &io_ctx, size_t sz) {
+  auto target{std::make_shared<def::Target>(io_ctx, tmpfs_file_open(sz))};
+  return std::make_unique<RWHandler>(
+      std::make_shared<def::RDQSubmitter>(target),
+      std::make_shared<def::WRQSubmitter>(target));
+}
+
+auto def_rw_handlers_make(boost::asio::io_context &io_ctx, size_t nr,
+                          size_t sz) {
+  auto hs{std::vector<std::shared_ptr<IRWHandler>>{}};
+  std::ranges::generate_n(std::back_inserter(hs), nr, [&] {
+    return std::shared_ptr{def_rw_handler_make(io_ctx, sz)};
+  });
+  return hs;
+}
+
+template <typename Target, typename RDQSubmitter, typename WRQSubmitter>
+std::unique_ptr<IRWHandler> raid_rw_handler_make(auto &&...args) {
+  auto target{std::make_shared<Target>(std::forward<decltype(args)>(args)...)};
+  return std::make_unique<RWHandler>(std::make_shared<RDQSubmitter>(target),
+                                     std::make_shared<WRQSubmitter>(target));
+}
+
+ops ops_from(std::unique_ptr<IRWHandler> rw_handler, bool cached) {
+  if (cached) {
+    rw_handler = std::make_unique<cache::RWHandler>(
+        bytes_to_sectors(kCacheSz), std::move(rw_handler));
+  }
+
+  auto sp_rw_handler{std::shared_ptr{std::move(rw_handler)}};
+
+  return {
+      .reader = std::make_shared<RDQSubmitter>(sp_rw_handler),
+      .writer = std::make_shared<WRQSubmitter>(sp_rw_handler),
+  };
+}
+
+ops ops_make(boost::asio::io_context &io_ctx, target_kind kind) {
+  switch (kind) {
+  case target_kind::def_uring:
+  case target_kind::raid0_uring:
+    def::uring::attach(io_ctx, {});
+    return ops_make(io_ctx, target_kind::def_uring == kind
+                                ? target_kind::def
+                                : target_kind::raid0);
+  case target_kind::null:
+    return {
+        .reader = std::make_shared<null::RDQSubmitter>(),
+        .writer = std::make_shared<null::WRQSubmitter>(),
+    };
+  case target_kind::inmem: {
+    auto target{
+        std::make_shared<inmem::Target>(
+            mm::get_unique_bytes_generator(kSectorSz, kCapacity)(), kCapacity),
+    };
+    return {
+        .reader = std::make_shared<inmem::RDQSubmitter>(target),
+        .writer = std::make_shared<inmem::WRQSubmitter>(target),
+    };
+  }
+  case target_kind::def:
+  case target_kind::cached_def:
+    return ops_from(def_rw_handler_make(io_ctx, kCapacity),
+                    target_kind::cached_def == kind);
+  case target_kind::raid0: {
+    constexpr auto kMembersNr{4uz};
+    return ops_from(
+        raid_rw_handler_make<raid0::Target, raid0::RDQSubmitter,
+                             raid0::WRQSubmitter>(
+            kStripSz,
+            def_rw_handlers_make(io_ctx, kMembersNr, kCapacity / kMembersNr)),
+        false);
+  }
+  case target_kind::raid1: {
+    constexpr auto kMembersNr{2uz};
+    return ops_from(
+        raid_rw_handler_make<raid1::Target, raid1::RDQSubmitter,
+                             raid1::WRQSubmitter>(
+            kStripSz, def_rw_handlers_make(io_ctx, kMembersNr, kCapacity)),
+        false);
+  }
+  case target_kind::raid5:
+  case target_kind::cached_raid5: {
+    constexpr auto kMembersNr{3uz};
+    return ops_from(
+        raid_rw_handler_make<raid5::Target, raid5::RDQSubmitter,
+                             raid5::WRQSubmitter>(
+            kStripSz, def_rw_handlers_make(io_ctx, kMembersNr,
+                                           kCapacity / (kMembersNr - 1))),
+        target_kind::cached_raid5 == kind);
+  }
+  }
+  return {};
+}
+
+/*
+ * Plays the kernel's part against the whole userspace command path: the
+ * commands are pushed into the emulated ring, CmdHandler dispatches them to
+ * the target and the acks are popped back. Every benchmark iteration is one
+ * command completed, a new one is submitted in its place to keep the queue
+ * depth constant
+ */
+void e2e_bench(benchmark::State &state, target_kind kind, workload const &wl) {
+  using clock = std::chrono::steady_clock;
+
+  auto io_ctx{boost::asio::io_context{}};
+
+  auto ring{emu::ring{{.cmds_len = wl.qd + 1, .cell_sz = wl.bs}}};
+  auto gen{make_random_bytes_generator()};
+  std::ranges::generate(ring.cells(), std::ref(gen));
+
+  auto const ops{ops_make(io_ctx, kind)};
+
+  if (auto *r{def::uring::find(io_ctx)})
+    r->buffers_register(ring.cells());
+
+  auto const hs{
+      std::map<ublkdrv_cmd_op, std::shared_ptr<IUblkReqHandler>>{
+          {
+              UBLKDRV_CMD_OP_READ,
+              std::make_shared<CmdReadHandlerAdaptor>(
+                  std::make_shared<CmdReadHandler>(ops.reader)),
+          },
+          {
+              UBLKDRV_CMD_OP_WRITE,
+              std::make_shared<CmdWriteHandlerAdaptor>(
+                  std::make_shared<CmdWriteHandler>(ops.writer)),
+          },
+      },
+  };
+
+  async_start(ring.fd_cmds(), io_ctx, ring.qcmd(),
+              std::make_unique<CmdHandler>(
+                  ring.cellds(), ring.cells(),
+                  std::make_shared<CmdAcknowledger>(io_ctx, ring.qcmd_ack(),
+                                                    ring.fd_acks()),
+                  hs));
+
+  auto const blocks_nr{kCapacity / wl.bs};
+
+  auto rnd{std::minstd_rand{}};
+  auto block_dist{std::uniform_int_distribution<uint64_t>{0, blocks_nr - 1}};
+  auto pct_dist{std::uniform_int_distribution<unsigned>{0, 99}};
+  uint64_t block_next{0};
+
+  auto starts{std::vector<clock::time_point>(wl.qd)};
+  uint32_t inflight{0};
+
+  auto const submit{[&](uint32_t id) {
+    auto const block{wl.random ? block_dist(rnd)
+                               : std::exchange(block_next,
+                                               (block_next + 1) % blocks_nr)};
+    starts[id] = clock::now();
+    auto const r{
+        pct_dist(rnd) < wl.read_pct ? ring.read(id, block * wl.bs, wl.bs)
+                                    : ring.write(id, block * wl.bs, wl.bs),
+    };
+    if (r) [[unlikely]]
+      state.SkipWithError("failed to push a command");
+    else
+      ++inflight;
+  }};
+
+  auto acks{std::vector<ublkdrv_cmd_ack>(wl.qd)};
+  auto acks_pending{std::span<ublkdrv_cmd_ack const>{}};
+
+  auto const ack_next{[&] {
+    while (acks_pending.empty()) {
+      if (auto const n{ring.acks_pop(acks)})
+        acks_pending = std::span{acks}.first(n);
+      else
+        io_ctx.run_one();
+    }
+    auto const ack{acks_pending.front()};
+    acks_pending = acks_pending.subspan(1);
+    --inflight;
+    return ack;
+  }};
+
+  for (uint32_t id{0}; id < wl.qd; ++id)
+    submit(id);
+
+  auto lats{std::vector<clock::duration>{}};
+
+  for (auto _ : state) {
+    auto const ack{ack_next()};
+    auto const id{ublkdrv_cmd_ack_get_id(&ack)};
+    if (ublkdrv_cmd_ack_get_err(&ack)) [[unlikely]] {
+      state.SkipWithError("command failed");
+      break;
+    }
+    lats.push_back(clock::now() - starts[id]);
+    submit(id);
+  }
+
+  while (inflight)
+    ack_next();
+
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * wl.bs);
+
+  state.counters["IOPS"] = benchmark::Counter(
+      static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+
+  if (lats.empty())
+    return;
+
+  std::ranges::sort(lats);
+  auto const percentile_us{[&](double p) {
+    auto const i{static_cast<size_t>(p * static_cast<double>(lats.size() - 1))};
+    return std::chrono::duration<double, std::micro>{lats[i]}.count();
+  }};
+
+  state.counters["p50_us"] = percentile_us(0.5);
+  state.counters["p99_us"] = percentile_us(0.99);
+  state.counters["p99.9_us"] = percentile_us(0.999);
+}
+
+} // namespace
+
+} // namespace ublk::bench
+
+int main(int argc, char **argv) {
+  using ublk::bench::target_kind;
+  using ublk::bench::workload;
+  using namespace ublk::literals;
+
+  constexpr target_kind kinds[]{
+      target_kind::null,       target_kind::inmem, target_kind::def,
+      target_kind::raid0,      target_kind::raid1, target_kind::raid5,
+      target_kind::cached_def, target_kind::cached_raid5,
+      target_kind::def_uring,  target_kind::raid0_uring,
+  };
+
+  constexpr workload workloads[]{
+      {
+          .name = "randread",
+          .random = true,
+          .read_pct = 100,
+          .bs = 4_KiB,
+          .qd = 1,
+      },
+      {
+          .name = "randread",
+          .random = true,
+          .read_pct = 100,
+          .bs = 4_KiB,
+          .qd = 32,
+      },
+      {
+          .name = "randwrite",
+          .random = true,
+          .read_pct = 0,
+          .bs = 4_KiB,
+          .qd = 32,
+      },
+      {
+          .name = "randrw70",
+          .random = true,
+          .read_pct = 70,
+          .bs = 4_KiB,
+          .qd = 32,
+      },
+      {
+          .name = "seqread",
+          .random = false,
+          .read_pct = 100,
+          .bs = 128_KiB,
+          .qd = 8,
+      },
+      {
+          .name = "seqwrite",
+          .random = false,
+          .read_pct = 0,
+          .bs = 128_KiB,
+          .qd = 8,
+      },
+  };
+
+  for (auto const kind : kinds) {
+    for (auto const &wl : workloads) {
+      benchmark::RegisterBenchmark(
+          std::format("e2e/{}/{}/bs:{}/qd:{}",
+                      ublk::bench::to_string_view(kind), wl.name, wl.bs, wl.qd)
+              .c_str(),
+          [kind, wl](benchmark::State &state) {
+            ublk::bench::e2e_bench(state, kind, wl);
+          })
+          ->UseRealTime()
+          ->Unit(benchmark::kMicrosecond);
+    }
+  }
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    return 1;
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+
+  return 0;
+}
@@ -3,6 +3,7 @@
 #include <cstdint>
 
 #include <algorithm>
+#include <mutex>
 #include <utility>
 
 #include <gsl/assert>
@@ -18,6 +19,8 @@ void *mem_cached_allocator::allocate_aligned(size_t alignment,
   Expects(is_power_of_2(alignment));
   Expects(sz);
 
+  auto const lck{std::lock_guard{mtx_}};
+
   alignment = std::max(alignment, alignof(std::max_align_t));
   auto ftbl_it = ftbl_.lower_bound(alignment);
   if (ftbl_it == ftbl_.end())
@@ -48,6 +51,8 @@ void *mem_cached_allocator::allocate_aligned(size_t alignment,
 }
 
 void mem_cached_allocator::free(void *p [[maybe_unused]]) noexcept {
+  auto const lck{std::lock_guard{mtx_}};
+
   auto const it = btbl_.find(reinterpret_cast<uintptr_t>(p));
   Expects(it != btbl_.end());
   it->second.ftbl_desc_it->second.free_chunks.push(std::move(it->second.chunk));
@@ -4,6 +4,7 @@
 #include <cstdint>
 
 #include <map>
+#include <mutex>
 #include <stack>
 #include <unordered_map>
 
@@ -45,6 +46,7 @@ public:
   void free(void *p [[maybe_unused]]) noexcept override;
 
 private:
+  std::mutex mtx_;
   free_table_t ftbl_;
   busy_table_t btbl_;
 };
@@ -3,28 +3,58 @@
 #include <cstddef>
 #include <cstdlib>
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
-#include <stack>
+#include <new>
 #include <utility>
 
 #include "mem_allocator.hpp"
 
+#include "utils/align.hpp"
 #include "utils/utility.hpp"
 
 namespace ublk::mm {
 
+/*
+ * Meant to be used by a single thread: allocating and freeing touch neither
+ * locks nor atomics. A block freed by another thread gets back to the pool it
+ * comes from through a lock-free return list, the owner takes the list as a
+ * whole once its own free list runs dry
+ */
 template <typename T, size_t Alignment = alignof(T)> class mem_pool_allocator {
 public:
   static_assert(is_power_of_2(Alignment), "Alignment must be a power of 2");
   static_assert(alignof(T) <= Alignment,
                 "Alignment must be at least alignof(T)");
 
+private:
+  struct node {
+    node *next;
+  };
+  static_assert(std::atomic<node *>::is_always_lock_free);
+
+  /* every block is preceded by the pool it belongs to */
+  static constexpr auto kAlignment{std::max(Alignment, alignof(node))};
+  static constexpr auto kHdrSz{
+      std::max(Alignment, sizeof(mem_pool_allocator *))};
+  static constexpr auto kBlockSz{kHdrSz + std::max(sizeof(T), sizeof(node))};
+
+  static mem_pool_allocator *&owner(void *p) noexcept {
+    return *std::launder(reinterpret_cast<mem_pool_allocator **>(
+        static_cast<std::byte *>(p) - kHdrSz));
+  }
+
+public:
   explicit mem_pool_allocator(std::shared_ptr<mem_allocator> a = {}) noexcept
       : a_(std::move(a)) {
     if (!a_)
       a_ = std::make_shared<mem_allocator>();
   }
-  virtual ~mem_pool_allocator() = default;
+  virtual ~mem_pool_allocator() {
+    release(free_);
+    release(returned_.exchange(nullptr, std::memory_order_acquire));
+  }
 
   mem_pool_allocator(mem_pool_allocator const &) = delete;
   mem_pool_allocator &operator=(mem_pool_allocator const &) = delete;
@@ -33,19 +63,55 @@ public:
   mem_pool_allocator &operator=(mem_pool_allocator &&) = delete;
 
   virtual void *allocate() noexcept {
-    if (!free_.empty()) [[likely]] {
-      auto *p = free_.top();
-      free_.pop();
-      return p;
+    if (!free_ && returned_.load(std::memory_order_relaxed)) [[unlikely]]
+      free_ = returned_.exchange(nullptr, std::memory_order_acquire);
+
+    if (free_) [[likely]] {
+      auto *n = free_;
+      free_ = n->next;
+      return n;
     }
-    return a_->allocate_aligned(Alignment, sizeof(T));
+
+    auto *b =
+        static_cast<std::byte *>(a_->allocate_aligned(kAlignment, kBlockSz));
+    if (!b) [[unlikely]]
+      return nullptr;
+    ::new (b) mem_pool_allocator *{this};
+    return b + kHdrSz;
   }
 
-  virtual void free(void *p) noexcept { free_.push(p); }
+  virtual void free(void *p) noexcept {
+    auto *pool = owner(p);
+    auto *n = ::new (p) node{.next = nullptr};
+    if (pool == this) [[likely]] {
+      n->next = free_;
+      free_ = n;
+    } else {
+      pool->give_back(n);
+    }
+  }
 
 private:
+  void give_back(node *n) noexcept {
+    n->next = returned_.load(std::memory_order_relaxed);
+    while (!returned_.compare_exchange_weak(n->next, n,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed)) {
+    }
+  }
+
+  void release(node *n) noexcept {
+    while (n) {
+      auto *next = n->next;
+      a_->free(reinterpret_cast<std::byte *>(n) - kHdrSz);
+      n = next;
+    }
+  }
+
   std::shared_ptr<mem_allocator> a_;
-  std::stack<void *> free_;
+  node *free_{nullptr};
+  alignas(hardware_destructive_interference_size) std::atomic<node *>
+      returned_{nullptr};
 };
 
 } // namespace ublk::mm
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <atomic>
+#include <memory>
+#include <utility>
+
+#include <gsl/assert>
+
+#include "utils/align.hpp"
+#include "utils/utility.hpp"
+
+#include "mem.hpp"
+#include "mem_types.hpp"
+
+namespace ublk::mm {
+
+/*
+ * Preallocated fixed count of fixed size slots addressed by an index.
+ *
+ * The slab is reference counted intrusively: the owner holds one reference
+ * and every allocation made through it holds another one, so the slab and
+ * the anchor given at creation outlive all the objects allocated from it
+ */
+class mem_slab final {
+public:
+  static constexpr size_t kSlotAlignment{
+      hardware_destructive_interference_size,
+  };
+
+  static uptrwd<mem_slab> create(size_t slot_sz, size_t slots_nr,
+                                 std::shared_ptr<void const> anchor = {}) {
+    return {
+        new mem_slab(slot_sz, slots_nr, std::move(anchor)),
+        [](mem_slab *p) { p->unref(); },
+    };
+  }
+
+  mem_slab(mem_slab const &) = delete;
+  mem_slab &operator=(mem_slab const &) = delete;
+
+  mem_slab(mem_slab &&) = delete;
+  mem_slab &operator=(mem_slab &&) = delete;
+
+  size_t slot_sz() const noexcept { return slot_sz_; }
+  size_t slots_nr() const noexcept { return slots_nr_; }
+
+  /*
+   * Returns the slot idx is mapped to, nullptr if the slot is busy or
+   * cannot fit sz bytes aligned by alignment
+   */
+  void *allocate(size_t idx, size_t sz, size_t alignment) noexcept {
+    if (sz > slot_sz_ || alignment > kSlotAlignment) [[unlikely]]
+      return nullptr;
+
+    idx %= slots_nr_;
+    if (busy_[idx].test_and_set(std::memory_order_acquire)) [[unlikely]]
+      return nullptr;
+
+    return slots_.get() + idx * slot_sz_;
+  }
+
+  bool owns(void const *p) const noexcept {
+    auto const *pb = static_cast<std::byte const *>(p);
+    return !(pb < slots_.get()) && pb < slots_.get() + slots_nr_ * slot_sz_;
+  }
+
+  void free(void *p) noexcept {
+    Expects(owns(p));
+    auto const idx{
+        static_cast<size_t>(static_cast<std::byte *>(p) - slots_.get()) /
+            slot_sz_,
+    };
+    busy_[idx].clear(std::memory_order_release);
+  }
+
+  void ref() noexcept { refs_.fetch_add(1, std::memory_order_relaxed); }
+
+  void unref() noexcept {
+    if (1 == refs_.fetch_sub(1, std::memory_order_acq_rel))
+      delete this;
+  }
+
+private:
+  explicit mem_slab(size_t slot_sz, size_t slots_nr,
+                    std::shared_ptr<void const> anchor)
+      : slot_sz_(alignup(slot_sz, kSlotAlignment)), slots_nr_(slots_nr),
+        anchor_(std::move(anchor)), refs_(1) {
+    Ensures(slot_sz_);
+    Ensures(slots_nr_);
+
+    slots_ = get_unique_bytes_generator(kSlotAlignment,
+                                        slot_sz_ * slots_nr_)();
+    Ensures(slots_);
+
+    busy_ = std::make_unique<std::atomic_flag[]>(slots_nr_);
+  }
+  ~mem_slab() = default;
+
+  size_t slot_sz_;
+  size_t slots_nr_;
+  uptrwd<std::byte[]> slots_;
+  std::unique_ptr<std::atomic_flag[]> busy_;
+  std::shared_ptr<void const> anchor_;
+  std::atomic<uint64_t> refs_;
+};
+
+} // namespace ublk::mm
@@ -5,7 +5,9 @@
 
 #include <algorithm>
 #include <memory>
+#include <mutex>
 #include <new>
+#include <vector>
 
 #include <gsl/assert>
 
@@ -22,9 +24,55 @@ template <typename T, size_t Alignment = alignof(T)> class pool_allocator {
                 "Alignment must be at least alignof(T)");
 
 private:
-  static inline auto __mpool_a__ =
-      std::make_shared<mem_pool_allocator<T, Alignment>>(
-          __mem_cached_allocator__);
+  using pool_t = mem_pool_allocator<T, Alignment>;
+
+  /*
+   * Every thread allocates from a pool of its own, so that queries neither
+   * lock nor contend. The pool of a thread gone is kept for the next thread
+   * to come, blocks it has handed out may still be freed back to it
+   */
+  struct pools {
+    std::mutex mtx;
+    std::vector<std::unique_ptr<pool_t>> all;
+    std::vector<pool_t *> orphans;
+  };
+  static inline pools __pools__;
+
+  class pool_ref {
+  public:
+    pool_ref() {
+      auto const lck{std::lock_guard{__pools__.mtx}};
+      if (!__pools__.orphans.empty()) {
+        pool_ = __pools__.orphans.back();
+        __pools__.orphans.pop_back();
+      } else {
+        pool_ = __pools__.all
+                    .emplace_back(std::make_unique<pool_t>(
+                        __mem_cached_allocator__))
+                    .get();
+      }
+    }
+    ~pool_ref() {
+      auto const lck{std::lock_guard{__pools__.mtx}};
+      __pools__.orphans.push_back(pool_);
+    }
+
+    pool_ref(pool_ref const &) = delete;
+    pool_ref &operator=(pool_ref const &) = delete;
+
+    pool_ref(pool_ref &&) = delete;
+    pool_ref &operator=(pool_ref &&) = delete;
+
+    pool_t &operator*() const noexcept { return *pool_; }
+
+  private:
+    pool_t *pool_;
+  };
+
+  static pool_t &__mpool_a__() {
+    static thread_local pool_ref ref;
+    return *ref;
+  }
 
 public:
   template <typename U> struct rebind {
@@ -53,14 +101,14 @@ public:
 
   T *allocate(size_t n [[maybe_unused]]) {
     Expects(1 == n);
-    if (auto *p = static_cast<T *>(__mpool_a__->allocate()))
+    if (auto *p = static_cast<T *>(__mpool_a__().allocate()))
       return p;
     throw std::bad_alloc();
   }
 
   void deallocate(T *p, [[maybe_unused]] size_t n) noexcept {
     Expects(1 == n);
-    __mpool_a__->free(p);
+    __mpool_a__().free(p);
   }
 
   template <typename U, size_t A>
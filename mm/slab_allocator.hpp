@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+
+#include <gsl/assert>
+
+#include "utils/align.hpp"
+
+#include "mem_slab.hpp"
+#include "pool_allocator.hpp"
+
+namespace ublk::mm {
+
+/*
+ * Places the object into the slab's slot idx is mapped to. When the slot is
+ * busy or too small the object goes to the pool instead
+ */
+template <typename T> class slab_allocator {
+  template <typename U> friend class slab_allocator;
+
+  using fallback_allocator =
+      pool_allocator<T, hardware_destructive_interference_size>;
+
+public:
+  using value_type = T;
+
+  template <typename U> struct rebind {
+    using other = slab_allocator<U>;
+  };
+
+  explicit slab_allocator(mem_slab &slab, size_t idx) noexcept
+      : slab_(&slab), idx_(idx) {}
+  ~slab_allocator() = default;
+
+  slab_allocator(slab_allocator const &other) = default;
+  slab_allocator &operator=(slab_allocator const &other) = default;
+
+  slab_allocator(slab_allocator &&other) = default;
+  slab_allocator &operator=(slab_allocator &&other) = default;
+
+  template <typename U>
+  explicit slab_allocator(slab_allocator<U> const &other) noexcept
+      : slab_(other.slab_), idx_(other.idx_) {}
+
+  T *allocate(size_t n [[maybe_unused]]) {
+    Expects(1 == n);
+    auto *p = static_cast<T *>(slab_->allocate(idx_, sizeof(T), alignof(T)));
+    if (!p) [[unlikely]]
+      p = fallback_allocator{}.allocate(1);
+    slab_->ref();
+    return p;
+  }
+
+  void deallocate(T *p, [[maybe_unused]] size_t n) noexcept {
+    Expects(1 == n);
+    if (slab_->owns(p)) [[likely]]
+      slab_->free(p);
+    else
+      fallback_allocator{}.deallocate(p, 1);
+    slab_->unref();
+  }
+
+  template <typename U>
+  bool operator==(slab_allocator<U> const &other) const noexcept {
+    return slab_ == other.slab_;
+  }
+
+  template <typename U>
+  bool operator!=(slab_allocator<U> const &other) const noexcept {
+    return !(*this == other);
+  }
+
+private:
+  mem_slab *slab_;
+  size_t idx_;
+};
+
+} // namespace ublk::mm
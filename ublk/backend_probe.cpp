@@ -0,0 +1,114 @@
+#include "backend_probe.hpp"
+
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+
+#include <cerrno>
+#include <cstdint>
+
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <system_error>
+
+#include "sys/file.hpp"
+
+#include "sector.hpp"
+
+namespace ublk {
+
+namespace {
+
+std::filesystem::path queue_dir(dev_t dev) {
+  auto const dir{
+      std::filesystem::path{
+          std::format("/sys/dev/block/{}:{}", major(dev), minor(dev)),
+      },
+  };
+  /* partitions go by the queue of the whole disk */
+  if (auto ec{std::error_code{}}; std::filesystem::exists(dir / "queue", ec))
+    return dir / "queue";
+  return dir / ".." / "queue";
+}
+
+template <typename T>
+T queue_attr(std::filesystem::path const &qdir, char const *name,
+             T dflt) noexcept {
+  try {
+    auto v{T{}};
+    if (std::ifstream f{qdir / name}; f >> v)
+      return v;
+  } catch (...) {
+  }
+  return dflt;
+}
+
+} // namespace
+
+backend_properties backend_probe(std::filesystem::path const &path) {
+  auto props{
+      backend_properties{
+          .path = path,
+          .blkdev = false,
+          .sz = 0,
+          .logical_block_sz = static_cast<uint32_t>(kSectorSz),
+          .physical_block_sz = static_cast<uint32_t>(kSectorSz),
+          .optimal_io_sz = 0,
+          .rotational = false,
+          .discard_granularity = 0,
+          .queue_depth = 0,
+      },
+  };
+
+  struct stat st;
+  if (::stat(path.c_str(), &st) < 0) {
+    if (ENOENT != errno)
+      throw std::system_error(errno, std::generic_category(), path.string());
+    auto const dir{path.has_parent_path() ? path.parent_path() : "."};
+    if (::stat(dir.c_str(), &st) < 0)
+      throw std::system_error(errno, std::generic_category(), dir.string());
+    st.st_size = 0;
+  }
+
+  auto const qdir{queue_dir(S_ISBLK(st.st_mode) ? st.st_rdev : st.st_dev)};
+
+  if (S_ISBLK(st.st_mode)) {
+    props.blkdev = true;
+
+    auto const fd{sys::open(path, O_RDONLY | O_CLOEXEC)};
+    if (::ioctl(*fd, BLKGETSIZE64, &props.sz) < 0)
+      throw std::system_error(errno, std::generic_category(), "BLKGETSIZE64");
+    if (int lbs{0}; 0 == ::ioctl(*fd, BLKSSZGET, &lbs) && lbs > 0)
+      props.logical_block_sz = static_cast<uint32_t>(lbs);
+    if (unsigned pbs{0}; 0 == ::ioctl(*fd, BLKPBSZGET, &pbs) && pbs)
+      props.physical_block_sz = pbs;
+    if (unsigned opt{0}; 0 == ::ioctl(*fd, BLKIOOPT, &opt))
+      props.optimal_io_sz = opt;
+    if (unsigned short rot{0}; 0 == ::ioctl(*fd, BLKROTATIONAL, &rot))
+      props.rotational = 0 != rot;
+  } else {
+    props.sz = static_cast<uint64_t>(st.st_size);
+    props.logical_block_sz =
+        queue_attr(qdir, "logical_block_size", props.logical_block_sz);
+    props.physical_block_sz =
+        queue_attr(qdir, "physical_block_size", props.physical_block_sz);
+    props.optimal_io_sz =
+        queue_attr(qdir, "optimal_io_size", props.optimal_io_sz);
+    props.rotational = 0 != queue_attr(qdir, "rotational", 0u);
+  }
+
+  props.discard_granularity =
+      queue_attr(qdir, "discard_granularity", props.discard_granularity);
+  /* holes get punched into files whatever the device below */
+  if (!props.blkdev && !props.discard_granularity)
+    props.discard_granularity = static_cast<uint32_t>(st.st_blksize);
+
+  props.queue_depth = queue_attr(qdir, "nr_requests", props.queue_depth);
+
+  return props;
+}
+
+} // namespace ublk
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <filesystem>
+
+#include "backend_properties.hpp"
+
+namespace ublk {
+
+/*
+ * Block devices are asked by ioctl()s, the queue limits are read from sysfs.
+ * Files have those of the device of the file system they are on. A path not
+ * existing yet stands for a file to be created
+ */
+backend_properties backend_probe(std::filesystem::path const &path);
+
+} // namespace ublk
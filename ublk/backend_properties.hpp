@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+#include <filesystem>
+
+namespace ublk {
+
+/* What a backend has been found to be at the time its target was created */
+struct backend_properties {
+  std::filesystem::path path;
+  bool blkdev;
+  /* the current one for a file, files grow as written to */
+  uint64_t sz;
+  uint32_t logical_block_sz;
+  uint32_t physical_block_sz;
+  /* 0 if not reported */
+  uint32_t optimal_io_sz;
+  bool rotational;
+  /* 0 if discards are not supported */
+  uint32_t discard_granularity;
+  /* of the request queue of the device, 0 if not known */
+  uint32_t queue_depth;
+};
+
+} // namespace ublk
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstdint>
+
+#include <filesystem>
 #include <string>
 
 namespace ublk {
@@ -9,6 +12,16 @@ struct bdev_map_param {
   std::string target_name;
   bool read_only;
   bool zero_copy;
+  uint32_t ack_batch_max;
+  uint32_t ack_delay_max_us;
+  uint32_t poll_budget_us;
+  /* every n-th command gets traced, 0 turns tracing off */
+  uint32_t trace_sample_every;
+  /*
+   * Where the traces get dumped, /run/ublk if left empty. It must be a
+   * directory nobody but its owner may write into
+   */
+  std::filesystem::path trace_dir;
 };
 
 } // namespace ublk
@@ -0,0 +1,38 @@
+#include "discard_handler.hpp"
+
+#include <memory>
+#include <utility>
+
+#include <gsl/assert>
+
+namespace ublk::cache {
+
+DiscardHandler::DiscardHandler(std::shared_ptr<RWHandler> cache,
+                               std::shared_ptr<IDiscardHandler> handler)
+    : cache_(std::move(cache)), handler_(std::move(handler)) {
+  Ensures(cache_);
+  Ensures(handler_);
+}
+
+int DiscardHandler::submit(std::shared_ptr<discard_query> dq) noexcept {
+  Expects(dq);
+
+  if (0 == dq->size()) [[unlikely]]
+    return handler_->submit(std::move(dq));
+
+  auto *p_dq = dq.get();
+  auto new_dq{
+      p_dq->subquery(p_dq->offset(), p_dq->size(),
+                     [this, dq = std::move(dq)](discard_query const &sq) {
+                       cache_->invalidate(dq->offset(), dq->size());
+                       if (sq.err()) [[unlikely]] {
+                         dq->set_err(sq.err());
+                         return;
+                       }
+                     }),
+  };
+
+  return handler_->submit(std::move(new_dq));
+}
+
+} // namespace ublk::cache
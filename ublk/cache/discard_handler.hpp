@@ -0,0 +1,35 @@
+#pragma once
+
+#include <memory>
+
+#include "discard_handler_interface.hpp"
+#include "discard_query.hpp"
+
+#include "rw_handler.hpp"
+
+namespace ublk::cache {
+
+/*
+ * Chunks of the range discarded get invalidated once the discard is over, as
+ * they do for writes
+ */
+class DiscardHandler final : public IDiscardHandler {
+public:
+  explicit DiscardHandler(std::shared_ptr<RWHandler> cache,
+                          std::shared_ptr<IDiscardHandler> handler);
+  ~DiscardHandler() override = default;
+
+  DiscardHandler(DiscardHandler const &) = delete;
+  DiscardHandler &operator=(DiscardHandler const &) = delete;
+
+  DiscardHandler(DiscardHandler &&) = delete;
+  DiscardHandler &operator=(DiscardHandler &&) = delete;
+
+  int submit(std::shared_ptr<discard_query> dq) noexcept override;
+
+private:
+  std::shared_ptr<RWHandler> cache_;
+  std::shared_ptr<IDiscardHandler> handler_;
+};
+
+} // namespace ublk::cache
@@ -42,7 +42,8 @@ namespace ublk::cache {
 
 RWHandler::RWHandler(uint64_t cache_len_sectors,
                      std::unique_ptr<IRWHandler> handler,
-                     bool write_through /* = true*/) {
+                     bool write_through /* = true*/,
+                     std::shared_ptr<target_stats> stats /* = {}*/) {
   auto cache_sp{
       std::shared_ptr{make_cache(sectors_to_bytes(cache_len_sectors))},
   };
@@ -53,8 +54,10 @@ RWHandler::RWHandler(uint64_t cache_len_sectors,
   auto pool = std::make_shared<mm::mem_chunk_pool>(kCachedChunkAlignment,
                                                    cache_sp->item_sz());
 
-  handlers_[0] = std::make_shared<RWIHandler>(cache_sp, handler_sp, pool);
-  handlers_[1] = std::make_shared<RWTHandler>(cache_sp, handler_sp, pool);
+  handlers_[0] =
+      std::make_shared<RWIHandler>(cache_sp, handler_sp, pool, stats);
+  handlers_[1] = std::make_shared<RWTHandler>(cache_sp, handler_sp, pool,
+                                              std::move(stats));
 
   set_write_through(write_through);
 }
@@ -75,4 +78,9 @@ int RWHandler::submit(std::shared_ptr<write_query> wq) noexcept {
   return handler_->submit(std::move(wq));
 }
 
+void RWHandler::invalidate(uint64_t offset, uint64_t sz) noexcept {
+  for (auto const &h : handlers_)
+    h->invalidate(offset, sz);
+}
+
 } // namespace ublk::cache
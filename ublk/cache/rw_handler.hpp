@@ -10,6 +10,9 @@
 
 #include "rw_handler_interface.hpp"
 #include "sector.hpp"
+#include "target_stats.hpp"
+
+#include "rwi_handler.hpp"
 
 namespace ublk::cache {
 
@@ -22,7 +25,8 @@ private:
 public:
   explicit RWHandler(uint64_t cache_len_sectors,
                      std::unique_ptr<IRWHandler> handler,
-                     bool write_through = true);
+                     bool write_through = true,
+                     std::shared_ptr<target_stats> stats = {});
   ~RWHandler() override = default;
 
   RWHandler(RWHandler const &) = delete;
@@ -37,9 +41,12 @@ public:
   int submit(std::shared_ptr<read_query> rq) noexcept override;
   int submit(std::shared_ptr<write_query> wq) noexcept override;
 
+  /* Drops the chunks of the range whatever the mode is */
+  void invalidate(uint64_t offset, uint64_t sz) noexcept;
+
 private:
   std::shared_ptr<IRWHandler> handler_;
-  std::array<std::shared_ptr<IRWHandler>, 2> handlers_;
+  std::array<std::shared_ptr<RWIHandler>, 2> handlers_;
 };
 
 } // namespace ublk::cache
@@ -12,6 +12,8 @@
 #include "utils/algo.hpp"
 #include "utils/utility.hpp"
 
+#include "trace/trace.hpp"
+
 #include "read_query.hpp"
 #include "write_query.hpp"
 
@@ -20,9 +22,11 @@ namespace ublk::cache {
 RWIHandler::RWIHandler(
     std::shared_ptr<cache::flat_lru<uint64_t, std::byte>> cache,
     std::shared_ptr<IRWHandler> handler,
-    std::shared_ptr<mm::mem_chunk_pool> mem_chunk_pool) noexcept
+    std::shared_ptr<mm::mem_chunk_pool> mem_chunk_pool,
+    std::shared_ptr<target_stats> stats /* = {}*/) noexcept
     : cache_(std::move(cache)), handler_(std::move(handler)),
-      mem_chunk_pool_(std::move(mem_chunk_pool)), last_wq_done_seq_(0) {
+      mem_chunk_pool_(std::move(mem_chunk_pool)), last_wq_done_seq_(0),
+      stats_(std::move(stats)) {
   Ensures(cache_);
   Ensures(handler_);
   Ensures(mem_chunk_pool_);
@@ -44,10 +48,17 @@ int RWIHandler::submit(std::shared_ptr<read_query> rq) noexcept {
 
     if (auto cached_chunk = cache_->find(chunk_id); !cached_chunk.empty())
         [[likely]] {
+      if (stats_)
+        stats_add(stats_->cache_hits, 1);
+      trace::record("cache.hit", rq->trace_id());
       auto const from{cached_chunk.subspan(chunk_offset, chunk.size())};
       auto const to{chunk};
       algo::copy(from, to);
     } else {
+      if (stats_)
+        stats_add(stats_->cache_misses, 1);
+      trace::record("cache.miss", rq->trace_id());
+
       auto mem_chunk = mem_chunk_pool_->get();
       Ensures(mem_chunk);
 
@@ -71,6 +82,8 @@ int RWIHandler::submit(std::shared_ptr<read_query> rq) noexcept {
               cache_->update({chunk_id, std::move(*mem_chunk_holder)});
           });
 
+      chunk_rq->set_trace_id(rq->trace_id());
+
       if (auto const res{handler_->submit(std::move(chunk_rq))}) [[unlikely]] {
         return res;
       }
@@ -87,16 +100,10 @@ int RWIHandler::submit(std::shared_ptr<write_query> wq) noexcept {
   Expects(wq);
   Expects(0 != wq->buf().size());
 
-  auto const chunk_id_first{wq->offset() / cache_->item_sz()};
-  auto const chunk_id_last{
-      div_round_up(wq->offset() + wq->buf().size(), cache_->item_sz()),
-  };
-
   auto new_wq{
       wq->subquery(0, wq->buf().size(), wq->offset(),
-                   [=, this, wq = std::move(wq)](write_query const &chunk_wq) {
-                     cache_->invalidate_range({chunk_id_first, chunk_id_last});
-                     ++last_wq_done_seq_;
+                   [this, wq = std::move(wq)](write_query const &chunk_wq) {
+                     invalidate(wq->offset(), wq->buf().size());
                      if (chunk_wq.err()) [[unlikely]] {
                        wq->set_err(chunk_wq.err());
                        return;
@@ -111,4 +118,14 @@ int RWIHandler::submit(std::shared_ptr<write_query> wq) noexcept {
   return 0;
 }
 
+void RWIHandler::invalidate(uint64_t offset, uint64_t sz) noexcept {
+  Expects(0 != sz);
+
+  cache_->invalidate_range({
+      offset / cache_->item_sz(),
+      div_round_up(offset + sz, cache_->item_sz()),
+  });
+  ++last_wq_done_seq_;
+}
+
 } // namespace ublk::cache
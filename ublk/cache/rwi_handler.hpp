@@ -8,6 +8,7 @@
 #include "mm/mem_chunk_pool.hpp"
 
 #include "rw_handler_interface.hpp"
+#include "target_stats.hpp"
 
 #include "flat_lru.hpp"
 #include "write_query.hpp"
@@ -19,7 +20,8 @@ public:
   explicit RWIHandler(
       std::shared_ptr<cache::flat_lru<uint64_t, std::byte>> cache,
       std::shared_ptr<IRWHandler> handler,
-      std::shared_ptr<mm::mem_chunk_pool> mem_chunk_pool) noexcept;
+      std::shared_ptr<mm::mem_chunk_pool> mem_chunk_pool,
+      std::shared_ptr<target_stats> stats = {}) noexcept;
   ~RWIHandler() override = default;
 
   RWIHandler(RWIHandler const &) = delete;
@@ -31,11 +33,16 @@ public:
   int submit(std::shared_ptr<read_query> rq) noexcept override;
   int submit(std::shared_ptr<write_query> wq) noexcept override;
 
+  /* Reads of the range in flight do not get their chunks cached either */
+  void invalidate(uint64_t offset, uint64_t sz) noexcept;
+
 protected:
   std::shared_ptr<cache::flat_lru<uint64_t, std::byte>> cache_;
   std::shared_ptr<IRWHandler> handler_;
   std::shared_ptr<mm::mem_chunk_pool> mem_chunk_pool_;
   uint64_t last_wq_done_seq_;
+  /* reads are accounted as hits or misses chunk by chunk */
+  std::shared_ptr<target_stats> stats_;
 };
 
 } // namespace ublk::cache
@@ -11,14 +11,17 @@
 
 #include "utils/algo.hpp"
 
+#include "trace/trace.hpp"
+
 namespace ublk::cache {
 
 RWTHandler::RWTHandler(
     std::shared_ptr<cache::flat_lru<uint64_t, std::byte>> cache,
     std::shared_ptr<IRWHandler> handler,
-    std::shared_ptr<mm::mem_chunk_pool> mem_chunk_pool) noexcept
+    std::shared_ptr<mm::mem_chunk_pool> mem_chunk_pool,
+    std::shared_ptr<target_stats> stats /* = {}*/) noexcept
     : RWIHandler(std::move(cache), std::move(handler),
-                 std::move(mem_chunk_pool)),
+                 std::move(mem_chunk_pool), std::move(stats)),
       chunk_w_locker_(0, mm::allocator::cache_line_aligned<uint64_t>::value) {}
 
 int RWTHandler::process(std::shared_ptr<write_query> wq) noexcept {
@@ -50,6 +53,7 @@ int RWTHandler::process(std::shared_ptr<write_query> wq) noexcept {
     Ensures(mem_chunk);
 
     auto mem_chunk_span = mem_chunk_pool_->chunk_view(mem_chunk);
+    auto const trace_id{wq->trace_id()};
     auto rmwq = read_query::create(
         mem_chunk_span, chunk_id * cache_->item_sz(),
         [this, chunk_id, chunk_offset, chunk, mem_chunk_span,
@@ -73,6 +77,8 @@ int RWTHandler::process(std::shared_ptr<write_query> wq) noexcept {
             return;
           }
         });
+    rmwq->set_trace_id(trace_id);
+    trace::record("cache.rmw", trace_id);
     if (auto const res{handler_->submit(std::move(rmwq))}) [[unlikely]] {
       return res;
     }
@@ -12,6 +12,7 @@
 
 #include "utils/bitset_locker.hpp"
 
+#include "target_stats.hpp"
 #include "write_query.hpp"
 
 #include "flat_lru.hpp"
@@ -25,7 +26,8 @@ public:
   explicit RWTHandler(
       std::shared_ptr<cache::flat_lru<uint64_t, std::byte>> cache,
       std::shared_ptr<IRWHandler> handler,
-      std::shared_ptr<mm::mem_chunk_pool> mem_chunk_pool) noexcept;
+      std::shared_ptr<mm::mem_chunk_pool> mem_chunk_pool,
+      std::shared_ptr<target_stats> stats = {}) noexcept;
   ~RWTHandler() override = default;
 
   RWTHandler(RWTHandler const &) = delete;
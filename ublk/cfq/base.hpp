@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+
 #include <concepts>
 #include <span>
 #include <stdexcept>
@@ -16,6 +18,13 @@ public:
   [[nodiscard]] auto capacity_full() const noexcept { return items_.size(); }
   [[nodiscard]] auto capacity() const noexcept { return capacity_full() - 1; }
 
+  /* The number of items queued, a snapshot as the other side keeps going */
+  [[nodiscard]] size_t size() const noexcept {
+    auto const ch{__atomic_load_n(ph_.get(), __ATOMIC_ACQUIRE)};
+    auto const ct{__atomic_load_n(pt_.get(), __ATOMIC_ACQUIRE)};
+    return (ct + capacity_full() - ch) % capacity_full();
+  }
+
 protected:
   explicit base(pos_t<I1> p_head, pos_t<I2> p_tail, std::span<T> items)
       : ph_(std::move(p_head)), pt_(std::move(p_tail)), items_(items) {
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
 #include <optional>
 #include <span>
 #include <type_traits>
@@ -48,6 +50,32 @@ public:
 
     return v;
   }
+
+  /*
+   * Pops as many items as available and fit into vs, the head is published
+   * once for the whole run. Returns the number of items popped
+   */
+  size_t pop_n(std::span<T> vs) noexcept(std::is_nothrow_copy_assignable_v<T>) {
+    auto const ch{__atomic_load_n(this->ph_.get(), __ATOMIC_RELAXED)};
+    auto const ct{__atomic_load_n(this->pt_.get(), __ATOMIC_ACQUIRE)};
+    auto const cap{this->capacity_full()};
+
+    Expects(ch < cap);
+    Expects(ct < cap);
+
+    auto const n{std::min((ct + cap - ch) % cap, vs.size())};
+    if (!n) [[unlikely]]
+      return 0;
+
+    auto const n1{std::min(n, cap - ch)};
+    std::copy_n(this->items_.begin() + ch, n1, vs.begin());
+    std::copy_n(this->items_.begin(), n - n1, vs.begin() + n1);
+
+    __atomic_store_n(this->ph_.get(), static_cast<I1>((ch + n) % cap),
+                     __ATOMIC_RELEASE);
+
+    return n;
+  }
 };
 
 } // namespace ublk::cfq
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
 #include <span>
 #include <type_traits>
 #include <utility>
@@ -43,6 +45,33 @@ public:
 
     return false;
   }
+
+  /*
+   * Pushes as many items of vs as there is room for, the tail is published
+   * once for the whole run. Returns the number of items pushed
+   */
+  size_t push_n(std::span<T const> vs) noexcept(
+      std::is_nothrow_copy_assignable_v<T>) {
+    auto const ct{*this->pt_};
+    auto const ch{__atomic_load_n(this->ph_.get(), __ATOMIC_ACQUIRE)};
+    auto const cap{this->capacity_full()};
+
+    Expects(ch < cap);
+    Expects(ct < cap);
+
+    auto const n{std::min((ch + cap - ct - 1) % cap, vs.size())};
+    if (!n) [[unlikely]]
+      return 0;
+
+    auto const n1{std::min(n, cap - ct)};
+    std::copy_n(vs.begin(), n1, this->items_.begin() + ct);
+    std::copy_n(vs.begin() + n1, n - n1, this->items_.begin());
+
+    __atomic_store_n(this->pt_.get(), static_cast<I2>((ct + n) % cap),
+                     __ATOMIC_RELEASE);
+
+    return n;
+  }
 };
 
 } // namespace ublk::cfq
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+
+#include <chrono>
+#include <memory>
+
+#include "target_stats.hpp"
+
+namespace ublk {
+
+struct cmd_ack_param {
+  /*
+   * Max number of acks accumulated before the kernel gets notified.
+   * 0 means the kernel is notified about every single ack
+   */
+  uint32_t batch_max;
+  /*
+   * Max time an ack may stay unnotified. 0 means the notification is
+   * sent once per io_context's turn
+   */
+  std::chrono::microseconds delay_max;
+  /* where the ack ring's occupancy is reported to, may be empty */
+  std::shared_ptr<target_stats> stats;
+};
+
+} // namespace ublk
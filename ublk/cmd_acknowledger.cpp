@@ -5,12 +5,15 @@
 #include <cstdint>
 #include <cstdlib>
 
+#include <chrono>
 #include <format>
 #include <ostream>
 #include <sstream>
-#include <thread>
 #include <utility>
 
+#include <boost/asio/post.hpp>
+#include <boost/system/error_code.hpp>
+
 #include <fmt/format.h>
 #include <gsl/assert>
 #include <spdlog/spdlog.h>
@@ -33,26 +36,88 @@ struct fmt::formatter<ublkdrv_cmd_ack> : fmt::formatter<std::string> {
 
 namespace ublk {
 
-CmdAcknowledger::CmdAcknowledger(std::unique_ptr<qublkcmd_ack_t> qcmd_ack,
-                                 mm::uptrwd<const int> fd_notify)
-    : qcmd_ack_(std::move(qcmd_ack)), fd_notify_(std::move(fd_notify)) {
+CmdAcknowledger::CmdAcknowledger(boost::asio::io_context &io_ctx,
+                                 std::unique_ptr<qublkcmd_ack_t> qcmd_ack,
+                                 mm::uptrwd<const int> fd_notify,
+                                 cmd_ack_param const &param)
+    : qcmd_ack_(std::move(qcmd_ack)), fd_notify_(std::move(fd_notify)),
+      param_(param), ex_(io_ctx.get_executor()), flush_scheduled_(false),
+      flush_timer_(io_ctx) {
   Ensures(qcmd_ack_);
   Ensures(fd_notify_);
+
+  acks_pending_.reserve(qcmd_ack_->capacity());
 }
 
 int CmdAcknowledger::handle(ublkdrv_cmd_ack cmd) noexcept {
+  /* With workers the requests complete in the workers' threads */
+  if (!ex_.running_in_this_thread()) [[unlikely]] {
+    boost::asio::post(ex_,
+                      [self = shared_from_this(), cmd] {
+                        if (auto const r{self->handle(cmd)}) [[unlikely]] {
+                          spdlog::error("failed to acknowledge, r {}", r);
+                          std::abort();
+                        }
+                      });
+    return 0;
+  }
+
   spdlog::debug("acknowledging {}", cmd);
 
-  while (!qcmd_ack_->push(cmd))
-    std::this_thread::yield();
+  acks_pending_.push_back(cmd);
 
-  if (uint32_t new_cmds = 1;
-      4 != write(*fd_notify_, &new_cmds, sizeof(new_cmds))) [[unlikely]] {
+  if (!param_.batch_max || acks_pending_.size() >= param_.batch_max)
+    return flush();
+
+  flush_schedule(param_.delay_max);
+
+  return 0;
+}
 
-    return EXIT_FAILURE;
+int CmdAcknowledger::flush() noexcept {
+  if (uint32_t const acks = qcmd_ack_->push_n(acks_pending_); acks) [[likely]] {
+    acks_pending_.erase(acks_pending_.begin(), acks_pending_.begin() + acks);
+    if (sizeof(acks) != write(*fd_notify_, &acks, sizeof(acks))) [[unlikely]]
+      return EXIT_FAILURE;
   }
 
+  if (param_.stats)
+    stats_set(param_.stats->cmdb_ack_occupancy, qcmd_ack_->size());
+
+  /*
+   * The ack ring is full, the kernel has been notified and is going to
+   * release the space, so the rest is pushed on one of the next turns
+   */
+  if (!acks_pending_.empty()) [[unlikely]]
+    flush_schedule({});
+
   return 0;
 }
 
+void CmdAcknowledger::flush_schedule(std::chrono::microseconds delay) noexcept {
+  if (std::exchange(flush_scheduled_, true))
+    return;
+
+  auto f{
+      [self = shared_from_this()] {
+        self->flush_scheduled_ = false;
+        if (auto const r{self->flush()}) [[unlikely]] {
+          spdlog::error("failed to notify about acks, r {}", r);
+          std::abort();
+        }
+      },
+  };
+
+  if (delay.count()) {
+    flush_timer_.expires_after(delay);
+    flush_timer_.async_wait(
+        [f = std::move(f)](boost::system::error_code const &ec) {
+          if (!ec) [[likely]]
+            f();
+        });
+  } else {
+    boost::asio::post(flush_timer_.get_executor(), std::move(f));
+  }
+}
+
 } // namespace ublk
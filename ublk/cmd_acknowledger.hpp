@@ -1,33 +1,53 @@
 #pragma once
 
+#include <chrono>
 #include <memory>
+#include <vector>
 
 #include <linux/ublkdrv/cmd_ack.h>
 
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/steady_timer.hpp>
+
 #include "mm/mem_types.hpp"
 
+#include "cmd_ack_param.hpp"
 #include "handler_interface.hpp"
 #include "qublkcmd.hpp"
 
 namespace ublk {
 
-class CmdAcknowledger : public IHandler<int(ublkdrv_cmd_ack) noexcept> {
+class CmdAcknowledger
+    : public IHandler<int(ublkdrv_cmd_ack) noexcept>,
+      public std::enable_shared_from_this<CmdAcknowledger> {
 public:
-  explicit CmdAcknowledger(std::unique_ptr<qublkcmd_ack_t> qcmd_ack,
-                           mm::uptrwd<const int> fd_notify);
+  explicit CmdAcknowledger(boost::asio::io_context &io_ctx,
+                           std::unique_ptr<qublkcmd_ack_t> qcmd_ack,
+                           mm::uptrwd<const int> fd_notify,
+                           cmd_ack_param const &param = {});
   ~CmdAcknowledger() override = default;
 
   CmdAcknowledger(CmdAcknowledger const &) = delete;
   CmdAcknowledger &operator=(CmdAcknowledger const &) = delete;
 
-  CmdAcknowledger(CmdAcknowledger &&) = default;
-  CmdAcknowledger &operator=(CmdAcknowledger &&) = default;
+  CmdAcknowledger(CmdAcknowledger &&) = delete;
+  CmdAcknowledger &operator=(CmdAcknowledger &&) = delete;
 
   int handle(ublkdrv_cmd_ack cmd) noexcept override;
 
 private:
+  int flush() noexcept;
+  void flush_schedule(std::chrono::microseconds delay) noexcept;
+
   std::unique_ptr<qublkcmd_ack_t> qcmd_ack_;
   mm::uptrwd<const int> fd_notify_;
+  cmd_ack_param param_;
+  boost::asio::io_context::executor_type ex_;
+
+  /* acks that have not been pushed into the ack ring yet, kept in order */
+  std::vector<ublkdrv_cmd_ack> acks_pending_;
+  bool flush_scheduled_;
+  boost::asio::steady_timer flush_timer_;
 };
 
 } // namespace ublk
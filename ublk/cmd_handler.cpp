@@ -3,28 +3,121 @@
 #include <cstddef>
 
 #include <algorithm>
+#include <chrono>
 #include <memory>
 #include <ranges>
+#include <vector>
 
 #include <linux/ublkdrv/cmd.h>
 
 #include <gsl/assert>
 
+#include "mm/slab_allocator.hpp"
+
+#include "trace/trace.hpp"
+
 #include "discard_req.hpp"
 #include "flush_req.hpp"
+#include "for_each_celld.hpp"
 #include "read_req.hpp"
 #include "req_handler_not_supp.hpp"
 #include "write_req.hpp"
 
+namespace {
+
+constexpr auto kReqCtrlBlockSzMax{64uz};
+
+void ack(ublk::IHandler<int(ublkdrv_cmd_ack) noexcept> &acknowledger,
+         ublk::req const &rq) noexcept {
+  ublk::trace::record("cmd", rq.trace_id(), ublk::trace::phase::end);
+  ublkdrv_cmd_ack cmd_ack;
+  ublkdrv_cmd_ack_set_id(&cmd_ack, ublkdrv_cmd_get_id(&rq.cmd()));
+  ublkdrv_cmd_ack_set_err(&cmd_ack, static_cast<__u16>(rq.err()));
+  acknowledger.handle(cmd_ack);
+}
+
+uint64_t cmd_bytes(ublkdrv_cmd const &cmd,
+                   std::span<ublkdrv_celld const> cellds,
+                   std::span<std::byte const> cells) noexcept {
+  uint64_t bytes{0};
+  auto const sum{[&bytes](uint64_t, std::span<std::byte const> buf) {
+    bytes += buf.size();
+    return 0;
+  }};
+
+  switch (ublkdrv_cmd_get_op(&cmd)) {
+  case UBLKDRV_CMD_OP_READ:
+    ublk::for_each_celld(ublkdrv_cmd_read_get_offset(&cmd.u.r),
+                         ublkdrv_cmd_read_get_fcdn(&cmd.u.r),
+                         ublkdrv_cmd_read_get_cds_nr(&cmd.u.r), cellds, cells,
+                         sum);
+    break;
+  case UBLKDRV_CMD_OP_WRITE:
+    ublk::for_each_celld(ublkdrv_cmd_write_get_offset(&cmd.u.w),
+                         ublkdrv_cmd_write_get_fcdn(&cmd.u.w),
+                         ublkdrv_cmd_write_get_cds_nr(&cmd.u.w), cellds, cells,
+                         sum);
+    break;
+  case UBLKDRV_CMD_OP_DISCARD:
+    bytes = ublkdrv_cmd_discard_get_sz(&cmd.u.d);
+    break;
+  default:
+    break;
+  }
+
+  return bytes;
+}
+
+} // namespace
+
 namespace ublk {
 
+/*
+ * Keeps when and how much every command in flight has been started with, the
+ * records are indexed by commands ids as the requests' slots are
+ */
+struct CmdHandler::stats_tracker {
+  struct cmd_record {
+    std::chrono::steady_clock::time_point start;
+    uint64_t bytes;
+  };
+
+  std::shared_ptr<IHandler<int(ublkdrv_cmd_ack) noexcept>> acknowledger;
+  std::shared_ptr<target_stats> stats;
+  std::vector<cmd_record> cmds;
+};
+
 CmdHandler::CmdHandler(
     std::span<ublkdrv_celld const> cellds, std::span<std::byte> cells,
     std::shared_ptr<IHandler<int(ublkdrv_cmd_ack) noexcept>> acknowledger,
-    std::map<ublkdrv_cmd_op, std::shared_ptr<IUblkReqHandler>> const &maphs)
+    std::map<ublkdrv_cmd_op, std::shared_ptr<IUblkReqHandler>> const &maphs,
+    std::shared_ptr<target_stats> stats /* = {}*/)
     : cellds_(cellds), cells_(cells), acknowledger_(std::move(acknowledger)) {
   Ensures(acknowledger_);
 
+  if (stats) {
+    stats_tracker_ = std::make_shared<stats_tracker>(stats_tracker{
+        .acknowledger = acknowledger_,
+        .stats = std::move(stats),
+        .cmds = std::vector<stats_tracker::cmd_record>(cellds_.size()),
+    });
+  }
+
+  /*
+   * A request and its shared_ptr's control block fit into a slot. There
+   * cannot be more read/write requests in flight than cells descriptors.
+   * The slab keeps the acknowledger alive while requests use it
+   */
+  constexpr auto kReqSlotSz{
+      std::max({sizeof(read_req), sizeof(write_req), sizeof(flush_req),
+                sizeof(discard_req)}) +
+          kReqCtrlBlockSzMax,
+  };
+  req_slab_ = mm::mem_slab::create(
+      kReqSlotSz, cellds_.size(),
+      stats_tracker_ ? std::shared_ptr<void const>{stats_tracker_}
+                     : std::shared_ptr<void const>{acknowledger_});
+
   static auto reqh_not_supp{ReqHandlerNotSupp{}};
   static auto const sp_reqh_not_supp{
       std::shared_ptr<IUblkReqHandler>{&reqh_not_supp,
@@ -43,40 +136,70 @@ CmdHandler::CmdHandler(
 int CmdHandler::handle(ublkdrv_cmd const &cmd) noexcept {
   auto rq = std::shared_ptr<req>{};
 
-  auto completer{
-      [a = acknowledger_](req const &rq) {
-        ublkdrv_cmd_ack cmd_ack;
-        ublkdrv_cmd_ack_set_id(&cmd_ack, ublkdrv_cmd_get_id(&rq.cmd()));
-        ublkdrv_cmd_ack_set_err(&cmd_ack, static_cast<__u16>(rq.err()));
-        a->handle(cmd_ack);
+  auto completion{
+      req::completion{
+          .f = [](void *ctx, req const &rq) noexcept {
+            ack(*static_cast<IHandler<int(ublkdrv_cmd_ack) noexcept> *>(ctx),
+                rq);
+          },
+          .ctx = acknowledger_.get(),
       },
   };
 
+  if (stats_tracker_) {
+    auto &rec{
+        stats_tracker_
+            ->cmds[ublkdrv_cmd_get_id(&cmd) % stats_tracker_->cmds.size()],
+    };
+    rec.start = std::chrono::steady_clock::now();
+    rec.bytes = cmd_bytes(cmd, cellds_, cells_);
+    stats_add(stats_tracker_->stats->cmds_inflight, 1);
+
+    completion = {
+        .f = [](void *ctx, req const &rq) noexcept {
+          auto *t = static_cast<stats_tracker *>(ctx);
+          auto const &rec{
+              t->cmds[ublkdrv_cmd_get_id(&rq.cmd()) % t->cmds.size()],
+          };
+          if (auto *op_stats{
+                  stats_of(*t->stats, static_cast<ublkdrv_cmd_op>(
+                                          ublkdrv_cmd_get_op(&rq.cmd()))),
+              }) {
+            stats_account(*op_stats, rec.bytes, rq.err(),
+                          std::chrono::steady_clock::now() - rec.start);
+          }
+          stats_sub(t->stats->cmds_inflight, 1);
+          ack(*t->acknowledger, rq);
+        },
+        .ctx = stats_tracker_.get(),
+    };
+  }
+
+  auto const a{
+      mm::slab_allocator<req>{*req_slab_, ublkdrv_cmd_get_id(&cmd)},
+  };
+
   auto const op = ublkdrv_cmd_get_op(&cmd);
   switch (op) {
   case UBLKDRV_CMD_OP_READ:
-    rq = read_req::create(cmd, cellds_, cells_, std::move(completer));
+    rq = std::allocate_shared<read_req>(a, cmd, cellds_, cells_, completion);
     break;
   case UBLKDRV_CMD_OP_WRITE:
-    rq = write_req::create(cmd, cellds_, cells_, std::move(completer));
+    rq = std::allocate_shared<write_req>(a, cmd, cellds_, cells_, completion);
     break;
   case UBLKDRV_CMD_OP_DISCARD:
-    rq = discard_req::create(cmd, std::move(completer));
+    rq = std::allocate_shared<discard_req>(a, cmd, completion);
     break;
   case UBLKDRV_CMD_OP_FLUSH:
-    rq = flush_req::create(cmd, std::move(completer));
+    rq = std::allocate_shared<flush_req>(a, cmd, completion);
     break;
   default:
-    rq = {
-        new req{cmd},
-        [c = std::move(completer)](req *p) {
-          c(*p);
-          delete p;
-        },
-    };
+    rq = std::allocate_shared<req>(a, cmd, completion);
     break;
   }
 
+  rq->set_trace_id(trace::current());
+
   auto const hid{std::min(static_cast<size_t>(op), std::size(hs_) - 1)};
   Expects(hs_[hid]);
   return hs_[hid]->handle(std::move(rq));
@@ -11,7 +11,10 @@
 #include <linux/ublkdrv/cmd.h>
 #include <linux/ublkdrv/cmd_ack.h>
 
+#include "mm/mem_slab.hpp"
+
 #include "handler_interface.hpp"
+#include "target_stats.hpp"
 #include "ublk_req_handler_interface.hpp"
 
 namespace ublk {
@@ -21,7 +24,8 @@ public:
   explicit CmdHandler(
       std::span<ublkdrv_celld const> cellds, std::span<std::byte> cells,
       std::shared_ptr<IHandler<int(ublkdrv_cmd_ack) noexcept>> acknowledger,
-      std::map<ublkdrv_cmd_op, std::shared_ptr<IUblkReqHandler>> const &maphs);
+      std::map<ublkdrv_cmd_op, std::shared_ptr<IUblkReqHandler>> const &maphs,
+      std::shared_ptr<target_stats> stats = {});
   ~CmdHandler() override = default;
 
   CmdHandler(CmdHandler const &) = default;
@@ -33,10 +37,15 @@ public:
   int handle(ublkdrv_cmd const &cmd) noexcept override;
 
 private:
+  struct stats_tracker;
+
   std::array<std::shared_ptr<IUblkReqHandler>, UBLKDRV_CMD_OP_MAX + 2> hs_;
   std::span<ublkdrv_celld const> cellds_;
   std::span<std::byte> cells_;
   std::shared_ptr<IHandler<int(ublkdrv_cmd_ack) noexcept>> acknowledger_;
+  /* requests live in the slots of the slab indexed by their command ids */
+  std::shared_ptr<mm::mem_slab> req_slab_;
+  std::shared_ptr<stats_tracker> stats_tracker_;
 };
 
 } // namespace ublk
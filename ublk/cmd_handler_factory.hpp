@@ -13,6 +13,7 @@
 #include "cmd_handler.hpp"
 #include "factory_unique_interface.hpp"
 #include "handler_interface.hpp"
+#include "target_stats.hpp"
 #include "ublk_req_handler_interface.hpp"
 
 namespace ublk {
@@ -23,8 +24,9 @@ class CmdHandlerFactory
           std::shared_ptr<IHandler<int(ublkdrv_cmd_ack) noexcept>>)> {
 public:
   explicit CmdHandlerFactory(
-      std::map<ublkdrv_cmd_op, std::shared_ptr<IUblkReqHandler>> maphs)
-      : maphs_(std::move(maphs)) {}
+      std::map<ublkdrv_cmd_op, std::shared_ptr<IUblkReqHandler>> maphs,
+      std::shared_ptr<target_stats> stats = {})
+      : maphs_(std::move(maphs)), stats_(std::move(stats)) {}
   ~CmdHandlerFactory() override = default;
 
   CmdHandlerFactory(CmdHandlerFactory const &) = default;
@@ -38,11 +40,12 @@ public:
       std::shared_ptr<IHandler<int(ublkdrv_cmd_ack) noexcept>> acknowledger)
       override {
     return std::make_unique<CmdHandler>(cellds, cells, std::move(acknowledger),
-                                        maphs_);
+                                        maphs_, stats_);
   }
 
 private:
   std::map<ublkdrv_cmd_op, std::shared_ptr<IUblkReqHandler>> maphs_;
+  std::shared_ptr<target_stats> stats_;
 };
 
 } // namespace ublk
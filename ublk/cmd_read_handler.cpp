@@ -1,8 +1,10 @@
 #include "cmd_read_handler.hpp"
 
 #include <cstddef>
+#include <cstdint>
 
 #include <memory>
+#include <span>
 #include <utility>
 
 #include <gsl/assert>
@@ -11,6 +13,10 @@
 
 #include "for_each_celld.hpp"
 #include "read_query.hpp"
+#include "readv_query.hpp"
+#include "sg_bufs.hpp"
+
+#include "trace/trace.hpp"
 
 namespace ublk {
 
@@ -22,23 +28,52 @@ CmdReadHandler::CmdReadHandler(std::shared_ptr<IRDQSubmitter> reader)
 int CmdReadHandler::handle(std::shared_ptr<read_req> req) noexcept {
   Expects(req);
   auto *p_req = req.get();
-  return for_each_celld(
-      ublkdrv_cmd_read_get_offset(&p_req->cmd()),
-      ublkdrv_cmd_read_get_fcdn(&p_req->cmd()),
-      ublkdrv_cmd_read_get_cds_nr(&p_req->cmd()), p_req->cellds(),
-      p_req->cells(),
-      [r = reader_.get(), req = std::move(req)](uint64_t offset,
-                                                std::span<std::byte> buf) {
-        auto completer = [req](read_query const &rq) {
-          if (rq.err())
-            req->set_err(rq.err());
-        };
-        auto rq = read_query::create(buf, offset, std::move(completer));
-        if (auto const res{r->submit(std::move(rq))}) [[unlikely]] {
-          return res;
-        }
-        return 0;
-      });
+  auto const trace_id{p_req->trace_id()};
+
+  if (1 == ublkdrv_cmd_read_get_cds_nr(&p_req->cmd())) [[likely]] {
+    return for_each_celld(
+        ublkdrv_cmd_read_get_offset(&p_req->cmd()),
+        ublkdrv_cmd_read_get_fcdn(&p_req->cmd()), 1u, p_req->cellds(),
+        p_req->cells(),
+        [r = reader_.get(), req = std::move(req),
+         trace_id](uint64_t offset, std::span<std::byte> buf) mutable {
+          auto rq{read_req::inline_query(std::move(req), buf, offset)};
+          rq->set_trace_id(trace_id);
+          trace::record("submit", trace_id);
+          return r->submit(std::move(rq));
+        });
+  }
+
+  /* The whole cell chain goes down as a single scatter-gather list */
+  auto bufs{sg_bufs<std::byte>{}};
+  if (auto const res{for_each_celld(
+          ublkdrv_cmd_read_get_offset(&p_req->cmd()),
+          ublkdrv_cmd_read_get_fcdn(&p_req->cmd()),
+          ublkdrv_cmd_read_get_cds_nr(&p_req->cmd()), p_req->cellds(),
+          p_req->cells(),
+          [&bufs](uint64_t offset [[maybe_unused]],
+                  std::span<std::byte> buf) {
+            bufs.push_back(buf);
+            return 0;
+          })};
+      res) [[unlikely]] {
+    return res;
+  }
+
+  if (bufs.empty()) [[unlikely]]
+    return 0;
+
+  auto rq{
+      readv_query::create(
+          std::move(bufs), ublkdrv_cmd_read_get_offset(&p_req->cmd()),
+          [req = std::move(req)](readv_query const &rq) {
+            if (rq.err())
+              req->set_err(rq.err());
+          }),
+  };
+  rq->set_trace_id(trace_id);
+  trace::record("submit", trace_id);
+  return reader_->submit(std::move(rq));
 }
 
 } // namespace ublk
@@ -1,8 +1,10 @@
 #include "cmd_write_handler.hpp"
 
 #include <cstddef>
+#include <cstdint>
 
 #include <memory>
+#include <span>
 #include <utility>
 
 #include <gsl/assert>
@@ -10,7 +12,11 @@
 #include <linux/ublkdrv/cmd.h>
 
 #include "for_each_celld.hpp"
+#include "sg_bufs.hpp"
 #include "write_query.hpp"
+#include "writev_query.hpp"
+
+#include "trace/trace.hpp"
 
 namespace ublk {
 
@@ -22,23 +28,55 @@ CmdWriteHandler::CmdWriteHandler(std::shared_ptr<IWRQSubmitter> writer)
 int CmdWriteHandler::handle(std::shared_ptr<write_req> req) noexcept {
   Expects(req);
   auto *p_req = req.get();
-  return for_each_celld(
-      ublkdrv_cmd_write_get_offset(&p_req->cmd()),
-      ublkdrv_cmd_write_get_fcdn(&p_req->cmd()),
-      ublkdrv_cmd_write_get_cds_nr(&p_req->cmd()), p_req->cellds(),
-      p_req->cells(),
-      [w = writer_.get(), req = std::move(req)](
-          uint64_t offset, std::span<std::byte const> buf) mutable {
-        auto completer = [req](write_query const &wq) {
-          if (wq.err())
-            req->set_err(wq.err());
-        };
-        auto wq = write_query::create(buf, offset, std::move(completer));
-        if (auto const res{w->submit(std::move(wq))}) [[unlikely]] {
-          return res;
-        }
-        return 0;
-      });
+  auto const trace_id{p_req->trace_id()};
+  auto const fua{p_req->fua()};
+
+  if (1 == ublkdrv_cmd_write_get_cds_nr(&p_req->cmd())) [[likely]] {
+    return for_each_celld(
+        ublkdrv_cmd_write_get_offset(&p_req->cmd()),
+        ublkdrv_cmd_write_get_fcdn(&p_req->cmd()), 1u, p_req->cellds(),
+        p_req->cells(),
+        [w = writer_.get(), req = std::move(req), trace_id,
+         fua](uint64_t offset, std::span<std::byte const> buf) mutable {
+          auto wq{write_req::inline_query(std::move(req), buf, offset)};
+          wq->set_trace_id(trace_id);
+          wq->set_fua(fua);
+          trace::record("submit", trace_id);
+          return w->submit(std::move(wq));
+        });
+  }
+
+  /* The whole cell chain goes down as a single scatter-gather list */
+  auto bufs{sg_bufs<std::byte const>{}};
+  if (auto const res{for_each_celld(
+          ublkdrv_cmd_write_get_offset(&p_req->cmd()),
+          ublkdrv_cmd_write_get_fcdn(&p_req->cmd()),
+          ublkdrv_cmd_write_get_cds_nr(&p_req->cmd()), p_req->cellds(),
+          p_req->cells(),
+          [&bufs](uint64_t offset [[maybe_unused]],
+                  std::span<std::byte const> buf) {
+            bufs.push_back(buf);
+            return 0;
+          })};
+      res) [[unlikely]] {
+    return res;
+  }
+
+  if (bufs.empty()) [[unlikely]]
+    return 0;
+
+  auto wq{
+      writev_query::create(
+          std::move(bufs), ublkdrv_cmd_write_get_offset(&p_req->cmd()),
+          [req = std::move(req)](writev_query const &wq) {
+            if (wq.err())
+              req->set_err(wq.err());
+          }),
+  };
+  wq->set_trace_id(trace_id);
+  wq->set_fua(fua);
+  trace::record("submit", trace_id);
+  return writer_->submit(std::move(wq));
 }
 
 } // namespace ublk
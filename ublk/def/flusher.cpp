@@ -0,0 +1,65 @@
+#include "flusher.hpp"
+
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <gsl/assert>
+
+namespace ublk::def {
+
+std::shared_ptr<flusher> flusher::create(sync_fn sync) {
+  return std::make_shared<flusher>(std::move(sync));
+}
+
+flusher::flusher(sync_fn sync) noexcept
+    : sync_(std::move(sync)), inflight_(false) {
+  Ensures(sync_);
+}
+
+int flusher::submit(std::shared_ptr<flush_query> fq) noexcept {
+  Expects(fq);
+
+  /*
+   * The sync running might have been started before writes completed by now,
+   * so the flush may only be served by the next one
+   */
+  if (inflight_) {
+    pending_.push_back(std::move(fq));
+    return 0;
+  }
+
+  running_.push_back(std::move(fq));
+  start();
+
+  return 0;
+}
+
+void flusher::start() noexcept {
+  Expects(!inflight_);
+  Expects(!running_.empty());
+
+  inflight_ = true;
+  sync_([self = shared_from_this()](int err) { self->done(err); });
+}
+
+void flusher::done(int err) noexcept {
+  Expects(inflight_);
+
+  auto const fqs{std::exchange(running_, {})};
+  inflight_ = false;
+
+  if (!pending_.empty()) {
+    running_ = std::exchange(pending_, {});
+    start();
+  }
+
+  /* completers might submit further flushes, the state is consistent by now */
+  if (err) [[unlikely]] {
+    for (auto const &fq : fqs)
+      fq->set_err(err);
+  }
+}
+
+} // namespace ublk::def
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "flush_query.hpp"
+
+namespace ublk::def {
+
+/*
+ * Flushes coming in while a sync of the backend is running wait for the next
+ * one, all of them get merged into that single sync. Thus there is at most one
+ * sync running and one pending at any moment, just the way the block layer
+ * handles flushes
+ */
+class flusher final : public std::enable_shared_from_this<flusher> {
+public:
+  /* done must be called once the sync is over, whatever its outcome */
+  using sync_fn = std::function<void(std::function<void(int err)> &&done)>;
+
+  static std::shared_ptr<flusher> create(sync_fn sync);
+
+  explicit flusher(sync_fn sync) noexcept;
+  ~flusher() noexcept = default;
+
+  flusher(flusher const &) = delete;
+  flusher &operator=(flusher const &) = delete;
+
+  flusher(flusher &&) = delete;
+  flusher &operator=(flusher &&) = delete;
+
+  int submit(std::shared_ptr<flush_query> fq) noexcept;
+
+private:
+  void start() noexcept;
+  void done(int err) noexcept;
+
+  sync_fn sync_;
+  std::vector<std::shared_ptr<flush_query>> running_;
+  std::vector<std::shared_ptr<flush_query>> pending_;
+  bool inflight_;
+};
+
+} // namespace ublk::def
@@ -0,0 +1,345 @@
+#include "psync.hpp"
+
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ranges>
+#include <span>
+#include <stop_token>
+#include <utility>
+#include <vector>
+
+#include <gsl/assert>
+#include <spdlog/spdlog.h>
+
+#include <boost/asio/post.hpp>
+
+#include "trace/trace.hpp"
+
+namespace {
+
+constexpr auto kThreadsNrDefault{4u};
+constexpr auto kQueueDepthDefault{32u};
+
+auto iovs_make(std::ranges::input_range auto const &bufs) {
+  auto iovs{std::vector<iovec>{}};
+  iovs.reserve(std::ranges::size(bufs));
+  for (auto const buf : bufs) {
+    iovs.push_back({
+        .iov_base = const_cast<std::byte *>(buf.data()),
+        .iov_len = buf.size(),
+    });
+  }
+  return iovs;
+}
+
+/*
+ * Goes on until the whole list is transferred, what is beyond the end of a
+ * file reads back as zeroes
+ */
+int preadv_full(int fd, std::span<iovec> iovs, uint64_t offset) noexcept {
+  while (!iovs.empty()) {
+    auto const nr{std::min<size_t>(iovs.size(), IOV_MAX)};
+    auto const r{
+        ::preadv2(fd, iovs.data(), static_cast<int>(nr),
+                  static_cast<off_t>(offset), 0),
+    };
+    if (r < 0) {
+      if (EINTR == errno)
+        continue;
+      return errno;
+    }
+    if (0 == r) {
+      for (auto const &iov : iovs)
+        std::memset(iov.iov_base, 0, iov.iov_len);
+      return 0;
+    }
+    offset += static_cast<uint64_t>(r);
+    for (auto left{static_cast<size_t>(r)}; left;) {
+      auto &iov{iovs.front()};
+      if (iov.iov_len > left) {
+        iov.iov_base = static_cast<std::byte *>(iov.iov_base) + left;
+        iov.iov_len -= left;
+        break;
+      }
+      left -= iov.iov_len;
+      iovs = iovs.subspan(1);
+    }
+  }
+  return 0;
+}
+
+int pwritev_full(int fd, std::span<iovec> iovs, uint64_t offset,
+                 bool fua) noexcept {
+  auto flags{fua ? RWF_DSYNC : 0};
+  while (!iovs.empty()) {
+    auto const nr{std::min<size_t>(iovs.size(), IOV_MAX)};
+    auto const r{
+        ::pwritev2(fd, iovs.data(), static_cast<int>(nr),
+                   static_cast<off_t>(offset), flags),
+    };
+    if (r < 0) {
+      if (EINTR == errno)
+        continue;
+      /* kernels not knowing RWF_DSYNC get the data flushed behind */
+      if (EOPNOTSUPP == errno && flags) {
+        flags = 0;
+        continue;
+      }
+      return errno;
+    }
+    if (0 == r)
+      return EIO;
+    offset += static_cast<uint64_t>(r);
+    for (auto left{static_cast<size_t>(r)}; left;) {
+      auto &iov{iovs.front()};
+      if (iov.iov_len > left) {
+        iov.iov_base = static_cast<std::byte *>(iov.iov_base) + left;
+        iov.iov_len -= left;
+        break;
+      }
+      left -= iov.iov_len;
+      iovs = iovs.subspan(1);
+    }
+  }
+  if (fua && !flags)
+    return ::fdatasync(fd) < 0 ? errno : 0;
+  return 0;
+}
+
+/* Queries are let go of within the io_context, their completers run there */
+auto completer(auto q) {
+  return [q = std::move(q)](int err) {
+    ublk::trace::record("def.complete", q->trace_id());
+    if (err) [[unlikely]]
+      q->set_err(err);
+  };
+}
+
+} // namespace
+
+namespace ublk::def {
+
+psync &psync::attach(boost::asio::io_context &io_ctx,
+                     psync_param const &param) {
+  if (auto *pool{find(io_ctx)})
+    return *pool;
+  return boost::asio::make_service<psync>(io_ctx, param);
+}
+
+psync *psync::find(boost::asio::io_context &io_ctx) noexcept {
+  return boost::asio::has_service<psync>(io_ctx)
+             ? &boost::asio::use_service<psync>(io_ctx)
+             : nullptr;
+}
+
+psync::psync(boost::asio::execution_context &ctx, psync_param const &param)
+    : boost::asio::execution_context::service(ctx),
+      io_ctx_(static_cast<boost::asio::io_context &>(ctx)), param_(param),
+      next_(0) {
+  if (!param_.threads_nr)
+    param_.threads_nr = kThreadsNrDefault;
+  if (!param_.queue_depth)
+    param_.queue_depth = kQueueDepthDefault;
+}
+
+psync::~psync() { shutdown(); }
+
+void psync::shutdown() {
+  /* jthreads get stopped and joined */
+  workers_.clear();
+  backlog_.clear();
+}
+
+int psync::init() noexcept {
+  if (!workers_.empty()) [[likely]]
+    return 0;
+
+  try {
+    auto workers{std::vector<std::unique_ptr<worker>>{}};
+    for (auto i{0u}; i < param_.threads_nr; ++i) {
+      auto &w{*workers.emplace_back(std::make_unique<worker>())};
+      w.th = std::jthread{
+          [this, &w](std::stop_token stoken) { run(w, std::move(stoken)); }};
+    }
+    workers_ = std::move(workers);
+  } catch (std::exception const &ex) {
+    spdlog::error("failed to start psync threads, {}", ex.what());
+    return ENOMEM;
+  }
+
+  spdlog::info("psync set up, threads {}, queue depth {}", param_.threads_nr,
+               param_.queue_depth);
+
+  return 0;
+}
+
+void psync::run(worker &w, std::stop_token stoken) noexcept {
+  for (;;) {
+    auto j{std::optional<job>{}};
+    {
+      auto lck{std::unique_lock{w.mtx}};
+      if (!w.cv.wait(lck, stoken, [&w] { return !w.jobs.empty(); }))
+        return;
+      j.emplace(std::move(w.jobs.front()));
+      w.jobs.pop_front();
+    }
+
+    auto const err{j->call()};
+    j->call = {};
+
+    try {
+      boost::asio::post(io_ctx_, [this, done = std::move(j->done),
+                                  worker_id = j->worker_id, err] {
+        complete(worker_id);
+        done(err);
+      });
+    } catch (...) {
+      /* nothing is to be done, the io_context must be gone */
+    }
+  }
+}
+
+void psync::dispatch(job &&j, size_t worker_id) {
+  auto &w{*workers_[worker_id]};
+  j.worker_id = worker_id;
+  ++w.inflight;
+  {
+    auto lck{std::lock_guard{w.mtx}};
+    w.jobs.push_back(std::move(j));
+  }
+  w.cv.notify_one();
+}
+
+void psync::complete(size_t worker_id) noexcept {
+  auto &w{*workers_[worker_id]};
+  Expects(w.inflight > 0);
+  --w.inflight;
+
+  if (!backlog_.empty()) {
+    try {
+      dispatch(std::move(backlog_.front()), worker_id);
+    } catch (...) {
+      backlog_.front().done(ENOMEM);
+    }
+    backlog_.pop_front();
+  }
+}
+
+void psync::exec(std::function<int()> &&call,
+                 std::function<void(int err)> &&done) noexcept {
+  Expects(call);
+  Expects(done);
+
+  if (auto const r{init()}) [[unlikely]] {
+    done(r);
+    return;
+  }
+
+  auto j{
+      job{
+          .call = std::move(call),
+          .done = std::move(done),
+          .worker_id = 0,
+          .work = boost::asio::make_work_guard(io_ctx_),
+      },
+  };
+
+  try {
+    /* round-robin among the workers having room in their queues */
+    for (auto i{0uz}; i < workers_.size(); ++i) {
+      auto const worker_id{(next_ + i) % workers_.size()};
+      if (workers_[worker_id]->inflight < param_.queue_depth) {
+        next_ = worker_id + 1;
+        dispatch(std::move(j), worker_id);
+        return;
+      }
+    }
+
+    backlog_.push_back(std::move(j));
+  } catch (...) {
+    j.done(ENOMEM);
+  }
+}
+
+int psync::submit(int fd, std::shared_ptr<read_query> rq) noexcept {
+  Expects(rq);
+  auto const buf{rq->buf()};
+  auto call{
+      [fd, buf, offset = rq->offset()] {
+        auto iov{iovec{.iov_base = buf.data(), .iov_len = buf.size()}};
+        return preadv_full(fd, {&iov, 1}, offset);
+      },
+  };
+  exec(std::move(call), completer(std::move(rq)));
+  return 0;
+}
+
+int psync::submit(int fd, std::shared_ptr<write_query> wq) noexcept {
+  Expects(wq);
+  auto const buf{wq->buf()};
+  auto call{
+      [fd, buf, offset = wq->offset(), fua = wq->fua()] {
+        auto iov{
+            iovec{
+                .iov_base = const_cast<std::byte *>(buf.data()),
+                .iov_len = buf.size(),
+            },
+        };
+        return pwritev_full(fd, {&iov, 1}, offset, fua);
+      },
+  };
+  exec(std::move(call), completer(std::move(wq)));
+  return 0;
+}
+
+int psync::submit(int fd, std::shared_ptr<readv_query> rq) noexcept {
+  Expects(rq);
+  try {
+    auto call{
+        [fd, iovs = iovs_make(rq->bufs()), offset = rq->offset()]() mutable {
+          return preadv_full(fd, iovs, offset);
+        },
+    };
+    exec(std::move(call), completer(std::move(rq)));
+  } catch (...) {
+    return ENOMEM;
+  }
+  return 0;
+}
+
+int psync::submit(int fd, std::shared_ptr<writev_query> wq) noexcept {
+  Expects(wq);
+  try {
+    auto call{
+        [fd, iovs = iovs_make(wq->bufs()), offset = wq->offset(),
+         fua = wq->fua()]() mutable {
+          return pwritev_full(fd, iovs, offset, fua);
+        },
+    };
+    exec(std::move(call), completer(std::move(wq)));
+  } catch (...) {
+    return ENOMEM;
+  }
+  return 0;
+}
+
+int psync::submit(int fd, std::shared_ptr<flush_query> fq) noexcept {
+  Expects(fq);
+  exec([fd] { return ::fdatasync(fd) < 0 ? errno : 0; },
+       completer(std::move(fq)));
+  return 0;
+}
+
+} // namespace ublk::def
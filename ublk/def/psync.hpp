@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <boost/asio/execution_context.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+
+#include "flush_query.hpp"
+#include "read_query.hpp"
+#include "readv_query.hpp"
+#include "write_query.hpp"
+#include "writev_query.hpp"
+
+#include "psync_param.hpp"
+
+namespace ublk::def {
+
+/*
+ * Thread pool engine of an io_context, shared by all the def targets running
+ * within it. Queries go down by blocking preadv2/pwritev2 made by the threads
+ * of the pool, each having a queue of its own, completions are posted back
+ * into the io_context. Queries none of the queues have room for wait in the
+ * io_context until one has.
+ *
+ * The threads get started lazily by the first use, that is in the slave once
+ * the master has forked it
+ */
+class psync final : public boost::asio::execution_context::service {
+public:
+  using key_type = psync;
+  static inline boost::asio::execution_context::id id;
+
+  static psync &attach(boost::asio::io_context &io_ctx,
+                       psync_param const &param);
+  static psync *find(boost::asio::io_context &io_ctx) noexcept;
+
+  explicit psync(boost::asio::execution_context &ctx,
+                 psync_param const &param = {});
+  ~psync() override;
+
+  psync(psync const &) = delete;
+  psync &operator=(psync const &) = delete;
+
+  psync(psync &&) = delete;
+  psync &operator=(psync &&) = delete;
+
+  int submit(int fd, std::shared_ptr<read_query> rq) noexcept;
+  int submit(int fd, std::shared_ptr<write_query> wq) noexcept;
+  int submit(int fd, std::shared_ptr<readv_query> rq) noexcept;
+  int submit(int fd, std::shared_ptr<writev_query> wq) noexcept;
+  int submit(int fd, std::shared_ptr<flush_query> fq) noexcept;
+
+  /* runs call() by a thread of the pool, done(err) is posted back */
+  void exec(std::function<int()> &&call,
+            std::function<void(int err)> &&done) noexcept;
+
+private:
+  void shutdown() override;
+
+  struct job {
+    std::function<int()> call;
+    std::function<void(int err)> done;
+    size_t worker_id;
+    boost::asio::executor_work_guard<boost::asio::io_context::executor_type>
+        work;
+  };
+
+  struct worker {
+    std::mutex mtx;
+    std::condition_variable_any cv;
+    std::deque<job> jobs;
+    /* touched within the io_context only */
+    size_t inflight{0};
+    std::jthread th;
+  };
+
+  int init() noexcept;
+  void dispatch(job &&j, size_t worker_id);
+  void complete(size_t worker_id) noexcept;
+  void run(worker &w, std::stop_token stoken) noexcept;
+
+  boost::asio::io_context &io_ctx_;
+  psync_param param_;
+
+  std::vector<std::unique_ptr<worker>> workers_;
+  size_t next_;
+  /* jobs none of the workers have had room for */
+  std::deque<job> backlog_;
+};
+
+} // namespace ublk::def
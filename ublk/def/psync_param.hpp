@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdint>
+
+namespace ublk::def {
+
+struct psync_param {
+  uint32_t threads_nr;
+  /* queries a thread may have queued up, the rest wait in the io_context */
+  uint32_t queue_depth;
+};
+
+} // namespace ublk::def
@@ -28,6 +28,10 @@ public:
     return target_->process(std::move(rq));
   }
 
+  int submit(std::shared_ptr<readv_query> rq) noexcept override {
+    return target_->process(std::move(rq));
+  }
+
 private:
   std::shared_ptr<Target> target_;
 };
@@ -2,31 +2,70 @@
 
 #include <cerrno>
 #include <cstddef>
+#include <cstdint>
 
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
 #include <boost/asio/buffer.hpp>
 #include <boost/asio/error.hpp>
+#include <boost/asio/post.hpp>
 #include <boost/asio/random_access_file.hpp>
 #include <boost/asio/read_at.hpp>
+#include <boost/asio/thread_pool.hpp>
 #include <boost/asio/write_at.hpp>
+#include <boost/container/small_vector.hpp>
 #include <boost/system/detail/errc.hpp>
 #include <boost/system/detail/error_code.hpp>
 
 #include <gsl/assert>
+#include <spdlog/spdlog.h>
 
+#include <format>
+#include <functional>
+#include <memory>
 #include <utility>
 
+#include "trace/trace.hpp"
+
 namespace {
 
-void async_read(boost::asio::random_access_file *raf,
-                std::shared_ptr<ublk::read_query> rq) {
+auto buffers(ublk::read_query &rq) noexcept {
+  auto const buf{rq.buf()};
+  return boost::asio::mutable_buffer(buf.data(), buf.size());
+}
+
+auto buffers(ublk::readv_query const &rq) {
+  auto bufs{boost::container::small_vector<boost::asio::mutable_buffer, 8>{}};
+  for (auto const buf : rq.bufs())
+    bufs.emplace_back(buf.data(), buf.size());
+  return bufs;
+}
+
+auto buffers(ublk::write_query const &wq) noexcept {
+  return boost::asio::const_buffer(wq.buf().data(), wq.buf().size());
+}
+
+auto buffers(ublk::writev_query const &wq) {
+  auto bufs{boost::container::small_vector<boost::asio::const_buffer, 8>{}};
+  for (auto const buf : wq.bufs())
+    bufs.emplace_back(buf.data(), buf.size());
+  return bufs;
+}
+
+template <typename Q>
+void async_read(boost::asio::random_access_file *raf, std::shared_ptr<Q> rq) {
   auto const offset{rq->offset()};
-  auto const buf{rq->buf()};
+  ublk::trace::record("def.submit", rq->trace_id());
   boost::asio::async_read_at(
-      *raf, offset, boost::asio::mutable_buffer(buf.data(), buf.size()),
+      *raf, offset, buffers(*rq),
       [=, rq = std::move(rq)](boost::system::error_code ec [[maybe_unused]],
                               size_t bytes_read [[maybe_unused]]) {
+        ublk::trace::record("def.complete", rq->trace_id());
+
         if (ec.value() == boost::asio::error::operation_aborted) {
           rq->set_err(ENOTCONN);
           return;
@@ -37,16 +76,16 @@ void async_read(boost::asio::random_access_file *raf,
           return;
         }
 
-        if (bytes_read < rq->buf().size()) {
+        if (bytes_read < rq->size()) {
           if ([[maybe_unused]] auto const res =
                   ::ftruncate64(raf->native_handle(),
-                                offset + rq->buf().size()) < 0) {
+                                offset + rq->size()) < 0) {
             rq->set_err(errno);
             return;
           }
 
           auto new_rq{
-              rq->subquery(bytes_read, rq->buf().size() - bytes_read,
+              rq->subquery(bytes_read, rq->size() - bytes_read,
                            offset + bytes_read, rq),
           };
 
@@ -55,6 +94,116 @@ void async_read(boost::asio::random_access_file *raf,
       });
 }
 
+template <typename Q>
+void async_write(boost::asio::random_access_file *raf, std::shared_ptr<Q> wq) {
+  auto const offset{wq->offset()};
+  ublk::trace::record("def.submit", wq->trace_id());
+  boost::asio::async_write_at(
+      *raf, offset, buffers(*wq),
+      [wq = std::move(wq)](boost::system::error_code ec [[maybe_unused]],
+                           size_t bytes_written [[maybe_unused]]) {
+        ublk::trace::record("def.complete", wq->trace_id());
+
+        if (ec == boost::asio::error::operation_aborted) {
+          wq->set_err(ENOTCONN);
+          return;
+        }
+
+        if (ec) {
+          wq->set_err(ec.value());
+          return;
+        }
+
+        Ensures(bytes_written == wq->size());
+      });
+}
+
+/*
+ * Without a file description of O_DSYNC the write is followed by a flush the
+ * query completes behind
+ */
+template <typename Q>
+auto flush_behind(std::shared_ptr<Q> wq,
+                  std::shared_ptr<ublk::def::flusher> flusher) {
+  auto sq{
+      wq->subquery(
+          0, wq->size(), wq->offset(),
+          [wq, flusher = std::move(flusher)](Q const &sq) {
+            if (sq.err()) [[unlikely]] {
+              wq->set_err(sq.err());
+              return;
+            }
+            flusher->submit(ublk::flush_query::create(
+                [wq](ublk::flush_query const &fq) {
+                  if (fq.err()) [[unlikely]]
+                    wq->set_err(fq.err());
+                }));
+          }),
+  };
+  sq->set_fua(false);
+  return sq;
+}
+
+int dsync_reopen(int fd) noexcept {
+  auto const fl{::fcntl(fd, F_GETFL)};
+  if (fl < 0) [[unlikely]]
+    return -1;
+  return ::open(std::format("/proc/self/fd/{}", fd).c_str(),
+                (fl & (O_ACCMODE | O_DIRECT)) | O_DSYNC | O_CLOEXEC);
+}
+
+auto uring_sync(ublk::def::uring *ring, int file) {
+  return [=](std::function<void(int err)> &&done) {
+    auto fq{
+        ublk::flush_query::create(
+            [done = std::move(done)](ublk::flush_query const &fq) {
+              done(fq.err());
+            }),
+    };
+    if (auto const r{ring->submit(file, fq)}) [[unlikely]]
+      fq->set_err(r);
+  };
+}
+
+auto worker_exec(boost::asio::io_context &io_ctx) {
+  /* the thread is started by the first call, that is in the slave */
+  auto worker{std::make_shared<std::unique_ptr<boost::asio::thread_pool>>()};
+  return [&io_ctx, worker](std::function<int()> &&call,
+                           std::function<void(int err)> &&done) {
+    try {
+      if (!*worker)
+        *worker = std::make_unique<boost::asio::thread_pool>(1);
+      boost::asio::post(**worker, [&io_ctx, call = std::move(call),
+                                   done = std::move(done)]() mutable {
+        auto const err{call()};
+        boost::asio::post(io_ctx,
+                          [done = std::move(done), err] { done(err); });
+      });
+    } catch (...) {
+      done(ENOMEM);
+    }
+  };
+}
+
+auto worker_sync(ublk::def::Target::exec_fn exec, int fd) {
+  return [exec = std::move(exec), fd](std::function<void(int err)> &&done) {
+    exec([fd] { return ::fdatasync(fd) < 0 ? errno : 0; }, std::move(done));
+  };
+}
+
+int discard(int fd, bool blkdev, uint64_t offset, uint64_t sz) noexcept {
+  if (blkdev) {
+    uint64_t range[2]{offset, sz};
+    return ::ioctl(fd, BLKDISCARD, &range) < 0 ? errno : 0;
+  }
+  /* the range reads back as zeroes, the file keeps its size */
+  return ::fallocate64(fd, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                       static_cast<off64_t>(offset),
+                       static_cast<off64_t>(sz)) < 0
+             ? errno
+             : 0;
+}
+
 } // namespace
 
 namespace ublk::def {
@@ -63,6 +212,46 @@ Target::Target(boost::asio::io_context &io_ctx, mm::uptrwd<const int> fd) {
   Expects(fd);
 
   auto const *p_fd = fd.get();
+
+  if (struct stat st; 0 == ::fstat(*p_fd, &st))
+    blkdev_ = S_ISBLK(st.st_mode);
+
+  if (auto *ring{uring::find(io_ctx)}) {
+    uring_ = ring;
+    uring_file_ = uring_->file_register(*p_fd);
+  } else if (auto *pool{psync::find(io_ctx)}) {
+    psync_ = pool;
+  }
+
+  /* flushes and discards block, the pool runs them if there is one */
+  if (psync_) {
+    exec_ = [pool = psync_](std::function<int()> &&call,
+                            std::function<void(int err)> &&done) {
+      pool->exec(std::move(call), std::move(done));
+    };
+  } else {
+    exec_ = worker_exec(io_ctx);
+  }
+
+  /* IORING_OP_FSYNC is not allowed onto IOPOLL rings */
+  if (uring_ && !uring_->iopoll())
+    flusher_ = flusher::create(uring_sync(uring_, uring_file_));
+  else
+    flusher_ = flusher::create(worker_sync(exec_, *p_fd));
+
+  if (!uring_ && !psync_) {
+    if (auto const dsync_fd{dsync_reopen(*p_fd)}; dsync_fd >= 0) {
+      raf_dsync_ = {
+          new boost::asio::random_access_file{io_ctx, dsync_fd},
+          [](auto *praf) { delete praf; },
+      };
+    } else {
+      spdlog::warn("failed to reopen fd {} with O_DSYNC, err {}, FUA writes "
+                   "will be followed by flushes",
+                   *p_fd, errno);
+    }
+  }
+
   raf_ = {
       new boost::asio::random_access_file{io_ctx, *p_fd},
       [fd = std::shared_ptr{std::move(fd)}](auto *praf) { delete praf; },
@@ -70,34 +259,94 @@ Target::Target(boost::asio::io_context &io_ctx, mm::uptrwd<const int> fd) {
 }
 
 int Target::process(std::shared_ptr<read_query> rq) noexcept {
+  if (uring_) {
+    trace::record("def.submit", rq->trace_id());
+    return uring_->submit(uring_file_, std::move(rq));
+  }
+
+  if (psync_) {
+    trace::record("def.submit", rq->trace_id());
+    return psync_->submit(raf_->native_handle(), std::move(rq));
+  }
+
   async_read(raf_.get(), std::move(rq));
   return 0;
 }
 
 int Target::process(std::shared_ptr<write_query> wq) noexcept {
-  auto const offset{wq->offset()};
-  auto const buf{wq->buf()};
-  boost::asio::async_write_at(
-      *raf_, offset, boost::asio::const_buffer(buf.data(), buf.size()),
-      [wq = std::move(wq)](boost::system::error_code ec [[maybe_unused]],
-                           size_t bytes_written [[maybe_unused]]) {
-        if (ec == boost::asio::error::operation_aborted) {
-          wq->set_err(ENOTCONN);
-          return;
-        }
+  if (uring_) {
+    trace::record("def.submit", wq->trace_id());
+    return uring_->submit(uring_file_, std::move(wq));
+  }
 
-        if (ec) {
-          wq->set_err(ec.value());
-          return;
-        }
+  if (psync_) {
+    trace::record("def.submit", wq->trace_id());
+    return psync_->submit(raf_->native_handle(), std::move(wq));
+  }
 
-        Ensures(bytes_written == wq->buf().size());
-      });
+  if (wq->fua() && !raf_dsync_) [[unlikely]]
+    wq = flush_behind(std::move(wq), flusher_);
+
+  async_write(wq->fua() ? raf_dsync_.get() : raf_.get(), std::move(wq));
   return 0;
 }
 
-int Target::process(std::shared_ptr<flush_query> fq [[maybe_unused]]) noexcept {
-  return ::fsync(raf_->native_handle());
+int Target::process(std::shared_ptr<readv_query> rq) noexcept {
+  if (uring_) {
+    trace::record("def.submit", rq->trace_id());
+    return uring_->submit(uring_file_, std::move(rq));
+  }
+
+  if (psync_) {
+    trace::record("def.submit", rq->trace_id());
+    return psync_->submit(raf_->native_handle(), std::move(rq));
+  }
+
+  async_read(raf_.get(), std::move(rq));
+  return 0;
+}
+
+int Target::process(std::shared_ptr<writev_query> wq) noexcept {
+  if (uring_) {
+    trace::record("def.submit", wq->trace_id());
+    return uring_->submit(uring_file_, std::move(wq));
+  }
+
+  if (psync_) {
+    trace::record("def.submit", wq->trace_id());
+    return psync_->submit(raf_->native_handle(), std::move(wq));
+  }
+
+  if (wq->fua() && !raf_dsync_) [[unlikely]]
+    wq = flush_behind(std::move(wq), flusher_);
+
+  async_write(wq->fua() ? raf_dsync_.get() : raf_.get(), std::move(wq));
+  return 0;
+}
+
+int Target::process(std::shared_ptr<flush_query> fq) noexcept {
+  return flusher_->submit(std::move(fq));
+}
+
+int Target::process(std::shared_ptr<discard_query> dq) noexcept {
+  Expects(dq);
+
+  if (0 == dq->size()) [[unlikely]]
+    return 0;
+
+  trace::record("def.submit", dq->trace_id());
+
+  auto call{
+      [fd = raf_->native_handle(), blkdev = blkdev_, offset = dq->offset(),
+       sz = dq->size()] { return discard(fd, blkdev, offset, sz); },
+  };
+  exec_(std::move(call), [dq = std::move(dq)](int err) {
+    trace::record("def.complete", dq->trace_id());
+    if (err) [[unlikely]]
+      dq->set_err(err);
+  });
+
+  return 0;
 }
 
 } // namespace ublk::def
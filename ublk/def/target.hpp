@@ -2,27 +2,66 @@
 
 #include <unistd.h>
 
+#include <functional>
+#include <memory>
+
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/random_access_file.hpp>
 
 #include "mm/mem_types.hpp"
 
+#include "discard_query.hpp"
 #include "flush_query.hpp"
 #include "read_query.hpp"
+#include "readv_query.hpp"
 #include "write_query.hpp"
+#include "writev_query.hpp"
+
+#include "flusher.hpp"
+#include "psync.hpp"
+#include "uring.hpp"
 
 namespace ublk::def {
 
 class Target final {
 public:
+  /*
+   * Goes through the engine attached to the io_context, the native io_uring
+   * one or the psync thread pool, through boost::asio's random_access_file if
+   * there is none
+   */
   explicit Target(boost::asio::io_context &io_ctx, mm::uptrwd<const int> fd);
 
   int process(std::shared_ptr<read_query> rq) noexcept;
   int process(std::shared_ptr<write_query> wq) noexcept;
+  /* Scatter-gather lists go down as a single preadv/pwritev */
+  int process(std::shared_ptr<readv_query> rq) noexcept;
+  int process(std::shared_ptr<writev_query> wq) noexcept;
+  /*
+   * Never blocks, fdatasync goes through the engine or a worker thread of the
+   * target's own. Flushes issued while one is running get merged
+   */
   int process(std::shared_ptr<flush_query> fq) noexcept;
+  /*
+   * Punches a hole into a file, issues BLKDISCARD onto a block device. Both
+   * block, so they are run by the worker thread as well
+   */
+  int process(std::shared_ptr<discard_query> dq) noexcept;
+
+  /* runs call() off the io_context, done(err) is posted back into it */
+  using exec_fn = std::function<void(std::function<int()> &&call,
+                                     std::function<void(int err)> &&done)>;
 
 private:
   mm::uptrwd<boost::asio::random_access_file> raf_;
+  /* opened with O_DSYNC, FUA writes go through it */
+  mm::uptrwd<boost::asio::random_access_file> raf_dsync_;
+  uring *uring_{nullptr};
+  int uring_file_{-1};
+  psync *psync_{nullptr};
+  std::shared_ptr<flusher> flusher_;
+  exec_fn exec_;
+  bool blkdev_{false};
 };
 
 } // namespace ublk::def
@@ -0,0 +1,525 @@
+#include "uring.hpp"
+
+#include <sys/eventfd.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <ranges>
+#include <span>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <gsl/assert>
+#include <spdlog/spdlog.h>
+
+#include <boost/asio/buffer.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/read.hpp>
+#include <boost/system/detail/error_code.hpp>
+
+#include "utils/algo.hpp"
+#include "utils/utility.hpp"
+
+#include "trace/trace.hpp"
+
+#include "sg_bufs.hpp"
+
+namespace {
+
+constexpr auto kFilesMax{64u};
+constexpr auto kBuffersMax{16u};
+constexpr auto kSQDepthDefault{256u};
+
+/*
+ * No more than IOV_MAX buffers go down at once, the rest gets resubmitted as
+ * a short transfer once they are done
+ */
+void iovs_fill(std::vector<iovec> &iovs,
+               std::ranges::input_range auto const &bufs) noexcept {
+  iovs.clear();
+  for (auto const buf : bufs | std::views::take(IOV_MAX)) {
+    iovs.push_back({
+        .iov_base = const_cast<std::byte *>(buf.data()),
+        .iov_len = buf.size(),
+    });
+  }
+}
+
+} // namespace
+
+namespace ublk::def {
+
+uring &uring::attach(boost::asio::io_context &io_ctx,
+                     uring_param const &param) {
+  if (auto *ring{find(io_ctx)})
+    return *ring;
+  return boost::asio::make_service<uring>(io_ctx, param);
+}
+
+uring *uring::find(boost::asio::io_context &io_ctx) noexcept {
+  return boost::asio::has_service<uring>(io_ctx)
+             ? &boost::asio::use_service<uring>(io_ctx)
+             : nullptr;
+}
+
+uring::uring(boost::asio::execution_context &ctx, uring_param const &param)
+    : boost::asio::execution_context::service(ctx),
+      io_ctx_(static_cast<boost::asio::io_context &>(ctx)), param_(param),
+      efd_cnt_(0), files_fixed_(false), buffers_fixed_(false),
+      ops_inflight_(0), flush_pending_(false), reaping_(false) {
+  if (!param_.sq_depth)
+    param_.sq_depth = kSQDepthDefault;
+}
+
+uring::~uring() {
+  if (ring_)
+    io_uring_queue_exit(ring_.get());
+}
+
+void uring::shutdown() {
+  efd_sd_.reset();
+  ops_.clear();
+  ops_free_.clear();
+}
+
+int uring::init() noexcept {
+  if (ring_) [[likely]]
+    return 0;
+
+  auto ring{std::unique_ptr<io_uring>{new (std::nothrow) io_uring{}}};
+  if (!ring)
+    return ENOMEM;
+
+  auto params{io_uring_params{}};
+  if (param_.sqpoll) {
+    params.flags |= IORING_SETUP_SQPOLL;
+    params.sq_thread_idle = param_.sqpoll_idle_ms;
+  }
+  if (param_.iopoll)
+    params.flags |= IORING_SETUP_IOPOLL;
+
+  if (auto const r{
+          io_uring_queue_init_params(param_.sq_depth, ring.get(), &params),
+      };
+      r < 0) {
+    spdlog::error("failed to set io_uring up, err {}", -r);
+    return -r;
+  }
+
+  if (!param_.iopoll) {
+    auto const efd{eventfd(0, EFD_CLOEXEC)};
+    if (efd < 0) {
+      io_uring_queue_exit(ring.get());
+      return errno;
+    }
+    if (auto const r{io_uring_register_eventfd(ring.get(), efd)}; r < 0) {
+      close(efd);
+      io_uring_queue_exit(ring.get());
+      return -r;
+    }
+    try {
+      efd_sd_ = std::make_unique<boost::asio::posix::stream_descriptor>(
+          io_ctx_, efd);
+    } catch (...) {
+      close(efd);
+      io_uring_queue_exit(ring.get());
+      return ENOMEM;
+    }
+  }
+
+  /* Fixed files and buffers are optimizations, they may be gone without */
+  if (io_uring_register_files_sparse(ring.get(), kFilesMax) >= 0) {
+    files_fixed_ = true;
+    auto const n{std::min<size_t>(files_.size(), kFilesMax)};
+    if (n && io_uring_register_files_update(ring.get(), 0, files_.data(),
+                                            static_cast<unsigned>(n)) < 0)
+      files_fixed_ = false;
+  }
+
+  buffers_fixed_ =
+      io_uring_register_buffers_sparse(ring.get(), kBuffersMax) >= 0;
+
+  spdlog::info("io_uring set up, sq depth {}, sqpoll {}, iopoll {}, fixed "
+               "files {}, fixed buffers {}",
+               param_.sq_depth, param_.sqpoll, param_.iopoll, files_fixed_,
+               buffers_fixed_);
+
+  ring_ = std::move(ring);
+
+  return 0;
+}
+
+int uring::file_register(int fd) {
+  files_.push_back(fd);
+  auto const file{static_cast<int>(files_.size() - 1)};
+
+  if (ring_ && files_fixed_ && file < static_cast<int>(kFilesMax)) {
+    if (auto const r{
+            io_uring_register_files_update(ring_.get(),
+                                           static_cast<unsigned>(file), &fd, 1),
+        };
+        r < 0) {
+      throw std::system_error(-r, std::generic_category(),
+                              "io_uring_register_files_update");
+    }
+  }
+
+  return file;
+}
+
+void uring::buffers_register(std::span<std::byte> region) {
+  Expects(!region.empty());
+
+  if (auto const r{init()}) [[unlikely]]
+    throw std::system_error(r, std::generic_category(), "io_uring set up");
+
+  buffers_.push_back(region);
+
+  auto const i{buffers_.size() - 1};
+  if (buffers_fixed_ && i < kBuffersMax) {
+    auto iov{iovec{.iov_base = region.data(), .iov_len = region.size()}};
+    if (auto const r{
+            io_uring_register_buffers_update_tag(
+                ring_.get(), static_cast<unsigned>(i), &iov, nullptr, 1),
+        };
+        r < 0) {
+      /* most likely RLIMIT_MEMLOCK, go on with I/O on unfixed buffers */
+      spdlog::warn("failed to register buffers of {} bytes, err {}",
+                   region.size(), -r);
+      buffers_.pop_back();
+    }
+  }
+}
+
+std::optional<uint16_t> uring::buffer_find(void const *p,
+                                           size_t sz) const noexcept {
+  if (!buffers_fixed_)
+    return {};
+
+  auto const *b{static_cast<std::byte const *>(p)};
+  for (size_t i{0}; i < std::min<size_t>(buffers_.size(), kBuffersMax); ++i) {
+    auto const &r{buffers_[i]};
+    if (!(b < r.data()) && !(b + sz > r.data() + r.size()))
+      return static_cast<uint16_t>(i);
+  }
+
+  return {};
+}
+
+io_uring_sqe *uring::sqe_get() noexcept {
+  auto *sqe{io_uring_get_sqe(ring_.get())};
+  if (!sqe) [[unlikely]] {
+    /* the queue is full, let the kernel have what has been gathered */
+    io_uring_submit(ring_.get());
+    sqe = io_uring_get_sqe(ring_.get());
+  }
+  return sqe;
+}
+
+void uring::prep(io_uring_sqe *sqe, uint32_t op_id) noexcept {
+  auto &o{ops_[op_id]};
+
+  auto const fixed_file{files_fixed_ && o.file < static_cast<int>(kFilesMax)};
+  auto const fd{fixed_file ? o.file : files_[o.file]};
+
+  std::visit(
+      overloaded{
+          [](std::monostate) { Expects(false); },
+          [&](std::shared_ptr<read_query> const &rq) {
+            auto const buf{rq->buf().subspan(o.done)};
+            auto const off{rq->offset() + o.done};
+            if (auto const bid{buffer_find(buf.data(), buf.size())}) {
+              io_uring_prep_read_fixed(sqe, fd, buf.data(),
+                                       static_cast<unsigned>(buf.size()), off,
+                                       *bid);
+            } else {
+              io_uring_prep_read(sqe, fd, buf.data(),
+                                 static_cast<unsigned>(buf.size()), off);
+            }
+          },
+          [&](std::shared_ptr<write_query> const &wq) {
+            auto const buf{wq->buf().subspan(o.done)};
+            auto const off{wq->offset() + o.done};
+            if (auto const bid{buffer_find(buf.data(), buf.size())}) {
+              io_uring_prep_write_fixed(sqe, fd, buf.data(),
+                                        static_cast<unsigned>(buf.size()), off,
+                                        *bid);
+            } else {
+              io_uring_prep_write(sqe, fd, buf.data(),
+                                  static_cast<unsigned>(buf.size()), off);
+            }
+            if (wq->fua())
+              sqe->rw_flags |= RWF_DSYNC;
+          },
+          [&](std::shared_ptr<readv_query> const &rq) {
+            iovs_fill(o.iovs,
+                      sg_slice(rq->bufs(), o.done, rq->size() - o.done));
+            io_uring_prep_readv(sqe, fd, o.iovs.data(),
+                                static_cast<unsigned>(o.iovs.size()),
+                                rq->offset() + o.done);
+          },
+          [&](std::shared_ptr<writev_query> const &wq) {
+            iovs_fill(o.iovs,
+                      sg_slice(wq->bufs(), o.done, wq->size() - o.done));
+            io_uring_prep_writev(sqe, fd, o.iovs.data(),
+                                 static_cast<unsigned>(o.iovs.size()),
+                                 wq->offset() + o.done);
+            if (wq->fua())
+              sqe->rw_flags |= RWF_DSYNC;
+          },
+          [&](std::shared_ptr<flush_query> const &) {
+            io_uring_prep_fsync(sqe, fd, IORING_FSYNC_DATASYNC);
+          },
+      },
+      o.q);
+
+  if (fixed_file)
+    io_uring_sqe_set_flags(sqe, IOSQE_FIXED_FILE);
+  io_uring_sqe_set_data64(sqe, op_id);
+}
+
+int uring::enqueue(op &&o) noexcept {
+  if (auto const r{init()}) [[unlikely]]
+    return r;
+
+  auto *sqe{sqe_get()};
+  if (!sqe) [[unlikely]]
+    return EAGAIN;
+
+  auto op_id{uint32_t{0}};
+  if (!ops_free_.empty()) {
+    op_id = ops_free_.back();
+    ops_free_.pop_back();
+    ops_[op_id] = std::move(o);
+  } else {
+    try {
+      op_id = static_cast<uint32_t>(ops_.size());
+      ops_.push_back(std::move(o));
+    } catch (...) {
+      return ENOMEM;
+    }
+  }
+
+  prep(sqe, op_id);
+  ++ops_inflight_;
+
+  /*
+   * Posted behind the handlers the io_context is running at the moment, so
+   * the whole batch gets submitted by a single io_uring_enter
+   */
+  if (!std::exchange(flush_pending_, true))
+    boost::asio::post(io_ctx_, [this] { flush(); });
+
+  return 0;
+}
+
+void uring::flush() noexcept {
+  flush_pending_ = false;
+
+  if (auto const r{io_uring_submit(ring_.get())}; r < 0) [[unlikely]]
+    spdlog::error("failed to submit to io_uring, err {}", -r);
+
+  /*
+   * Completions are waited for only while there are ops in flight, an idle
+   * engine must not keep the io_context running
+   */
+  if (ops_inflight_ && !std::exchange(reaping_, true)) {
+    if (param_.iopoll)
+      boost::asio::post(io_ctx_, [this] { cqes_poll(); });
+    else
+      cqes_wait();
+  }
+}
+
+void uring::reap() noexcept {
+  io_uring_cqe *cqe{nullptr};
+  while (0 == io_uring_peek_cqe(ring_.get(), &cqe)) {
+    auto const op_id{static_cast<uint32_t>(io_uring_cqe_get_data64(cqe))};
+    auto const res{cqe->res};
+    io_uring_cqe_seen(ring_.get(), cqe);
+    complete(op_id, res);
+  }
+}
+
+void uring::complete(uint32_t op_id, int res) noexcept {
+  Expects(op_id < ops_.size());
+
+  auto &o{ops_[op_id]};
+
+  auto const resubmit{[&, this](size_t sz) {
+    if (res > 0 && o.done + static_cast<uint32_t>(res) < sz) {
+      o.done += static_cast<uint32_t>(res);
+      if (auto *sqe{sqe_get()}) [[likely]] {
+        prep(sqe, op_id);
+        if (!std::exchange(flush_pending_, true))
+          boost::asio::post(io_ctx_, [this] { flush(); });
+        return true;
+      }
+      res = -EAGAIN;
+    }
+    return false;
+  }};
+
+  auto const done{
+      std::visit(
+          overloaded{
+              [](std::monostate) { return true; },
+              [&](std::shared_ptr<read_query> const &rq) {
+                trace::record("def.complete", rq->trace_id());
+                if (res < 0) [[unlikely]] {
+                  rq->set_err(-res);
+                } else if (0 == res) {
+                  /* Nothing has been written beyond the end of file yet */
+                  algo::fill(rq->buf().subspan(o.done), std::byte{0});
+                } else if (resubmit(rq->buf().size())) {
+                  return false;
+                } else if (res < 0) [[unlikely]] {
+                  rq->set_err(-res);
+                }
+                return true;
+              },
+              [&](std::shared_ptr<write_query> const &wq) {
+                trace::record("def.complete", wq->trace_id());
+                if (res < 0) [[unlikely]] {
+                  wq->set_err(-res);
+                } else if (0 == res) [[unlikely]] {
+                  wq->set_err(EIO);
+                } else if (resubmit(wq->buf().size())) {
+                  return false;
+                } else if (res < 0) [[unlikely]] {
+                  wq->set_err(-res);
+                }
+                return true;
+              },
+              [&](std::shared_ptr<readv_query> const &rq) {
+                trace::record("def.complete", rq->trace_id());
+                if (res < 0) [[unlikely]] {
+                  rq->set_err(-res);
+                } else if (0 == res) {
+                  /* Nothing has been written beyond the end of file yet */
+                  for (auto const buf :
+                       sg_slice(rq->bufs(), o.done, rq->size() - o.done))
+                    algo::fill(buf, std::byte{0});
+                } else if (resubmit(rq->size())) {
+                  return false;
+                } else if (res < 0) [[unlikely]] {
+                  rq->set_err(-res);
+                }
+                return true;
+              },
+              [&](std::shared_ptr<writev_query> const &wq) {
+                trace::record("def.complete", wq->trace_id());
+                if (res < 0) [[unlikely]] {
+                  wq->set_err(-res);
+                } else if (0 == res) [[unlikely]] {
+                  wq->set_err(EIO);
+                } else if (resubmit(wq->size())) {
+                  return false;
+                } else if (res < 0) [[unlikely]] {
+                  wq->set_err(-res);
+                }
+                return true;
+              },
+              [&](std::shared_ptr<flush_query> const &fq) {
+                if (res < 0) [[unlikely]]
+                  fq->set_err(-res);
+                return true;
+              },
+          },
+          o.q),
+  };
+
+  if (!done)
+    return;
+
+  /*
+   * The query's completer may submit further queries, the slot is to be
+   * released before it gets called
+   */
+  auto const q{std::exchange(o.q, {})};
+  ops_free_.push_back(op_id);
+  --ops_inflight_;
+}
+
+void uring::cqes_wait() {
+  boost::asio::async_read(
+      *efd_sd_, boost::asio::buffer(&efd_cnt_, sizeof(efd_cnt_)),
+      [this](boost::system::error_code const &ec,
+             size_t bytes_read [[maybe_unused]]) {
+        if (ec) [[unlikely]] {
+          if (ec != boost::asio::error::operation_aborted)
+            spdlog::error("failed to async_read eventfd, ec {}", ec.value());
+          return;
+        }
+        reap();
+
+        if (!ops_inflight_) {
+          reaping_ = false;
+          return;
+        }
+
+        cqes_wait();
+      });
+}
+
+void uring::cqes_poll() {
+  io_uring_get_events(ring_.get());
+  reap();
+
+  if (!ops_inflight_) {
+    reaping_ = false;
+    return;
+  }
+
+  /* other handlers get their chance between the polling rounds */
+  boost::asio::post(io_ctx_, [this] { cqes_poll(); });
+}
+
+int uring::submit(int file, std::shared_ptr<read_query> rq) noexcept {
+  Expects(rq);
+  Expects(file < static_cast<int>(files_.size()));
+  return enqueue({.q = std::move(rq), .file = file, .done = 0, .iovs = {}});
+}
+
+int uring::submit(int file, std::shared_ptr<write_query> wq) noexcept {
+  Expects(wq);
+  Expects(file < static_cast<int>(files_.size()));
+  return enqueue({.q = std::move(wq), .file = file, .done = 0, .iovs = {}});
+}
+
+int uring::submit(int file, std::shared_ptr<readv_query> rq) noexcept {
+  Expects(rq);
+  Expects(file < static_cast<int>(files_.size()));
+  return enqueue({.q = std::move(rq), .file = file, .done = 0, .iovs = {}});
+}
+
+int uring::submit(int file, std::shared_ptr<writev_query> wq) noexcept {
+  Expects(wq);
+  Expects(file < static_cast<int>(files_.size()));
+  return enqueue({.q = std::move(wq), .file = file, .done = 0, .iovs = {}});
+}
+
+int uring::submit(int file, std::shared_ptr<flush_query> fq) noexcept {
+  Expects(fq);
+  Expects(file < static_cast<int>(files_.size()));
+
+  /* IORING_OP_FSYNC is not allowed onto IOPOLL rings */
+  if (param_.iopoll) {
+    if (::fdatasync(files_[file]) < 0) [[unlikely]]
+      fq->set_err(errno);
+    return 0;
+  }
+
+  return enqueue({.q = std::move(fq), .file = file, .done = 0, .iovs = {}});
+}
+
+} // namespace ublk::def
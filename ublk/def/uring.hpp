@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <memory>
+#include <optional>
+#include <span>
+#include <variant>
+#include <vector>
+
+#include <liburing.h>
+
+#include <boost/asio/execution_context.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/posix/stream_descriptor.hpp>
+
+#include "flush_query.hpp"
+#include "read_query.hpp"
+#include "readv_query.hpp"
+#include "write_query.hpp"
+#include "writev_query.hpp"
+
+#include "uring_param.hpp"
+
+namespace ublk::def {
+
+/*
+ * Native io_uring engine of an io_context, shared by all the def targets
+ * running within it. SQEs prepared while the io_context runs a batch of
+ * handlers get submitted by a single io_uring_enter posted behind them.
+ * Backend fds are registered as fixed files, memory regions I/O goes to or
+ * from may be registered as fixed buffers.
+ *
+ * The ring itself gets set up lazily by the first use, that is in the slave
+ * once the master has forked it
+ */
+class uring final : public boost::asio::execution_context::service {
+public:
+  using key_type = uring;
+  static inline boost::asio::execution_context::id id;
+
+  static uring &attach(boost::asio::io_context &io_ctx,
+                       uring_param const &param);
+  static uring *find(boost::asio::io_context &io_ctx) noexcept;
+
+  explicit uring(boost::asio::execution_context &ctx,
+                 uring_param const &param = {});
+  ~uring() override;
+
+  uring(uring const &) = delete;
+  uring &operator=(uring const &) = delete;
+
+  uring(uring &&) = delete;
+  uring &operator=(uring &&) = delete;
+
+  /* Returns a handle the fd is to be referred to by */
+  int file_register(int fd);
+
+  /* The region must stay mapped for as long as the engine lives */
+  void buffers_register(std::span<std::byte> region);
+
+  bool iopoll() const noexcept { return param_.iopoll; }
+
+  int submit(int file, std::shared_ptr<read_query> rq) noexcept;
+  int submit(int file, std::shared_ptr<write_query> wq) noexcept;
+  int submit(int file, std::shared_ptr<readv_query> rq) noexcept;
+  int submit(int file, std::shared_ptr<writev_query> wq) noexcept;
+  int submit(int file, std::shared_ptr<flush_query> fq) noexcept;
+
+private:
+  void shutdown() override;
+
+  struct op {
+    std::variant<std::monostate, std::shared_ptr<read_query>,
+                 std::shared_ptr<write_query>, std::shared_ptr<readv_query>,
+                 std::shared_ptr<writev_query>, std::shared_ptr<flush_query>>
+        q;
+    int file;
+    /* bytes transferred so far, short transfers get resubmitted */
+    uint32_t done;
+    /* must not move while SQEs referring to it are pending submission */
+    std::vector<iovec> iovs;
+  };
+
+  int init() noexcept;
+
+  io_uring_sqe *sqe_get() noexcept;
+  void prep(io_uring_sqe *sqe, uint32_t op_id) noexcept;
+  int enqueue(op &&o) noexcept;
+  void flush() noexcept;
+
+  void reap() noexcept;
+  void complete(uint32_t op_id, int res) noexcept;
+
+  void cqes_wait();
+  void cqes_poll();
+
+  std::optional<uint16_t> buffer_find(void const *p,
+                                      size_t sz) const noexcept;
+
+  boost::asio::io_context &io_ctx_;
+  uring_param param_;
+
+  std::unique_ptr<io_uring> ring_;
+  std::unique_ptr<boost::asio::posix::stream_descriptor> efd_sd_;
+  uint64_t efd_cnt_;
+
+  std::vector<int> files_;
+  bool files_fixed_;
+  std::vector<std::span<std::byte>> buffers_;
+  bool buffers_fixed_;
+
+  std::vector<op> ops_;
+  std::vector<uint32_t> ops_free_;
+  size_t ops_inflight_;
+
+  bool flush_pending_;
+  bool reaping_;
+};
+
+} // namespace ublk::def
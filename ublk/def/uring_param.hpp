@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+
+namespace ublk::def {
+
+struct uring_param {
+  uint32_t sq_depth;
+  /* the kernel polls the submission queue, no io_uring_enter to submit */
+  bool sqpoll;
+  uint32_t sqpoll_idle_ms;
+  /* completions are busy-polled for, O_DIRECT onto NVMe only */
+  bool iopoll;
+};
+
+} // namespace ublk::def
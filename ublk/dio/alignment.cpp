@@ -0,0 +1,49 @@
+#include "alignment.hpp"
+
+#include <fcntl.h>
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+
+#include <cstdint>
+
+#include <optional>
+
+#include "utils/utility.hpp"
+
+#include "sector.hpp"
+
+namespace ublk::dio {
+
+std::optional<alignment> alignment_probe(int fd) noexcept {
+  if (auto const fl{::fcntl(fd, F_GETFL)}; fl < 0 || !(fl & O_DIRECT))
+    return {};
+
+  auto al{
+      alignment{
+          .mem = static_cast<uint32_t>(kSectorSz),
+          .offset = static_cast<uint32_t>(kSectorSz),
+      },
+  };
+
+  struct statx stx {};
+  if (0 == ::statx(fd, "", AT_EMPTY_PATH, STATX_TYPE | STATX_DIOALIGN, &stx)) {
+    if ((stx.stx_mask & STATX_DIOALIGN) &&
+        is_power_of_2(stx.stx_dio_mem_align) &&
+        is_power_of_2(stx.stx_dio_offset_align)) {
+      al.mem = stx.stx_dio_mem_align;
+      al.offset = stx.stx_dio_offset_align;
+    } else if ((stx.stx_mask & STATX_TYPE) && S_ISBLK(stx.stx_mode)) {
+      /* older kernels, the logical block size bounds both */
+      if (int lbs{0}; 0 == ::ioctl(fd, BLKSSZGET, &lbs) && lbs > 0 &&
+                      is_power_of_2(static_cast<uint32_t>(lbs))) {
+        al.mem = static_cast<uint32_t>(lbs);
+        al.offset = static_cast<uint32_t>(lbs);
+      }
+    }
+  }
+
+  return al;
+}
+
+} // namespace ublk::dio
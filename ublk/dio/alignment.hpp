@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+
+#include <optional>
+
+namespace ublk::dio {
+
+/* What O_DIRECT I/O onto a file or a block device must be aligned to */
+struct alignment {
+  /* of the addresses of the buffers */
+  uint32_t mem;
+  /* of the offsets and the lengths */
+  uint32_t offset;
+};
+
+/*
+ * Asks statx() for STATX_DIOALIGN, falls back to the logical block size of a
+ * block device and to a sector otherwise. Nothing for fds opened without
+ * O_DIRECT, those take any
+ */
+std::optional<alignment> alignment_probe(int fd) noexcept;
+
+} // namespace ublk::dio
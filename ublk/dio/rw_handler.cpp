@@ -0,0 +1,354 @@
+#include "rw_handler.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include <gsl/assert>
+
+#include "mm/mem_chunk_pool.hpp"
+
+#include "utils/algo.hpp"
+#include "utils/size_units.hpp"
+#include "utils/utility.hpp"
+
+#include "read_query.hpp"
+#include "readv_query.hpp"
+#include "sector.hpp"
+#include "sg_bufs.hpp"
+#include "write_query.hpp"
+#include "writev_query.hpp"
+
+namespace ublk::dio {
+
+namespace {
+
+/* bounce buffers up to that long are pooled, longer ones are not */
+constexpr auto kBounceChunkSz{128_KiB};
+
+bool buf_aligned(auto const &buf, alignment al) noexcept {
+  return is_aligned_to(reinterpret_cast<uintptr_t>(buf.data()), al.mem) &&
+         is_aligned_to(buf.size(), al.offset);
+}
+
+bool bufs_aligned(auto const &q, alignment al) noexcept {
+  return std::ranges::all_of(sg_bufs_of(q), [al](auto const &buf) {
+    return buf_aligned(buf, al);
+  });
+}
+
+void copy_in(std::span<std::byte> to, auto const &wq) noexcept {
+  for (auto const buf : sg_bufs_of(wq)) {
+    algo::copy(buf, to);
+    to = to.subspan(buf.size());
+  }
+}
+
+void copy_out(auto &rq, std::span<std::byte const> from) noexcept {
+  for (auto const buf : sg_bufs_of(rq)) {
+    algo::copy(from.first(buf.size()), buf);
+    from = from.subspan(buf.size());
+  }
+}
+
+} // namespace
+
+class RWHandler::bouncer final : public std::enable_shared_from_this<bouncer> {
+public:
+  explicit bouncer(std::shared_ptr<IRWHandler> h, alignment al)
+      : h_(std::move(h)), al_(al),
+        pool_(std::make_shared<mm::mem_chunk_pool>(al_.mem, kBounceChunkSz)),
+        locking_(al_.offset > kSectorSz), next_id_(0) {
+    Ensures(h_);
+    Ensures(is_power_of_2(al_.mem));
+    Ensures(is_power_of_2(al_.offset));
+  }
+
+  template <typename T> int read(std::shared_ptr<T> rq) noexcept {
+    Expects(rq);
+
+    auto const off{rq->offset()};
+    auto const end{off + rq->size()};
+    auto const a_off{align_down(off, uint64_t{al_.offset})};
+    auto const a_end{align_up(end, uint64_t{al_.offset})};
+
+    if (a_off == off && a_end == end && bufs_aligned(*rq, al_)) [[likely]]
+      return h_->submit(std::move(rq));
+
+    auto buf{bounce(a_end - a_off)};
+    if (!buf) [[unlikely]]
+      return ENOMEM;
+    auto const span{std::span{buf.get(), a_end - a_off}};
+
+    auto brq{
+        read_query::create(
+            span, a_off,
+            [rq, buf, span, skip = off - a_off](read_query const &brq) {
+              if (brq.err()) [[unlikely]] {
+                rq->set_err(brq.err());
+                return;
+              }
+              copy_out(*rq, span.subspan(skip));
+            }),
+    };
+    brq->set_trace_id(rq->trace_id());
+
+    if (auto const res{h_->submit(brq)}) [[unlikely]]
+      brq->set_err(res);
+    return 0;
+  }
+
+  template <typename T> int write(std::shared_ptr<T> wq) noexcept {
+    Expects(wq);
+
+    auto const off{wq->offset()};
+    auto const end{off + wq->size()};
+    auto const a_off{align_down(off, uint64_t{al_.offset})};
+    auto const a_end{align_up(end, uint64_t{al_.offset})};
+    auto const rmw{a_off != off || a_end != end};
+
+    if (!rmw && !locking_) [[likely]] {
+      if (bufs_aligned(*wq, al_)) [[likely]]
+        return h_->submit(std::move(wq));
+      write_bounced(std::move(wq), a_off, a_end, false, {});
+      return 0;
+    }
+
+    try {
+      lock({.off = a_off, .end = a_end, .rmw = rmw, .id = 0},
+           [self = shared_from_this(), wq = std::move(wq), a_off, a_end,
+            rmw](uint64_t id) {
+             self->write_locked(wq, a_off, a_end, rmw, id);
+           });
+    } catch (...) {
+      return ENOMEM;
+    }
+    return 0;
+  }
+
+private:
+  /* block-aligned range a write covers */
+  struct extent {
+    uint64_t off;
+    uint64_t end;
+    bool rmw;
+    uint64_t id;
+  };
+
+  using starter = std::function<void(uint64_t id)>;
+
+  static bool conflict(extent const &a, extent const &b) noexcept {
+    return a.off < b.end && b.off < a.end && (a.rmw || b.rmw);
+  }
+
+  std::shared_ptr<std::byte[]> bounce(size_t sz) noexcept {
+    try {
+      if (sz > pool_->chunk_sz())
+        return std::shared_ptr<std::byte[]>{
+            mm::get_unique_bytes_generator(al_.mem, sz)(),
+        };
+
+      auto chunk{pool_->get()};
+      if (!chunk) [[unlikely]]
+        return {};
+      /* the pool must outlive the chunks it has handed out */
+      return std::shared_ptr<std::byte[]>{
+          chunk.release(),
+          [pool = pool_, d = chunk.get_deleter()](std::byte *p) { d(p); },
+      };
+    } catch (...) {
+    }
+    return {};
+  }
+
+  void lock(extent e, starter &&start) {
+    e.id = next_id_++;
+
+    auto const blocked{
+        std::ranges::any_of(locked_,
+                            [&e](auto const &l) { return conflict(l, e); }) ||
+            std::ranges::any_of(waiting_,
+                                [&e](auto const &w) {
+                                  return conflict(w.first, e);
+                                }),
+    };
+    if (blocked) {
+      waiting_.emplace_back(e, std::move(start));
+      return;
+    }
+
+    locked_.push_back(e);
+    start(e.id);
+  }
+
+  void unlock(uint64_t id) noexcept {
+    std::erase_if(locked_, [id](auto const &l) { return l.id == id; });
+
+    /* the ones waiting keep the order among the conflicting */
+    auto ready{std::vector<std::pair<extent, starter>>{}};
+    for (auto it{waiting_.begin()}; it != waiting_.end();) {
+      auto const &e{it->first};
+      auto const blocked{
+          std::ranges::any_of(locked_,
+                              [&e](auto const &l) { return conflict(l, e); }) ||
+              std::any_of(waiting_.begin(), it,
+                          [&e](auto const &w) { return conflict(w.first, e); }),
+      };
+      if (blocked) {
+        ++it;
+        continue;
+      }
+      locked_.push_back(e);
+      ready.push_back(std::move(*it));
+      it = waiting_.erase(it);
+    }
+
+    /* might complete right away and get back in here */
+    for (auto &[e, start] : ready)
+      start(e.id);
+  }
+
+  template <typename T>
+  void write_locked(std::shared_ptr<T> wq, uint64_t a_off, uint64_t a_end,
+                    bool rmw, uint64_t id) noexcept {
+    auto unlock{[self = shared_from_this(), id] { self->unlock(id); }};
+
+    if (!rmw && bufs_aligned(*wq, al_)) {
+      auto sq{
+          wq->subquery(0, wq->size(), wq->offset(),
+                       [wq, unlock](T const &sq) {
+                         if (sq.err()) [[unlikely]]
+                           wq->set_err(sq.err());
+                         unlock();
+                       }),
+      };
+      if (auto const res{h_->submit(sq)}) [[unlikely]]
+        sq->set_err(res);
+      return;
+    }
+
+    write_bounced(std::move(wq), a_off, a_end, rmw, std::move(unlock));
+  }
+
+  template <typename T>
+  void write_bounced(std::shared_ptr<T> wq, uint64_t a_off, uint64_t a_end,
+                     bool rmw, std::function<void()> &&done) noexcept {
+    auto buf{bounce(a_end - a_off)};
+    if (!buf) [[unlikely]] {
+      wq->set_err(ENOMEM);
+      if (done)
+        done();
+      return;
+    }
+    auto const span{std::span{buf.get(), a_end - a_off}};
+
+    auto issue{
+        [self = shared_from_this(), wq, buf, span, a_off, done] {
+          copy_in(span.subspan(wq->offset() - a_off), *wq);
+          auto bwq{
+              write_query::create(span, a_off,
+                                  [wq, buf, done](write_query const &bwq) {
+                                    if (bwq.err()) [[unlikely]]
+                                      wq->set_err(bwq.err());
+                                    if (done)
+                                      done();
+                                  }),
+          };
+          bwq->set_trace_id(wq->trace_id());
+          bwq->set_fua(wq->fua());
+          if (auto const res{self->h_->submit(bwq)}) [[unlikely]]
+            bwq->set_err(res);
+        },
+    };
+
+    if (!rmw) {
+      issue();
+      return;
+    }
+
+    /* the blocks the write covers partially, one might be both */
+    auto const off{wq->offset()};
+    auto const end{off + wq->size()};
+    auto blocks{std::vector<uint64_t>{}};
+    if (off != a_off)
+      blocks.push_back(a_off);
+    if (end != a_end && (blocks.empty() || a_end - al_.offset != a_off))
+      blocks.push_back(a_end - al_.offset);
+
+    struct reads {
+      size_t pending;
+      int err;
+    };
+    auto rs{std::make_shared<reads>(blocks.size(), 0)};
+
+    for (auto const block : blocks) {
+      auto rq{
+          read_query::create(
+              span.subspan(block - a_off, al_.offset), block,
+              [rs, wq, done, issue](read_query const &rq) {
+                if (rq.err()) [[unlikely]]
+                  rs->err = rq.err();
+                if (--rs->pending)
+                  return;
+                if (rs->err) [[unlikely]] {
+                  wq->set_err(rs->err);
+                  if (done)
+                    done();
+                  return;
+                }
+                issue();
+              }),
+      };
+      rq->set_trace_id(wq->trace_id());
+      if (auto const res{h_->submit(rq)}) [[unlikely]]
+        rq->set_err(res);
+    }
+  }
+
+  std::shared_ptr<IRWHandler> h_;
+  alignment al_;
+  std::shared_ptr<mm::mem_chunk_pool> pool_;
+  /*
+   * Blocks longer than a sector get written partially by the sector-aligned
+   * queries the device takes, aligned writes are then serialized against
+   * read-modify-writes too
+   */
+  bool locking_;
+  uint64_t next_id_;
+  std::vector<extent> locked_;
+  std::list<std::pair<extent, starter>> waiting_;
+};
+
+RWHandler::RWHandler(std::shared_ptr<IRWHandler> h, alignment al)
+    : b_(std::make_shared<bouncer>(std::move(h), al)) {
+  Ensures(b_);
+}
+
+RWHandler::~RWHandler() = default;
+
+int RWHandler::submit(std::shared_ptr<read_query> rq) noexcept {
+  return b_->read(std::move(rq));
+}
+
+int RWHandler::submit(std::shared_ptr<write_query> wq) noexcept {
+  return b_->write(std::move(wq));
+}
+
+int RWHandler::submit(std::shared_ptr<readv_query> rq) noexcept {
+  return b_->read(std::move(rq));
+}
+
+int RWHandler::submit(std::shared_ptr<writev_query> wq) noexcept {
+  return b_->write(std::move(wq));
+}
+
+} // namespace ublk::dio
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <memory>
+
+#include "rw_handler_interface.hpp"
+
+#include "alignment.hpp"
+
+namespace ublk::dio {
+
+/*
+ * Lets queries aligned as O_DIRECT wants them go down as they are. Others go
+ * through bounce buffers of the alignment taken out of a pool, writes not
+ * covering whole blocks read the blocks first. Such read-modify-writes and
+ * writes overlapping them are serialized block-wise
+ */
+class RWHandler final : public IRWHandler {
+public:
+  explicit RWHandler(std::shared_ptr<IRWHandler> h, alignment al);
+  ~RWHandler() override;
+
+  RWHandler(RWHandler const &) = delete;
+  RWHandler &operator=(RWHandler const &) = delete;
+
+  RWHandler(RWHandler &&) = delete;
+  RWHandler &operator=(RWHandler &&) = delete;
+
+  int submit(std::shared_ptr<read_query> rq) noexcept override;
+  int submit(std::shared_ptr<write_query> wq) noexcept override;
+  int submit(std::shared_ptr<readv_query> rq) noexcept override;
+  int submit(std::shared_ptr<writev_query> wq) noexcept override;
+
+private:
+  class bouncer;
+  /* outlives the handler until the queries bounced get through */
+  std::shared_ptr<bouncer> b_;
+};
+
+} // namespace ublk::dio
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <gsl/assert>
+
+#include "discard_handler_interface.hpp"
+
+namespace ublk {
+
+class DiscardHandlerComposite : public IDiscardHandler {
+public:
+  explicit DiscardHandlerComposite(
+      std::vector<std::shared_ptr<IDiscardHandler>> hs)
+      : hs_(std::move(hs)) {
+    Ensures(std::ranges::all_of(
+        hs_, [](auto const &h) { return static_cast<bool>(h); }));
+  }
+  ~DiscardHandlerComposite() override = default;
+
+  DiscardHandlerComposite(DiscardHandlerComposite const &) = delete;
+  DiscardHandlerComposite &operator=(DiscardHandlerComposite const &) = delete;
+
+  DiscardHandlerComposite(DiscardHandlerComposite &&) = delete;
+  DiscardHandlerComposite &operator=(DiscardHandlerComposite &&) = delete;
+
+  /* Every member gets the whole range, as mirrors do */
+  int submit(std::shared_ptr<discard_query> dq) noexcept override {
+    std::ranges::for_each(hs_, [dq = std::move(dq)](auto const &h) {
+      if (auto const res{h->submit(dq)}) [[unlikely]]
+        dq->set_err(res);
+    });
+    return 0;
+  }
+
+private:
+  std::vector<std::shared_ptr<IDiscardHandler>> hs_;
+};
+
+} // namespace ublk
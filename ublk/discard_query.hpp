@@ -45,7 +45,21 @@ public:
   subquery(uint64_t rq_offset, uint64_t rq_sz,
            std::function<void(discard_query const &)> &&completer = {})
       const noexcept {
-    return create(rq_offset, rq_sz, std::move(completer));
+    auto sq{create(rq_offset, rq_sz, std::move(completer))};
+    sq->set_trace_id(trace_id());
+    return sq;
+  }
+
+  std::shared_ptr<discard_query>
+  subquery(uint64_t rq_offset, uint64_t rq_sz,
+           std::shared_ptr<discard_query> parent_dq) const noexcept {
+    return subquery(
+        rq_offset, rq_sz,
+        [parent_dq = std::move(parent_dq)](discard_query const &dq) {
+          if (dq.err()) [[unlikely]] {
+            parent_dq->set_err(dq.err());
+          }
+        });
   }
 
   auto size() const noexcept { return sz_; }
@@ -22,21 +22,11 @@ public:
   }
 
   discard_req() = default;
-  explicit discard_req(
-      ublkdrv_cmd const &cmd,
-      std::function<void(discard_req const &)> &&completer = {}) noexcept
-      : req(cmd), completer_(std::move(completer)) {
+  explicit discard_req(ublkdrv_cmd const &cmd, completion c = {}) noexcept
+      : req(cmd, c) {
     Ensures(UBLKDRV_CMD_OP_DISCARD == ublkdrv_cmd_get_op(&req::cmd()));
   }
-  ~discard_req() noexcept override {
-    static_assert(std::is_nothrow_destructible_v<req>);
-    if (completer_) {
-      try {
-        completer_(*this);
-      } catch (...) {
-      }
-    }
-  }
+  ~discard_req() noexcept override = default;
 
   discard_req(discard_req const &) = delete;
   discard_req &operator=(discard_req const &) = delete;
@@ -45,9 +35,6 @@ public:
   discard_req &operator=(discard_req &&) = delete;
 
   auto const &cmd() const noexcept { return req::cmd().u.d; }
-
-private:
-  std::function<void(discard_req const &)> completer_;
 };
 
 } // namespace ublk
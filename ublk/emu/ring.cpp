@@ -0,0 +1,265 @@
+#include "ring.hpp"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <new>
+#include <system_error>
+#include <tuple>
+#include <utility>
+
+#include <gsl/assert>
+
+#include "mm/mem.hpp"
+
+using namespace ublk;
+
+namespace {
+
+constexpr auto pfddcloser = +[](int const *pfd) {
+  close(*pfd);
+  delete pfd;
+};
+
+mm::uptrwd<int const> fd_wrap(int fd) {
+  if (auto result = mm::uptrwd<int const>{new (std::nothrow) int{fd},
+                                          pfddcloser})
+    return result;
+  close(fd);
+  throw std::bad_alloc{};
+}
+
+auto socketpair_open() {
+  int fds[2];
+  if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds)) [[unlikely]]
+    throw std::system_error(errno, std::generic_category());
+  auto kfd{fd_wrap(fds[0])};
+  auto ufd{fd_wrap(fds[1])};
+  return std::pair{std::move(kfd), std::move(ufd)};
+}
+
+template <typename T> mm::uptrwd<T> mmap_shared_anon(size_t sz) {
+  if (auto p = mm::mmap_shared<T>(sz))
+    return p;
+  throw std::bad_alloc{};
+}
+
+constexpr auto nop = []([[maybe_unused]] auto *p) {};
+
+} // namespace
+
+namespace ublk::emu {
+
+ring::ring(ring_param const &param) : param_(param), cmds_notified_(0) {
+  Ensures(!(param_.cmds_len < 2));
+  Ensures(0 != param_.cell_sz);
+
+  cellc_ = mmap_shared_anon<ublkdrv_cellc>(
+      sizeof(ublkdrv_cellc) + param_.cmds_len * sizeof(ublkdrv_celld));
+  cellc_->cellds_len = param_.cmds_len;
+  for (uint32_t id{0}; id < param_.cmds_len; ++id) {
+    auto &celld{cellc_->cellds[id]};
+    celld.offset = id * param_.cell_sz;
+    celld.data_sz = param_.cell_sz;
+    celld.ncelld = (id + 1) % param_.cmds_len;
+  }
+
+  cmdb_ = mmap_shared_anon<ublkdrv_cmdb>(
+      sizeof(ublkdrv_cmdb) + param_.cmds_len * sizeof(ublkdrv_cmd));
+  cmdb_->cmds_len = param_.cmds_len;
+
+  cmdb_ack_ = mmap_shared_anon<ublkdrv_cmdb_ack>(
+      sizeof(ublkdrv_cmdb_ack) + param_.cmds_len * sizeof(ublkdrv_cmd_ack));
+  cmdb_ack_->cmds_len = param_.cmds_len;
+
+  cells_ = mmap_shared_anon<std::byte>(static_cast<size_t>(param_.cmds_len) *
+                                       param_.cell_sz);
+
+  using TH = decltype(cellc_->cmdb_head);
+  using TT = decltype(cmdb_->tail);
+
+  cmds_pusher_ = std::make_unique<cmds_pusher_t>(
+      cfq::pos_t<TH const>{&cellc_->cmdb_head, nop},
+      cfq::pos_t<TT>{&cmdb_->tail, nop},
+      std::span{cmdb_->cmds, cmdb_->cmds_len});
+
+  using TAH = decltype(cellc_->cmdb_ack_head);
+  using TAT = decltype(cmdb_ack_->tail);
+
+  acks_popper_ = std::make_unique<acks_popper_t>(
+      cfq::pos_t<TAH>{&cellc_->cmdb_ack_head, nop},
+      cfq::pos_t<TAT const>{&cmdb_ack_->tail, nop},
+      std::span<ublkdrv_cmd_ack const>{cmdb_ack_->cmds, cmdb_ack_->cmds_len});
+
+  std::tie(kfd_cmds_, ufd_cmds_) = socketpair_open();
+  std::tie(kfd_acks_, ufd_acks_) = socketpair_open();
+}
+
+ring::~ring() noexcept = default;
+
+std::unique_ptr<qublkcmd_t> ring::qcmd() {
+  using TH = decltype(cellc_->cmdb_head);
+  using TT = decltype(cmdb_->tail);
+
+  /* The head is private to userspace as it is in slave::run */
+  return std::make_unique<qublkcmd_t>(
+      cfq::pos_t<TH>{new TH{cellc_->cmdb_head}, std::default_delete<TH>{}},
+      cfq::pos_t<TT const>{&cmdb_->tail, nop},
+      std::span<ublkdrv_cmd const>{cmdb_->cmds, cmdb_->cmds_len});
+}
+
+std::unique_ptr<qublkcmd_ack_t> ring::qcmd_ack() {
+  using TH = decltype(cellc_->cmdb_ack_head);
+  using TT = decltype(cmdb_ack_->tail);
+
+  return std::make_unique<qublkcmd_ack_t>(
+      cfq::pos_t<TH const>{&cellc_->cmdb_ack_head, nop},
+      cfq::pos_t<TT>{&cmdb_ack_->tail, nop},
+      std::span{cmdb_ack_->cmds, cmdb_ack_->cmds_len});
+}
+
+std::span<ublkdrv_celld const> ring::cellds() const noexcept {
+  return {cellc_->cellds, cellc_->cellds_len};
+}
+
+std::span<std::byte> ring::cells() const noexcept {
+  return {cells_.get(), static_cast<size_t>(param_.cmds_len) * param_.cell_sz};
+}
+
+mm::uptrwd<int const> ring::fd_cmds() const {
+  if (auto const fd{dup(*ufd_cmds_)}; fd >= 0) [[likely]]
+    return fd_wrap(fd);
+  throw std::system_error(errno, std::generic_category());
+}
+
+mm::uptrwd<int const> ring::fd_acks() const {
+  if (auto const fd{dup(*ufd_acks_)}; fd >= 0) [[likely]]
+    return fd_wrap(fd);
+  throw std::system_error(errno, std::generic_category());
+}
+
+std::span<std::byte> ring::cell(uint32_t id) const noexcept {
+  Expects(id < param_.cmds_len);
+  return cells().subspan(static_cast<size_t>(id) * param_.cell_sz,
+                         param_.cell_sz);
+}
+
+void ring::celld_set(uint32_t id, uint32_t sz) noexcept {
+  Expects(id < param_.cmds_len);
+  Expects(0 != sz);
+  Expects(!(sz > param_.cell_sz));
+  cellc_->cellds[id].data_sz = sz;
+}
+
+int ring::read(uint32_t id, uint64_t offset, uint32_t sz) noexcept {
+  celld_set(id, sz);
+
+  ublkdrv_cmd cmd{};
+  ublkdrv_cmd_set_id(&cmd, id);
+  ublkdrv_cmd_set_op(&cmd, UBLKDRV_CMD_OP_READ);
+  ublkdrv_cmd_read_set_offset(&cmd.u.r, offset);
+  ublkdrv_cmd_read_set_fcdn(&cmd.u.r, id);
+  ublkdrv_cmd_read_set_cds_nr(&cmd.u.r, 1);
+
+  return push(cmd);
+}
+
+int ring::write(uint32_t id, uint64_t offset, uint32_t sz) noexcept {
+  celld_set(id, sz);
+
+  ublkdrv_cmd cmd{};
+  ublkdrv_cmd_set_id(&cmd, id);
+  ublkdrv_cmd_set_op(&cmd, UBLKDRV_CMD_OP_WRITE);
+  ublkdrv_cmd_write_set_offset(&cmd.u.w, offset);
+  ublkdrv_cmd_write_set_fcdn(&cmd.u.w, id);
+  ublkdrv_cmd_write_set_cds_nr(&cmd.u.w, 1);
+
+  return push(cmd);
+}
+
+int ring::flush(uint32_t id) noexcept {
+  Expects(id < param_.cmds_len);
+
+  ublkdrv_cmd cmd{};
+  ublkdrv_cmd_set_id(&cmd, id);
+  ublkdrv_cmd_set_op(&cmd, UBLKDRV_CMD_OP_FLUSH);
+
+  return push(cmd);
+}
+
+int ring::discard(uint32_t id, uint64_t offset, uint32_t sz) noexcept {
+  Expects(id < param_.cmds_len);
+
+  ublkdrv_cmd cmd{};
+  ublkdrv_cmd_set_id(&cmd, id);
+  ublkdrv_cmd_set_op(&cmd, UBLKDRV_CMD_OP_DISCARD);
+  ublkdrv_cmd_discard_set_offset(&cmd.u.d, offset);
+  ublkdrv_cmd_discard_set_sz(&cmd.u.d, sz);
+
+  return push(cmd);
+}
+
+/*
+ * Userspace reports how many commands it has taken out of the ring, that is
+ * the only way for the kernel to learn that the slots are free again
+ */
+void ring::reports_drain() noexcept {
+  using TH = decltype(cellc_->cmdb_head);
+  for (uint32_t cmds{0};
+       sizeof(cmds) == ::recv(*kfd_cmds_, &cmds, sizeof(cmds), MSG_DONTWAIT);) {
+    auto const ch{__atomic_load_n(&cellc_->cmdb_head, __ATOMIC_RELAXED)};
+    __atomic_store_n(&cellc_->cmdb_head,
+                     static_cast<TH>((ch + cmds) % cmdb_->cmds_len),
+                     __ATOMIC_RELEASE);
+  }
+}
+
+int ring::push(ublkdrv_cmd const &cmd) noexcept {
+  reports_drain();
+
+  if (!cmds_pusher_->push(cmd)) [[unlikely]]
+    return EAGAIN;
+
+  ++cmds_notified_;
+  if (auto const r{
+          ::write(*kfd_cmds_, &cmds_notified_, sizeof(cmds_notified_)),
+      };
+      sizeof(cmds_notified_) != r) [[unlikely]] {
+    return r < 0 ? errno : EIO;
+  }
+
+  return 0;
+}
+
+size_t ring::acks_pop(std::span<ublkdrv_cmd_ack> acks) noexcept {
+  /* The notifications only wake the kernel up, the ring tells the acks */
+  for (uint32_t acks_nr{0}; sizeof(acks_nr) == ::recv(*kfd_acks_, &acks_nr,
+                                                      sizeof(acks_nr),
+                                                      MSG_DONTWAIT);) {
+  }
+  return acks_popper_->pop_n(acks);
+}
+
+int ring::acks_wait(std::chrono::milliseconds timeout) noexcept {
+  if (__atomic_load_n(&cmdb_ack_->tail, __ATOMIC_ACQUIRE) !=
+      __atomic_load_n(&cellc_->cmdb_ack_head, __ATOMIC_RELAXED)) {
+    return 0;
+  }
+
+  auto pfd{pollfd{.fd = *kfd_acks_, .events = POLLIN, .revents = 0}};
+  switch (::poll(&pfd, 1, static_cast<int>(timeout.count()))) {
+  case -1:
+    return errno;
+  case 0:
+    return ETIMEDOUT;
+  default:
+    return 0;
+  }
+}
+
+} // namespace ublk::emu
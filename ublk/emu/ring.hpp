@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <chrono>
+#include <memory>
+#include <span>
+
+#include <linux/ublkdrv/cellc.h>
+#include <linux/ublkdrv/celld.h>
+#include <linux/ublkdrv/cmd.h>
+#include <linux/ublkdrv/cmd_ack.h>
+#include <linux/ublkdrv/cmdb.h>
+#include <linux/ublkdrv/cmdb_ack.h>
+
+#include "cfq/popper.hpp"
+#include "cfq/pusher.hpp"
+
+#include "mm/mem_types.hpp"
+
+#include "qublkcmd.hpp"
+
+#include "ring_param.hpp"
+
+namespace ublk::emu {
+
+/*
+ * Plays the ublkdrv's part in the process: the cells configuration, the
+ * command rings and the cells are allocated in anonymous shared memory and
+ * socket pairs stand for UIO devices. Userspace gets the same things
+ * slave::run would get out of UIO mappings, so the command path runs
+ * unmodified, while the kernel side pushes commands and pops acks.
+ *
+ * Every command id is bound to a cell of its own, hence there may be no
+ * more commands in flight than there are ids
+ */
+class ring final {
+public:
+  explicit ring(ring_param const &param);
+  ~ring() noexcept;
+
+  ring(ring const &) = delete;
+  ring &operator=(ring const &) = delete;
+
+  ring(ring &&) = delete;
+  ring &operator=(ring &&) = delete;
+
+  /* The userspace side */
+  std::unique_ptr<qublkcmd_t> qcmd();
+  std::unique_ptr<qublkcmd_ack_t> qcmd_ack();
+
+  std::span<ublkdrv_celld const> cellds() const noexcept;
+  std::span<std::byte> cells() const noexcept;
+
+  /* the counterpart of the kernel-to-user UIO device */
+  mm::uptrwd<int const> fd_cmds() const;
+  /* the counterpart of the user-to-kernel UIO device */
+  mm::uptrwd<int const> fd_acks() const;
+
+  /* The kernel side */
+  uint32_t cmds_len() const noexcept { return param_.cmds_len; }
+  std::span<std::byte> cell(uint32_t id) const noexcept;
+
+  int read(uint32_t id, uint64_t offset, uint32_t sz) noexcept;
+  int write(uint32_t id, uint64_t offset, uint32_t sz) noexcept;
+  int flush(uint32_t id) noexcept;
+  int discard(uint32_t id, uint64_t offset, uint32_t sz) noexcept;
+
+  size_t acks_pop(std::span<ublkdrv_cmd_ack> acks) noexcept;
+  int acks_wait(std::chrono::milliseconds timeout) noexcept;
+
+private:
+  using cmds_pusher_t =
+      cfq::pusher<ublkdrv_cmd, decltype(std::declval<ublkdrv_cellc>().cmdb_head),
+                  decltype(std::declval<ublkdrv_cmdb>().tail)>;
+  using acks_popper_t =
+      cfq::popper<ublkdrv_cmd_ack,
+                  decltype(std::declval<ublkdrv_cellc>().cmdb_ack_head),
+                  decltype(std::declval<ublkdrv_cmdb_ack>().tail)>;
+
+  void celld_set(uint32_t id, uint32_t sz) noexcept;
+  int push(ublkdrv_cmd const &cmd) noexcept;
+  void reports_drain() noexcept;
+
+  ring_param param_;
+
+  mm::uptrwd<ublkdrv_cellc> cellc_;
+  mm::uptrwd<ublkdrv_cmdb> cmdb_;
+  mm::uptrwd<ublkdrv_cmdb_ack> cmdb_ack_;
+  mm::uptrwd<std::byte> cells_;
+
+  std::unique_ptr<cmds_pusher_t> cmds_pusher_;
+  std::unique_ptr<acks_popper_t> acks_popper_;
+
+  /* the kernel's ends of the socket pairs */
+  mm::uptrwd<int const> kfd_cmds_;
+  mm::uptrwd<int const> kfd_acks_;
+  /* the userspace's ends of the socket pairs */
+  mm::uptrwd<int const> ufd_cmds_;
+  mm::uptrwd<int const> ufd_acks_;
+
+  /* UIO reports the events counter rather than separate events */
+  uint32_t cmds_notified_;
+};
+
+} // namespace ublk::emu
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+namespace ublk::emu {
+
+struct ring_param {
+  /* commands the rings and the cells descriptors are capable of */
+  uint32_t cmds_len;
+  /* each command is given a cell of this size, the largest IO possible */
+  uint32_t cell_sz;
+};
+
+} // namespace ublk::emu
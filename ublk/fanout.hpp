@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <functional>
+#include <memory>
+#include <utility>
+
+#include <gsl/assert>
+
+#include <boost/container/small_vector.hpp>
+
+#include "mm/pool_allocators.hpp"
+
+namespace ublk {
+
+/*
+ * Splits parent queries into children kept inline within a single allocation.
+ * Children are handed out as pointers aliasing the fan-out, so its reference
+ * counter tracks the children pending. Once all of them have completed errors
+ * get propagated to the parents and the completer is called with the first one
+ */
+template <typename Q, size_t N = 16>
+class fanout final : public std::enable_shared_from_this<fanout<Q, N>> {
+public:
+  static auto create(size_t children_nr,
+                     std::function<void(int err)> &&completer = {}) noexcept {
+    return std::allocate_shared<fanout>(
+        mm::allocator::pool_cache_line_aligned<fanout>::value, children_nr,
+        std::move(completer));
+  }
+
+  static auto create(std::shared_ptr<Q> parent, size_t children_nr,
+                     std::function<void(int err)> &&completer = {}) noexcept {
+    auto fo{create(children_nr, std::move(completer))};
+    fo->parent(std::move(parent));
+    return fo;
+  }
+
+  explicit fanout(size_t children_nr,
+                  std::function<void(int err)> &&completer = {}) noexcept
+      : completer_(std::move(completer)) {
+    Ensures(0 != children_nr);
+    children_.reserve(children_nr);
+  }
+  ~fanout() {
+    auto err{0};
+    for (auto const &child : children_) {
+      if (auto const child_err{child.q.err()}) [[unlikely]] {
+        parents_[child.parent_id]->set_err(child_err);
+        if (!err)
+          err = child_err;
+      }
+    }
+    if (completer_) {
+      try {
+        completer_(err);
+      } catch (...) {
+      }
+    }
+  }
+
+  fanout(fanout const &) = delete;
+  fanout &operator=(fanout const &) = delete;
+
+  fanout(fanout &&) = delete;
+  fanout &operator=(fanout &&) = delete;
+
+  size_t parent(std::shared_ptr<Q> p) noexcept {
+    Expects(p);
+    parents_.push_back(std::move(p));
+    return parents_.size() - 1;
+  }
+
+  std::shared_ptr<Q> subquery(size_t parent_id, uint64_t buf_offset,
+                              uint64_t buf_sz, uint64_t offset) noexcept {
+    Expects(parent_id < parents_.size());
+    Expects(0 != buf_sz);
+    /* children must never be relocated as they might be in flight */
+    Expects(children_.size() < children_.capacity());
+
+    auto const buf{parents_[parent_id]->buf()};
+    Expects(!(buf_offset + buf_sz > buf.size()));
+
+    auto &child{
+        children_.emplace_back(buf.subspan(buf_offset, buf_sz), offset,
+                               parent_id),
+    };
+    child.q.set_trace_id(parents_[parent_id]->trace_id());
+    if constexpr (requires { child.q.set_fua(true); })
+      child.q.set_fua(parents_[parent_id]->fua());
+
+    return {this->shared_from_this(), &child.q};
+  }
+
+  std::shared_ptr<Q> subquery(uint64_t buf_offset, uint64_t buf_sz,
+                              uint64_t offset) noexcept {
+    return subquery(0, buf_offset, buf_sz, offset);
+  }
+
+private:
+  struct child {
+    child(auto buf, uint64_t offset, size_t parent_id) noexcept
+        : q(buf, offset), parent_id(parent_id) {}
+
+    Q q;
+    size_t parent_id;
+  };
+
+  boost::container::small_vector<std::shared_ptr<Q>, 2> parents_;
+  boost::container::small_vector<child, N> children_;
+  std::function<void(int err)> completer_;
+};
+
+} // namespace ublk
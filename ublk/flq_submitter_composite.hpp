@@ -26,9 +26,15 @@ public:
   FLQSubmitterComposite(FLQSubmitterComposite &&) = delete;
   FLQSubmitterComposite &operator=(FLQSubmitterComposite &&) = delete;
 
+  /*
+   * Members flush in parallel, the query completes once the slowest of them
+   * has
+   */
   int submit(std::shared_ptr<flush_query> fq) noexcept override {
-    std::ranges::for_each(
-        hs_, [fq = std::move(fq)](auto const &h) { h->submit(fq); });
+    std::ranges::for_each(hs_, [fq = std::move(fq)](auto const &h) {
+      if (auto const res{h->submit(fq)}) [[unlikely]]
+        fq->set_err(res);
+    });
     return 0;
   }
 
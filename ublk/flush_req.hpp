@@ -22,21 +22,11 @@ public:
   }
 
   flush_req() = default;
-  explicit flush_req(
-      ublkdrv_cmd const &cmd,
-      std::function<void(flush_req const &)> &&completer = {}) noexcept
-      : req(cmd), completer_(std::move(completer)) {
+  explicit flush_req(ublkdrv_cmd const &cmd, completion c = {}) noexcept
+      : req(cmd, c) {
     Ensures(UBLKDRV_CMD_OP_FLUSH == ublkdrv_cmd_get_op(&req::cmd()));
   }
-  ~flush_req() noexcept override {
-    static_assert(std::is_nothrow_destructible_v<req>);
-    if (completer_) {
-      try {
-        completer_(*this);
-      } catch (...) {
-      }
-    }
-  }
+  ~flush_req() noexcept override = default;
 
   flush_req(flush_req const &) = delete;
   flush_req &operator=(flush_req const &) = delete;
@@ -45,9 +35,6 @@ public:
   flush_req &operator=(flush_req &&) = delete;
 
   auto const &cmd() const noexcept { return req::cmd().u.f; }
-
-private:
-  std::function<void(flush_req const &)> completer_;
 };
 
 } // namespace ublk
@@ -12,10 +12,14 @@
 
 #include <linux/types.h>
 
+#include <algorithm>
+#include <chrono>
 #include <format>
+#include <span>
 #include <stdexcept>
 #include <thread>
 #include <utility>
+#include <vector>
 
 #include <gsl/assert>
 #include <spdlog/spdlog.h>
@@ -31,6 +35,8 @@
 
 #include "sys/file.hpp"
 
+#include "trace/trace.hpp"
+
 using namespace ublk;
 
 namespace {
@@ -42,9 +48,20 @@ struct handler_ctx {
   mm::uptrwd<int const> fd;
   std::unique_ptr<boost::asio::posix::stream_descriptor> sd;
 
+  handler_param param;
+  std::shared_ptr<handler_stats> stats;
+
+  std::vector<ublkdrv_cmd> cmds_buf;
+
   uint32_t cmds;
-  uint32_t processed_cmds;
   uint32_t last_cmds;
+  /* commands popped by polling ahead of the kernel's notifications */
+  uint32_t polled_cmds;
+  /* commands popped the kernel has not been told about yet */
+  uint32_t unreported_cmds;
+  uint32_t processed_cmds;
+  bool reporting;
+  bool polling;
 };
 
 mm::uptrwd<int const> fd_open(evpaths_t const &evpaths) {
@@ -62,6 +79,95 @@ mm::uptrwd<int const> fd_open(evpaths_t const &evpaths) {
   return fd;
 }
 
+void dispatch(std::shared_ptr<handler_ctx> const &ctx,
+              ublkdrv_cmd const &cmd) {
+  auto const trace_id{trace::sample()};
+  trace::record("cmd", trace_id, trace::phase::begin);
+
+  boost::asio::post(ctx->sd->get_executor(), [ctx, cmd, trace_id] {
+    trace::current_scope const scope{trace_id};
+    trace::record("dispatch", trace_id);
+    if (auto const r [[maybe_unused]]{ctx->handler->handle(cmd)}) [[unlikely]]
+      std::abort();
+  });
+  ++ctx->unreported_cmds;
+}
+
+/*
+ * Tells the kernel how many commands have been taken out of the ring.
+ * Only one write is in flight at a time, the commands popped meanwhile
+ * are reported by the next one
+ */
+void report(std::shared_ptr<handler_ctx> ctx) {
+  if (ctx->reporting || !ctx->unreported_cmds)
+    return;
+
+  ctx->reporting = true;
+  ctx->processed_cmds = std::exchange(ctx->unreported_cmds, 0);
+
+  auto *p_ctx = ctx.get();
+  boost::asio::async_write(
+      *p_ctx->sd,
+      boost::asio::buffer(&p_ctx->processed_cmds,
+                          sizeof(p_ctx->processed_cmds)),
+      [ctx = std::move(ctx)](boost::system::error_code const &ec,
+                             size_t bytes_written [[maybe_unused]]) mutable {
+        if (ec) [[unlikely]] {
+          spdlog::error("failed to async_write, ec {}", ec.value());
+          return;
+        } else {
+          Ensures(bytes_written == sizeof(ctx->processed_cmds));
+        }
+
+        ctx->reporting = false;
+        report(std::move(ctx));
+      });
+}
+
+void poll(std::shared_ptr<handler_ctx> ctx,
+          std::chrono::steady_clock::time_point deadline) {
+  uint32_t cmds{0};
+  for (auto n = ctx->qcmd->pop_n(ctx->cmds_buf); n;
+       n = ctx->qcmd->pop_n(ctx->cmds_buf)) {
+    for (auto const &cmd : std::span{ctx->cmds_buf}.first(n))
+      dispatch(ctx, cmd);
+    cmds += n;
+  }
+
+  auto const now{std::chrono::steady_clock::now()};
+
+  if (cmds) {
+    ++ctx->stats->poll_hits;
+    ctx->polled_cmds += cmds;
+    deadline = now + ctx->param.poll_budget;
+    report(ctx);
+  } else if (now >= deadline) {
+    ++ctx->stats->poll_misses;
+    ctx->polling = false;
+    return;
+  }
+
+  /*
+   * Going through the io_context lets the posted commands and completions
+   * run between the polling rounds
+   */
+  auto *p_ctx = ctx.get();
+  boost::asio::post(p_ctx->sd->get_executor(),
+                    [ctx = std::move(ctx), deadline]() mutable {
+                      poll(std::move(ctx), deadline);
+                    });
+}
+
+void poll_start(std::shared_ptr<handler_ctx> ctx) {
+  if (!ctx->param.poll_budget.count() || std::exchange(ctx->polling, true))
+    return;
+
+  auto const deadline{
+      std::chrono::steady_clock::now() + ctx->param.poll_budget,
+  };
+  poll(std::move(ctx), deadline);
+}
+
 void async_read(std::shared_ptr<handler_ctx> ctx) {
   auto *p_ctx = ctx.get();
   boost::asio::async_read(
@@ -76,33 +182,32 @@ void async_read(std::shared_ptr<handler_ctx> ctx) {
           Ensures(bytes_read == sizeof(ctx->cmds));
         }
 
-        ctx->processed_cmds = 0;
-        for (ctx->cmds -= std::exchange(ctx->last_cmds, ctx->cmds); ctx->cmds;
-             --ctx->cmds, ++ctx->processed_cmds) {
-          auto cmd = ctx->qcmd->pop();
-          for (; !cmd; cmd = ctx->qcmd->pop())
+        auto new_cmds{ctx->cmds - std::exchange(ctx->last_cmds, ctx->cmds)};
+
+        if (ctx->param.stats)
+          stats_set(ctx->param.stats->cmdb_occupancy, ctx->qcmd->size());
+
+        /* Some of the commands notified might have been polled already */
+        auto const polled_cmds{std::min(new_cmds, ctx->polled_cmds)};
+        ctx->polled_cmds -= polled_cmds;
+        new_cmds -= polled_cmds;
+
+        while (new_cmds) {
+          auto const n{
+              ctx->qcmd->pop_n(std::span{ctx->cmds_buf}.first(
+                  std::min<size_t>(new_cmds, ctx->cmds_buf.size()))),
+          };
+          if (!n) [[unlikely]] {
             std::this_thread::yield();
-          boost::asio::post(
-              ctx->sd->get_executor(), [ctx, cmd = std::move(*cmd)] {
-                if (auto const r [[maybe_unused]]{ctx->handler->handle(cmd)})
-                    [[unlikely]]
-                  std::abort();
-              });
+            continue;
+          }
+          for (auto const &cmd : std::span{ctx->cmds_buf}.first(n))
+            dispatch(ctx, cmd);
+          new_cmds -= n;
         }
 
-        boost::asio::async_write(
-            *ctx->sd,
-            boost::asio::buffer(&ctx->processed_cmds,
-                                sizeof(ctx->processed_cmds)),
-            [ctx](boost::system::error_code const &ec,
-                  size_t bytes_written [[maybe_unused]]) mutable {
-              if (ec) [[unlikely]] {
-                spdlog::error("failed to async_write, ec {}", ec.value());
-                return;
-              } else {
-                Ensures(bytes_written == sizeof(ctx->processed_cmds));
-              }
-            });
+        report(ctx);
+        poll_start(ctx);
 
         async_read(std::move(ctx));
       });
@@ -112,10 +217,21 @@ void async_read(std::shared_ptr<handler_ctx> ctx) {
 
 namespace ublk {
 
-void async_start(
+std::shared_ptr<handler_stats const> async_start(
     evpaths_t const &evpaths, boost::asio::io_context &io_ctx,
     std::unique_ptr<qublkcmd_t> qcmd,
-    std::unique_ptr<IHandler<int(ublkdrv_cmd const &) noexcept>> handler) {
+    std::unique_ptr<IHandler<int(ublkdrv_cmd const &) noexcept>> handler,
+    handler_param const &param) {
+  return async_start(fd_open(evpaths), io_ctx, std::move(qcmd),
+                     std::move(handler), param);
+}
+
+std::shared_ptr<handler_stats const> async_start(
+    mm::uptrwd<int const> fd, boost::asio::io_context &io_ctx,
+    std::unique_ptr<qublkcmd_t> qcmd,
+    std::unique_ptr<IHandler<int(ublkdrv_cmd const &) noexcept>> handler,
+    handler_param const &param) {
+  Expects(fd);
   Expects(qcmd);
   Expects(handler);
 
@@ -123,14 +239,20 @@ void async_start(
 
   ctx->qcmd = std::move(qcmd);
   ctx->handler = std::move(handler);
+  ctx->param = param;
+  ctx->stats = std::make_shared<handler_stats>();
+  ctx->cmds_buf.resize(ctx->qcmd->capacity());
 
-  ctx->fd = fd_open(evpaths);
-  Ensures(ctx->fd);
+  ctx->fd = std::move(fd);
 
   ctx->sd =
       std::make_unique<boost::asio::posix::stream_descriptor>(io_ctx, *ctx->fd);
 
+  auto stats{ctx->stats};
+
   async_read(std::move(ctx));
+
+  return stats;
 }
 
 } // namespace ublk
@@ -2,6 +2,8 @@
 
 #include <linux/ublkdrv/cmd.h>
 
+#include <cstdint>
+
 #include <filesystem>
 #include <memory>
 #include <string>
@@ -9,16 +11,33 @@
 
 #include <boost/asio/io_context.hpp>
 
+#include "mm/mem_types.hpp"
+
 #include "handler_interface.hpp"
+#include "handler_param.hpp"
 #include "qublkcmd.hpp"
 
 namespace ublk {
 
 using evpaths_t = std::unordered_map<std::string, std::filesystem::path>;
 
-void async_start(
+struct handler_stats {
+  /* polling rounds that have found commands in the ring */
+  uint64_t poll_hits;
+  /* polling rounds that have run out of the budget with the ring empty */
+  uint64_t poll_misses;
+};
+
+std::shared_ptr<handler_stats const> async_start(
     evpaths_t const &evpaths, boost::asio::io_context &io_ctx,
     std::unique_ptr<qublkcmd_t> qcmd,
-    std::unique_ptr<IHandler<int(ublkdrv_cmd const &) noexcept>> handler);
+    std::unique_ptr<IHandler<int(ublkdrv_cmd const &) noexcept>> handler,
+    handler_param const &param = {});
+
+std::shared_ptr<handler_stats const> async_start(
+    mm::uptrwd<int const> fd, boost::asio::io_context &io_ctx,
+    std::unique_ptr<qublkcmd_t> qcmd,
+    std::unique_ptr<IHandler<int(ublkdrv_cmd const &) noexcept>> handler,
+    handler_param const &param = {});
 
 } // namespace ublk
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+
+#include "target_stats.hpp"
+
+namespace ublk {
+
+struct handler_param {
+  /*
+   * How long the command ring is polled after the last command found there
+   * before falling back to waiting for the kernel's notification.
+   * 0 disables polling
+   */
+  std::chrono::microseconds poll_budget;
+  /* where the command ring's occupancy is reported to, may be empty */
+  std::shared_ptr<target_stats> stats;
+};
+
+} // namespace ublk
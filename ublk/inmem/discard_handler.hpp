@@ -0,0 +1,35 @@
+#pragma once
+
+#include <memory>
+#include <utility>
+
+#include <gsl/assert>
+
+#include "discard_handler_interface.hpp"
+#include "target.hpp"
+
+namespace ublk::inmem {
+
+class DiscardHandler final : public IDiscardHandler {
+public:
+  explicit DiscardHandler(std::shared_ptr<Target> target)
+      : target_(std::move(target)) {
+    Ensures(target_);
+  }
+  ~DiscardHandler() override = default;
+
+  DiscardHandler(DiscardHandler const &) = delete;
+  DiscardHandler &operator=(DiscardHandler const &) = delete;
+
+  DiscardHandler(DiscardHandler &&) = delete;
+  DiscardHandler &operator=(DiscardHandler &&) = delete;
+
+  int submit(std::shared_ptr<discard_query> dq) noexcept override {
+    return target_->process(std::move(dq));
+  }
+
+private:
+  std::shared_ptr<Target> target_;
+};
+
+} // namespace ublk::inmem
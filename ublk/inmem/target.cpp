@@ -1,15 +1,25 @@
 #include "target.hpp"
 
 #include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#include <sys/mman.h>
 
 #include <span>
 #include <utility>
 
 #include <gsl/assert>
 
+#include "mm/mem.hpp"
 #include "mm/mem_types.hpp"
 
+#include "sys/page.hpp"
+
 #include "utils/algo.hpp"
+#include "utils/utility.hpp"
+
+#include "trace/trace.hpp"
 
 namespace ublk::inmem {
 
@@ -31,6 +41,7 @@ int Target::process(std::shared_ptr<read_query> rq) noexcept {
   auto const to{rq->buf()};
 
   algo::copy(from, to);
+  trace::record("inmem", rq->trace_id());
 
   return 0;
 }
@@ -46,8 +57,52 @@ int Target::process(std::shared_ptr<write_query> wq) noexcept {
   auto const to{std::span{mem_.get() + wq->offset(), wq->buf().size()}};
 
   algo::copy(from, to);
+  trace::record("inmem", wq->trace_id());
+
+  return 0;
+}
+
+int Target::process(std::shared_ptr<discard_query> dq) noexcept {
+  Expects(dq);
+
+  if (mem_sz_ < dq->offset() + dq->size()) [[unlikely]]
+    return EINVAL;
+
+  auto const from{reinterpret_cast<uintptr_t>(mem_.get() + dq->offset())};
+  auto const to{from + dq->size()};
+
+  auto const page_sz{static_cast<uintptr_t>(sys::page_size())};
+  auto const pages_from{align_up(from, page_sz)};
+  auto const pages_to{align_down(to, page_sz)};
+
+  /*
+   * The memory is mapped privately, thus pages dropped read back as zeroes.
+   * Edges of the range not covering a page, as well as the whole range in case
+   * the kernel refuses (e.g. huge pages), are zeroed explicitly
+   */
+  if (pages_from < pages_to &&
+      0 == ::madvise(reinterpret_cast<void *>(pages_from),
+                     pages_to - pages_from, MADV_DONTNEED)) {
+    std::memset(reinterpret_cast<void *>(from), 0, pages_from - from);
+    std::memset(reinterpret_cast<void *>(pages_to), 0, to - pages_to);
+  } else {
+    std::memset(reinterpret_cast<void *>(from), 0, to - from);
+  }
+  trace::record("inmem", dq->trace_id());
 
   return 0;
 }
 
+mm::uptrwd<std::byte[]> make_sparse_mem(uint64_t sz) noexcept {
+  auto mem{mm::make_unique_bytes(mm::alloc_mode_mmap{.flags = MAP_NORESERVE},
+                                 sz)};
+  /*
+   * Transparent huge pages would back a whole 2MiB by a single write and
+   * keep it from being given back by discards smaller than that
+   */
+  if (mem)
+    ::madvise(mem.get(), sz, MADV_NOHUGEPAGE);
+  return mem;
+}
+
 } // namespace ublk::inmem
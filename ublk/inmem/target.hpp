@@ -5,6 +5,7 @@
 
 #include "mm/mem_types.hpp"
 
+#include "discard_query.hpp"
 #include "read_query.hpp"
 #include "write_query.hpp"
 
@@ -16,10 +17,18 @@ public:
 
   int process(std::shared_ptr<read_query> rq) noexcept;
   int process(std::shared_ptr<write_query> wq) noexcept;
+  /* Whole pages of the range are given back to the kernel */
+  int process(std::shared_ptr<discard_query> dq) noexcept;
 
 private:
   mm::uptrwd<std::byte[]> mem_;
   uint64_t mem_sz_;
 };
 
+/*
+ * Reserves memory for a sparse target. Pages are not accounted until written
+ * to, so that RSS follows the data stored rather than the capacity
+ */
+mm::uptrwd<std::byte[]> make_sparse_mem(uint64_t sz) noexcept;
+
 } // namespace ublk::inmem
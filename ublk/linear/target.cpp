@@ -0,0 +1,115 @@
+#include "target.hpp"
+
+#include <cerrno>
+#include <cstdint>
+
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <gsl/assert>
+
+namespace ublk::linear {
+
+Target::Target(std::vector<member> members) : offsets_{0} {
+  Ensures(!members.empty());
+  for (auto &m : members)
+    append(std::move(m));
+}
+
+void Target::append(member m) {
+  Expects(0 != m.sz);
+  Expects(m.h);
+  Expects(m.discarder);
+
+  offsets_.push_back(offsets_.back() + m.sz);
+  members_.push_back(std::move(m));
+}
+
+template <typename T>
+int Target::do_op(std::shared_ptr<T> query, uint64_t query_sz,
+                  auto &&submit) const noexcept {
+  Expects(query);
+  Expects(0 != query_sz);
+
+  if (size() < query->offset() + query_sz) [[unlikely]]
+    return EINVAL;
+
+  auto mid{
+      static_cast<size_t>(
+          std::ranges::upper_bound(offsets_, query->offset()) -
+          offsets_.begin() - 1),
+  };
+
+  for (auto off{query->offset()}; off < query->offset() + query_sz; ++mid) {
+    Expects(mid < members_.size());
+    auto const sz{
+        std::min(offsets_[mid + 1], query->offset() + query_sz) - off,
+    };
+    if (auto const res{
+            submit(members_[mid], query, off - query->offset(), sz,
+                   off - offsets_[mid]),
+        }) [[unlikely]] {
+      return res;
+    }
+    off += sz;
+  }
+
+  return 0;
+}
+
+namespace {
+
+template <typename T>
+int rw_submit(member const &m, std::shared_ptr<T> const &query,
+              uint64_t buf_offset, uint64_t sz, uint64_t m_offset) noexcept {
+  return m.h->submit(query->subquery(buf_offset, sz, m_offset, query));
+}
+
+} // namespace
+
+int Target::process(std::shared_ptr<read_query> rq) noexcept {
+  Expects(rq);
+
+  auto const sz{rq->buf().size()};
+  return do_op(std::move(rq), sz, rw_submit<read_query>);
+}
+
+int Target::process(std::shared_ptr<write_query> wq) noexcept {
+  Expects(wq);
+
+  auto const sz{wq->buf().size()};
+  return do_op(std::move(wq), sz, rw_submit<write_query>);
+}
+
+int Target::process(std::shared_ptr<readv_query> rq) noexcept {
+  Expects(rq);
+
+  auto const sz{rq->size()};
+  return do_op(std::move(rq), sz, rw_submit<readv_query>);
+}
+
+int Target::process(std::shared_ptr<writev_query> wq) noexcept {
+  Expects(wq);
+
+  auto const sz{wq->size()};
+  return do_op(std::move(wq), sz, rw_submit<writev_query>);
+}
+
+int Target::process(std::shared_ptr<discard_query> dq) noexcept {
+  Expects(dq);
+
+  if (0 == dq->size()) [[unlikely]]
+    return 0;
+
+  auto const sz{dq->size()};
+  return do_op(std::move(dq), sz,
+               [](member const &m, std::shared_ptr<discard_query> const &dq,
+                  uint64_t, uint64_t sz, uint64_t m_offset) {
+                 return m.discarder->submit(dq->subquery(m_offset, sz, dq));
+               });
+}
+
+} // namespace ublk::linear
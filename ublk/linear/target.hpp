@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+
+#include <memory>
+#include <vector>
+
+#include "discard_handler_interface.hpp"
+#include "rw_handler_interface.hpp"
+
+#include "discard_query.hpp"
+#include "read_query.hpp"
+#include "readv_query.hpp"
+#include "write_query.hpp"
+#include "writev_query.hpp"
+
+namespace ublk::linear {
+
+struct member {
+  uint64_t sz;
+  std::shared_ptr<IRWHandler> h;
+  std::shared_ptr<IDiscardHandler> discarder;
+};
+
+/*
+ * Lays the members out one after another, each of them taking a range as long
+ * as its size. The members a query falls into are found by binary search.
+ * Appending a member grows the target by its size, leaving the data of the
+ * others where it is
+ */
+class Target final {
+public:
+  explicit Target(std::vector<member> members);
+  ~Target() = default;
+
+  Target(Target const &) = delete;
+  Target &operator=(Target const &) = delete;
+
+  Target(Target &&) = default;
+  Target &operator=(Target &&) = default;
+
+  void append(member m);
+
+  uint64_t size() const noexcept { return offsets_.back(); }
+
+  int process(std::shared_ptr<read_query> rq) noexcept;
+  int process(std::shared_ptr<write_query> wq) noexcept;
+  int process(std::shared_ptr<readv_query> rq) noexcept;
+  int process(std::shared_ptr<writev_query> wq) noexcept;
+  int process(std::shared_ptr<discard_query> dq) noexcept;
+
+private:
+  template <typename T>
+  int do_op(std::shared_ptr<T> query, uint64_t query_sz, auto &&submit)
+      const noexcept;
+
+  /* where the i-th member begins, the last one is where the target ends */
+  std::vector<uint64_t> offsets_;
+  std::vector<member> members_;
+};
+
+} // namespace ublk::linear
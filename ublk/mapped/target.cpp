@@ -0,0 +1,172 @@
+#include "target.hpp"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <iterator>
+#include <span>
+#include <system_error>
+#include <utility>
+
+#include <gsl/assert>
+
+#include "mm/mem.hpp"
+#include "mm/mem_types.hpp"
+
+#include "sys/page.hpp"
+
+#include "utils/algo.hpp"
+#include "utils/utility.hpp"
+
+#include "trace/trace.hpp"
+
+namespace ublk::mapped {
+
+Target::Target(mm::uptrwd<int const> fd, mm::uptrwd<std::byte[]> mem,
+               uint64_t sz, bool punch_holes) noexcept
+    : fd_(std::move(fd)), mem_(std::move(mem)), mem_sz_(sz),
+      punch_holes_(punch_holes) {
+  Ensures(fd_);
+  Ensures(mem_);
+}
+
+int Target::process(std::shared_ptr<read_query> rq) noexcept {
+  Expects(rq);
+  Expects(!rq->buf().empty());
+
+  if (mem_sz_ < rq->offset() + rq->buf().size()) [[unlikely]]
+    return EINVAL;
+
+  auto const from{
+      std::span<std::byte const>{mem_.get() + rq->offset(), rq->buf().size()},
+  };
+  auto const to{rq->buf()};
+
+  algo::copy(from, to);
+  trace::record("mapped", rq->trace_id());
+
+  return 0;
+}
+
+int Target::process(std::shared_ptr<write_query> wq) noexcept {
+  Expects(wq);
+  Expects(!wq->buf().empty());
+
+  if (mem_sz_ < wq->offset() + wq->buf().size()) [[unlikely]]
+    return EINVAL;
+
+  auto const from{wq->buf()};
+  auto const to{std::span{mem_.get() + wq->offset(), wq->buf().size()}};
+
+  algo::copy(from, to);
+  trace::record("mapped", wq->trace_id());
+
+  if (wq->fua()) {
+    return sync(align_down(wq->offset(), sys::page_size()),
+                wq->offset() + wq->buf().size());
+  }
+
+  dirty_mark(wq->offset(), wq->buf().size());
+
+  return 0;
+}
+
+int Target::process(std::shared_ptr<flush_query> fq) noexcept {
+  Expects(fq);
+
+  /* ranges synced are forgotten, the failed one and the rest wait for more */
+  for (auto it{dirty_.begin()}; it != dirty_.end(); it = dirty_.erase(it)) {
+    if (auto const res{sync(it->first, it->second)}) [[unlikely]]
+      return res;
+  }
+  trace::record("mapped", fq->trace_id());
+
+  return 0;
+}
+
+int Target::process(std::shared_ptr<discard_query> dq) noexcept {
+  Expects(dq);
+
+  if (mem_sz_ < dq->offset() + dq->size()) [[unlikely]]
+    return EINVAL;
+
+  /*
+   * Pages of the range dropped out of the page cache read back as zeroes via
+   * the mapping. File systems zero the edges not covering a block themselves
+   */
+  if (!punch_holes_ ||
+      0 != ::fallocate(*fd_, FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                       static_cast<off_t>(dq->offset()),
+                       static_cast<off_t>(dq->size()))) {
+    std::memset(mem_.get() + dq->offset(), 0, dq->size());
+    dirty_mark(dq->offset(), dq->size());
+  }
+  trace::record("mapped", dq->trace_id());
+
+  return 0;
+}
+
+void Target::dirty_mark(uint64_t offset, uint64_t sz) noexcept {
+  auto const page_sz{sys::page_size()};
+  auto from{align_down(offset, page_sz)};
+  auto to{std::min(align_up(offset + sz, page_sz), mem_sz_)};
+
+  /* the range gets merged with the ones it overlaps or adjoins */
+  auto it{dirty_.upper_bound(from)};
+  if (it != dirty_.begin() && !(std::prev(it)->second < from))
+    --it;
+  while (it != dirty_.end() && !(to < it->first)) {
+    from = std::min(from, it->first);
+    to = std::max(to, it->second);
+    it = dirty_.erase(it);
+  }
+  dirty_.emplace_hint(it, from, to);
+}
+
+int Target::sync(uint64_t from, uint64_t to) noexcept {
+  Expects(is_aligned_to(from, sys::page_size()));
+  Expects(from < to);
+
+  if (0 != ::msync(mem_.get() + from, to - from, MS_SYNC)) [[unlikely]]
+    return errno;
+
+  return 0;
+}
+
+mm::uptrwd<std::byte[]> map(int fd, uint64_t sz, bool populate,
+                            bool hugepages) {
+  struct stat st;
+  if (0 != ::fstat(fd, &st))
+    throw std::system_error(errno, std::generic_category());
+
+  /*
+   * A page beyond the end of the file raises SIGBUS once touched, so does a
+   * store to a hole with the file system out of space. Blocks of the whole
+   * range get allocated up front for neither to happen
+   */
+  if (S_ISREG(st.st_mode)) {
+    if (auto const err{::posix_fallocate(fd, 0, static_cast<off_t>(sz))})
+      throw std::system_error(err, std::generic_category());
+  }
+
+  auto mem{
+      mm::mmap_shared<std::byte[]>(sz, PROT_READ | PROT_WRITE, fd,
+                                   populate ? MAP_POPULATE : 0),
+  };
+  if (!mem)
+    throw std::system_error(errno, std::generic_category());
+
+  if (hugepages)
+    ::madvise(mem.get(), sz, MADV_HUGEPAGE);
+
+  return mem;
+}
+
+} // namespace ublk::mapped
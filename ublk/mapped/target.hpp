@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <map>
+#include <memory>
+
+#include "mm/mem_types.hpp"
+
+#include "discard_query.hpp"
+#include "flush_query.hpp"
+#include "read_query.hpp"
+#include "write_query.hpp"
+
+namespace ublk::mapped {
+
+/*
+ * Serves queries by copying in and out of a file mapped into memory, no system
+ * call is made but for flushes, FUA writes and discards. Pages written to are
+ * remembered until the next flush syncs them.
+ *
+ * punch_holes makes discards punch holes in the file, a store to a hole raises
+ * SIGBUS rather than failing once the file system runs out of space
+ */
+class Target final {
+public:
+  explicit Target(mm::uptrwd<int const> fd, mm::uptrwd<std::byte[]> mem,
+                  uint64_t sz, bool punch_holes) noexcept;
+
+  int process(std::shared_ptr<read_query> rq) noexcept;
+  int process(std::shared_ptr<write_query> wq) noexcept;
+  int process(std::shared_ptr<flush_query> fq) noexcept;
+  /*
+   * The range is zeroed via the mapping unless holes are to be punched and
+   * can be
+   */
+  int process(std::shared_ptr<discard_query> dq) noexcept;
+
+private:
+  void dirty_mark(uint64_t offset, uint64_t sz) noexcept;
+  int sync(uint64_t from, uint64_t to) noexcept;
+
+  mm::uptrwd<int const> fd_;
+  mm::uptrwd<std::byte[]> mem_;
+  uint64_t mem_sz_;
+  bool punch_holes_;
+  /* page aligned ranges dirtied since the last flush, from -> to */
+  std::map<uint64_t, uint64_t> dirty_;
+};
+
+/*
+ * Maps sz bytes of the file shared, a regular file gets all of them allocated
+ * first. populate prefaults the whole mapping, hugepages asks for it
+ * to be backed by transparent huge pages wherever the file system allows
+ */
+mm::uptrwd<std::byte[]> map(int fd, uint64_t sz, bool populate,
+                            bool hugepages);
+
+} // namespace ublk::mapped
@@ -1,25 +1,33 @@
 #include "master.hpp"
 
+#include <cerrno>
 #include <cstddef>
 #include <cstring>
 
 #include <fcntl.h>
 #include <netlink/attr.h>
 #include <ranges>
+#include <sys/stat.h>
 #include <sys/wait.h>
 #include <unistd.h>
 
 #include <linux/ublkdrv/genl.h>
 
 #include <algorithm>
+#include <bit>
+#include <chrono>
 #include <filesystem>
 #include <format>
+#include <functional>
 #include <future>
 #include <iterator>
 #include <limits>
 #include <memory>
+#include <new>
+#include <numeric>
 #include <optional>
 #include <stdexcept>
+#include <system_error>
 #include <utility>
 #include <vector>
 
@@ -33,10 +41,14 @@
 #include "sys/file.hpp"
 #include "sys/genl.hpp"
 
+#include "utils/size_units.hpp"
 #include "utils/utility.hpp"
 
+#include "cache/discard_handler.hpp"
 #include "cache/rw_handler.hpp"
 
+#include "backend_probe.hpp"
+#include "backend_properties.hpp"
 #include "cmd_handler_factory.hpp"
 #include "rw_handler_interface.hpp"
 #include "slave.hpp"
@@ -49,6 +61,7 @@
 #include "cmd_read_handler_adaptor.hpp"
 #include "cmd_write_handler.hpp"
 #include "cmd_write_handler_adaptor.hpp"
+#include "discard_handler_composite.hpp"
 #include "discard_handler_interface.hpp"
 #include "flq_submitter_composite.hpp"
 #include "flq_submitter_interface.hpp"
@@ -58,6 +71,7 @@
 #include "sector.hpp"
 #include "target.hpp"
 #include "target_create_param.hpp"
+#include "target_stats.hpp"
 #include "ublk_req_handler_interface.hpp"
 #include "wrq_submitter.hpp"
 #include "wrq_submitter_interface.hpp"
@@ -67,15 +81,46 @@
 #include "null/rdq_submitter.hpp"
 #include "null/wrq_submitter.hpp"
 
+#include "inmem/discard_handler.hpp"
 #include "inmem/rdq_submitter.hpp"
 #include "inmem/target.hpp"
 #include "inmem/wrq_submitter.hpp"
 
+#include "linear/discard_handler.hpp"
+#include "linear/rdq_submitter.hpp"
+#include "linear/target.hpp"
+#include "linear/wrq_submitter.hpp"
+
+#include "mapped/discard_handler.hpp"
+#include "mapped/flq_submitter.hpp"
+#include "mapped/rdq_submitter.hpp"
+#include "mapped/target.hpp"
+#include "mapped/wrq_submitter.hpp"
+
+#include "zram/discard_handler.hpp"
+#include "zram/rdq_submitter.hpp"
+#include "zram/target.hpp"
+#include "zram/wrq_submitter.hpp"
+
+#include "def/discard_handler.hpp"
 #include "def/flq_submitter.hpp"
+#include "def/psync.hpp"
 #include "def/rdq_submitter.hpp"
 #include "def/target.hpp"
+#include "def/uring.hpp"
 #include "def/wrq_submitter.hpp"
 
+#include "dio/alignment.hpp"
+#include "dio/rw_handler.hpp"
+
+#include "plug/rw_handler.hpp"
+
+#include "qos/control.hpp"
+#include "qos/fair_group.hpp"
+#include "qos/fair_rw_handler.hpp"
+#include "qos/rw_handler.hpp"
+
+#include "raid0/discard_handler.hpp"
 #include "raid0/rdq_submitter.hpp"
 #include "raid0/target.hpp"
 #include "raid0/wrq_submitter.hpp"
@@ -84,22 +129,42 @@
 #include "raid1/target.hpp"
 #include "raid1/wrq_submitter.hpp"
 
+#include "raid4/discard_handler.hpp"
 #include "raid4/rdq_submitter.hpp"
 #include "raid4/target.hpp"
 #include "raid4/wrq_submitter.hpp"
 
+#include "raid5/discard_handler.hpp"
 #include "raid5/rdq_submitter.hpp"
 #include "raid5/target.hpp"
 #include "raid5/wrq_submitter.hpp"
 
+#include "shard/discard_handler.hpp"
+#include "shard/flq_submitter.hpp"
+#include "shard/rw_handler.hpp"
+
 using namespace ublk;
 
 namespace {
 
+struct cache_param {
+  cache_cfg cfg;
+  std::shared_ptr<target_stats> stats;
+};
+
+/* What every backend of a target is set up with */
+struct backend_param {
+  std::optional<plug_cfg> plug;
+  /* the flow of the target in the group of the backend the fd refers to */
+  std::function<std::optional<qos::fair_flow>(int fd)> fair_flow_of;
+  std::shared_ptr<target_stats> stats;
+};
+
 struct handlers_ops {
   std::shared_ptr<IRDQSubmitter> reader;
   std::shared_ptr<IWRQSubmitter> writer;
   std::shared_ptr<IFLQSubmitter> flusher;
+  std::shared_ptr<IDiscardHandler> discarder;
 };
 
 auto backend_device_open(std::filesystem::path const &path) {
@@ -107,9 +172,41 @@ auto backend_device_open(std::filesystem::path const &path) {
                    S_IWUSR | S_IRUSR | S_IRGRP | S_IROTH);
 }
 
+/* Pages are cached by the kernel, the mapping is served out of them */
+auto mapped_file_open(std::filesystem::path const &path) {
+  return sys::open(path, O_RDWR | O_CREAT,
+                   S_IWUSR | S_IRUSR | S_IRGRP | S_IROTH);
+}
+
+/* Discards going through the cache invalidate the chunks it holds */
+std::shared_ptr<IRWHandler>
+cache_attach(std::optional<cache_param> const &cache_cfg,
+             std::unique_ptr<IRWHandler> rw_handler,
+             std::shared_ptr<IDiscardHandler> &discarder) {
+  if (!cache_cfg || !cache_cfg->cfg.len_sectors)
+    return rw_handler;
+
+  auto cache_rw_handler{
+      std::make_shared<cache::RWHandler>(
+          cache_cfg->cfg.len_sectors, std::move(rw_handler),
+          cache_cfg->cfg.write_through_enable, cache_cfg->stats),
+  };
+  discarder = std::make_shared<cache::DiscardHandler>(cache_rw_handler,
+                                                      std::move(discarder));
+
+  return cache_rw_handler;
+}
+
 handlers_ops make_default_ops(boost::asio::io_context &io_ctx,
-                              std::optional<cache_cfg> const &cache_cfg,
+                              backend_param const &backend,
+                              std::optional<cache_param> const &cache_cfg,
                               mm::uptrwd<int const> fd) {
+  auto flow{std::optional<qos::fair_flow>{}};
+  if (backend.fair_flow_of)
+    flow = backend.fair_flow_of(*fd);
+
+  auto const dio_al{dio::alignment_probe(*fd)};
+
   auto target{std::make_shared<def::Target>(io_ctx, std::move(fd))};
 
   auto rw_handler{std::unique_ptr<IRWHandler>{}};
@@ -118,24 +215,44 @@ handlers_ops make_default_ops(boost::asio::io_context &io_ctx,
       std::make_unique<RWHandler>(std::make_shared<def::RDQSubmitter>(target),
                                   std::make_shared<def::WRQSubmitter>(target));
 
-  if (cache_cfg && cache_cfg->len_sectors) {
-    rw_handler = std::make_unique<cache::RWHandler>(
-        cache_cfg->len_sectors, std::move(rw_handler),
-        cache_cfg->write_through_enable);
+  if (dio_al)
+    rw_handler =
+        std::make_unique<dio::RWHandler>(std::move(rw_handler), *dio_al);
+
+  if (backend.plug) {
+    rw_handler = std::make_unique<plug::RWHandler>(
+        io_ctx, std::move(rw_handler),
+        sectors_to_bytes(backend.plug->max_sectors),
+        std::chrono::microseconds{backend.plug->window_us});
+  }
+
+  if (flow) {
+    rw_handler = std::make_unique<qos::FairRWHandler>(
+        io_ctx, std::move(rw_handler), std::move(*flow), backend.stats);
   }
 
-  auto sp_rw_handler{std::shared_ptr{std::move(rw_handler)}};
+  auto discarder{
+      std::shared_ptr<IDiscardHandler>{
+          std::make_shared<def::DiscardHandler>(target),
+      },
+  };
+
+  auto sp_rw_handler{
+      cache_attach(cache_cfg, std::move(rw_handler), discarder),
+  };
 
   return {
       .reader = std::make_shared<RDQSubmitter>(sp_rw_handler),
       .writer = std::make_shared<WRQSubmitter>(sp_rw_handler),
       .flusher = std::make_shared<def::FLQSubmitter>(target),
+      .discarder = std::move(discarder),
   };
 }
 
 handlers_ops make_raid0_ops(uint64_t strip_sz,
-                            std::optional<cache_cfg> const &cache_cfg,
-                            std::vector<handlers_ops> handlers) {
+                            std::optional<cache_param> const &cache_cfg,
+                            std::vector<handlers_ops> handlers,
+                            bool sg_coalesce = false) {
   std::vector<std::shared_ptr<IRWHandler>> rw_handlers;
   std::ranges::transform(std::move(handlers), std::back_inserter(rw_handlers),
                          [](auto &&ops) {
@@ -147,8 +264,13 @@ handlers_ops make_raid0_ops(uint64_t strip_sz,
   std::ranges::transform(std::move(handlers), std::back_inserter(flushers),
                          [](auto &&ops) { return std::move(ops.flusher); });
 
+  std::vector<std::shared_ptr<IDiscardHandler>> discarders;
+  std::ranges::transform(std::move(handlers), std::back_inserter(discarders),
+                         [](auto &&ops) { return std::move(ops.discarder); });
+
   auto target{
-      std::make_shared<raid0::Target>(strip_sz, std::move(rw_handlers)),
+      std::make_shared<raid0::Target>(strip_sz, std::move(rw_handlers),
+                                      sg_coalesce),
   };
 
   auto rw_handler{std::unique_ptr<IRWHandler>{}};
@@ -157,44 +279,106 @@ handlers_ops make_raid0_ops(uint64_t strip_sz,
       std::make_shared<raid0::RDQSubmitter>(target),
       std::make_shared<raid0::WRQSubmitter>(target));
 
-  if (cache_cfg && cache_cfg->len_sectors) {
-    rw_handler = std::make_unique<cache::RWHandler>(
-        cache_cfg->len_sectors, std::move(rw_handler),
-        cache_cfg->write_through_enable);
-  }
+  auto discarder{
+      std::shared_ptr<IDiscardHandler>{
+          std::make_shared<raid0::DiscardHandler>(strip_sz,
+                                                  std::move(discarders)),
+      },
+  };
 
-  auto sp_rw_handler{std::shared_ptr{std::move(rw_handler)}};
+  auto sp_rw_handler{
+      cache_attach(cache_cfg, std::move(rw_handler), discarder),
+  };
 
   return {
       .reader = std::make_shared<RDQSubmitter>(sp_rw_handler),
       .writer = std::make_shared<WRQSubmitter>(sp_rw_handler),
       .flusher = std::make_shared<FLQSubmitterComposite>(std::move(flushers)),
+      .discarder = std::move(discarder),
   };
 }
 
-handlers_ops make_raid0_ops(boost::asio::io_context &io_ctx, uint64_t strip_sz,
-                            std::optional<cache_cfg> const &cache_cfg,
-                            std::vector<mm::uptrwd<const int>> fds) {
+handlers_ops make_raid0_ops(boost::asio::io_context &io_ctx,
+                            backend_param const &backend,
+                            uint64_t strip_sz,
+                            std::optional<cache_param> const &cache_cfg,
+                            std::vector<mm::uptrwd<const int>> fds,
+                            bool sg_coalesce) {
   std::vector<handlers_ops> default_hopss;
   std::ranges::transform(
       std::move(fds), std::back_inserter(default_hopss),
-      [&](auto &&fd) { return make_default_ops(io_ctx, {}, std::move(fd)); });
+      [&](auto &&fd) {
+        return make_default_ops(io_ctx, backend, {}, std::move(fd));
+      });
 
-  return make_raid0_ops(strip_sz, cache_cfg, std::move(default_hopss));
+  return make_raid0_ops(strip_sz, cache_cfg, std::move(default_hopss),
+                        sg_coalesce);
 }
 
 handlers_ops make_raid0_ops(boost::asio::io_context &io_ctx,
-                            std::optional<cache_cfg> const &cache_cfg,
+                            backend_param const &backend,
+                            std::optional<cache_param> const &cache_cfg,
                             target_raid0_cfg const &raid0) {
   std::vector<mm::uptrwd<int const>> fd_targets;
   std::ranges::transform(raid0.paths, std::back_inserter(fd_targets),
                          backend_device_open);
-  return make_raid0_ops(io_ctx, sectors_to_bytes(raid0.strip_len_sectors),
-                        cache_cfg, std::move(fd_targets));
+  return make_raid0_ops(io_ctx, backend,
+                        sectors_to_bytes(raid0.strip_len_sectors), cache_cfg,
+                        std::move(fd_targets), raid0.sg_coalesce);
+}
+
+handlers_ops make_linear_ops(boost::asio::io_context &io_ctx,
+                             backend_param const &backend,
+                             std::optional<cache_param> const &cache_cfg,
+                             target_linear_cfg const &linear) {
+  Expects(linear.paths.size() == linear.lens_sectors.size());
+
+  auto members{std::vector<linear::member>{}};
+  auto flushers{std::vector<std::shared_ptr<IFLQSubmitter>>{}};
+  for (auto i{0uz}; i < linear.paths.size(); ++i) {
+    auto ops{
+        make_default_ops(io_ctx, backend, {},
+                         backend_device_open(linear.paths[i])),
+    };
+    members.push_back({
+        .sz = sectors_to_bytes(linear.lens_sectors[i]),
+        .h = std::make_shared<RWHandler>(std::move(ops.reader),
+                                         std::move(ops.writer)),
+        .discarder = std::move(ops.discarder),
+    });
+    flushers.push_back(std::move(ops.flusher));
+  }
+
+  auto target{std::make_shared<linear::Target>(std::move(members))};
+
+  auto rw_handler{
+      std::unique_ptr<IRWHandler>{
+          std::make_unique<RWHandler>(
+              std::make_shared<linear::RDQSubmitter>(target),
+              std::make_shared<linear::WRQSubmitter>(target)),
+      },
+  };
+
+  auto discarder{
+      std::shared_ptr<IDiscardHandler>{
+          std::make_shared<linear::DiscardHandler>(target),
+      },
+  };
+
+  auto sp_rw_handler{
+      cache_attach(cache_cfg, std::move(rw_handler), discarder),
+  };
+
+  return {
+      .reader = std::make_shared<RDQSubmitter>(sp_rw_handler),
+      .writer = std::make_shared<WRQSubmitter>(sp_rw_handler),
+      .flusher = std::make_shared<FLQSubmitterComposite>(std::move(flushers)),
+      .discarder = std::move(discarder),
+  };
 }
 
 handlers_ops make_raid1_ops(uint64_t read_strip_len_sectors,
-                            std::optional<cache_cfg> const &cache_cfg,
+                            std::optional<cache_param> const &cache_cfg,
                             std::vector<handlers_ops> handlers) {
   std::vector<std::shared_ptr<IRWHandler>> rw_handlers;
   std::ranges::transform(std::move(handlers), std::back_inserter(rw_handlers),
@@ -207,6 +391,10 @@ handlers_ops make_raid1_ops(uint64_t read_strip_len_sectors,
   std::ranges::transform(std::move(handlers), std::back_inserter(flushers),
                          [](auto &&ops) { return std::move(ops.flusher); });
 
+  std::vector<std::shared_ptr<IDiscardHandler>> discarders;
+  std::ranges::transform(std::move(handlers), std::back_inserter(discarders),
+                         [](auto &&ops) { return std::move(ops.discarder); });
+
   if (read_strip_len_sectors >
       bytes_to_sectors(std::numeric_limits<uint64_t>::max()))
     throw std::overflow_error(std::format(
@@ -227,51 +415,62 @@ handlers_ops make_raid1_ops(uint64_t read_strip_len_sectors,
       std::make_shared<raid1::RDQSubmitter>(target),
       std::make_shared<raid1::WRQSubmitter>(target));
 
-  if (cache_cfg && cache_cfg->len_sectors) {
-    rw_handler = std::make_unique<cache::RWHandler>(
-        cache_cfg->len_sectors, std::move(rw_handler),
-        cache_cfg->write_through_enable);
-  }
+  auto discarder{
+      std::shared_ptr<IDiscardHandler>{
+          std::make_shared<DiscardHandlerComposite>(std::move(discarders)),
+      },
+  };
 
-  auto sp_rw_handler{std::shared_ptr{std::move(rw_handler)}};
+  auto sp_rw_handler{
+      cache_attach(cache_cfg, std::move(rw_handler), discarder),
+  };
 
   return {
       .reader = std::make_shared<RDQSubmitter>(sp_rw_handler),
       .writer = std::make_shared<WRQSubmitter>(sp_rw_handler),
       .flusher = std::make_shared<FLQSubmitterComposite>(std::move(flushers)),
+      .discarder = std::move(discarder),
   };
 }
 
 handlers_ops make_raid1_ops(boost::asio::io_context &io_ctx,
+                            backend_param const &backend,
                             uint64_t read_strip_len_sectors,
-                            std::optional<cache_cfg> const &cache_cfg,
+                            std::optional<cache_param> const &cache_cfg,
                             std::vector<mm::uptrwd<const int>> fds) {
   std::vector<handlers_ops> default_hopss;
   std::ranges::transform(
       std::move(fds), std::back_inserter(default_hopss),
-      [&](auto &&fd) { return make_default_ops(io_ctx, {}, std::move(fd)); });
+      [&](auto &&fd) {
+        return make_default_ops(io_ctx, backend, {}, std::move(fd));
+      });
 
   return make_raid1_ops(read_strip_len_sectors, cache_cfg,
                         std::move(default_hopss));
 }
 
 handlers_ops make_raid1_ops(boost::asio::io_context &io_ctx,
-                            std::optional<cache_cfg> const &cache_cfg,
+                            backend_param const &backend,
+                            std::optional<cache_param> const &cache_cfg,
                             target_raid1_cfg const &raid1) {
   std::vector<mm::uptrwd<int const>> fd_targets;
   std::ranges::transform(raid1.paths, std::back_inserter(fd_targets),
                          backend_device_open);
-  return make_raid1_ops(io_ctx, raid1.read_strip_len_sectors, cache_cfg,
-                        std::move(fd_targets));
+  return make_raid1_ops(io_ctx, backend, raid1.read_strip_len_sectors,
+                        cache_cfg, std::move(fd_targets));
 }
 
-handlers_ops make_raid4_ops(boost::asio::io_context &io_ctx, uint64_t strip_sz,
-                            std::optional<cache_cfg> const &cache_cfg,
+handlers_ops make_raid4_ops(boost::asio::io_context &io_ctx,
+                            backend_param const &backend,
+                            uint64_t strip_sz,
+                            std::optional<cache_param> const &cache_cfg,
                             std::vector<mm::uptrwd<int const>> fds) {
   std::vector<handlers_ops> default_hopss;
   std::ranges::transform(
       std::move(fds), std::back_inserter(default_hopss),
-      [&](auto &&fd) { return make_default_ops(io_ctx, {}, std::move(fd)); });
+      [&](auto &&fd) {
+        return make_default_ops(io_ctx, backend, {}, std::move(fd));
+      });
 
   std::vector<std::shared_ptr<IRWHandler>> rw_handlers;
   std::ranges::transform(std::move(default_hopss),
@@ -284,8 +483,14 @@ handlers_ops make_raid4_ops(boost::asio::io_context &io_ctx, uint64_t strip_sz,
   std::ranges::transform(std::move(default_hopss), std::back_inserter(flushers),
                          [](auto &&ops) { return std::move(ops.flusher); });
 
+  std::vector<std::shared_ptr<IDiscardHandler>> discarders;
+  std::ranges::transform(std::move(default_hopss),
+                         std::back_inserter(discarders),
+                         [](auto &&ops) { return std::move(ops.discarder); });
+
   auto target{
-      std::make_shared<raid4::Target>(strip_sz, std::move(rw_handlers)),
+      std::make_shared<raid4::Target>(strip_sz, std::move(rw_handlers),
+                                      std::move(discarders)),
   };
 
   auto rw_handler{std::unique_ptr<IRWHandler>{}};
@@ -294,39 +499,48 @@ handlers_ops make_raid4_ops(boost::asio::io_context &io_ctx, uint64_t strip_sz,
       std::make_shared<raid4::RDQSubmitter>(target),
       std::make_shared<raid4::WRQSubmitter>(target));
 
-  if (cache_cfg && cache_cfg->len_sectors) {
-    rw_handler = std::make_unique<cache::RWHandler>(
-        cache_cfg->len_sectors, std::move(rw_handler),
-        cache_cfg->write_through_enable);
-  }
+  auto discarder{
+      std::shared_ptr<IDiscardHandler>{
+          std::make_shared<raid4::DiscardHandler>(target),
+      },
+  };
 
-  auto sp_rw_handler{std::shared_ptr{std::move(rw_handler)}};
+  auto sp_rw_handler{
+      cache_attach(cache_cfg, std::move(rw_handler), discarder),
+  };
 
   return {
       .reader = std::make_shared<RDQSubmitter>(sp_rw_handler),
       .writer = std::make_shared<WRQSubmitter>(sp_rw_handler),
       .flusher = std::make_shared<FLQSubmitterComposite>(std::move(flushers)),
+      .discarder = std::move(discarder),
   };
 }
 
 handlers_ops make_raid4_ops(boost::asio::io_context &io_ctx,
-                            std::optional<cache_cfg> const &cache_cfg,
+                            backend_param const &backend,
+                            std::optional<cache_param> const &cache_cfg,
                             target_raid4_cfg const &raid4) {
   std::vector<mm::uptrwd<int const>> fd_targets;
   std::ranges::transform(raid4.data_paths, std::back_inserter(fd_targets),
                          backend_device_open);
   fd_targets.push_back(backend_device_open(raid4.parity_path));
-  return make_raid4_ops(io_ctx, sectors_to_bytes(raid4.strip_len_sectors),
-                        cache_cfg, std::move(fd_targets));
+  return make_raid4_ops(io_ctx, backend,
+                        sectors_to_bytes(raid4.strip_len_sectors), cache_cfg,
+                        std::move(fd_targets));
 }
 
-handlers_ops make_raid5_ops(boost::asio::io_context &io_ctx, uint64_t strip_sz,
-                            std::optional<cache_cfg> const &cache_cfg,
+handlers_ops make_raid5_ops(boost::asio::io_context &io_ctx,
+                            backend_param const &backend,
+                            uint64_t strip_sz,
+                            std::optional<cache_param> const &cache_cfg,
                             std::vector<mm::uptrwd<int const>> fds) {
   std::vector<handlers_ops> default_hopss;
   std::ranges::transform(
       std::move(fds), std::back_inserter(default_hopss),
-      [&](auto &&fd) { return make_default_ops(io_ctx, {}, std::move(fd)); });
+      [&](auto &&fd) {
+        return make_default_ops(io_ctx, backend, {}, std::move(fd));
+      });
 
   std::vector<std::shared_ptr<IRWHandler>> rw_handlers;
   std::ranges::transform(std::move(default_hopss),
@@ -339,8 +553,14 @@ handlers_ops make_raid5_ops(boost::asio::io_context &io_ctx, uint64_t strip_sz,
   std::ranges::transform(std::move(default_hopss), std::back_inserter(flushers),
                          [](auto &&ops) { return std::move(ops.flusher); });
 
+  std::vector<std::shared_ptr<IDiscardHandler>> discarders;
+  std::ranges::transform(std::move(default_hopss),
+                         std::back_inserter(discarders),
+                         [](auto &&ops) { return std::move(ops.discarder); });
+
   auto target{
-      std::make_shared<raid5::Target>(strip_sz, std::move(rw_handlers)),
+      std::make_shared<raid5::Target>(strip_sz, std::move(rw_handlers),
+                                      std::move(discarders)),
   };
 
   auto rw_handler{std::unique_ptr<IRWHandler>{}};
@@ -349,29 +569,347 @@ handlers_ops make_raid5_ops(boost::asio::io_context &io_ctx, uint64_t strip_sz,
       std::make_shared<raid5::RDQSubmitter>(target),
       std::make_shared<raid5::WRQSubmitter>(target));
 
-  if (cache_cfg && cache_cfg->len_sectors) {
-    rw_handler = std::make_unique<cache::RWHandler>(
-        cache_cfg->len_sectors, std::move(rw_handler),
-        cache_cfg->write_through_enable);
-  }
+  auto discarder{
+      std::shared_ptr<IDiscardHandler>{
+          std::make_shared<raid5::DiscardHandler>(target),
+      },
+  };
 
-  auto sp_rw_handler{std::shared_ptr{std::move(rw_handler)}};
+  auto sp_rw_handler{
+      cache_attach(cache_cfg, std::move(rw_handler), discarder),
+  };
 
   return {
       .reader = std::make_shared<RDQSubmitter>(sp_rw_handler),
       .writer = std::make_shared<WRQSubmitter>(sp_rw_handler),
       .flusher = std::make_shared<FLQSubmitterComposite>(std::move(flushers)),
+      .discarder = std::move(discarder),
   };
 }
 
 handlers_ops make_raid5_ops(boost::asio::io_context &io_ctx,
-                            std::optional<cache_cfg> const &cache_cfg,
+                            backend_param const &backend,
+                            std::optional<cache_param> const &cache_cfg,
                             target_raid5_cfg const &raid5) {
   auto fd_targets{std::vector<mm::uptrwd<int const>>{}};
   std::ranges::transform(raid5.paths, std::back_inserter(fd_targets),
                          backend_device_open);
-  return make_raid5_ops(io_ctx, sectors_to_bytes(raid5.strip_len_sectors),
-                        cache_cfg, std::move(fd_targets));
+  return make_raid5_ops(io_ctx, backend,
+                        sectors_to_bytes(raid5.strip_len_sectors), cache_cfg,
+                        std::move(fd_targets));
+}
+
+/*
+ * The shard length is kept a multiple of the stripe data length so that no
+ * stripe lock or parity is shared by workers
+ */
+uint64_t shard_len_sectors_default(auto const &target) {
+  constexpr uint64_t kShardLenSectorsMin{bytes_to_sectors(1_MiB)};
+
+  auto raid4_stripe_len_sectors{[](target_raid4_cfg const &raid4) {
+    return raid4.strip_len_sectors * raid4.data_paths.size();
+  }};
+  auto raid5_stripe_len_sectors{[](target_raid5_cfg const &raid5) {
+    return raid5.strip_len_sectors * (raid5.paths.size() - 1);
+  }};
+
+  auto const stripe_len_sectors{std::visit(
+      overloaded{
+          [](target_raid0_cfg const &raid0) -> uint64_t {
+            return raid0.strip_len_sectors * raid0.paths.size();
+          },
+          [](target_raid10_cfg const &raid10) -> uint64_t {
+            return raid10.strip_len_sectors * raid10.raid1s.size();
+          },
+          [&](target_raid4_cfg const &raid4) -> uint64_t {
+            return raid4_stripe_len_sectors(raid4);
+          },
+          [&](target_raid5_cfg const &raid5) -> uint64_t {
+            return raid5_stripe_len_sectors(raid5);
+          },
+          [&](target_raid40_cfg const &raid40) -> uint64_t {
+            uint64_t member_stripe_len_sectors{1};
+            for (auto const &raid4 : raid40.raid4s)
+              member_stripe_len_sectors = std::lcm(
+                  member_stripe_len_sectors, raid4_stripe_len_sectors(raid4));
+            return raid40.strip_len_sectors * raid40.raid4s.size() *
+                   member_stripe_len_sectors;
+          },
+          [&](target_raid50_cfg const &raid50) -> uint64_t {
+            uint64_t member_stripe_len_sectors{1};
+            for (auto const &raid5 : raid50.raid5s)
+              member_stripe_len_sectors = std::lcm(
+                  member_stripe_len_sectors, raid5_stripe_len_sectors(raid5));
+            return raid50.strip_len_sectors * raid50.raid5s.size() *
+                   member_stripe_len_sectors;
+          },
+          [](auto const &) -> uint64_t { return 0; },
+      },
+      target)};
+
+  if (!stripe_len_sectors)
+    return kShardLenSectorsMin;
+
+  return stripe_len_sectors *
+         div_round_up(kShardLenSectorsMin, stripe_len_sectors);
+}
+
+/* What a layout of backends provides, files may grow beyond their sizes */
+struct backends_probed {
+  uint64_t sz;
+  bool growable;
+  std::vector<backend_properties> props;
+};
+
+backends_probed backends_probe(std::filesystem::path const &path) {
+  auto props{backend_probe(path)};
+  return {
+      .sz = props.sz,
+      .growable = !props.blkdev,
+      .props = {std::move(props)},
+  };
+}
+
+/* Members take strip-aligned space each, data_nr of them carry the data */
+backends_probed backends_level(std::vector<backends_probed> members,
+                               uint64_t strip_sz, size_t data_nr) {
+  auto r{backends_probed{.sz = 0, .growable = false, .props = {}}};
+  if (members.empty())
+    return r;
+
+  auto member_sz{std::numeric_limits<uint64_t>::max()};
+  for (auto &m : members) {
+    member_sz = std::min(member_sz, m.sz);
+    r.growable = r.growable || m.growable;
+    std::ranges::move(m.props, std::back_inserter(r.props));
+  }
+  if (strip_sz)
+    member_sz = aligndown(member_sz, strip_sz);
+  r.sz = member_sz * data_nr;
+
+  return r;
+}
+
+/*
+ * A multiple of the optimal I/O sizes and the physical blocks of all the
+ * backends below, kStripSzDefault at least. Strips must be powers of 2, so
+ * sizes that are not, like those of md and hardware RAIDs often are, get no
+ * say
+ */
+uint64_t strip_len_sectors_default(
+    std::vector<backend_properties> const &props) {
+  constexpr uint64_t kStripSzDefault{128_KiB};
+
+  auto unit{uint64_t{kSectorSz}};
+  for (auto const &p : props) {
+    for (auto const sz :
+         {uint64_t{p.physical_block_sz}, uint64_t{p.optimal_io_sz}}) {
+      if (is_power_of_2(sz))
+        unit = std::max(unit, sz);
+    }
+  }
+
+  return bytes_to_sectors(std::max(kStripSzDefault, unit));
+}
+
+template <typename Cfg> auto members_probe(Cfg const &cfg) {
+  auto members{std::vector<backends_probed>{}};
+  auto const add{[&members](std::filesystem::path const &path) {
+    members.push_back(backends_probe(path));
+  }};
+  if constexpr (std::same_as<Cfg, target_raid4_cfg>) {
+    std::ranges::for_each(cfg.data_paths, add);
+    add(cfg.parity_path);
+  } else {
+    std::ranges::for_each(cfg.paths, add);
+  }
+  return members;
+}
+
+backends_probed raid1_probe(target_raid1_cfg const &raid1) {
+  return backends_level(members_probe(raid1), 0, 1);
+}
+
+template <typename Cfg>
+backends_probed striped_probe(Cfg &cfg, std::vector<backends_probed> members,
+                              size_t data_nr) {
+  if (!cfg.strip_len_sectors) {
+    auto props{std::vector<backend_properties>{}};
+    for (auto const &m : members)
+      props.insert(props.end(), m.props.begin(), m.props.end());
+    cfg.strip_len_sectors = strip_len_sectors_default(props);
+  } else if (!is_power_of_2(cfg.strip_len_sectors)) {
+    throw std::invalid_argument(std::format(
+        "strip_len_sectors {} is not a power of 2", cfg.strip_len_sectors));
+  }
+  return backends_level(std::move(members),
+                        sectors_to_bytes(cfg.strip_len_sectors), data_nr);
+}
+
+/* Members left with no length contribute all they have */
+backends_probed linear_probe(target_linear_cfg &linear) {
+  auto r{backends_probed{.sz = 0, .growable = false, .props = {}}};
+
+  linear.lens_sectors.resize(linear.paths.size());
+  for (auto i{0uz}; i < linear.paths.size(); ++i) {
+    auto m{backends_probe(linear.paths[i])};
+    auto &len_sectors{linear.lens_sectors[i]};
+    if (!len_sectors) {
+      if (!m.sz)
+        throw std::invalid_argument(std::format(
+            "length of '{}' cannot be derived", linear.paths[i].string()));
+      len_sectors = bytes_to_sectors(m.sz);
+    } else if (!m.growable && sectors_to_bytes(len_sectors) > m.sz) {
+      throw std::invalid_argument(
+          std::format("length of '{}' {} exceeds {} it provides",
+                      linear.paths[i].string(), len_sectors,
+                      bytes_to_sectors(m.sz)));
+    }
+    r.sz += sectors_to_bytes(len_sectors);
+    std::ranges::move(m.props, std::back_inserter(r.props));
+  }
+
+  return r;
+}
+
+backends_probed raid4_probe(target_raid4_cfg &raid4) {
+  return striped_probe(raid4, members_probe(raid4), raid4.data_paths.size());
+}
+
+backends_probed raid5_probe(target_raid5_cfg &raid5) {
+  return striped_probe(raid5, members_probe(raid5), raid5.paths.size() - 1);
+}
+
+/*
+ * Probes the backends of the target. Strip lengths and the capacity left 0 get
+ * derived from them, the capacity given gets checked against them unless
+ * there are files. The engine left with depths of 0 gets those to match the
+ * queues of the backends
+ */
+std::vector<backend_properties> backends_tune(target_create_param &param) {
+  auto const probed{
+      std::visit(
+          overloaded{
+              [](target_default_cfg const &def) {
+                return backends_probe(def.path);
+              },
+              [](target_mapped_cfg const &mapped) {
+                return backends_probe(mapped.path);
+              },
+              [](target_raid0_cfg &raid0) {
+                return striped_probe(raid0, members_probe(raid0),
+                                     raid0.paths.size());
+              },
+              [](target_linear_cfg &linear) { return linear_probe(linear); },
+              [](target_raid1_cfg const &raid1) { return raid1_probe(raid1); },
+              [](target_raid4_cfg &raid4) { return raid4_probe(raid4); },
+              [](target_raid5_cfg &raid5) { return raid5_probe(raid5); },
+              [](target_raid10_cfg &raid10) {
+                auto members{std::vector<backends_probed>{}};
+                std::ranges::transform(raid10.raid1s,
+                                       std::back_inserter(members),
+                                       raid1_probe);
+                return striped_probe(raid10, std::move(members),
+                                     raid10.raid1s.size());
+              },
+              [](target_raid40_cfg &raid40) {
+                auto members{std::vector<backends_probed>{}};
+                std::ranges::transform(raid40.raid4s,
+                                       std::back_inserter(members),
+                                       raid4_probe);
+                return striped_probe(raid40, std::move(members),
+                                     raid40.raid4s.size());
+              },
+              [](target_raid50_cfg &raid50) {
+                auto members{std::vector<backends_probed>{}};
+                std::ranges::transform(raid50.raid5s,
+                                       std::back_inserter(members),
+                                       raid5_probe);
+                return striped_probe(raid50, std::move(members),
+                                     raid50.raid5s.size());
+              },
+              [](auto const &) {
+                return backends_probed{.sz = 0, .growable = true, .props = {}};
+              },
+          },
+          param.target),
+  };
+
+  if (!probed.props.empty()) {
+    if (!param.capacity_sectors) {
+      if (!probed.sz)
+        throw std::invalid_argument(
+            "capacity_sectors cannot be derived from the backends");
+      param.capacity_sectors = bytes_to_sectors(probed.sz);
+    } else if (!probed.growable &&
+               sectors_to_bytes(param.capacity_sectors) > probed.sz) {
+      throw std::invalid_argument(std::format(
+          "capacity_sectors {} exceeds {} the backends provide",
+          param.capacity_sectors, bytes_to_sectors(probed.sz)));
+    }
+  }
+
+  if (param.cache && param.cache->len_sectors > param.capacity_sectors)
+    throw std::invalid_argument(
+        std::format("cache_len_sectors {} exceeds capacity_sectors {}",
+                    param.cache->len_sectors, param.capacity_sectors));
+
+  auto const qd{
+      std::accumulate(probed.props.begin(), probed.props.end(), uint64_t{0},
+                      [](uint64_t acc, auto const &p) {
+                        return acc + p.queue_depth;
+                      }),
+  };
+  if (param.uring && !param.uring->sq_depth && qd) {
+    constexpr uint64_t kSQDepthMin{64};
+    constexpr uint64_t kSQDepthMax{4096};
+    param.uring->sq_depth = static_cast<uint32_t>(
+        std::bit_ceil(std::clamp(qd, kSQDepthMin, kSQDepthMax)));
+  }
+
+  /* a thread per spindle, a few per solid state backend */
+  if (param.psync && !param.psync->threads_nr && !probed.props.empty()) {
+    constexpr uint64_t kThreadsPerSSD{4};
+    constexpr uint64_t kThreadsMax{64};
+    auto const threads_nr{
+        std::accumulate(probed.props.begin(), probed.props.end(), uint64_t{0},
+                        [](uint64_t acc, auto const &p) {
+                          return acc + (p.rotational ? 1 : kThreadsPerSSD);
+                        }),
+    };
+    param.psync->threads_nr =
+        static_cast<uint32_t>(std::min(threads_nr, kThreadsMax));
+  }
+
+  return probed.props;
+}
+
+/*
+ * The privileged slaves create files in there, so nobody but the owner may
+ * be able to put anything into it. The default one gets created if missing
+ */
+std::filesystem::path trace_dir_prepare(std::filesystem::path dir) {
+  if (dir.empty()) {
+    dir = "/run/ublk";
+    if (mkdir(dir.c_str(), S_IRWXU) < 0 && EEXIST != errno)
+      throw std::system_error(errno, std::generic_category(),
+                              std::format("mkdir {}", dir.string()));
+  }
+
+  struct stat st {};
+  if (lstat(dir.c_str(), &st) < 0)
+    throw std::system_error(errno, std::generic_category(),
+                            std::format("lstat {}", dir.string()));
+
+  if (!S_ISDIR(st.st_mode))
+    throw std::invalid_argument(
+        std::format("trace_dir '{}' is not a directory", dir.string()));
+
+  if (st.st_uid != geteuid() || (st.st_mode & (S_IWGRP | S_IWOTH)))
+    throw std::invalid_argument(std::format(
+        "trace_dir '{}' may be written into by others", dir.string()));
+
+  return dir;
 }
 
 } // namespace
@@ -396,6 +934,10 @@ void Master::map(bdev_map_param const &param) {
     throw std::invalid_argument(
         std::format("'{}' target does not exist", param.target_name));
 
+  auto trace_dir{std::filesystem::path{}};
+  if (param.trace_sample_every)
+    trace_dir = trace_dir_prepare(param.trace_dir);
+
   auto nl_sock{sys::genl::sock_open()};
   auto msg{sys::genl::msg_alloc()};
 
@@ -420,10 +962,31 @@ void Master::map(bdev_map_param const &param) {
   if (auto const child_pid{fork()}; 0 == child_pid) {
     spdlog::set_pattern("[slave %P] [%^%l%$]: %v");
     spdlog::info("started: {}", param.target_name);
-    slave::run(target->io_ctx(), {
-                                     .bdev_suffix = param.bdev_suffix,
-                                     .hfactory = target->req_hfactory(),
-                                 });
+    slave::run(target->io_ctx(),
+               {
+                   .bdev_suffix = param.bdev_suffix,
+                   .hfactory = target->req_hfactory(),
+                   .ack =
+                       {
+                           .batch_max = param.ack_batch_max,
+                           .delay_max =
+                               std::chrono::microseconds{
+                                   param.ack_delay_max_us,
+                               },
+                           .stats = target->stats(),
+                       },
+                   .handler =
+                       {
+                           .poll_budget =
+                               std::chrono::microseconds{
+                                   param.poll_budget_us,
+                               },
+                           .stats = target->stats(),
+                       },
+                   .workers_io_ctxs = target->workers_io_ctxs(),
+                   .trace_sample_every = param.trace_sample_every,
+                   .trace_dir = trace_dir,
+               });
   } else if (child_pid > 0) {
     /* We're in a parent's body, remember a new child's PID */
     children_.emplace(
@@ -452,155 +1015,323 @@ void Master::unmap(bdev_unmap_param const &param) {
   sys::genl::auto_send(*nl_sock, *msg);
 }
 
-void Master::create(target_create_param const &param) {
-  if (targets_.contains(param.name))
+void Master::create(target_create_param const &create_param) {
+  if (targets_.contains(create_param.name))
     throw std::invalid_argument(
-        std::format("{} target already exists", param.name));
+        std::format("{} target already exists", create_param.name));
+
+  auto param{create_param};
+  auto backends{backends_tune(param)};
+
+  if (param.uring && param.psync)
+    throw std::invalid_argument("only one engine may be chosen for a target");
 
   auto io_ctx{std::make_unique<boost::asio::io_context>()};
+  auto workers_io_ctxs{std::vector<std::unique_ptr<boost::asio::io_context>>{}};
 
-  auto reader{std::shared_ptr<IRDQSubmitter>{}};
-  auto writer{std::shared_ptr<IWRQSubmitter>{}};
-  auto flusher{std::shared_ptr<IFLQSubmitter>{}};
-  auto discarder{std::shared_ptr<IDiscardHandler>{}};
+  /* Mapped before any slave gets forked so that they all share it */
+  auto stats{
+      std::shared_ptr<target_stats>{
+          mm::mmap_shared<target_stats>(sizeof(target_stats)),
+      },
+  };
+  if (!stats)
+    throw std::bad_alloc{};
+
+  auto cache{std::optional<cache_param>{}};
+  if (param.cache)
+    cache = {.cfg = *param.cache, .stats = stats};
+
+  auto qos_ctl{std::shared_ptr<qos::control>{}};
+  if (param.qos) {
+    auto lims{
+        std::shared_ptr<qos::limits>{
+            mm::mmap_shared<qos::limits>(sizeof(qos::limits)),
+        },
+    };
+    if (!lims)
+      throw std::bad_alloc{};
+    qos_ctl = std::make_shared<qos::control>(std::move(lims), *param.qos);
+  }
 
-  std::visit(
-      overloaded{
-          [&](target_null_cfg const &) {},
-          [&](target_inmem_cfg const &) {
-            uint64_t const mem_sz{sectors_to_bytes(param.capacity_sectors)};
-            auto target{
-                std::make_shared<inmem::Target>(
-                    mm::get_unique_bytes_generator(kSectorSz, mem_sz)(),
-                    mem_sz),
-            };
-            reader = std::make_shared<inmem::RDQSubmitter>(target);
-            writer = std::make_shared<inmem::WRQSubmitter>(target);
-          },
-          [&](target_default_cfg const &def) {
-            auto ops{
-                make_default_ops(*io_ctx, param.cache,
-                                 backend_device_open(def.path)),
-            };
-            reader = std::move(ops.reader);
-            writer = std::move(ops.writer);
-            flusher = std::move(ops.flusher);
-          },
-          [&](target_raid0_cfg const &raid0) {
-            auto ops{make_raid0_ops(*io_ctx, param.cache, raid0)};
-            reader = std::move(ops.reader);
-            writer = std::move(ops.writer);
-            flusher = std::move(ops.flusher);
-          },
-          [&](target_raid1_cfg const &raid1) {
-            auto ops{make_raid1_ops(*io_ctx, param.cache, raid1)};
-            reader = std::move(ops.reader);
-            writer = std::move(ops.writer);
-            flusher = std::move(ops.flusher);
-          },
-          [&](target_raid4_cfg const &raid4) {
-            auto ops{make_raid4_ops(*io_ctx, param.cache, raid4)};
-            reader = std::move(ops.reader);
-            writer = std::move(ops.writer);
-            flusher = std::move(ops.flusher);
-          },
-          [&](target_raid5_cfg const &raid5) {
-            auto ops{make_raid5_ops(*io_ctx, param.cache, raid5)};
-            reader = std::move(ops.reader);
-            writer = std::move(ops.writer);
-            flusher = std::move(ops.flusher);
-          },
-          [&](target_raid10_cfg const &raid10) {
-            std::vector<handlers_ops> raid1s_ops;
-            std::ranges::transform(raid10.raid1s,
-                                   std::back_inserter(raid1s_ops),
-                                   [&](auto const &raid1) {
-                                     return make_raid1_ops(*io_ctx, {}, raid1);
-                                   });
-
-            auto ops{
-                make_raid0_ops(sectors_to_bytes(raid10.strip_len_sectors),
-                               param.cache, std::move(raid1s_ops)),
-            };
-
-            reader = std::move(ops.reader);
-            writer = std::move(ops.writer);
-            flusher = std::move(ops.flusher);
-          },
-          [&](target_raid40_cfg const &raid40) {
-            std::vector<handlers_ops> raid4s_ops;
-            std::ranges::transform(raid40.raid4s,
-                                   std::back_inserter(raid4s_ops),
-                                   [&](auto const &raid4) {
-                                     return make_raid4_ops(*io_ctx, {}, raid4);
-                                   });
-
-            auto ops{
-                make_raid0_ops(sectors_to_bytes(raid40.strip_len_sectors),
-                               param.cache, std::move(raid4s_ops)),
-            };
-
-            reader = std::move(ops.reader);
-            writer = std::move(ops.writer);
-            flusher = std::move(ops.flusher);
-          },
-          [&](target_raid50_cfg const &raid50) {
-            std::vector<handlers_ops> raid5s_ops;
-            std::ranges::transform(raid50.raid5s,
-                                   std::back_inserter(raid5s_ops),
-                                   [&](auto const &raid5) {
-                                     return make_raid5_ops(*io_ctx, {}, raid5);
-                                   });
-
-            auto ops{
-                make_raid0_ops(sectors_to_bytes(raid50.strip_len_sectors),
-                               param.cache, std::move(raid5s_ops)),
-            };
-
-            reader = std::move(ops.reader);
-            writer = std::move(ops.writer);
-            flusher = std::move(ops.flusher);
-          },
+  auto backend{
+      backend_param{
+          .plug = param.plug,
+          .fair_flow_of = {},
+          .stats = stats,
       },
-      param.target);
+  };
+  if (qos_ctl) {
+    backend.fair_flow_of = [this, &qos_ctl](int fd) {
+      return qos_ctl->flow_of(fair_group_of(fd));
+    };
+  }
 
-  if (!reader)
-    reader = std::make_shared<null::RDQSubmitter>();
+  auto inmem_target{std::shared_ptr<inmem::Target>{}};
+  auto zram_target{std::shared_ptr<zram::Target>{}};
 
-  if (!writer)
-    writer = std::make_shared<null::WRQSubmitter>();
+  auto make_ops{[&](boost::asio::io_context &io_ctx,
+                    std::optional<cache_param> const &cache) {
+    auto ops{handlers_ops{}};
 
-  if (!flusher)
-    flusher = std::make_shared<null::FLQSubmitter>();
+    if (param.uring) {
+      def::uring::attach(io_ctx, {
+                                     .sq_depth = param.uring->sq_depth,
+                                     .sqpoll = param.uring->sqpoll,
+                                     .sqpoll_idle_ms =
+                                         param.uring->sqpoll_idle_ms,
+                                     .iopoll = param.uring->iopoll,
+                                 });
+    } else if (param.psync) {
+      def::psync::attach(io_ctx, {
+                                     .threads_nr = param.psync->threads_nr,
+                                     .queue_depth = param.psync->queue_depth,
+                                 });
+    }
+
+    std::visit(
+        overloaded{
+            [&](target_null_cfg const &) {},
+            [&](target_inmem_cfg const &inmem) {
+              /* The memory is shared by all the workers */
+              if (!inmem_target) {
+                uint64_t const mem_sz{sectors_to_bytes(param.capacity_sectors)};
+                auto mem{
+                    inmem.sparse
+                        ? inmem::make_sparse_mem(mem_sz)
+                        : mm::get_unique_bytes_generator(kSectorSz, mem_sz)(),
+                };
+                if (!mem)
+                  throw std::bad_alloc{};
+                inmem_target =
+                    std::make_shared<inmem::Target>(std::move(mem), mem_sz);
+              }
+              ops.reader = std::make_shared<inmem::RDQSubmitter>(inmem_target);
+              ops.writer = std::make_shared<inmem::WRQSubmitter>(inmem_target);
+              ops.discarder =
+                  std::make_shared<inmem::DiscardHandler>(inmem_target);
+            },
+            [&](target_zram_cfg const &) {
+              /* The pages are shared by all the workers */
+              if (!zram_target) {
+                zram_target = std::make_shared<zram::Target>(
+                    sectors_to_bytes(param.capacity_sectors), stats);
+              }
+              ops.reader = std::make_shared<zram::RDQSubmitter>(zram_target);
+              ops.writer = std::make_shared<zram::WRQSubmitter>(zram_target);
+              ops.discarder =
+                  std::make_shared<zram::DiscardHandler>(zram_target);
+            },
+            [&](target_default_cfg const &def) {
+              ops = make_default_ops(io_ctx, backend, cache,
+                                     backend_device_open(def.path));
+            },
+            [&](target_mapped_cfg const &mapped) {
+              /*
+               * Every worker maps the file on its own and keeps track of the
+               * pages it has dirtied, flushes are fanned out to all of them
+               */
+              uint64_t const mem_sz{sectors_to_bytes(param.capacity_sectors)};
+              auto fd{mapped_file_open(mapped.path)};
+              auto mem{
+                  mapped::map(*fd, mem_sz, mapped.populate, mapped.hugepages),
+              };
+              auto target{
+                  std::make_shared<mapped::Target>(std::move(fd),
+                                                   std::move(mem), mem_sz,
+                                                   mapped.punch_holes),
+              };
+              ops = {
+                  .reader = std::make_shared<mapped::RDQSubmitter>(target),
+                  .writer = std::make_shared<mapped::WRQSubmitter>(target),
+                  .flusher = std::make_shared<mapped::FLQSubmitter>(target),
+                  .discarder = std::make_shared<mapped::DiscardHandler>(target),
+              };
+            },
+            [&](target_linear_cfg const &linear) {
+              ops = make_linear_ops(io_ctx, backend, cache, linear);
+            },
+            [&](target_raid0_cfg const &raid0) {
+              ops = make_raid0_ops(io_ctx, backend, cache, raid0);
+            },
+            [&](target_raid1_cfg const &raid1) {
+              ops = make_raid1_ops(io_ctx, backend, cache, raid1);
+            },
+            [&](target_raid4_cfg const &raid4) {
+              ops = make_raid4_ops(io_ctx, backend, cache, raid4);
+            },
+            [&](target_raid5_cfg const &raid5) {
+              ops = make_raid5_ops(io_ctx, backend, cache, raid5);
+            },
+            [&](target_raid10_cfg const &raid10) {
+              std::vector<handlers_ops> raid1s_ops;
+              std::ranges::transform(raid10.raid1s,
+                                     std::back_inserter(raid1s_ops),
+                                     [&](auto const &raid1) {
+                                       return make_raid1_ops(
+                                           io_ctx, backend, {}, raid1);
+                                     });
+
+              ops = make_raid0_ops(sectors_to_bytes(raid10.strip_len_sectors),
+                                   cache, std::move(raid1s_ops));
+            },
+            [&](target_raid40_cfg const &raid40) {
+              std::vector<handlers_ops> raid4s_ops;
+              std::ranges::transform(raid40.raid4s,
+                                     std::back_inserter(raid4s_ops),
+                                     [&](auto const &raid4) {
+                                       return make_raid4_ops(
+                                           io_ctx, backend, {}, raid4);
+                                     });
+
+              ops = make_raid0_ops(sectors_to_bytes(raid40.strip_len_sectors),
+                                   cache, std::move(raid4s_ops));
+            },
+            [&](target_raid50_cfg const &raid50) {
+              std::vector<handlers_ops> raid5s_ops;
+              std::ranges::transform(raid50.raid5s,
+                                     std::back_inserter(raid5s_ops),
+                                     [&](auto const &raid5) {
+                                       return make_raid5_ops(
+                                           io_ctx, backend, {}, raid5);
+                                     });
+
+              ops = make_raid0_ops(sectors_to_bytes(raid50.strip_len_sectors),
+                                   cache, std::move(raid5s_ops));
+            },
+        },
+        param.target);
+
+    if (!ops.reader)
+      ops.reader = std::make_shared<null::RDQSubmitter>();
+
+    if (!ops.writer)
+      ops.writer = std::make_shared<null::WRQSubmitter>();
+
+    if (!ops.flusher)
+      ops.flusher = std::make_shared<null::FLQSubmitter>();
+
+    if (!ops.discarder)
+      ops.discarder = std::make_shared<null::DiscardHandler>();
+
+    return ops;
+  }};
+
+  auto ops{handlers_ops{}};
+
+  if (param.workers && param.workers->nr > 1) {
+    auto shard_len_sectors{param.workers->shard_len_sectors};
+    if (!shard_len_sectors)
+      shard_len_sectors = shard_len_sectors_default(param.target);
+
+    /* Every worker gets its own part of the cache */
+    auto worker_cache{cache};
+    if (worker_cache)
+      worker_cache->cfg.len_sectors /= param.workers->nr;
+
+    std::vector<boost::asio::io_context::executor_type> exs;
+    std::vector<std::shared_ptr<IRWHandler>> rw_handlers;
+    std::vector<std::shared_ptr<IFLQSubmitter>> flushers;
+    std::vector<std::shared_ptr<IDiscardHandler>> discarders;
+
+    for (uint32_t i{0}; i < param.workers->nr; ++i) {
+      auto &worker_io_ctx{
+          *workers_io_ctxs.emplace_back(
+              std::make_unique<boost::asio::io_context>()),
+      };
+      auto worker_ops{make_ops(worker_io_ctx, worker_cache)};
+      exs.push_back(worker_io_ctx.get_executor());
+      rw_handlers.push_back(std::make_shared<RWHandler>(
+          std::move(worker_ops.reader), std::move(worker_ops.writer)));
+      flushers.push_back(std::move(worker_ops.flusher));
+      discarders.push_back(std::move(worker_ops.discarder));
+    }
+
+    auto sp_rw_handler{
+        std::make_shared<shard::RWHandler>(sectors_to_bytes(shard_len_sectors),
+                                           exs, std::move(rw_handlers)),
+    };
+
+    ops = {
+        .reader = std::make_shared<RDQSubmitter>(sp_rw_handler),
+        .writer = std::make_shared<WRQSubmitter>(sp_rw_handler),
+        .flusher = std::make_shared<shard::FLQSubmitter>(exs,
+                                                         std::move(flushers)),
+        .discarder = std::make_shared<shard::DiscardHandler>(
+            sectors_to_bytes(shard_len_sectors), std::move(exs),
+            std::move(discarders)),
+    };
+  } else {
+    ops = make_ops(*io_ctx, cache);
+  }
 
-  if (!discarder)
-    discarder = std::make_shared<null::DiscardHandler>();
+  /* the limits apply to the target as a whole, ahead of the workers */
+  if (qos_ctl) {
+    auto qos_rw_handler{
+        std::make_shared<qos::RWHandler>(
+            *io_ctx,
+            std::make_shared<RWHandler>(std::move(ops.reader),
+                                        std::move(ops.writer)),
+            qos_ctl->lims(), stats),
+    };
+    ops.reader = std::make_shared<RDQSubmitter>(qos_rw_handler);
+    ops.writer = std::make_shared<WRQSubmitter>(qos_rw_handler);
+  }
 
   auto hs = std::map<ublkdrv_cmd_op, std::shared_ptr<IUblkReqHandler>>{
       {
           UBLKDRV_CMD_OP_READ,
           std::make_unique<CmdReadHandlerAdaptor>(
-              std::make_unique<CmdReadHandler>(std::move(reader))),
+              std::make_unique<CmdReadHandler>(std::move(ops.reader))),
       },
       {
           UBLKDRV_CMD_OP_WRITE,
           std::make_unique<CmdWriteHandlerAdaptor>(
-              std::make_unique<CmdWriteHandler>(std::move(writer))),
+              std::make_unique<CmdWriteHandler>(std::move(ops.writer))),
       },
       {
           UBLKDRV_CMD_OP_FLUSH,
           std::make_unique<CmdFlushHandlerAdaptor>(
-              std::make_unique<CmdFlushHandler>(std::move(flusher))),
+              std::make_unique<CmdFlushHandler>(std::move(ops.flusher))),
       },
       {
           UBLKDRV_CMD_OP_DISCARD,
           std::make_unique<CmdDiscardHandlerAdaptor>(
-              std::make_unique<CmdDiscardHandler>(std::move(discarder))),
+              std::make_unique<CmdDiscardHandler>(std::move(ops.discarder))),
       },
   };
   targets_[param.name] = std::make_unique<Target>(
-      std::move(io_ctx), std::make_shared<CmdHandlerFactory>(std::move(hs)),
-      target_properties{param.capacity_sectors});
+      std::move(io_ctx),
+      std::make_shared<CmdHandlerFactory>(std::move(hs), stats),
+      target_properties{
+          .capacity_sectors = param.capacity_sectors,
+          .backends = std::move(backends),
+      },
+      std::move(workers_io_ctxs), stats, std::move(qos_ctl));
+}
+
+std::shared_ptr<qos::fair_group> Master::fair_group_of(int fd) {
+  struct stat st;
+  if (fstat(fd, &st) < 0)
+    throw std::system_error(errno, std::generic_category(), "fstat");
+
+  auto const key{
+      S_ISBLK(st.st_mode)
+          ? std::pair<uint64_t, uint64_t>{st.st_rdev, 0}
+          : std::pair<uint64_t, uint64_t>{st.st_dev, st.st_ino},
+  };
+
+  auto &group{fair_groups_[key]};
+  if (!group) {
+    /* Mapped before any slave using the backend gets forked */
+    group = std::shared_ptr<qos::fair_group>{
+        mm::mmap_shared<qos::fair_group>(sizeof(qos::fair_group)),
+    };
+    if (!group)
+      throw std::bad_alloc{};
+  }
+
+  return group;
 }
 
 void Master::destroy(target_destroy_param const &param) {
@@ -614,16 +1345,38 @@ void Master::destroy(target_destroy_param const &param) {
   }
 }
 
-std::list<std::pair<std::string, size_t>>
+target_stats Master::stats(target_stats_param const &param) const {
+  if (auto it = targets_.find(param.name); it != targets_.end())
+    return stats_snapshot(*it->second->stats());
+
+  throw std::invalid_argument(
+      std::format("'{}' target does not exist", param.name));
+}
+
+void Master::qos(target_qos_param const &param) {
+  auto it{targets_.find(param.name)};
+  if (it == targets_.end())
+    throw std::invalid_argument(
+        std::format("'{}' target does not exist", param.name));
+
+  if (!it->second->qos())
+    throw std::invalid_argument(
+        std::format("'{}' target has been created with no QoS", param.name));
+
+  it->second->qos()->set(param.qos);
+}
+
+std::list<std::pair<std::string, target_properties>>
 Master::list(targets_list_param const &) {
   /* clang-format off */
   auto const list_view{
         std::views::all(targets_)
-      | std::views::transform([](auto const &item) -> std::pair<std::string, size_t> { return {item.first, item.second->properties().capacity_sectors}; }),
+      | std::views::transform([](auto const &item) -> std::pair<std::string, target_properties> { return {item.first, item.second->properties()}; }),
   };
   /* clang-format on */
 #ifdef __clang__
-  return std::ranges::to<std::list<std::pair<std::string, size_t>>>(list_view);
+  return std::ranges::to<std::list<std::pair<std::string, target_properties>>>(
+      list_view);
 #else
   return {std::ranges::begin(list_view), std::ranges::end(list_view)};
 #endif
@@ -1,9 +1,12 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 
 #include <future>
 #include <list>
+#include <map>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -13,10 +16,18 @@
 #include "target.hpp"
 #include "target_create_param.hpp"
 #include "target_destroy_param.hpp"
+#include "target_properties.hpp"
+#include "target_qos_param.hpp"
+#include "target_stats.hpp"
+#include "target_stats_param.hpp"
 #include "targets_list_param.hpp"
 
 namespace ublk {
 
+namespace qos {
+struct fair_group;
+} // namespace qos
+
 class __attribute__((visibility("default"))) Master {
 public:
   static Master &instance() {
@@ -39,12 +50,19 @@ public:
   void unmap(bdev_unmap_param const &param);
   void create(target_create_param const &param);
   void destroy(target_destroy_param const &param);
-  std::list<std::pair<std::string, size_t>>
+  target_stats stats(target_stats_param const &param) const;
+  void qos(target_qos_param const &param);
+  std::list<std::pair<std::string, target_properties>>
   list(targets_list_param const &param);
 
 private:
+  std::shared_ptr<qos::fair_group> fair_group_of(int fd);
+
   std::unordered_map<pid_t, std::future<void>> children_;
   std::unordered_map<std::string, std::shared_ptr<Target>> targets_;
+  /* by device and inode of the backend, shared by the targets using it */
+  std::map<std::pair<uint64_t, uint64_t>, std::shared_ptr<qos::fair_group>>
+      fair_groups_;
 };
 
 } // namespace ublk
@@ -0,0 +1,242 @@
+#include "rw_handler.hpp"
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <chrono>
+#include <concepts>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/system/error_code.hpp>
+
+#include <gsl/assert>
+
+#include "read_query.hpp"
+#include "readv_query.hpp"
+#include "sg_bufs.hpp"
+#include "write_query.hpp"
+#include "writev_query.hpp"
+
+namespace ublk::plug {
+
+namespace {
+
+/* a merged query must still go down by a single preadv/pwritev */
+constexpr size_t kBufsNrMax{IOV_MAX};
+
+size_t bufs_nr(auto const &q) noexcept {
+  return std::ranges::size(sg_bufs_of(q));
+}
+
+void bufs_append(auto &bufs, auto &q) noexcept {
+  auto const qbufs{sg_bufs_of(q)};
+  bufs.insert(bufs.end(), qbufs.begin(), qbufs.end());
+}
+
+template <typename... Qs>
+uint64_t query_offset(std::variant<std::shared_ptr<Qs>...> const &v) noexcept {
+  return std::visit([](auto const &q) { return q->offset(); }, v);
+}
+
+template <typename... Qs>
+uint64_t query_sz(std::variant<std::shared_ptr<Qs>...> const &v) noexcept {
+  return std::visit([](auto const &q) { return q->size(); }, v);
+}
+
+template <typename... Qs>
+size_t bufs_nr(std::variant<std::shared_ptr<Qs>...> const &v) noexcept {
+  return std::visit([](auto const &q) { return bufs_nr(*q); }, v);
+}
+
+} // namespace
+
+class RWHandler::queue final : public std::enable_shared_from_this<queue> {
+public:
+  explicit queue(boost::asio::io_context &io_ctx,
+                 std::shared_ptr<IRWHandler> h, uint64_t max_sz,
+                 std::chrono::microseconds window) noexcept
+      : io_ctx_(io_ctx), timer_(io_ctx), h_(std::move(h)), max_sz_(max_sz),
+        window_(window), armed_(false) {
+    Ensures(h_);
+  }
+
+  template <typename T> void plug(std::shared_ptr<T> q) noexcept {
+    Expects(q);
+
+    auto const sz{q->size()};
+    if (!max_sz_ || !(sz > max_sz_)) {
+      plugged<T>().push_back(std::move(q));
+    } else {
+      for (auto off{uint64_t{0}}; off < sz; off += max_sz_) {
+        plugged<T>().push_back(q->subquery(off, std::min(max_sz_, sz - off),
+                                           q->offset() + off, q));
+      }
+    }
+
+    arm();
+  }
+
+private:
+  using reads = std::vector<
+      std::variant<std::shared_ptr<read_query>, std::shared_ptr<readv_query>>>;
+  using writes = std::vector<std::variant<std::shared_ptr<write_query>,
+                                          std::shared_ptr<writev_query>>>;
+
+  template <typename T> auto &plugged() noexcept {
+    if constexpr (std::same_as<T, read_query> || std::same_as<T, readv_query>)
+      return rqs_;
+    else
+      return wqs_;
+  }
+
+  void arm() noexcept {
+    if (armed_)
+      return;
+    armed_ = true;
+
+    /* posted behind the handlers of the batch the query has come in by */
+    if (window_ == std::chrono::microseconds::zero()) {
+      boost::asio::post(io_ctx_, [self = shared_from_this()] {
+        self->unplug();
+      });
+      return;
+    }
+
+    timer_.expires_after(window_);
+    timer_.async_wait(
+        [self = shared_from_this()](boost::system::error_code const &) {
+          self->unplug();
+        });
+  }
+
+  void unplug() noexcept {
+    armed_ = false;
+    /* completions might plug more queries meanwhile */
+    issue<readv_query>(std::exchange(rqs_, {}));
+    issue<writev_query>(std::exchange(wqs_, {}));
+  }
+
+  template <typename TV, typename V> void issue(std::vector<V> qs) noexcept {
+    std::ranges::stable_sort(
+        qs, {}, [](auto const &q) { return query_offset(q); });
+
+    for (auto first{qs.begin()}; first != qs.end();) {
+      auto sz{query_sz(*first)};
+      auto nr{bufs_nr(*first)};
+      auto last{std::next(first)};
+      for (; last != qs.end(); ++last) {
+        if (query_offset(*last) != query_offset(*first) + sz)
+          break;
+        if (max_sz_ && sz + query_sz(*last) > max_sz_)
+          break;
+        if (nr + bufs_nr(*last) > kBufsNrMax)
+          break;
+        sz += query_sz(*last);
+        nr += bufs_nr(*last);
+      }
+
+      if (std::next(first) == last) {
+        std::visit(
+            [this](auto const &q) {
+              if (auto const res{h_->submit(q)}) [[unlikely]]
+                q->set_err(res);
+            },
+            *first);
+      } else {
+        issue_merged<TV>(std::vector<V>(first, last), sz);
+      }
+
+      first = last;
+    }
+  }
+
+  template <typename TV, typename V>
+  void issue_merged(std::vector<V> qs, uint64_t sz) noexcept {
+    auto bufs{
+        sg_bufs<typename std::ranges::range_value_t<
+            decltype(std::declval<TV const &>().bufs())>::element_type>{},
+    };
+    for (auto const &q : qs)
+      std::visit([&bufs](auto const &q) { bufs_append(bufs, *q); }, q);
+    Ensures(sg_size(bufs) == sz);
+
+    auto const offset{query_offset(qs.front())};
+    auto const trace_id{
+        std::visit([](auto const &q) { return q->trace_id(); }, qs.front()),
+    };
+    auto fua{false};
+    if constexpr (std::same_as<TV, writev_query>) {
+      fua = std::ranges::any_of(qs, [](auto const &q) {
+        return std::visit([](auto const &q) { return q->fua(); }, q);
+      });
+    }
+
+    auto mq{
+        TV::create(std::move(bufs), offset,
+                   [qs = std::move(qs)](TV const &mq) {
+                     if (mq.err()) [[unlikely]] {
+                       for (auto const &q : qs) {
+                         std::visit(
+                             [&mq](auto const &q) { q->set_err(mq.err()); },
+                             q);
+                       }
+                     }
+                   }),
+    };
+    mq->set_trace_id(trace_id);
+    if constexpr (std::same_as<TV, writev_query>)
+      mq->set_fua(fua);
+
+    if (auto const res{h_->submit(mq)}) [[unlikely]]
+      mq->set_err(res);
+  }
+
+  boost::asio::io_context &io_ctx_;
+  boost::asio::steady_timer timer_;
+  std::shared_ptr<IRWHandler> h_;
+  uint64_t max_sz_;
+  std::chrono::microseconds window_;
+  reads rqs_;
+  writes wqs_;
+  bool armed_;
+};
+
+RWHandler::RWHandler(boost::asio::io_context &io_ctx,
+                     std::shared_ptr<IRWHandler> h, uint64_t max_sz,
+                     std::chrono::microseconds window)
+    : q_(std::make_shared<queue>(io_ctx, std::move(h), max_sz, window)) {
+  Ensures(q_);
+}
+
+RWHandler::~RWHandler() = default;
+
+int RWHandler::submit(std::shared_ptr<read_query> rq) noexcept {
+  q_->plug(std::move(rq));
+  return 0;
+}
+
+int RWHandler::submit(std::shared_ptr<write_query> wq) noexcept {
+  q_->plug(std::move(wq));
+  return 0;
+}
+
+int RWHandler::submit(std::shared_ptr<readv_query> rq) noexcept {
+  q_->plug(std::move(rq));
+  return 0;
+}
+
+int RWHandler::submit(std::shared_ptr<writev_query> wq) noexcept {
+  q_->plug(std::move(wq));
+  return 0;
+}
+
+} // namespace ublk::plug
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+
+#include <chrono>
+#include <memory>
+
+#include <boost/asio/io_context.hpp>
+
+#include "rw_handler_interface.hpp"
+
+namespace ublk::plug {
+
+/*
+ * Holds queries back until the io_context is done with the batch of handlers
+ * they came in by, or until the window is over if there is one. LBA-adjacent
+ * reads and writes plugged by then get merged into single scatter-gather
+ * queries of up to max_sz bytes, queries longer than that get split.
+ * Completions fan back out to the original queries. max_sz of 0 puts no limit
+ * but the one of the iovec count
+ */
+class RWHandler final : public IRWHandler {
+public:
+  explicit RWHandler(boost::asio::io_context &io_ctx,
+                     std::shared_ptr<IRWHandler> h, uint64_t max_sz,
+                     std::chrono::microseconds window = {});
+  ~RWHandler() override;
+
+  RWHandler(RWHandler const &) = delete;
+  RWHandler &operator=(RWHandler const &) = delete;
+
+  RWHandler(RWHandler &&) = delete;
+  RWHandler &operator=(RWHandler &&) = delete;
+
+  int submit(std::shared_ptr<read_query> rq) noexcept override;
+  int submit(std::shared_ptr<write_query> wq) noexcept override;
+  int submit(std::shared_ptr<readv_query> rq) noexcept override;
+  int submit(std::shared_ptr<writev_query> wq) noexcept override;
+
+private:
+  class queue;
+  /* outlives the handler until the queries plugged get unplugged */
+  std::shared_ptr<queue> q_;
+};
+
+} // namespace ublk::plug
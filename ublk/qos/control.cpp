@@ -0,0 +1,47 @@
+#include "control.hpp"
+
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include <gsl/assert>
+
+namespace ublk::qos {
+
+control::control(std::shared_ptr<limits> lims, qos_cfg const &cfg) noexcept
+    : lims_(std::move(lims)), weight_(0) {
+  Ensures(lims_);
+  set(cfg);
+}
+
+control::~control() noexcept {
+  for (auto &[_, flow] : flows_)
+    flow.leave();
+}
+
+std::optional<fair_flow>
+control::flow_of(std::shared_ptr<fair_group> const &group) {
+  Expects(group);
+
+  if (auto it{flows_.find(group.get())}; it != flows_.end())
+    return it->second;
+
+  auto flow{fair_flow::join(group, weight_)};
+  if (flow)
+    flows_.emplace(group.get(), *flow);
+
+  return flow;
+}
+
+void control::set(qos_cfg const &cfg) noexcept {
+  limit_store(lims_->read_iops, cfg.read_iops);
+  limit_store(lims_->write_iops, cfg.write_iops);
+  limit_store(lims_->read_bps, cfg.read_bps);
+  limit_store(lims_->write_bps, cfg.write_bps);
+
+  weight_ = cfg.weight;
+  for (auto &[_, flow] : flows_)
+    flow.weight_set(weight_);
+}
+
+} // namespace ublk::qos
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+
+#include <map>
+#include <memory>
+#include <optional>
+
+#include "target_create_param.hpp"
+
+#include "fair_group.hpp"
+#include "limits.hpp"
+
+namespace ublk::qos {
+
+/*
+ * The master's hold of QoS of a target: the limits shared with the slave and
+ * the flows the target has got in the groups of the backends it runs on. The
+ * flows are left once the target is gone
+ */
+class control {
+public:
+  explicit control(std::shared_ptr<limits> lims,
+                   qos_cfg const &cfg) noexcept;
+  ~control() noexcept;
+
+  control(control const &) = delete;
+  control &operator=(control const &) = delete;
+
+  control(control &&) = delete;
+  control &operator=(control &&) = delete;
+
+  std::shared_ptr<limits const> lims() const noexcept { return lims_; }
+
+  /* The flow of the target in the group, the first call joins it */
+  std::optional<fair_flow> flow_of(std::shared_ptr<fair_group> const &group);
+
+  void set(qos_cfg const &cfg) noexcept;
+
+private:
+  std::shared_ptr<limits> lims_;
+  uint32_t weight_;
+  std::map<fair_group const *, fair_flow> flows_;
+};
+
+} // namespace ublk::qos
@@ -0,0 +1,139 @@
+#include "fair_group.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <utility>
+
+#include <gsl/assert>
+
+#include "utils/size_units.hpp"
+
+namespace ublk::qos {
+
+namespace {
+
+/* how far in bytes at the default weight a flow may run ahead of the others */
+constexpr uint64_t kSlack{4_MiB};
+
+constexpr uint64_t kStaleNs{1'000'000'000};
+
+uint64_t load(uint64_t const &v) noexcept {
+  return __atomic_load_n(&v, __ATOMIC_RELAXED);
+}
+
+void store(uint64_t &v, uint64_t n) noexcept {
+  __atomic_store_n(&v, n, __ATOMIC_RELAXED);
+}
+
+uint64_t ns_of(fair_flow::clock::time_point tp) noexcept {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          tp.time_since_epoch())
+          .count());
+}
+
+} // namespace
+
+std::optional<fair_flow> fair_flow::join(std::shared_ptr<fair_group> group,
+                                         uint32_t weight) noexcept {
+  Expects(group);
+
+  for (size_t id{0}; id < group->flows.size(); ++id) {
+    auto &f{group->flows[id]};
+    auto expected{uint64_t{0}};
+    if (!__atomic_compare_exchange_n(
+            &f.weight, &expected, weight ? weight : kFairWeightDefault, false,
+            __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+      continue;
+    store(f.vtime, 0);
+    store(f.backlog, 0);
+    store(f.stamp_ns, 0);
+    return fair_flow{std::move(group), id};
+  }
+
+  return std::nullopt;
+}
+
+fair_flow::fair_flow(std::shared_ptr<fair_group> group, size_t id) noexcept
+    : group_(std::move(group)), id_(id) {
+  Ensures(group_);
+  Ensures(id_ < group_->flows.size());
+}
+
+void fair_flow::leave() noexcept {
+  store(self().backlog, 0);
+  store(self().weight, 0);
+}
+
+void fair_flow::weight_set(uint32_t weight) noexcept {
+  store(self().weight, weight ? weight : kFairWeightDefault);
+}
+
+bool fair_flow::backlogged(fair_group::flow const &f,
+                           clock::time_point now) const noexcept {
+  if (!load(f.weight) || !load(f.backlog))
+    return false;
+
+  /* the stamp might have been made by another slave a moment after now */
+  auto const stamp_ns{load(f.stamp_ns)};
+  auto const now_ns{ns_of(now)};
+  return !(now_ns > stamp_ns && now_ns - stamp_ns > kStaleNs);
+}
+
+void fair_flow::backlog_inc(clock::time_point now) noexcept {
+  auto &me{self()};
+  store(me.stamp_ns, ns_of(now));
+  if (__atomic_fetch_add(&me.backlog, 1, __ATOMIC_RELAXED))
+    return;
+
+  auto vtime_min{std::numeric_limits<uint64_t>::max()};
+  for (size_t id{0}; id < group_->flows.size(); ++id) {
+    auto const &f{group_->flows[id]};
+    if (id != id_ && backlogged(f, now))
+      vtime_min = std::min(vtime_min, load(f.vtime));
+  }
+
+  if (vtime_min != std::numeric_limits<uint64_t>::max() &&
+      load(me.vtime) < vtime_min) {
+    store(me.vtime, vtime_min);
+  }
+}
+
+void fair_flow::backlog_dec(clock::time_point now) noexcept {
+  auto &me{self()};
+  store(me.stamp_ns, ns_of(now));
+  /* the master might have reset the flow meanwhile */
+  auto backlog{load(me.backlog)};
+  while (backlog && !__atomic_compare_exchange_n(&me.backlog, &backlog,
+                                                 backlog - 1, false,
+                                                 __ATOMIC_RELAXED,
+                                                 __ATOMIC_RELAXED)) {
+  }
+}
+
+bool fair_flow::may_dispatch(clock::time_point now) const noexcept {
+  auto const vtime{load(self().vtime)};
+  for (size_t id{0}; id < group_->flows.size(); ++id) {
+    auto const &f{group_->flows[id]};
+    if (id != id_ && backlogged(f, now) && vtime > load(f.vtime) + kSlack)
+      return false;
+  }
+  return true;
+}
+
+void fair_flow::dispatched(uint64_t sz, clock::time_point now) noexcept {
+  auto &me{self()};
+  auto const weight{load(me.weight)};
+  __atomic_fetch_add(&me.vtime,
+                     sz * kFairWeightDefault / (weight ? weight : 1),
+                     __ATOMIC_RELAXED);
+  store(me.stamp_ns, ns_of(now));
+}
+
+} // namespace ublk::qos
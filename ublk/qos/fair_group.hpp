@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <array>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <type_traits>
+
+namespace ublk::qos {
+
+constexpr inline auto kFairFlowsNr{64uz};
+constexpr inline uint32_t kFairWeightDefault{100};
+
+/*
+ * Lives in shared memory, there is one per backend targets share and every
+ * target running on the backend gets a flow within. A flow's virtual time
+ * advances by the bytes it dispatches scaled by kFairWeightDefault / weight.
+ * A flow ahead of some other backlogged flow by more than the slack waits for
+ * it to catch up, a flow getting backlogged after having been idle starts off
+ * the slowest backlogged one so that idleness does not get saved up. Flows not
+ * making any progress for long are not waited for.
+ *
+ * Slaves of different targets work on the group concurrently, every field is
+ * accessed atomically
+ */
+struct fair_group {
+  struct flow {
+    /* 0 for a free slot */
+    uint64_t weight;
+    uint64_t vtime;
+    /* queries waiting for their turn or in flight */
+    uint64_t backlog;
+    /* steady clock time of the last progress */
+    uint64_t stamp_ns;
+  };
+  std::array<flow, kFairFlowsNr> flows;
+};
+
+static_assert(std::is_trivial_v<fair_group>);
+
+/* A flow of the group, the group stays mapped for as long as the flow lives */
+class fair_flow {
+public:
+  using clock = std::chrono::steady_clock;
+
+  /* nullopt if there is no slot left in the group */
+  static std::optional<fair_flow> join(std::shared_ptr<fair_group> group,
+                                       uint32_t weight) noexcept;
+
+  explicit fair_flow(std::shared_ptr<fair_group> group, size_t id) noexcept;
+
+  void leave() noexcept;
+  /* 0 stands for kFairWeightDefault */
+  void weight_set(uint32_t weight) noexcept;
+
+  void backlog_inc(clock::time_point now) noexcept;
+  void backlog_dec(clock::time_point now) noexcept;
+
+  bool may_dispatch(clock::time_point now) const noexcept;
+  void dispatched(uint64_t sz, clock::time_point now) noexcept;
+
+private:
+  fair_group::flow &self() const noexcept { return group_->flows[id_]; }
+  bool backlogged(fair_group::flow const &f,
+                  clock::time_point now) const noexcept;
+
+  std::shared_ptr<fair_group> group_;
+  size_t id_;
+};
+
+} // namespace ublk::qos
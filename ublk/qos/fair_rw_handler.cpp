@@ -0,0 +1,159 @@
+#include "fair_rw_handler.hpp"
+
+#include <cstdint>
+
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <utility>
+#include <variant>
+
+#include <boost/asio/steady_timer.hpp>
+#include <boost/system/error_code.hpp>
+
+#include <gsl/assert>
+
+#include "read_query.hpp"
+#include "readv_query.hpp"
+#include "write_query.hpp"
+#include "writev_query.hpp"
+
+namespace ublk::qos {
+
+namespace {
+
+using clock = fair_flow::clock;
+
+constexpr auto kFairPollPeriod{std::chrono::microseconds{100}};
+
+} // namespace
+
+class FairRWHandler::sharer final
+    : public std::enable_shared_from_this<sharer> {
+public:
+  explicit sharer(boost::asio::io_context &io_ctx,
+                  std::shared_ptr<IRWHandler> h, fair_flow flow,
+                  std::shared_ptr<target_stats> stats) noexcept
+      : h_(std::move(h)), flow_(std::move(flow)), stats_(std::move(stats)),
+        timer_(io_ctx), armed_(false) {
+    Ensures(h_);
+  }
+
+  template <typename T> void admit(std::shared_ptr<T> q) noexcept {
+    Expects(q);
+
+    auto const now{clock::now()};
+    flow_.backlog_inc(now);
+
+    if (held_.empty() && flow_.may_dispatch(now)) {
+      dispatch(std::move(q), now);
+      return;
+    }
+
+    held_.push_back({std::move(q), now});
+    if (stats_)
+      stats_add(stats_->qos_fair_waits, 1);
+    arm();
+  }
+
+private:
+  struct held_query {
+    std::variant<std::shared_ptr<read_query>, std::shared_ptr<write_query>,
+                 std::shared_ptr<readv_query>, std::shared_ptr<writev_query>>
+        q;
+    clock::time_point since;
+  };
+
+  template <typename T>
+  void dispatch(std::shared_ptr<T> q, clock::time_point now) noexcept {
+    auto const sz{q->size()};
+    flow_.dispatched(sz, now);
+
+    /* the backlog lasts until the query is over */
+    auto sq{
+        q->subquery(0, sz, q->offset(),
+                    [self = shared_from_this(), q](T const &sq) {
+                      if (sq.err()) [[unlikely]]
+                        q->set_err(sq.err());
+                      self->flow_.backlog_dec(clock::now());
+                    }),
+    };
+    if (auto const res{h_->submit(sq)}) [[unlikely]]
+      sq->set_err(res);
+  }
+
+  void arm() noexcept {
+    if (armed_)
+      return;
+    armed_ = true;
+
+    timer_.expires_after(kFairPollPeriod);
+    timer_.async_wait(
+        [self = shared_from_this()](boost::system::error_code const &) {
+          self->armed_ = false;
+          self->drain();
+        });
+  }
+
+  void drain() noexcept {
+    auto const now{clock::now()};
+
+    while (!held_.empty() && flow_.may_dispatch(now)) {
+      auto hq{std::move(held_.front())};
+      held_.pop_front();
+
+      if (stats_) {
+        stats_add(stats_->qos_fair_wait_us,
+                  static_cast<uint64_t>(
+                      std::chrono::duration_cast<std::chrono::microseconds>(
+                          now - hq.since)
+                          .count()));
+      }
+
+      std::visit([this, now](auto &&q) { dispatch(std::move(q), now); },
+                 std::move(hq.q));
+    }
+
+    if (!held_.empty())
+      arm();
+  }
+
+  std::shared_ptr<IRWHandler> h_;
+  fair_flow flow_;
+  std::shared_ptr<target_stats> stats_;
+  std::deque<held_query> held_;
+  boost::asio::steady_timer timer_;
+  bool armed_;
+};
+
+FairRWHandler::FairRWHandler(boost::asio::io_context &io_ctx,
+                             std::shared_ptr<IRWHandler> h, fair_flow flow,
+                             std::shared_ptr<target_stats> stats)
+    : s_(std::make_shared<sharer>(io_ctx, std::move(h), std::move(flow),
+                                  std::move(stats))) {
+  Ensures(s_);
+}
+
+FairRWHandler::~FairRWHandler() = default;
+
+int FairRWHandler::submit(std::shared_ptr<read_query> rq) noexcept {
+  s_->admit(std::move(rq));
+  return 0;
+}
+
+int FairRWHandler::submit(std::shared_ptr<write_query> wq) noexcept {
+  s_->admit(std::move(wq));
+  return 0;
+}
+
+int FairRWHandler::submit(std::shared_ptr<readv_query> rq) noexcept {
+  s_->admit(std::move(rq));
+  return 0;
+}
+
+int FairRWHandler::submit(std::shared_ptr<writev_query> wq) noexcept {
+  s_->admit(std::move(wq));
+  return 0;
+}
+
+} // namespace ublk::qos
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <memory>
+
+#include <boost/asio/io_context.hpp>
+
+#include "rw_handler_interface.hpp"
+#include "target_stats.hpp"
+
+#include "fair_group.hpp"
+
+namespace ublk::qos {
+
+/*
+ * Passes queries on to the backend for as long as the target keeps within its
+ * share of it, holds them in FIFO order otherwise. The other targets sharing
+ * the backend run in other slaves, so those held are looked at again every
+ * kFairPollPeriod rather than upon the others' progress
+ */
+class FairRWHandler final : public IRWHandler {
+public:
+  explicit FairRWHandler(boost::asio::io_context &io_ctx,
+                         std::shared_ptr<IRWHandler> h, fair_flow flow,
+                         std::shared_ptr<target_stats> stats = {});
+  ~FairRWHandler() override;
+
+  FairRWHandler(FairRWHandler const &) = delete;
+  FairRWHandler &operator=(FairRWHandler const &) = delete;
+
+  FairRWHandler(FairRWHandler &&) = delete;
+  FairRWHandler &operator=(FairRWHandler &&) = delete;
+
+  int submit(std::shared_ptr<read_query> rq) noexcept override;
+  int submit(std::shared_ptr<write_query> wq) noexcept override;
+  int submit(std::shared_ptr<readv_query> rq) noexcept override;
+  int submit(std::shared_ptr<writev_query> wq) noexcept override;
+
+private:
+  class sharer;
+  /* outlives the handler until the queries held get through */
+  std::shared_ptr<sharer> s_;
+};
+
+} // namespace ublk::qos
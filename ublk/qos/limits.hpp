@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+
+#include <type_traits>
+
+namespace ublk::qos {
+
+/*
+ * Lives in shared memory mapped by the master before the slave is forked, the
+ * master changes the limits at run time and the slave picks them up by the
+ * next query. 0 leaves the respective limit off
+ */
+struct limits {
+  uint64_t read_iops;
+  uint64_t write_iops;
+  uint64_t read_bps;
+  uint64_t write_bps;
+};
+
+static_assert(std::is_trivial_v<limits>);
+
+inline uint64_t limit_load(uint64_t const &v) noexcept {
+  return __atomic_load_n(&v, __ATOMIC_RELAXED);
+}
+
+inline void limit_store(uint64_t &v, uint64_t n) noexcept {
+  __atomic_store_n(&v, n, __ATOMIC_RELAXED);
+}
+
+} // namespace ublk::qos
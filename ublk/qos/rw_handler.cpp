@@ -0,0 +1,194 @@
+#include "rw_handler.hpp"
+
+#include <cstdint>
+
+#include <algorithm>
+#include <chrono>
+#include <concepts>
+#include <deque>
+#include <memory>
+#include <utility>
+#include <variant>
+
+#include <boost/asio/steady_timer.hpp>
+#include <boost/system/error_code.hpp>
+
+#include <gsl/assert>
+
+#include "read_query.hpp"
+#include "readv_query.hpp"
+#include "write_query.hpp"
+#include "writev_query.hpp"
+
+#include "token_bucket.hpp"
+
+namespace ublk::qos {
+
+namespace {
+
+using clock = token_bucket::clock;
+
+constexpr auto kRecheckPeriod{std::chrono::milliseconds{100}};
+
+uint64_t us_since(clock::time_point since, clock::time_point now) noexcept {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(now - since)
+          .count());
+}
+
+} // namespace
+
+class RWHandler::throttle final
+    : public std::enable_shared_from_this<throttle> {
+public:
+  explicit throttle(boost::asio::io_context &io_ctx,
+                    std::shared_ptr<IRWHandler> h,
+                    std::shared_ptr<limits const> lims,
+                    std::shared_ptr<target_stats> stats) noexcept
+      : h_(std::move(h)), lims_(std::move(lims)), stats_(std::move(stats)),
+        reads_(io_ctx, &limits::read_iops, &limits::read_bps),
+        writes_(io_ctx, &limits::write_iops, &limits::write_bps) {
+    Ensures(h_);
+    Ensures(lims_);
+  }
+
+  template <typename T> void admit(std::shared_ptr<T> q) noexcept {
+    Expects(q);
+
+    auto &d{direction_of<T>()};
+    auto const now{clock::now()};
+
+    if (d.held.empty() && wait(d, now) == clock::duration::zero()) {
+      take(d, q->size(), now);
+      submit(q);
+      return;
+    }
+
+    d.held.push_back({std::move(q), now});
+    if (stats_)
+      stats_add(stats_->qos_throttled, 1);
+    arm(d);
+  }
+
+private:
+  template <typename... Qs> struct direction {
+    explicit direction(boost::asio::io_context &io_ctx,
+                       uint64_t limits::*iops_limit,
+                       uint64_t limits::*bps_limit) noexcept
+        : iops_limit(iops_limit), bps_limit(bps_limit), timer(io_ctx),
+          armed(false) {}
+
+    struct held_query {
+      std::variant<std::shared_ptr<Qs>...> q;
+      clock::time_point since;
+    };
+
+    uint64_t limits::*iops_limit;
+    uint64_t limits::*bps_limit;
+    token_bucket iops;
+    token_bucket bps;
+    std::deque<held_query> held;
+    boost::asio::steady_timer timer;
+    bool armed;
+  };
+
+  using reads = direction<read_query, readv_query>;
+  using writes = direction<write_query, writev_query>;
+
+  template <typename T> auto &direction_of() noexcept {
+    if constexpr (std::same_as<T, read_query> || std::same_as<T, readv_query>)
+      return reads_;
+    else
+      return writes_;
+  }
+
+  clock::duration wait(auto const &d, clock::time_point now) const noexcept {
+    return std::max(d.iops.wait(limit_load((*lims_).*d.iops_limit), now),
+                    d.bps.wait(limit_load((*lims_).*d.bps_limit), now));
+  }
+
+  void take(auto &d, uint64_t sz, clock::time_point now) noexcept {
+    d.iops.take(1, limit_load((*lims_).*d.iops_limit), now);
+    d.bps.take(sz, limit_load((*lims_).*d.bps_limit), now);
+  }
+
+  void submit(auto const &q) noexcept {
+    if (auto const res{h_->submit(q)}) [[unlikely]]
+      q->set_err(res);
+  }
+
+  void arm(auto &d) noexcept {
+    if (d.armed)
+      return;
+    d.armed = true;
+
+    d.timer.expires_after(
+        std::min<clock::duration>(wait(d, clock::now()), kRecheckPeriod));
+    d.timer.async_wait(
+        [self = shared_from_this(), &d](boost::system::error_code const &) {
+          d.armed = false;
+          self->drain(d);
+        });
+  }
+
+  void drain(auto &d) noexcept {
+    auto const now{clock::now()};
+
+    while (!d.held.empty() && wait(d, now) == clock::duration::zero()) {
+      auto hq{std::move(d.held.front())};
+      d.held.pop_front();
+
+      if (stats_)
+        stats_add(stats_->qos_throttled_us, us_since(hq.since, now));
+
+      std::visit(
+          [this, &d, now](auto const &q) {
+            take(d, q->size(), now);
+            submit(q);
+          },
+          hq.q);
+    }
+
+    if (!d.held.empty())
+      arm(d);
+  }
+
+  std::shared_ptr<IRWHandler> h_;
+  std::shared_ptr<limits const> lims_;
+  std::shared_ptr<target_stats> stats_;
+  reads reads_;
+  writes writes_;
+};
+
+RWHandler::RWHandler(boost::asio::io_context &io_ctx,
+                     std::shared_ptr<IRWHandler> h,
+                     std::shared_ptr<limits const> lims,
+                     std::shared_ptr<target_stats> stats)
+    : t_(std::make_shared<throttle>(io_ctx, std::move(h), std::move(lims),
+                                    std::move(stats))) {
+  Ensures(t_);
+}
+
+RWHandler::~RWHandler() = default;
+
+int RWHandler::submit(std::shared_ptr<read_query> rq) noexcept {
+  t_->admit(std::move(rq));
+  return 0;
+}
+
+int RWHandler::submit(std::shared_ptr<write_query> wq) noexcept {
+  t_->admit(std::move(wq));
+  return 0;
+}
+
+int RWHandler::submit(std::shared_ptr<readv_query> rq) noexcept {
+  t_->admit(std::move(rq));
+  return 0;
+}
+
+int RWHandler::submit(std::shared_ptr<writev_query> wq) noexcept {
+  t_->admit(std::move(wq));
+  return 0;
+}
+
+} // namespace ublk::qos
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <memory>
+
+#include <boost/asio/io_context.hpp>
+
+#include "rw_handler_interface.hpp"
+#include "target_stats.hpp"
+
+#include "limits.hpp"
+
+namespace ublk::qos {
+
+/*
+ * Lets reads and writes through at the rates the limits give, those beyond
+ * wait in FIFO order of their direction. The limits are looked at by every
+ * query and at least every kRecheckPeriod while queries wait, so that changes
+ * made at run time take effect without the ones waiting getting reordered
+ */
+class RWHandler final : public IRWHandler {
+public:
+  explicit RWHandler(boost::asio::io_context &io_ctx,
+                     std::shared_ptr<IRWHandler> h,
+                     std::shared_ptr<limits const> lims,
+                     std::shared_ptr<target_stats> stats = {});
+  ~RWHandler() override;
+
+  RWHandler(RWHandler const &) = delete;
+  RWHandler &operator=(RWHandler const &) = delete;
+
+  RWHandler(RWHandler &&) = delete;
+  RWHandler &operator=(RWHandler &&) = delete;
+
+  int submit(std::shared_ptr<read_query> rq) noexcept override;
+  int submit(std::shared_ptr<write_query> wq) noexcept override;
+  int submit(std::shared_ptr<readv_query> rq) noexcept override;
+  int submit(std::shared_ptr<writev_query> wq) noexcept override;
+
+private:
+  class throttle;
+  /* outlives the handler until the queries waiting get through */
+  std::shared_ptr<throttle> t_;
+};
+
+} // namespace ublk::qos
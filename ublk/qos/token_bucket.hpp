@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+
+#include <algorithm>
+#include <chrono>
+
+namespace ublk::qos {
+
+/*
+ * Token bucket kept as the theoretical arrival time of the next unit (GCRA).
+ * The rate is given by every call so that it may change at any moment, bursts
+ * of up to burst long worth of the rate pass at once
+ */
+class token_bucket {
+public:
+  using clock = std::chrono::steady_clock;
+
+  explicit token_bucket(
+      clock::duration burst = std::chrono::milliseconds{100}) noexcept
+      : burst_(burst) {}
+
+  /* how long it takes the bucket to let anything pass */
+  clock::duration wait(uint64_t rate, clock::time_point now) const noexcept {
+    if (!rate || !(tat_ - burst_ > now))
+      return clock::duration::zero();
+    return tat_ - burst_ - now;
+  }
+
+  /* n units taken are paid for even if the bucket gets in debt */
+  void take(uint64_t n, uint64_t rate, clock::time_point now) noexcept {
+    if (!rate)
+      return;
+    auto const cost{
+        std::chrono::nanoseconds{
+            static_cast<int64_t>(static_cast<unsigned __int128>(n) *
+                                 1'000'000'000 / rate),
+        },
+    };
+    tat_ = std::max(tat_, now) + cost;
+  }
+
+private:
+  clock::duration burst_;
+  clock::time_point tat_;
+};
+
+} // namespace ublk::qos
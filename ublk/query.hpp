@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 namespace ublk {
 
 class query {
@@ -16,11 +18,19 @@ protected:
   ~query() = default;
 
 public:
-  void set_err(int err) noexcept { err_ = err; }
-  int err() const noexcept { return err_; }
+  /* subqueries might complete in different threads */
+  void set_err(int err) noexcept {
+    __atomic_store_n(&err_, err, __ATOMIC_RELAXED);
+  }
+  int err() const noexcept { return __atomic_load_n(&err_, __ATOMIC_RELAXED); }
+
+  /* subqueries inherit the trace id of the query they are made of */
+  void set_trace_id(uint32_t id) noexcept { trace_id_ = id; }
+  uint32_t trace_id() const noexcept { return trace_id_; }
 
 private:
   int err_{0};
+  uint32_t trace_id_{0};
 };
 
 } // namespace ublk
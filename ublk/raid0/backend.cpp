@@ -1,29 +1,49 @@
 #include "backend.hpp"
 
+#include <climits>
+#include <cstddef>
 #include <cstdint>
 
 #include <algorithm>
 #include <bit>
 #include <concepts>
+#include <functional>
+#include <type_traits>
 #include <utility>
 
 #include <gsl/assert>
 
+#include <boost/container/small_vector.hpp>
+
 #include "mm/mem.hpp"
 #include "mm/mem_types.hpp"
 
 #include "utils/align.hpp"
 #include "utils/utility.hpp"
 
+#include "fanout.hpp"
+#include "read_query.hpp"
+#include "sg_bufs.hpp"
+#include "write_query.hpp"
+
 namespace ublk::raid0 {
 
+namespace {
+
+/* a gathered query must still go down by a single preadv/pwritev */
+constexpr size_t kBufsNrMax{IOV_MAX};
+
+} // namespace
+
 struct backend::static_cfg {
   uint64_t strip_sz;
   uint64_t strip_shift;
+  bool sg_coalesce;
 };
 
-backend::backend(uint64_t strip_sz, std::vector<std::shared_ptr<IRWHandler>> hs)
-    : hs_(std::move(hs)) {
+backend::backend(uint64_t strip_sz, std::vector<std::shared_ptr<IRWHandler>> hs,
+                 std::function<void(int err)> completer, bool sg_coalesce)
+    : hs_(std::move(hs)), completer_(std::move(completer)) {
   Ensures(is_power_of_2(strip_sz));
   Ensures(!hs_.empty());
   Ensures(std::ranges::all_of(
@@ -33,6 +53,7 @@ backend::backend(uint64_t strip_sz, std::vector<std::shared_ptr<IRWHandler>> hs)
       hardware_destructive_interference_size);
   cfg->strip_sz = strip_sz;
   cfg->strip_shift = std::countr_zero(cfg->strip_sz);
+  cfg->sg_coalesce = sg_coalesce;
 
   static_cfg_ = mm::const_uptrwd_cast(std::move(cfg));
 }
@@ -51,7 +72,41 @@ int backend::do_op(std::shared_ptr<T> query) noexcept {
   auto strip_id{query->offset() >> static_cfg_->strip_shift};
   auto strip_offset{query->offset() & (static_cfg_->strip_sz - 1)};
 
-  for (size_t submitted_bytes{0}; submitted_bytes < query->buf().size();
+  auto const query_sz{query->buf().size()};
+  auto const strips_nr{
+      div_round_up(strip_offset + query_sz, static_cfg_->strip_sz),
+  };
+
+  /*
+   * A backend getting more than one strip of the query gets all of them
+   * gathered into a single query, as long as the list fits in an iovec
+   */
+  if (static_cfg_->sg_coalesce && strips_nr > hs_.size() &&
+      !(div_round_up(strips_nr, hs_.size()) > kBufsNrMax)) {
+    using TV = std::conditional_t<std::same_as<T, read_query>, readv_query,
+                                  writev_query>;
+    auto vq{
+        TV::create(sg_bufs<typename decltype(query->buf())::element_type>{
+                       query->buf(),
+                   },
+                   query->offset(),
+                   [query](TV const &vq) {
+                     if (auto const err{vq.err()}) [[unlikely]]
+                       query->set_err(err);
+                   }),
+    };
+    vq->set_trace_id(query->trace_id());
+    if constexpr (std::same_as<T, write_query>)
+      vq->set_fua(query->fua());
+    return do_opv(std::move(vq));
+  }
+
+  auto fo{
+      fanout<T>::create(std::move(query), strips_nr,
+                        std::function{completer_}),
+  };
+
+  for (size_t submitted_bytes{0}; submitted_bytes < query_sz;
        ++strip_id, strip_offset = 0) {
     auto const strip_id_in_stripe{strip_id % hs_.size()};
     auto const hid{strip_id_in_stripe};
@@ -62,11 +117,9 @@ int backend::do_op(std::shared_ptr<T> query) noexcept {
     };
     auto const subquery_sz{
         std::min(static_cfg_->strip_sz - strip_offset,
-                 query->buf().size() - submitted_bytes),
-    };
-    auto subquery{
-        query->subquery(submitted_bytes, subquery_sz, subquery_offset, query),
+                 query_sz - submitted_bytes),
     };
+    auto subquery{fo->subquery(submitted_bytes, subquery_sz, subquery_offset)};
     if (auto const res{h->submit(std::move(subquery))}) [[unlikely]] {
       return res;
     }
@@ -76,6 +129,78 @@ int backend::do_op(std::shared_ptr<T> query) noexcept {
   return 0;
 }
 
+template <typename T>
+  requires std::same_as<T, writev_query> || std::same_as<T, readv_query>
+int backend::do_opv(std::shared_ptr<T> query) noexcept {
+  Expects(query);
+  Expects(0 != query->size());
+
+  auto strip_id{query->offset() >> static_cfg_->strip_shift};
+  auto strip_offset{query->offset() & (static_cfg_->strip_sz - 1)};
+
+  /*
+   * Strips of a backend following each other within the query are adjacent
+   * on the backend, so all of them make up a single contiguous range there.
+   * A list growing beyond an iovec goes down as is and the range continues
+   * in a list of its own
+   */
+  using bufs_t = decltype(sg_slice(query->bufs(), 0, 0));
+  auto hbufs{boost::container::small_vector<bufs_t, 8>(hs_.size())};
+  auto hoffsets{boost::container::small_vector<uint64_t, 8>(hs_.size())};
+
+  auto const submit{[&](size_t hid) {
+    auto const bufs_sz{sg_size(hbufs[hid])};
+    auto subquery{
+        T::create(std::move(hbufs[hid]), hoffsets[hid],
+                  [query, completer = completer_](T const &sq) {
+                    if (auto const err{sq.err()}) [[unlikely]] {
+                      query->set_err(err);
+                      if (completer)
+                        completer(err);
+                    }
+                  }),
+    };
+    hbufs[hid].clear();
+    hoffsets[hid] += bufs_sz;
+    subquery->set_trace_id(query->trace_id());
+    if constexpr (std::same_as<T, writev_query>)
+      subquery->set_fua(query->fua());
+    return hs_[hid]->submit(std::move(subquery));
+  }};
+
+  auto const query_sz{query->size()};
+  for (size_t submitted_bytes{0}; submitted_bytes < query_sz;
+       ++strip_id, strip_offset = 0) {
+    auto const hid{strip_id % hs_.size()};
+    auto const stripe_id{strip_id / hs_.size()};
+    auto const subquery_sz{
+        std::min(static_cfg_->strip_sz - strip_offset,
+                 query_sz - submitted_bytes),
+    };
+    if (hbufs[hid].empty()) {
+      hoffsets[hid] = strip_offset + (stripe_id << static_cfg_->strip_shift);
+    }
+    for (auto const buf :
+         sg_slice(query->bufs(), submitted_bytes, subquery_sz)) {
+      if (!(hbufs[hid].size() < kBufsNrMax)) [[unlikely]] {
+        if (auto const res{submit(hid)}) [[unlikely]]
+          return res;
+      }
+      hbufs[hid].push_back(buf);
+    }
+    submitted_bytes += subquery_sz;
+  }
+
+  for (size_t hid{0}; hid < hs_.size(); ++hid) {
+    if (hbufs[hid].empty())
+      continue;
+    if (auto const res{submit(hid)}) [[unlikely]]
+      return res;
+  }
+
+  return 0;
+}
+
 int backend::process(std::shared_ptr<read_query> rq) noexcept {
   return do_op(std::move(rq));
 }
@@ -84,4 +209,12 @@ int backend::process(std::shared_ptr<write_query> wq) noexcept {
   return do_op(std::move(wq));
 }
 
+int backend::process(std::shared_ptr<readv_query> rq) noexcept {
+  return do_opv(std::move(rq));
+}
+
+int backend::process(std::shared_ptr<writev_query> wq) noexcept {
+  return do_opv(std::move(wq));
+}
+
 } // namespace ublk::raid0
@@ -3,22 +3,36 @@
 #include <cstdint>
 
 #include <concepts>
+#include <functional>
 #include <memory>
 #include <ranges>
+#include <utility>
 #include <vector>
 
 #include "mm/mem_types.hpp"
 
+#include "readv_query.hpp"
 #include "rw_handler_interface.hpp"
+#include "writev_query.hpp"
 
 namespace ublk::raid0 {
 
 class backend final {
 public:
+  /*
+   * sg_coalesce makes a query spanning more strips than there are backends go
+   * down as a single scatter-gather query per backend rather than by a query
+   * per strip
+   */
   explicit backend(uint64_t strip_sz,
-                   std::vector<std::shared_ptr<IRWHandler>> hs);
-  explicit backend(uint64_t strip_sz, std::ranges::input_range auto &&hs)
-      : backend(strip_sz, {std::ranges::begin(hs), std::ranges::end(hs)}) {}
+                   std::vector<std::shared_ptr<IRWHandler>> hs,
+                   std::function<void(int err)> completer = {},
+                   bool sg_coalesce = false);
+  explicit backend(uint64_t strip_sz, std::ranges::input_range auto &&hs,
+                   std::function<void(int err)> completer = {},
+                   bool sg_coalesce = false)
+      : backend(strip_sz, {std::ranges::begin(hs), std::ranges::end(hs)},
+                std::move(completer), sg_coalesce) {}
 
   ~backend() noexcept;
 
@@ -31,15 +45,27 @@ public:
   int process(std::shared_ptr<read_query> rq) noexcept;
   int process(std::shared_ptr<write_query> wq) noexcept;
 
+  /*
+   * Scatter-gather lists get a single query per backend, gathering all the
+   * strips of the list the backend holds
+   */
+  int process(std::shared_ptr<readv_query> rq) noexcept;
+  int process(std::shared_ptr<writev_query> wq) noexcept;
+
 private:
   template <typename T>
     requires std::same_as<T, write_query> || std::same_as<T, read_query>
   int do_op(std::shared_ptr<T> query) noexcept;
 
+  template <typename T>
+    requires std::same_as<T, writev_query> || std::same_as<T, readv_query>
+  int do_opv(std::shared_ptr<T> query) noexcept;
+
   struct static_cfg;
   mm::uptrwd<static_cfg const> static_cfg_;
 
   std::vector<std::shared_ptr<IRWHandler>> hs_;
+  std::function<void(int err)> completer_;
 };
 
 } // namespace ublk::raid0
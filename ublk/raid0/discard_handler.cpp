@@ -0,0 +1,72 @@
+#include "discard_handler.hpp"
+
+#include <cstdint>
+
+#include <algorithm>
+#include <bit>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <gsl/assert>
+
+#include "utils/utility.hpp"
+
+namespace ublk::raid0 {
+
+DiscardHandler::DiscardHandler(uint64_t strip_sz,
+                               std::vector<std::shared_ptr<IDiscardHandler>> hs)
+    : strip_sz_(strip_sz), strip_shift_(std::countr_zero(strip_sz)),
+      hs_(std::move(hs)) {
+  Ensures(is_power_of_2(strip_sz_));
+  Ensures(!hs_.empty());
+  Ensures(std::ranges::all_of(
+      hs_, [](auto const &h) { return static_cast<bool>(h); }));
+}
+
+int DiscardHandler::submit(std::shared_ptr<discard_query> dq) noexcept {
+  Expects(dq);
+
+  if (0 == dq->size()) [[unlikely]]
+    return 0;
+
+  auto const hs_nr{static_cast<uint64_t>(hs_.size())};
+  auto const strip_id_first{dq->offset() >> strip_shift_};
+  auto const strip_id_last{(dq->offset() + dq->size() - 1) >> strip_shift_};
+
+  for (uint64_t hid{0}; hid < hs_nr; ++hid) {
+    /* The first and the last strips of the range the member holds */
+    auto const h_strip_id_first{
+        strip_id_first + (hid + hs_nr - strip_id_first % hs_nr) % hs_nr,
+    };
+    if (h_strip_id_first > strip_id_last)
+      continue;
+    auto const h_strip_id_last{
+        strip_id_last - (strip_id_last % hs_nr + hs_nr - hid) % hs_nr,
+    };
+
+    auto const h_offset_first{
+        ((h_strip_id_first / hs_nr) << strip_shift_) +
+            (h_strip_id_first == strip_id_first
+                 ? dq->offset() & (strip_sz_ - 1)
+                 : 0),
+    };
+    auto const h_offset_last{
+        ((h_strip_id_last / hs_nr) << strip_shift_) +
+            (h_strip_id_last == strip_id_last
+                 ? ((dq->offset() + dq->size() - 1) & (strip_sz_ - 1)) + 1
+                 : strip_sz_),
+    };
+
+    if (auto const res{
+            hs_[hid]->submit(dq->subquery(
+                h_offset_first, h_offset_last - h_offset_first, dq)),
+        }) [[unlikely]] {
+      return res;
+    }
+  }
+
+  return 0;
+}
+
+} // namespace ublk::raid0
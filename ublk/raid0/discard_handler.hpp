@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+
+#include <memory>
+#include <ranges>
+#include <vector>
+
+#include "discard_handler_interface.hpp"
+#include "discard_query.hpp"
+
+namespace ublk::raid0 {
+
+/*
+ * Splits a discard by strips. Strips of a member within the range are
+ * adjacent on the member, so every member touched gets a single discard
+ */
+class DiscardHandler final : public IDiscardHandler {
+public:
+  explicit DiscardHandler(uint64_t strip_sz,
+                          std::vector<std::shared_ptr<IDiscardHandler>> hs);
+  explicit DiscardHandler(uint64_t strip_sz, std::ranges::input_range auto &&hs)
+      : DiscardHandler(strip_sz,
+                       {std::ranges::begin(hs), std::ranges::end(hs)}) {}
+  ~DiscardHandler() override = default;
+
+  DiscardHandler(DiscardHandler const &) = delete;
+  DiscardHandler &operator=(DiscardHandler const &) = delete;
+
+  DiscardHandler(DiscardHandler &&) = delete;
+  DiscardHandler &operator=(DiscardHandler &&) = delete;
+
+  int submit(std::shared_ptr<discard_query> dq) noexcept override;
+
+private:
+  uint64_t strip_sz_;
+  uint64_t strip_shift_;
+  std::vector<std::shared_ptr<IDiscardHandler>> hs_;
+};
+
+} // namespace ublk::raid0
@@ -9,7 +9,9 @@
 #include <boost/sml.hpp>
 
 #include "read_query.hpp"
+#include "readv_query.hpp"
 #include "write_query.hpp"
+#include "writev_query.hpp"
 
 #include "backend.hpp"
 
@@ -27,6 +29,16 @@ struct wq {
   mutable int r;
 };
 
+struct rvq {
+  std::shared_ptr<readv_query> rq;
+  mutable int r;
+};
+
+struct wvq {
+  std::shared_ptr<writev_query> wq;
+  mutable int r;
+};
+
 struct fail {};
 
 } // namespace ev
@@ -58,10 +70,32 @@ struct transition_table {
                     process(ev::fail{});
                   }
                 },
+        "online"_s +
+            event<ev::rvq> /
+                [](ev::rvq const &e, ctx &ctx,
+                   back::process<ev::fail> process) {
+                  Expects(ctx.be);
+                  e.r = ctx.be->process(e.rq);
+                  if (0 != e.r) [[unlikely]] {
+                    process(ev::fail{});
+                  }
+                },
+        "online"_s +
+            event<ev::wvq> /
+                [](ev::wvq const &e, ctx &ctx,
+                   back::process<ev::fail> process) {
+                  Expects(ctx.be);
+                  e.r = ctx.be->process(e.wq);
+                  if (0 != e.r) [[unlikely]] {
+                    process(ev::fail{});
+                  }
+                },
         "online"_s + event<ev::fail> = "offline"_s,
         // offline state
         "offline"_s + event<ev::rq> / [](ev::rq const &e) { e.r = EIO; },
-        "offline"_s + event<ev::wq> / [](ev::wq const &e) { e.r = EIO; });
+        "offline"_s + event<ev::wq> / [](ev::wq const &e) { e.r = EIO; },
+        "offline"_s + event<ev::rvq> / [](ev::rvq const &e) { e.r = EIO; },
+        "offline"_s + event<ev::wvq> / [](ev::wvq const &e) { e.r = EIO; });
   }
 };
 
@@ -13,7 +13,9 @@
 #include <boost/sml.hpp>
 
 #include "read_query.hpp"
+#include "readv_query.hpp"
 #include "write_query.hpp"
+#include "writev_query.hpp"
 
 #include "backend.hpp"
 #include "fsm.hpp"
@@ -24,9 +26,16 @@ namespace ublk::raid0 {
 
 class Target::impl final {
 public:
-  explicit impl(uint64_t strip_sz, std::vector<std::shared_ptr<IRWHandler>> hs)
+  explicit impl(uint64_t strip_sz, std::vector<std::shared_ptr<IRWHandler>> hs,
+                bool sg_coalesce)
       : ctx_{
-          .be = std::make_unique<backend>(strip_sz, std::move(hs)),
+          .be = std::make_unique<backend>(
+              strip_sz, std::move(hs),
+              [this](int err) {
+                if (err) [[unlikely]]
+                  fail();
+              },
+              sg_coalesce),
         },
         fsm_(ctx_) {}
 
@@ -45,17 +54,8 @@ public:
   int process(std::shared_ptr<read_query> rq) noexcept {
     Expects(rq);
 
-    auto *p_rq = rq.get();
-    rq = p_rq->subquery(0, p_rq->buf().size(), p_rq->offset(),
-                        [this, rq = std::move(rq)](read_query const &new_rq) {
-                          if (new_rq.err()) [[unlikely]] {
-                            rq->set_err(new_rq.err());
-                            fsm_.process_event(fsm::ev::fail{});
-                          }
-                        });
-
     fsm::ev::rq e{.rq = std::move(rq), .r = 0};
-    fsm_.process_event(e);
+    process_event(e);
 
     return e.r;
   }
@@ -63,29 +63,61 @@ public:
   int process(std::shared_ptr<write_query> wq) noexcept {
     Expects(wq);
 
-    auto *p_wq = wq.get();
-    wq = p_wq->subquery(0, p_wq->buf().size(), p_wq->offset(),
-                        [this, wq = std::move(wq)](write_query const &new_wq) {
-                          if (new_wq.err()) [[unlikely]] {
-                            wq->set_err(new_wq.err());
-                            fsm_.process_event(fsm::ev::fail{});
-                          }
-                        });
-
     fsm::ev::wq e{.wq = std::move(wq), .r = 0};
-    fsm_.process_event(e);
+    process_event(e);
+
+    return e.r;
+  }
+
+  int process(std::shared_ptr<readv_query> rq) noexcept {
+    Expects(rq);
+
+    fsm::ev::rvq e{.rq = std::move(rq), .r = 0};
+    process_event(e);
+
+    return e.r;
+  }
+
+  int process(std::shared_ptr<writev_query> wq) noexcept {
+    Expects(wq);
+
+    fsm::ev::wvq e{.wq = std::move(wq), .r = 0};
+    process_event(e);
 
     return e.r;
   }
 
 private:
+  /*
+   * Queries might fail while the FSM is still processing an event, in this
+   * case the failure is deferred until the processing is finished
+   */
+  void fail() noexcept {
+    if (processing_) {
+      fail_pending_ = true;
+      return;
+    }
+    fsm_.process_event(fsm::ev::fail{});
+  }
+
+  template <typename E> void process_event(E &e) noexcept {
+    processing_ = true;
+    fsm_.process_event(e);
+    processing_ = false;
+    if (std::exchange(fail_pending_, false)) [[unlikely]]
+      fsm_.process_event(fsm::ev::fail{});
+  }
+
+  bool processing_{false};
+  bool fail_pending_{false};
   fsm::ctx ctx_;
   boost::sml::sm<fsm::transition_table, boost::sml::process_queue<std::queue>>
       fsm_;
 };
 
-Target::Target(uint64_t strip_sz, std::vector<std::shared_ptr<IRWHandler>> hs)
-    : pimpl_(std::make_unique<impl>(strip_sz, std::move(hs))) {}
+Target::Target(uint64_t strip_sz, std::vector<std::shared_ptr<IRWHandler>> hs,
+               bool sg_coalesce)
+    : pimpl_(std::make_unique<impl>(strip_sz, std::move(hs), sg_coalesce)) {}
 
 Target::~Target() noexcept = default;
 
@@ -102,4 +134,12 @@ int Target::process(std::shared_ptr<write_query> wq) noexcept {
   return pimpl_->process(std::move(wq));
 }
 
+int Target::process(std::shared_ptr<readv_query> rq) noexcept {
+  return pimpl_->process(std::move(rq));
+}
+
+int Target::process(std::shared_ptr<writev_query> wq) noexcept {
+  return pimpl_->process(std::move(wq));
+}
+
 } // namespace ublk::raid0
@@ -10,17 +10,22 @@
 #include "rw_handler_interface.hpp"
 
 #include "read_query.hpp"
+#include "readv_query.hpp"
 #include "write_query.hpp"
+#include "writev_query.hpp"
 
 namespace ublk::raid0 {
 
 class Target final {
 public:
   explicit Target(uint64_t strip_sz,
-                  std::vector<std::shared_ptr<IRWHandler>> hs);
+                  std::vector<std::shared_ptr<IRWHandler>> hs,
+                  bool sg_coalesce = false);
 
-  explicit Target(uint64_t strip_sz, std::ranges::input_range auto &&hs)
-      : Target(strip_sz, {std::ranges::begin(hs), std::ranges::end(hs)}) {}
+  explicit Target(uint64_t strip_sz, std::ranges::input_range auto &&hs,
+                  bool sg_coalesce = false)
+      : Target(strip_sz, {std::ranges::begin(hs), std::ranges::end(hs)},
+               sg_coalesce) {}
 
   ~Target() noexcept;
 
@@ -34,6 +39,8 @@ public:
 
   int process(std::shared_ptr<read_query> rq) noexcept;
   int process(std::shared_ptr<write_query> wq) noexcept;
+  int process(std::shared_ptr<readv_query> rq) noexcept;
+  int process(std::shared_ptr<writev_query> wq) noexcept;
 
 private:
   class impl;
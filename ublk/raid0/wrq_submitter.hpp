@@ -28,6 +28,10 @@ public:
     return target_->process(std::move(wq));
   }
 
+  int submit(std::shared_ptr<writev_query> wq) noexcept override {
+    return target_->process(std::move(wq));
+  }
+
 private:
   std::shared_ptr<Target> target_;
 };
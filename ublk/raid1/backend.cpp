@@ -13,6 +13,7 @@
 #include "utils/align.hpp"
 #include "utils/utility.hpp"
 
+#include "fanout.hpp"
 #include "sector.hpp"
 
 namespace ublk::raid1 {
@@ -42,12 +43,16 @@ backend::backend(backend &&) noexcept = default;
 backend &backend::operator=(backend &&) noexcept = default;
 
 int backend::process(std::shared_ptr<read_query> rq) noexcept {
-  for (auto rb{0uz}; rb < rq->buf().size();
-       next_hid_ = (next_hid_ + 1) % hs_.size()) {
-    auto const chunk_sz{
-        std::min(static_cfg_->read_strip_sz, rq->buf().size() - rb),
-    };
-    auto new_rq{rq->subquery(rb, chunk_sz, rq->offset() + rb, rq)};
+  auto const rq_sz{rq->buf().size()};
+  auto const rq_offset{rq->offset()};
+  auto fo{
+      fanout<read_query>::create(
+          std::move(rq), div_round_up(rq_sz, static_cfg_->read_strip_sz)),
+  };
+
+  for (auto rb{0uz}; rb < rq_sz; next_hid_ = (next_hid_ + 1) % hs_.size()) {
+    auto const chunk_sz{std::min(static_cfg_->read_strip_sz, rq_sz - rb)};
+    auto new_rq{fo->subquery(rb, chunk_sz, rq_offset + rb)};
     if (auto const res{hs_[next_hid_]->submit(std::move(new_rq))})
         [[unlikely]] {
       return res;
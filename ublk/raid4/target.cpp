@@ -11,12 +11,14 @@ namespace ublk::raid4 {
 
 class Target::impl final {
 public:
-  explicit impl(uint64_t strip_sz, std::vector<std::shared_ptr<IRWHandler>> hs)
+  explicit impl(uint64_t strip_sz, std::vector<std::shared_ptr<IRWHandler>> hs,
+                std::vector<std::shared_ptr<IDiscardHandler>> dhs)
       : target_(strip_sz, hs,
                 [strips_per_stripe_nr =
                      hs.size()](uint64_t stripe_id [[maybe_unused]]) {
                   return strips_per_stripe_nr - 1;
-                }) {}
+                },
+                std::move(dhs)) {}
 
   std::string state() const { return target_.state(); }
 
@@ -28,6 +30,10 @@ public:
     return target_.process(std::move(wq));
   }
 
+  int process(std::shared_ptr<discard_query> dq) noexcept {
+    return target_.process(std::move(dq));
+  }
+
   bool is_stripe_parity_coherent(uint64_t stripe_id) const noexcept {
     return target_.is_stripe_parity_coherent(stripe_id);
   }
@@ -36,8 +42,10 @@ private:
   raidsp::Target target_;
 };
 
-Target::Target(uint64_t strip_sz, std::vector<std::shared_ptr<IRWHandler>> hs)
-    : pimpl_(std::make_unique<impl>(strip_sz, std::move(hs))) {}
+Target::Target(uint64_t strip_sz, std::vector<std::shared_ptr<IRWHandler>> hs,
+               std::vector<std::shared_ptr<IDiscardHandler>> dhs /* = {}*/)
+    : pimpl_(
+          std::make_unique<impl>(strip_sz, std::move(hs), std::move(dhs))) {}
 
 Target::~Target() noexcept = default;
 
@@ -57,4 +65,8 @@ int Target::process(std::shared_ptr<write_query> wq) noexcept {
   return pimpl_->process(std::move(wq));
 }
 
+int Target::process(std::shared_ptr<discard_query> dq) noexcept {
+  return pimpl_->process(std::move(dq));
+}
+
 } // namespace ublk::raid4
@@ -7,8 +7,10 @@
 #include <string>
 #include <vector>
 
+#include "discard_handler_interface.hpp"
 #include "rw_handler_interface.hpp"
 
+#include "discard_query.hpp"
 #include "read_query.hpp"
 #include "write_query.hpp"
 
@@ -17,7 +19,8 @@ namespace ublk::raid5 {
 class Target final {
 public:
   explicit Target(uint64_t strip_sz,
-                  std::vector<std::shared_ptr<IRWHandler>> hs);
+                  std::vector<std::shared_ptr<IRWHandler>> hs,
+                  std::vector<std::shared_ptr<IDiscardHandler>> dhs = {});
 
   explicit Target(uint64_t strip_sz, std::ranges::input_range auto &&hs)
       : Target(strip_sz, {std::ranges::begin(hs), std::ranges::end(hs)}) {}
@@ -36,6 +39,7 @@ public:
 
   int process(std::shared_ptr<read_query> rq) noexcept;
   int process(std::shared_ptr<write_query> wq) noexcept;
+  int process(std::shared_ptr<discard_query> dq) noexcept;
 
 private:
   class impl;
@@ -15,15 +15,19 @@
 #include "utils/algo.hpp"
 #include "utils/math.hpp"
 
+#include "trace/trace.hpp"
+
 #include "parity.hpp"
 
 namespace ublk::raidsp {
 
 acceptor::acceptor(
     uint64_t strip_sz, std::vector<std::shared_ptr<IRWHandler>> hs,
-    std::function<uint64_t(uint64_t stripe_id)> stripe_id_to_parity_id)
+    std::function<uint64_t(uint64_t stripe_id)> stripe_id_to_parity_id,
+    std::vector<std::shared_ptr<IDiscardHandler>> dhs /* = {}*/)
     : be_(std::make_unique<backend>(strip_sz, std::move(hs),
-                                    std::move(stripe_id_to_parity_id))),
+                                    std::move(stripe_id_to_parity_id),
+                                    std::move(dhs))),
       stripe_w_locker_(0, mm::allocator::cache_line_aligned<uint64_t>::value),
       stripe_pool_(std::make_unique<mm::mem_chunk_pool>(
           kCachedStripeAlignment, be_->static_cfg().stripe_sz)),
@@ -50,39 +54,13 @@ int acceptor::stripe_incoherent_parity_write(
   Expects(wqd);
   Expects(wqp);
 
-  auto combined_completer_guard{
-      std::shared_ptr<std::nullptr_t>{
-          nullptr,
-          [=, this](std::nullptr_t *) {
-            Expects(stripe_id_at < stripe_parity_coherency_state_.size());
-            stripe_parity_coherency_state_.set(stripe_id_at,
-                                               !(wqd->err() || wqp->err()));
-          },
-      },
-  };
-
-  auto make_a_new_completer{
-      [combined_completer_guard = std::move(combined_completer_guard)](
-          std::shared_ptr<write_query> wq) {
-        return [wq = std::move(wq),
-                combined_completer_guard](write_query const &new_wq) {
-          if (new_wq.err()) [[unlikely]] {
-            wq->set_err(new_wq.err());
-            return;
-          }
-        };
-      },
-  };
-
-  auto *p_wqd = wqd.get();
-  wqd = write_query::create(p_wqd->buf(), p_wqd->offset(),
-                            make_a_new_completer(std::move(wqd)));
-
-  auto *p_wqp = wqp.get();
-  wqp = write_query::create(p_wqp->buf(), p_wqp->offset(),
-                            make_a_new_completer(std::move(wqp)));
-
-  return be_->stripe_write(stripe_id_at, std::move(wqd), std::move(wqp));
+  return be_->stripe_write(stripe_id_at, std::move(wqd), std::move(wqp),
+                           [stripe_id_at, this](int err) {
+                             Expects(stripe_id_at <
+                                     stripe_parity_coherency_state_.size());
+                             stripe_parity_coherency_state_.set(stripe_id_at,
+                                                                !err);
+                           });
 }
 
 int acceptor::stripe_coherent_parity_write(
@@ -91,28 +69,15 @@ int acceptor::stripe_coherent_parity_write(
   Expects(wqd);
   Expects(wqp);
 
-  auto make_a_new_completer{
-      [=, this](std::shared_ptr<write_query> wq) {
-        return [=, this, wq = std::move(wq)](write_query const &new_wq) {
-          if (new_wq.err()) [[unlikely]] {
-            wq->set_err(new_wq.err());
-            Expects(stripe_id_at < stripe_parity_coherency_state_.size());
-            stripe_parity_coherency_state_.reset(stripe_id_at);
-            return;
-          }
-        };
-      },
-  };
-
-  auto *p_wqd = wqd.get();
-  wqd = write_query::create(p_wqd->buf(), p_wqd->offset(),
-                            make_a_new_completer(std::move(wqd)));
-
-  auto *p_wqp = wqp.get();
-  wqp = write_query::create(p_wqp->buf(), p_wqp->offset(),
-                            make_a_new_completer(std::move(wqp)));
-
-  return be_->stripe_write(stripe_id_at, std::move(wqd), std::move(wqp));
+  return be_->stripe_write(stripe_id_at, std::move(wqd), std::move(wqp),
+                           [stripe_id_at, this](int err) {
+                             if (err) [[unlikely]] {
+                               Expects(stripe_id_at <
+                                       stripe_parity_coherency_state_.size());
+                               stripe_parity_coherency_state_.reset(
+                                   stripe_id_at);
+                             }
+                           });
 }
 
 int acceptor::stripe_write(uint64_t stripe_id_at,
@@ -156,6 +121,7 @@ int acceptor::stripe_data_write(uint64_t stripe_id_at,
   auto wqp{
       write_query::create(stripe_parity_buf_view, 0, std::move(wqp_completer)),
   };
+  wqp->set_fua(wqd->fua());
 
   /*
    * Write Back the chunk including the newly incoming full-stripe-sized data
@@ -232,6 +198,7 @@ int acceptor::process(uint64_t stripe_id,
                             }
                           }),
                   };
+                  wqp->set_fua(wq->fua());
 
                   /*
                    * Write Back the chunk including the newly incoming data
@@ -250,6 +217,7 @@ int acceptor::process(uint64_t stripe_id,
                 read_query::create(stripe_parity_buf_view, 0,
                                    std::move(new_rpq_completer)),
             };
+            new_rpq->set_trace_id(wq->trace_id());
 
             if (auto const res{
                     be_->parity_read(stripe_id, std::move(new_rpq)),
@@ -271,11 +239,9 @@ int acceptor::process(uint64_t stripe_id,
               return;
             }
 
-            auto const chunk{wq->buf()};
-
-            auto const copy_from{chunk};
+            auto const copy_from{wq->buf()};
             auto const copy_to{
-                stripe_data_buf_view.subspan(wq->offset(), chunk.size()),
+                stripe_data_buf_view.subspan(wq->offset(), copy_from.size()),
             };
 
             /* Modify the part of the stripe with the new data come in */
@@ -284,20 +250,6 @@ int acceptor::process(uint64_t stripe_id,
             /* Renew Parity of the stripe */
             parity_renew(stripe_data_buf_view, stripe_parity_buf_view);
 
-            auto wqd_completer{
-                [wq](write_query const &new_wq) {
-                  if (new_wq.err()) [[unlikely]] {
-                    wq->set_err(new_wq.err());
-                    return;
-                  }
-                },
-            };
-
-            auto new_wqd{
-                write_query::create(chunk, wq->offset(),
-                                    std::move(wqd_completer)),
-            };
-
             auto wqp_completer{
                 [wq, cached_stripe_sp = std::shared_ptr{std::move(
                          cached_stripe)}](write_query const &new_wq) {
@@ -312,14 +264,15 @@ int acceptor::process(uint64_t stripe_id,
                 write_query::create(stripe_parity_buf_view, 0,
                                     std::move(wqp_completer)),
             };
+            new_wqp->set_fua(wq->fua());
 
             /*
              * Write Back the chunk including the newly incoming data
              * and the parity computed and updated
              */
             if (auto const res{
-                    stripe_incoherent_parity_write(
-                        stripe_id, std::move(new_wqd), std::move(new_wqp)),
+                    stripe_incoherent_parity_write(stripe_id, wq,
+                                                   std::move(new_wqp)),
                 }) [[unlikely]] {
               wq->set_err(res);
               return;
@@ -331,6 +284,9 @@ int acceptor::process(uint64_t stripe_id,
                                    std::move(new_rdq_completer));
     }
 
+    new_rqd->set_trace_id(wq->trace_id());
+    trace::record("raidsp.rmw", wq->trace_id());
+
     if (auto const res{be_->data_read(stripe_id, std::move(new_rqd))})
         [[unlikely]] {
       return res;
@@ -348,6 +304,22 @@ int acceptor::process(uint64_t stripe_id,
   return 0;
 }
 
+void acceptor::stripe_unlock(uint64_t stripe_id) noexcept {
+  for (bool finish = false; !finish;) {
+    if (auto next_wq_it = std::ranges::find(
+            wqs_pending_, stripe_id,
+            [](auto const &wq_pend) { return wq_pend.first; });
+        next_wq_it != wqs_pending_.end()) {
+      finish = 0 == process(stripe_id, next_wq_it->second);
+      std::iter_swap(next_wq_it, wqs_pending_.end() - 1);
+      wqs_pending_.pop_back();
+    } else {
+      stripe_w_locker_.unlock(stripe_id);
+      finish = true;
+    }
+  }
+}
+
 int acceptor::process(std::shared_ptr<write_query> wq) noexcept {
   Expects(wq);
   Expects(!wq->buf().empty());
@@ -370,19 +342,7 @@ int acceptor::process(std::shared_ptr<write_query> wq) noexcept {
           if (new_wq.err()) [[unlikely]]
             wq->set_err(new_wq.err());
 
-          for (bool finish = false; !finish;) {
-            if (auto next_wq_it = std::ranges::find(
-                    wqs_pending_, stripe_id,
-                    [](auto const &wq_pend) { return wq_pend.first; });
-                next_wq_it != wqs_pending_.end()) {
-              finish = 0 == process(stripe_id, next_wq_it->second);
-              std::iter_swap(next_wq_it, wqs_pending_.end() - 1);
-              wqs_pending_.pop_back();
-            } else {
-              stripe_w_locker_.unlock(stripe_id);
-              finish = true;
-            }
-          }
+          stripe_unlock(stripe_id);
         },
     };
 
@@ -401,4 +361,58 @@ int acceptor::process(std::shared_ptr<write_query> wq) noexcept {
   return 0;
 }
 
+int acceptor::process(std::shared_ptr<discard_query> dq) noexcept {
+  Expects(dq);
+
+  auto const &cfg{be_->static_cfg()};
+
+  auto const stripe_id_first{div_round_up(dq->offset(), cfg.stripe_data_sz)};
+  auto const stripe_id_end{(dq->offset() + dq->size()) / cfg.stripe_data_sz};
+
+  if (!be_->discard_supported() || !(stripe_id_first < stripe_id_end))
+    return 0;
+
+  stripe_w_locker_.extend(stripe_id_end);
+  stripe_parity_coherency_state_.resize(stripe_w_locker_.size());
+
+  /*
+   * Stripes being written at the moment are skipped, a discard is no more than
+   * a hint. The rest get discarded by runs of stripes following each other
+   */
+  for (auto stripe_id{stripe_id_first}; stripe_id < stripe_id_end;) {
+    if (!stripe_w_locker_.try_lock(stripe_id)) {
+      ++stripe_id;
+      continue;
+    }
+
+    auto const stripe_id_from{stripe_id};
+    for (++stripe_id;
+         stripe_id < stripe_id_end && stripe_w_locker_.try_lock(stripe_id);
+         ++stripe_id) {
+    }
+
+    auto const stripes_nr{stripe_id - stripe_id_from};
+    auto sq{
+        dq->subquery(stripe_id_from * cfg.strip_sz, stripes_nr * cfg.strip_sz,
+                     [dq, stripe_id_from, stripes_nr,
+                      this](discard_query const &sq) {
+                       if (sq.err()) [[unlikely]]
+                         dq->set_err(sq.err());
+
+                       for (auto id{stripe_id_from};
+                            id < stripe_id_from + stripes_nr; ++id) {
+                         stripe_parity_coherency_state_.reset(id);
+                         stripe_unlock(id);
+                       }
+                     }),
+    };
+
+    if (auto const res{be_->stripes_discard(std::move(sq))}) [[unlikely]] {
+      return res;
+    }
+  }
+
+  return 0;
+}
+
 } // namespace ublk::raidsp
@@ -16,6 +16,8 @@
 #include "utils/bitset_locker.hpp"
 #include "utils/utility.hpp"
 
+#include "discard_handler_interface.hpp"
+#include "discard_query.hpp"
 #include "read_query.hpp"
 #include "rw_handler_interface.hpp"
 #include "write_query.hpp"
@@ -28,13 +30,20 @@ class acceptor final {
 public:
   explicit acceptor(
       uint64_t strip_sz, std::vector<std::shared_ptr<IRWHandler>> hs,
-      std::function<uint64_t(uint64_t stripe_id)> stripe_id_to_parity_id);
+      std::function<uint64_t(uint64_t stripe_id)> stripe_id_to_parity_id,
+      std::vector<std::shared_ptr<IDiscardHandler>> dhs = {});
   ~acceptor() = default;
 
   bool is_stripe_parity_coherent(uint64_t stripe_id) const noexcept;
 
   int process(std::shared_ptr<read_query> rq) noexcept;
   int process(std::shared_ptr<write_query> wq) noexcept;
+  /*
+   * Whole stripes only get discarded, all their strips parity included. Not
+   * every member reads back zeroes after a discard, so the stripes discarded
+   * get their parity incoherent, the rest is left intact
+   */
+  int process(std::shared_ptr<discard_query> dq) noexcept;
 
 private:
   constexpr static auto kCachedStripeAlignment = backend::kAlignmentRequiredMin;
@@ -61,6 +70,9 @@ private:
 
   int process(uint64_t stripe_id, std::shared_ptr<write_query> wq) noexcept;
 
+  /* Hands the stripe over to the next write pending it, if there is any */
+  void stripe_unlock(uint64_t stripe_id) noexcept;
+
   std::unique_ptr<backend> be_;
   bitset_locker<uint64_t, mm::allocator::cache_line_aligned_allocator<uint64_t>>
       stripe_w_locker_;
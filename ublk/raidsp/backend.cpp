@@ -11,6 +11,10 @@
 
 #include "mm/mem.hpp"
 
+#include "trace/trace.hpp"
+
+#include "fanout.hpp"
+
 namespace {
 
 auto handlers_data_view(
@@ -35,14 +39,18 @@ namespace ublk::raidsp {
 
 backend::backend(
     uint64_t strip_sz, std::vector<std::shared_ptr<IRWHandler>> hs,
-    std::function<uint64_t(uint64_t stripe_id)> stripe_id_to_parity_id)
-    : hs_(std::move(hs)),
+    std::function<uint64_t(uint64_t stripe_id)> stripe_id_to_parity_id,
+    std::vector<std::shared_ptr<IDiscardHandler>> dhs /* = {}*/)
+    : hs_(std::move(hs)), dhs_(std::move(dhs)),
       stripe_id_to_parity_id_(std::move(stripe_id_to_parity_id)) {
   Ensures(is_power_of_2(strip_sz));
   Ensures(is_multiple_of(strip_sz, kAlignmentRequiredMin));
   Ensures(!(hs_.size() < 3));
   Ensures(std::ranges::all_of(
       hs_, [](auto const &h) { return static_cast<bool>(h); }));
+  Ensures(dhs_.empty() || dhs_.size() == hs_.size());
+  Ensures(std::ranges::all_of(
+      dhs_, [](auto const &h) { return static_cast<bool>(h); }));
   Ensures(stripe_id_to_parity_id_);
 
   auto cfg = mm::make_unique_aligned<struct static_cfg>(
@@ -62,10 +70,16 @@ int backend::data_read(uint64_t stripe_id_from,
   auto stripe_id{stripe_id_from};
   auto stripe_offset{rq->offset()};
 
-  for (size_t rb{0}; rb < rq->buf().size(); ++stripe_id, stripe_offset = 0) {
+  auto const rq_sz{rq->buf().size()};
+  auto const sqs_nr{
+      div_round_up(stripe_offset % static_cfg_->strip_sz + rq_sz,
+                   static_cfg_->strip_sz),
+  };
+  auto fo{fanout<read_query>::create(std::move(rq), sqs_nr)};
+
+  for (size_t rb{0}; rb < rq_sz; ++stripe_id, stripe_offset = 0) {
     auto chunk_sz{
-        std::min(static_cfg_->stripe_data_sz - stripe_offset,
-                 rq->buf().size() - rb),
+        std::min(static_cfg_->stripe_data_sz - stripe_offset, rq_sz - rb),
     };
 
     auto const strip_id_first{stripe_offset / static_cfg_->strip_sz};
@@ -87,7 +101,7 @@ int backend::data_read(uint64_t stripe_id_from,
       auto const sq_sz{
           std::min(static_cfg_->strip_sz - strip_offset, chunk_sz),
       };
-      auto new_rq{rq->subquery(rb, sq_sz, sq_off, rq)};
+      auto new_rq{fo->subquery(rb, sq_sz, sq_off)};
       if (auto const res{h->submit(std::move(new_rq))}) [[unlikely]] {
         return res;
       }
@@ -109,6 +123,8 @@ int backend::parity_read(uint64_t stripe_id,
   auto const strip_parity_id{stripe_id_to_strip_parity_id(stripe_id)};
   Ensures(strip_parity_id < hs_.size());
 
+  trace::record("raidsp.parity_read", rq->trace_id());
+
   return hs_[strip_parity_id]->submit(
       rq->subquery(0, std::min(static_cfg_->strip_sz, rq->buf().size()),
                    stripe_id * static_cfg_->strip_sz, rq));
@@ -116,7 +132,8 @@ int backend::parity_read(uint64_t stripe_id,
 
 int backend::stripe_write(uint64_t stripe_id_at,
                           std::shared_ptr<write_query> wqd,
-                          std::shared_ptr<write_query> wqp) noexcept {
+                          std::shared_ptr<write_query> wqp,
+                          std::function<void(int err)> &&completer) noexcept {
   Expects(wqd);
   Expects(!wqd->buf().empty());
   Expects(!(wqd->offset() + wqd->buf().size() > static_cfg_->stripe_data_sz));
@@ -137,25 +154,42 @@ int backend::stripe_write(uint64_t stripe_id_at,
                          strip_id_last - strip_id_first),
   };
 
+  /* the parity is traced along with the data it has been computed of */
+  wqp->set_trace_id(wqd->trace_id());
+  trace::record("raidsp.stripe_write", wqd->trace_id());
+
+  auto const wqd_sz{wqd->buf().size()};
+  auto const wqd_offset{wqd->offset()};
+  auto const wqp_sz{wqp->buf().size()};
+  auto const wqp_offset{wqp->offset()};
+
+  /* data strips and the parity one complete as a whole */
+  auto fo{
+      fanout<write_query>::create(strip_id_last - strip_id_first + 1,
+                                  std::move(completer)),
+  };
+  auto const wqd_id{fo->parent(std::move(wqd))};
+  auto const wqp_id{fo->parent(std::move(wqp))};
+
   size_t wb{0};
-  for (auto strip_offset{wqd->offset() % static_cfg_->strip_sz};
+  for (auto strip_offset{wqd_offset % static_cfg_->strip_sz};
        auto const &h : hs) {
     auto const sq_off{stripe_id_at * static_cfg_->strip_sz + strip_offset};
     auto const sq_sz{
-        std::min(static_cfg_->strip_sz - strip_offset, wqd->buf().size() - wb),
+        std::min(static_cfg_->strip_sz - strip_offset, wqd_sz - wb),
     };
-    auto new_wqd{wqd->subquery(wb, sq_sz, sq_off, wqd)};
+    auto new_wqd{fo->subquery(wqd_id, wb, sq_sz, sq_off)};
     if (auto const res{h->submit(std::move(new_wqd))}) [[unlikely]] {
       return res;
     }
     wb += sq_sz;
     strip_offset = 0;
   }
-  Ensures(!(wb < wqd->buf().size()));
+  Ensures(!(wb < wqd_sz));
 
   auto new_wqp{
-      wqp->subquery(0, wqp->buf().size(),
-                    stripe_id_at * static_cfg_->strip_sz + wqp->offset(), wqp),
+      fo->subquery(wqp_id, 0, wqp_sz,
+                   stripe_id_at * static_cfg_->strip_sz + wqp_offset),
   };
 
   if (auto const res{hs_[strip_parity_id]->submit(std::move(new_wqp))})
@@ -166,4 +200,22 @@ int backend::stripe_write(uint64_t stripe_id_at,
   return 0;
 }
 
+int backend::stripes_discard(std::shared_ptr<discard_query> dq) noexcept {
+  Expects(dq);
+  Expects(0 != dq->size());
+  Expects(is_multiple_of(dq->offset(), static_cfg_->strip_sz));
+  Expects(is_multiple_of(dq->size(), static_cfg_->strip_sz));
+
+  trace::record("raidsp.stripes_discard", dq->trace_id());
+
+  for (auto const &h : dhs_) {
+    if (auto const res{h->submit(dq)}) [[unlikely]] {
+      dq->set_err(res);
+      return res;
+    }
+  }
+
+  return 0;
+}
+
 } // namespace ublk::raidsp
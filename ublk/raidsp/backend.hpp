@@ -10,6 +10,8 @@
 
 #include "utils/utility.hpp"
 
+#include "discard_handler_interface.hpp"
+#include "discard_query.hpp"
 #include "rw_handler_interface.hpp"
 #include "sector.hpp"
 
@@ -28,7 +30,8 @@ public:
 
   explicit backend(
       uint64_t strip_sz, std::vector<std::shared_ptr<IRWHandler>> hs,
-      std::function<uint64_t(uint64_t stripe_id)> stripe_id_to_parity_id);
+      std::function<uint64_t(uint64_t stripe_id)> stripe_id_to_parity_id,
+      std::vector<std::shared_ptr<IDiscardHandler>> dhs = {});
   ~backend() = default;
 
   backend(backend const &) = delete;
@@ -43,7 +46,16 @@ public:
   int parity_read(uint64_t stripe_id, std::shared_ptr<read_query> rq) noexcept;
 
   int stripe_write(uint64_t stripe_id_at, std::shared_ptr<write_query> wqd,
-                   std::shared_ptr<write_query> wqp) noexcept;
+                   std::shared_ptr<write_query> wqp,
+                   std::function<void(int err)> &&completer = {}) noexcept;
+
+  bool discard_supported() const noexcept { return !dhs_.empty(); }
+
+  /*
+   * The query's range is of the members' address space, all of them get it
+   * discarded, the parity ones included
+   */
+  int stripes_discard(std::shared_ptr<discard_query> dq) noexcept;
 
   struct static_cfg const &static_cfg() const noexcept { return *static_cfg_; }
 
@@ -53,6 +65,7 @@ private:
   }
 
   std::vector<std::shared_ptr<IRWHandler>> hs_;
+  std::vector<std::shared_ptr<IDiscardHandler>> dhs_;
   std::function<uint64_t(uint64_t stripe_id)> stripe_id_to_parity_id_;
 
   mm::uptrwd<struct static_cfg const> static_cfg_;
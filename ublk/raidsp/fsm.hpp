@@ -6,6 +6,7 @@
 
 #include <boost/sml.hpp>
 
+#include "discard_query.hpp"
 #include "read_query.hpp"
 #include "write_query.hpp"
 
@@ -25,6 +26,11 @@ struct wq {
   mutable int r;
 };
 
+struct dq {
+  std::shared_ptr<discard_query> dq;
+  mutable int r;
+};
+
 struct stripecohcheck {
   uint64_t stripe_id;
   mutable bool r;
@@ -55,6 +61,11 @@ struct transition_table {
                              process(ev::fail{});
                            }
                          },
+        /* discards failing leave stripes incoherent, the array keeps online */
+        "online"_s + event<ev::dq> /
+                         [](ev::dq const &e, acceptor &acc) {
+                           e.r = acc.process(e.dq);
+                         },
         "online"_s + event<ev::stripecohcheck> /
                          [](ev::stripecohcheck const &e, acceptor const &r) {
                            e.r = r.is_stripe_parity_coherent(e.stripe_id);
@@ -63,6 +74,7 @@ struct transition_table {
         // offline state
         "offline"_s + event<ev::rq> / [](ev::rq const &e) { e.r = EIO; },
         "offline"_s + event<ev::wq> / [](ev::wq const &e) { e.r = EIO; },
+        "offline"_s + event<ev::dq> / [](ev::dq const &e) { e.r = EIO; },
         "offline"_s + event<ev::stripecohcheck> /
                           [](ev::stripecohcheck const &e) { e.r = false; });
   }
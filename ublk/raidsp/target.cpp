@@ -12,6 +12,8 @@
 
 #include <gsl/assert>
 
+#include "discard_handler_interface.hpp"
+#include "discard_query.hpp"
 #include "read_query.hpp"
 #include "rw_handler_interface.hpp"
 #include "write_query.hpp"
@@ -25,8 +27,10 @@ class Target::impl final {
 public:
   explicit impl(
       uint64_t strip_sz, std::vector<std::shared_ptr<IRWHandler>> hs,
-      std::function<uint64_t(uint64_t stripe_id)> stripe_id_to_parity_id)
-      : acc_(strip_sz, std::move(hs), std::move(stripe_id_to_parity_id)),
+      std::function<uint64_t(uint64_t stripe_id)> stripe_id_to_parity_id,
+      std::vector<std::shared_ptr<IDiscardHandler>> dhs)
+      : acc_(strip_sz, std::move(hs), std::move(stripe_id_to_parity_id),
+             std::move(dhs)),
         fsm_(acc_) {}
 
   std::string state() const {
@@ -77,6 +81,15 @@ public:
     return e.r;
   }
 
+  int process(std::shared_ptr<discard_query> dq) noexcept {
+    Expects(dq);
+
+    fsm::ev::dq e{.dq = std::move(dq), .r = 0};
+    fsm_.process_event(e);
+
+    return e.r;
+  }
+
   bool is_stripe_parity_coherent(uint64_t stripe_id) const noexcept {
     fsm::ev::stripecohcheck e{.stripe_id = stripe_id, .r = false};
     fsm_.process_event(e);
@@ -92,9 +105,11 @@ private:
 
 Target::Target(
     uint64_t strip_sz, std::vector<std::shared_ptr<IRWHandler>> hs,
-    std::function<uint64_t(uint64_t stripe_id)> stripe_id_to_parity_id)
+    std::function<uint64_t(uint64_t stripe_id)> stripe_id_to_parity_id,
+    std::vector<std::shared_ptr<IDiscardHandler>> dhs /* = {}*/)
     : pimpl_(std::make_unique<impl>(strip_sz, std::move(hs),
-                                    std::move(stripe_id_to_parity_id))) {}
+                                    std::move(stripe_id_to_parity_id),
+                                    std::move(dhs))) {}
 
 Target::~Target() noexcept = default;
 
@@ -115,4 +130,8 @@ int Target::process(std::shared_ptr<write_query> wq) noexcept {
   return pimpl_->process(std::move(wq));
 }
 
+int Target::process(std::shared_ptr<discard_query> dq) noexcept {
+  return pimpl_->process(std::move(dq));
+}
+
 } // namespace ublk::raidsp
@@ -8,8 +8,10 @@
 #include <string>
 #include <vector>
 
+#include "discard_handler_interface.hpp"
 #include "rw_handler_interface.hpp"
 
+#include "discard_query.hpp"
 #include "read_query.hpp"
 #include "write_query.hpp"
 
@@ -19,7 +21,8 @@ class Target final {
 public:
   explicit Target(
       uint64_t strip_sz, std::vector<std::shared_ptr<IRWHandler>> hs,
-      std::function<uint64_t(uint64_t stripe_id)> stripe_id_to_parity_id);
+      std::function<uint64_t(uint64_t stripe_id)> stripe_id_to_parity_id,
+      std::vector<std::shared_ptr<IDiscardHandler>> dhs = {});
 
   explicit Target(
       uint64_t strip_sz, std::ranges::input_range auto &&hs,
@@ -41,6 +44,8 @@ public:
 
   int process(std::shared_ptr<read_query> rq) noexcept;
   int process(std::shared_ptr<write_query> wq) noexcept;
+  /* Discards are dropped unless handlers of the members have been given */
+  int process(std::shared_ptr<discard_query> dq) noexcept;
 
 private:
   class impl;
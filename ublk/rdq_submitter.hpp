@@ -28,6 +28,10 @@ public:
     return rwh_->submit(std::move(rq));
   }
 
+  int submit(std::shared_ptr<readv_query> rq) noexcept override {
+    return rwh_->submit(std::move(rq));
+  }
+
 private:
   std::shared_ptr<IRWHandler> rwh_;
 };
@@ -2,9 +2,40 @@
 
 #include <memory>
 
+#include <gsl/assert>
+
 #include "read_query.hpp"
+#include "readv_query.hpp"
 #include "submitter_interface.hpp"
 
 namespace ublk {
-using IRDQSubmitter = ISubmitter<int(std::shared_ptr<read_query>) noexcept>;
+
+class IRDQSubmitter
+    : public ISubmitter<int(std::shared_ptr<read_query>) noexcept> {
+public:
+  using ISubmitter<int(std::shared_ptr<read_query>) noexcept>::submit;
+
+  /*
+   * Submitters unable to handle scatter-gather lists natively get a query per
+   * buffer of the list
+   */
+  virtual int submit(std::shared_ptr<readv_query> rq) noexcept {
+    Expects(rq);
+    auto offset{rq->offset()};
+    for (auto const buf : rq->bufs()) {
+      auto sq{
+          read_query::create(buf, offset, [rq](read_query const &sq) {
+            if (sq.err()) [[unlikely]]
+              rq->set_err(sq.err());
+          }),
+      };
+      sq->set_trace_id(rq->trace_id());
+      if (auto const res{submit(std::move(sq))}) [[unlikely]]
+        return res;
+      offset += buf.size();
+    }
+    return 0;
+  }
+};
+
 } // namespace ublk
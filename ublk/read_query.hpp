@@ -51,8 +51,10 @@ public:
       std::function<void(read_query const &)> &&completer = {}) const noexcept {
     Expects(0 != buf_sz);
     Expects(!(buf_offset + buf_sz > buf_.size()));
-    return create(buf_.subspan(buf_offset, buf_sz), rq_offset,
-                  std::move(completer));
+    auto sq{create(buf_.subspan(buf_offset, buf_sz), rq_offset,
+                   std::move(completer))};
+    sq->set_trace_id(trace_id());
+    return sq;
   }
 
   auto subquery(uint64_t buf_offset, uint64_t buf_sz, uint64_t rq_offset,
@@ -67,6 +69,7 @@ public:
 
   auto buf() noexcept { return buf_; }
   auto buf() const noexcept { return std::span<std::byte const>{buf_}; }
+  auto size() const noexcept { return buf_.size(); }
 
   auto offset() const noexcept { return offset_; }
 
@@ -1,6 +1,11 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+
 #include <memory>
+#include <optional>
+#include <span>
 #include <utility>
 
 #include <gsl/assert>
@@ -11,6 +16,7 @@
 
 #include "cells_holder.hpp"
 #include "req.hpp"
+#include "read_query.hpp"
 
 namespace ublk {
 
@@ -23,22 +29,15 @@ public:
   }
 
   read_req() = default;
-  explicit read_req(
-      ublkdrv_cmd const &cmd, std::span<ublkdrv_celld const> cellds,
-      std::span<std::byte> cells,
-      std::function<void(read_req const &)> &&completer = {}) noexcept
-      : req(cmd), cells_holder(cellds, cells),
-        completer_(std::move(completer)) {
+  explicit read_req(ublkdrv_cmd const &cmd,
+                     std::span<ublkdrv_celld const> cellds,
+                     std::span<std::byte> cells, completion c = {}) noexcept
+      : req(cmd, c), cells_holder(cellds, cells) {
     Ensures(UBLKDRV_CMD_OP_READ == ublkdrv_cmd_get_op(&req::cmd()));
   }
   ~read_req() noexcept override {
-    static_assert(std::is_nothrow_destructible_v<req>);
-    if (completer_) {
-      try {
-        completer_(*this);
-      } catch (...) {
-      }
-    }
+    if (q_ && q_->err()) [[unlikely]]
+      set_err(q_->err());
   }
 
   read_req(read_req const &) = delete;
@@ -49,8 +48,22 @@ public:
 
   auto const &cmd() const noexcept { return req::cmd().u.r; }
 
+  /*
+   * The query of a single-cell request is kept inside the request itself and
+   * shares its reference count, so neither gets allocated separately. Its
+   * error is passed to the request once all the references are gone
+   */
+  static std::shared_ptr<read_query>
+  inline_query(std::shared_ptr<read_req> req, std::span<std::byte> buf,
+               uint64_t offset) noexcept {
+    Expects(req);
+    Expects(!req->q_);
+    auto *p_q = &req->q_.emplace(buf, offset);
+    return {std::move(req), p_q};
+  }
+
 private:
-  std::function<void(read_req const &)> completer_;
+  std::optional<read_query> q_;
 };
 
 } // namespace ublk
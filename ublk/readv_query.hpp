@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <functional>
+#include <memory>
+#include <span>
+#include <utility>
+
+#include <gsl/assert>
+
+#include "mm/pool_allocators.hpp"
+
+#include "query.hpp"
+#include "sg_bufs.hpp"
+
+namespace ublk {
+
+/* Reads a contiguous range of the device into a scatter-gather list */
+class readv_query final : public query {
+public:
+  template <typename... Args> static auto create(Args &&...args) noexcept {
+    return std::allocate_shared<readv_query>(
+        mm::allocator::pool_cache_line_aligned<readv_query>::value,
+        std::forward<Args>(args)...);
+  }
+
+  readv_query() = default;
+
+  readv_query(sg_bufs<std::byte> bufs, uint64_t offset,
+              std::function<void(readv_query const &)> &&completer =
+                  {}) noexcept
+      : bufs_(std::move(bufs)), sz_(sg_size(bufs_)), offset_(offset),
+        completer_(std::move(completer)) {
+    Ensures(0 != sz_);
+  }
+  ~readv_query() {
+    if (completer_) {
+      try {
+        completer_(*this);
+      } catch (...) {
+      }
+    }
+  }
+
+  readv_query(readv_query const &) = delete;
+  readv_query &operator=(readv_query const &) = delete;
+
+  readv_query(readv_query &&) = default;
+  readv_query &operator=(readv_query &&) = default;
+
+  auto subquery(uint64_t buf_offset, uint64_t buf_sz, uint64_t rq_offset,
+                std::function<void(readv_query const &)> &&completer = {})
+      const noexcept {
+    Expects(0 != buf_sz);
+    Expects(!(buf_offset + buf_sz > sz_));
+    auto sq{create(sg_slice(bufs_, buf_offset, buf_sz), rq_offset,
+                   std::move(completer))};
+    sq->set_trace_id(trace_id());
+    return sq;
+  }
+
+  auto subquery(uint64_t buf_offset, uint64_t buf_sz, uint64_t rq_offset,
+                std::shared_ptr<readv_query> parent_rq) const noexcept {
+    return subquery(buf_offset, buf_sz, rq_offset,
+                    [parent_rq = std::move(parent_rq)](readv_query const &rq) {
+                      if (rq.err()) [[unlikely]] {
+                        parent_rq->set_err(rq.err());
+                      }
+                    });
+  }
+
+  std::span<std::span<std::byte> const> bufs() const noexcept {
+    return {bufs_.data(), bufs_.size()};
+  }
+  auto size() const noexcept { return sz_; }
+
+  auto offset() const noexcept { return offset_; }
+
+private:
+  sg_bufs<std::byte> bufs_;
+  uint64_t sz_;
+  uint64_t offset_;
+  std::function<void(readv_query const &)> completer_;
+};
+
+} // namespace ublk
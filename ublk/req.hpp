@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstdint>
+
 #include <linux/ublkdrv/celld.h>
 #include <linux/ublkdrv/cmd.h>
 
@@ -7,9 +9,19 @@ namespace ublk {
 
 class req {
 public:
+  /* Called once the request is done, right before it gets destroyed */
+  struct completion {
+    void (*f)(void *ctx, req const &rq) noexcept;
+    void *ctx;
+  };
+
   req() = default;
-  explicit req(ublkdrv_cmd const &cmd) noexcept : cmd_(cmd) {}
-  virtual ~req() = default;
+  explicit req(ublkdrv_cmd const &cmd, completion c = {}) noexcept
+      : cmd_(cmd), completion_(c) {}
+  virtual ~req() {
+    if (completion_.f)
+      completion_.f(completion_.ctx, *this);
+  }
 
   req(req const &) = delete;
   req &operator=(req const &) = delete;
@@ -17,14 +29,22 @@ public:
   req(req &&other) = delete;
   req &operator=(req &&other) = delete;
 
-  void set_err(int err) noexcept { err_ = err; }
-  int err() const noexcept { return err_; }
+  /* queries of a request might complete in different threads */
+  void set_err(int err) noexcept {
+    __atomic_store_n(&err_, err, __ATOMIC_RELAXED);
+  }
+  int err() const noexcept { return __atomic_load_n(&err_, __ATOMIC_RELAXED); }
 
   auto const &cmd() const noexcept { return cmd_; }
 
+  void set_trace_id(uint32_t id) noexcept { trace_id_ = id; }
+  uint32_t trace_id() const noexcept { return trace_id_; }
+
 private:
   ublkdrv_cmd cmd_{};
   int err_{0};
+  uint32_t trace_id_{0};
+  completion completion_{};
 };
 
 } // namespace ublk
@@ -35,6 +35,14 @@ public:
     return wh_->submit(std::move(wq));
   }
 
+  int submit(std::shared_ptr<readv_query> rq) noexcept override {
+    return rh_->submit(std::move(rq));
+  }
+
+  int submit(std::shared_ptr<writev_query> wq) noexcept override {
+    return wh_->submit(std::move(wq));
+  }
+
 private:
   std::shared_ptr<IRDQSubmitter> rh_;
   std::shared_ptr<IWRQSubmitter> wh_;
@@ -2,7 +2,9 @@
 
 #include "rdq_submitter_interface.hpp"
 #include "read_query.hpp"
+#include "readv_query.hpp"
 #include "write_query.hpp"
+#include "writev_query.hpp"
 #include "wrq_submitter_interface.hpp"
 
 namespace ublk {
@@ -18,6 +20,9 @@ public:
   IRWHandler(IRWHandler &&) = delete;
   IRWHandler &operator=(IRWHandler &&) = delete;
 
+  using IRDQSubmitter::submit;
+  using IWRQSubmitter::submit;
+
   int submit(std::shared_ptr<read_query> rq) noexcept override = 0;
   int submit(std::shared_ptr<write_query> wq) noexcept override = 0;
 };
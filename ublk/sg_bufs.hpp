@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <ranges>
+#include <span>
+
+#include <boost/container/small_vector.hpp>
+
+namespace ublk {
+
+/* Scatter-gather list, a command rarely spans more cells than that */
+template <typename T>
+using sg_bufs = boost::container::small_vector<std::span<T>, 8>;
+
+constexpr uint64_t sg_size(std::ranges::input_range auto const &bufs) noexcept {
+  auto sz{uint64_t{0}};
+  for (auto const &buf : bufs)
+    sz += buf.size();
+  return sz;
+}
+
+/* Buffers of a query, a query of a single buffer makes a list of one */
+constexpr auto sg_bufs_of(auto &q) noexcept {
+  if constexpr (requires { q.bufs(); })
+    return q.bufs();
+  else
+    return std::views::single(q.buf());
+}
+
+/* The part of the list [off, off + sz) bytes are within */
+template <std::ranges::input_range R>
+auto sg_slice(R const &bufs, uint64_t off, uint64_t sz) noexcept {
+  auto r{sg_bufs<typename std::ranges::range_value_t<R>::element_type>{}};
+  for (auto const &buf : bufs) {
+    if (!sz)
+      break;
+    if (!(off < buf.size())) {
+      off -= buf.size();
+      continue;
+    }
+    auto const n{std::min<uint64_t>(buf.size() - off, sz)};
+    r.push_back(buf.subspan(off, n));
+    off = 0;
+    sz -= n;
+  }
+  return r;
+}
+
+} // namespace ublk
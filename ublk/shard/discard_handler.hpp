@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+
+#include <gsl/assert>
+
+#include "discard_handler_interface.hpp"
+#include "discard_query.hpp"
+
+namespace ublk::shard {
+
+/*
+ * Splits discards by shard_sz long LBA ranges just the way RWHandler does
+ * with reads and writes, each piece is handed over to the shard owning it
+ */
+class DiscardHandler final : public IDiscardHandler {
+public:
+  explicit DiscardHandler(
+      uint64_t shard_sz,
+      std::vector<boost::asio::io_context::executor_type> exs,
+      std::vector<std::shared_ptr<IDiscardHandler>> hs)
+      : shard_sz_(shard_sz), exs_(std::move(exs)), hs_(std::move(hs)) {
+    Ensures(shard_sz_);
+    Ensures(!hs_.empty());
+    Ensures(exs_.size() == hs_.size());
+    Ensures(std::ranges::all_of(
+        hs_, [](auto const &h) { return static_cast<bool>(h); }));
+  }
+  ~DiscardHandler() override = default;
+
+  DiscardHandler(DiscardHandler const &) = delete;
+  DiscardHandler &operator=(DiscardHandler const &) = delete;
+
+  DiscardHandler(DiscardHandler &&) = delete;
+  DiscardHandler &operator=(DiscardHandler &&) = delete;
+
+  int submit(std::shared_ptr<discard_query> dq) noexcept override {
+    Expects(dq);
+
+    auto range_id{dq->offset() / shard_sz_};
+    auto range_offset{dq->offset() % shard_sz_};
+
+    for (uint64_t submitted_bytes{0}; submitted_bytes < dq->size();
+         ++range_id, range_offset = 0) {
+      auto const shard_id{range_id % hs_.size()};
+      auto const subquery_sz{
+          std::min(shard_sz_ - range_offset, dq->size() - submitted_bytes),
+      };
+
+      auto subquery{
+          subquery_sz == dq->size()
+              ? dq
+              : dq->subquery(dq->offset() + submitted_bytes, subquery_sz, dq),
+      };
+
+      boost::asio::post(exs_[shard_id], [h = hs_[shard_id],
+                                         subquery = std::move(subquery)] {
+        if (auto const res{h->submit(subquery)}) [[unlikely]]
+          subquery->set_err(res);
+      });
+
+      submitted_bytes += subquery_sz;
+    }
+
+    return 0;
+  }
+
+private:
+  uint64_t shard_sz_;
+  std::vector<boost::asio::io_context::executor_type> exs_;
+  std::vector<std::shared_ptr<IDiscardHandler>> hs_;
+};
+
+} // namespace ublk::shard
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/post.hpp>
+
+#include <gsl/assert>
+
+#include "flq_submitter_interface.hpp"
+
+namespace ublk::shard {
+
+/* Hands a flush over to every shard in the shard's own io_context */
+class FLQSubmitter final : public IFLQSubmitter {
+public:
+  explicit FLQSubmitter(std::vector<boost::asio::io_context::executor_type> exs,
+                        std::vector<std::shared_ptr<IFLQSubmitter>> hs)
+      : exs_(std::move(exs)), hs_(std::move(hs)) {
+    Ensures(exs_.size() == hs_.size());
+    Ensures(std::ranges::all_of(
+        hs_, [](auto const &h) { return static_cast<bool>(h); }));
+  }
+  ~FLQSubmitter() override = default;
+
+  FLQSubmitter(FLQSubmitter const &) = delete;
+  FLQSubmitter &operator=(FLQSubmitter const &) = delete;
+
+  FLQSubmitter(FLQSubmitter &&) = delete;
+  FLQSubmitter &operator=(FLQSubmitter &&) = delete;
+
+  int submit(std::shared_ptr<flush_query> fq) noexcept override {
+    for (size_t i{0}; i < hs_.size(); ++i) {
+      boost::asio::post(exs_[i], [h = hs_[i], fq] {
+        if (auto const res{h->submit(fq)}) [[unlikely]]
+          fq->set_err(res);
+      });
+    }
+    return 0;
+  }
+
+private:
+  std::vector<boost::asio::io_context::executor_type> exs_;
+  std::vector<std::shared_ptr<IFLQSubmitter>> hs_;
+};
+
+} // namespace ublk::shard
@@ -0,0 +1,75 @@
+#include "rw_handler.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <concepts>
+#include <utility>
+
+#include <boost/asio/post.hpp>
+
+#include <gsl/assert>
+
+#include "read_query.hpp"
+#include "write_query.hpp"
+
+namespace ublk::shard {
+
+RWHandler::RWHandler(uint64_t shard_sz,
+                     std::vector<boost::asio::io_context::executor_type> exs,
+                     std::vector<std::shared_ptr<IRWHandler>> hs)
+    : shard_sz_(shard_sz), exs_(std::move(exs)), hs_(std::move(hs)) {
+  Ensures(shard_sz_);
+  Ensures(!hs_.empty());
+  Ensures(exs_.size() == hs_.size());
+  Ensures(std::ranges::all_of(
+      hs_, [](auto const &h) { return static_cast<bool>(h); }));
+}
+
+template <typename T>
+  requires std::same_as<T, write_query> || std::same_as<T, read_query>
+int RWHandler::do_op(std::shared_ptr<T> query) noexcept {
+  Expects(query);
+  Expects(!query->buf().empty());
+
+  auto range_id{query->offset() / shard_sz_};
+  auto range_offset{query->offset() % shard_sz_};
+
+  for (size_t submitted_bytes{0}; submitted_bytes < query->buf().size();
+       ++range_id, range_offset = 0) {
+    auto const shard_id{range_id % hs_.size()};
+    auto const subquery_sz{
+        std::min(shard_sz_ - range_offset,
+                 query->buf().size() - submitted_bytes),
+    };
+
+    /* Queries not crossing a range boundary are handed over as they are */
+    auto subquery{
+        subquery_sz == query->buf().size()
+            ? query
+            : query->subquery(submitted_bytes, subquery_sz,
+                              query->offset() + submitted_bytes, query),
+    };
+
+    boost::asio::post(exs_[shard_id], [h = hs_[shard_id],
+                                       subquery = std::move(subquery)] {
+      if (auto const res{h->submit(subquery)}) [[unlikely]]
+        subquery->set_err(res);
+    });
+
+    submitted_bytes += subquery_sz;
+  }
+
+  return 0;
+}
+
+int RWHandler::submit(std::shared_ptr<read_query> rq) noexcept {
+  return do_op(std::move(rq));
+}
+
+int RWHandler::submit(std::shared_ptr<write_query> wq) noexcept {
+  return do_op(std::move(wq));
+}
+
+} // namespace ublk::shard
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+
+#include <concepts>
+#include <memory>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+
+#include "rw_handler_interface.hpp"
+
+namespace ublk::shard {
+
+/*
+ * Splits queries by shard_sz long LBA ranges and hands each piece over to
+ * the handler of the shard owning the range, in the shard's own io_context.
+ * Ranges are assigned to shards round-robin
+ */
+class RWHandler final : public IRWHandler {
+public:
+  explicit RWHandler(uint64_t shard_sz,
+                     std::vector<boost::asio::io_context::executor_type> exs,
+                     std::vector<std::shared_ptr<IRWHandler>> hs);
+  ~RWHandler() override = default;
+
+  RWHandler(RWHandler const &) = delete;
+  RWHandler &operator=(RWHandler const &) = delete;
+
+  RWHandler(RWHandler &&) = delete;
+  RWHandler &operator=(RWHandler &&) = delete;
+
+  int submit(std::shared_ptr<read_query> rq) noexcept override;
+  int submit(std::shared_ptr<write_query> wq) noexcept override;
+
+private:
+  template <typename T>
+    requires std::same_as<T, write_query> || std::same_as<T, read_query>
+  int do_op(std::shared_ptr<T> query) noexcept;
+
+  uint64_t shard_sz_;
+  std::vector<boost::asio::io_context::executor_type> exs_;
+  std::vector<std::shared_ptr<IRWHandler>> hs_;
+};
+
+} // namespace ublk::shard
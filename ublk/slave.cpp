@@ -1,14 +1,29 @@
 #include "slave.hpp"
 
+#include <cerrno>
+#include <cstdint>
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
 #include <algorithm>
+#include <exception>
 #include <filesystem>
 #include <format>
 #include <initializer_list>
 #include <memory>
 #include <ranges>
 #include <span>
+#include <sstream>
 #include <stdexcept>
+#include <stop_token>
+#include <string>
 #include <string_view>
+#include <system_error>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -19,6 +34,7 @@
 #include <linux/ublkdrv/def.h>
 #include <linux/ublkdrv/mapping.h>
 
+#include <boost/asio/executor_work_guard.hpp>
 #include <boost/asio/io_context.hpp>
 #include <boost/lexical_cast.hpp>
 
@@ -30,6 +46,10 @@
 #include "sys/file.hpp"
 #include "sys/page.hpp"
 
+#include "trace/trace.hpp"
+
+#include "def/uring.hpp"
+
 #include "cmd_acknowledger.hpp"
 #include "handler.hpp"
 #include "qublkcmd.hpp"
@@ -79,6 +99,69 @@ auto maps_fetch(std::string_view bdev_name) {
   return maps;
 }
 
+/*
+ * Never follows nor overwrites anything already there, the slave runs
+ * privileged
+ */
+void trace_dump(std::filesystem::path const &path) {
+  auto out{std::ostringstream{}};
+  trace::dump(out);
+  auto const s{std::move(out).str()};
+
+  auto const fd{
+      sys::open(path, O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC,
+                S_IRUSR | S_IWUSR),
+  };
+  for (auto off{0uz}; off < s.size();) {
+    auto const r{write(*fd, s.data() + off, s.size() - off)};
+    if (r < 0) {
+      if (EINTR == errno)
+        continue;
+      throw std::system_error(errno, std::generic_category(), "write");
+    }
+    off += static_cast<size_t>(r);
+  }
+}
+
+/*
+ * SIGUSR1 is blocked for every thread of the slave and gets waited for by a
+ * dedicated one, so the trace gets dumped outside of a signal handler's
+ * context. Every dump goes into a file of its own
+ */
+std::jthread trace_dumper_start(std::filesystem::path prefix) {
+  sigset_t sigs;
+  sigemptyset(&sigs);
+  sigaddset(&sigs, SIGUSR1);
+  if (auto const r{pthread_sigmask(SIG_BLOCK, &sigs, nullptr)}) [[unlikely]]
+    throw std::system_error(r, std::generic_category(), "pthread_sigmask");
+
+  return std::jthread{[sigs, prefix = std::move(prefix)](std::stop_token st) {
+    auto dump_id{uint64_t{0}};
+    for (int sig{0}; 0 == sigwait(&sigs, &sig) && !st.stop_requested();) {
+      auto const path{
+          std::filesystem::path{
+              std::format("{}-{}.json", prefix.string(), dump_id++),
+          },
+      };
+      try {
+        trace_dump(path);
+        spdlog::info("trace dumped to {}", path.string());
+      } catch (std::exception const &ex) {
+        spdlog::error("failed to dump trace to {}: {}", path.string(),
+                      ex.what());
+      }
+    }
+  }};
+}
+
+void trace_dumper_stop(std::jthread &dumper) {
+  if (!dumper.joinable())
+    return;
+  dumper.request_stop();
+  pthread_kill(dumper.native_handle(), SIGUSR1);
+  dumper.join();
+}
+
 } // namespace
 
 namespace ublk::slave {
@@ -192,19 +275,60 @@ void run(boost::asio::io_context &io_ctx, slave_param const &param) {
   if (!fd_notify)
     _exit(EXIT_FAILURE);
 
+  /*
+   * Requests' data lives in the cells, native io_uring engines get them
+   * registered as fixed buffers
+   */
+  auto io_ctxs{param.workers_io_ctxs};
+  io_ctxs.push_back(&io_ctx);
+  for (auto *ctx : io_ctxs) {
+    if (auto *ring{def::uring::find(*ctx)}) {
+      ring->buffers_register(
+          {structured_maps.p_cells.get(), structured_maps.cells_sz});
+    }
+  }
+
   Expects(param.hfactory);
   auto handler = param.hfactory->create_unique(
       {structured_maps.p_cellc->cellds, structured_maps.p_cellc->cellds_len},
       {structured_maps.p_cells.get(), structured_maps.cells_sz},
-      std::make_unique<CmdAcknowledger>(std::move(structured_maps.p_qcmd_ack),
-                                        std::move(fd_notify)));
+      std::make_shared<CmdAcknowledger>(
+          io_ctx, std::move(structured_maps.p_qcmd_ack), std::move(fd_notify),
+          param.ack));
+
+  auto const stats{
+      async_start(uio_devs, io_ctx, std::move(structured_maps.p_qcmd),
+                  std::move(handler), param.handler),
+  };
+
+  /* must go before any other thread gets started */
+  auto trace_dumper{std::jthread{}};
+  if (param.trace_sample_every) {
+    trace::enable(param.trace_sample_every);
+    trace_dumper = trace_dumper_start(
+        param.trace_dir /
+        std::format("ublk-{}-{}", param.bdev_suffix, getpid()));
+  }
 
-  async_start(uio_devs, io_ctx, std::move(structured_maps.p_qcmd),
-              std::move(handler));
+  std::vector<std::jthread> workers;
+  for (auto *worker_io_ctx : param.workers_io_ctxs) {
+    Expects(worker_io_ctx);
+    workers.emplace_back([worker_io_ctx] {
+      auto const work_guard{boost::asio::make_work_guard(*worker_io_ctx)};
+      worker_io_ctx->run();
+    });
+  }
 
   io_ctx.run();
 
-  spdlog::info("{} finished", getpid());
+  for (auto *worker_io_ctx : param.workers_io_ctxs)
+    worker_io_ctx->stop();
+  workers.clear();
+
+  trace_dumper_stop(trace_dumper);
+
+  spdlog::info("{} finished, poll hits {}, poll misses {}", getpid(),
+               stats->poll_hits, stats->poll_misses);
 
   _exit(0);
 }
@@ -1,14 +1,22 @@
 #pragma once
 
+#include <cstdint>
+
+#include <filesystem>
 #include <memory>
 #include <span>
 #include <string>
+#include <vector>
 
 #include <linux/ublkdrv/celld.h>
 #include <linux/ublkdrv/cmd.h>
 #include <linux/ublkdrv/cmd_ack.h>
 
+#include <boost/asio/io_context.hpp>
+
+#include "cmd_ack_param.hpp"
 #include "factory_unique_interface.hpp"
+#include "handler_param.hpp"
 #include "handler_interface.hpp"
 
 namespace ublk::slave {
@@ -19,6 +27,11 @@ struct slave_param {
       std::span<ublkdrv_celld const>, std::span<std::byte>,
       std::shared_ptr<IHandler<int(ublkdrv_cmd_ack) noexcept>>)>>
       hfactory;
+  cmd_ack_param ack;
+  handler_param handler;
+  std::vector<boost::asio::io_context *> workers_io_ctxs;
+  uint32_t trace_sample_every;
+  std::filesystem::path trace_dir;
 };
 
 } // namespace ublk::slave
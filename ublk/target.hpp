@@ -3,6 +3,7 @@
 #include <memory>
 #include <span>
 #include <utility>
+#include <vector>
 
 #include <linux/ublkdrv/celld.h>
 #include <linux/ublkdrv/cmd.h>
@@ -14,9 +15,14 @@
 #include "factory_unique_interface.hpp"
 #include "handler_interface.hpp"
 #include "target_properties.hpp"
+#include "target_stats.hpp"
 
 namespace ublk {
 
+namespace qos {
+class control;
+} // namespace qos
+
 class Target {
 public:
   explicit Target(
@@ -26,9 +32,15 @@ public:
               std::span<ublkdrv_celld const>, std::span<std::byte>,
               std::shared_ptr<IHandler<int(ublkdrv_cmd_ack) noexcept>>)>>
           hfactory,
-      target_properties const &props)
-      : io_ctx_(std::move(io_ctx)), hfactory_(std::move(hfactory)),
-        props_(props) {
+      target_properties const &props,
+      std::vector<std::unique_ptr<boost::asio::io_context>> workers_io_ctxs =
+          {},
+      std::shared_ptr<target_stats> stats = {},
+      std::shared_ptr<qos::control> qos = {})
+      : io_ctx_(std::move(io_ctx)),
+        workers_io_ctxs_(std::move(workers_io_ctxs)),
+        hfactory_(std::move(hfactory)), props_(props),
+        stats_(std::move(stats)), qos_(std::move(qos)) {
     Ensures(io_ctx_);
     Ensures(hfactory_);
   }
@@ -43,16 +55,28 @@ public:
   boost::asio::io_context &io_ctx() noexcept { return *io_ctx_; }
   boost::asio::io_context const &io_ctx() const noexcept { return *io_ctx_; }
 
+  auto workers_io_ctxs() const noexcept {
+    std::vector<boost::asio::io_context *> out;
+    for (auto const &io_ctx : workers_io_ctxs_)
+      out.push_back(io_ctx.get());
+    return out;
+  }
+
   auto const &req_hfactory() const noexcept { return hfactory_; }
   auto const &properties() const noexcept { return props_; }
+  auto const &stats() const noexcept { return stats_; }
+  auto const &qos() const noexcept { return qos_; }
 
 private:
   std::unique_ptr<boost::asio::io_context> io_ctx_;
+  std::vector<std::unique_ptr<boost::asio::io_context>> workers_io_ctxs_;
   std::shared_ptr<IFactoryUnique<IHandler<int(ublkdrv_cmd const &) noexcept>(
       std::span<ublkdrv_celld const>, std::span<std::byte>,
       std::shared_ptr<IHandler<int(ublkdrv_cmd_ack) noexcept>>)>>
       hfactory_;
   target_properties props_;
+  std::shared_ptr<target_stats> stats_;
+  std::shared_ptr<qos::control> qos_;
 };
 
 } // namespace ublk
@@ -12,20 +12,110 @@ namespace ublk {
 
 struct target_null_cfg {};
 
-struct target_inmem_cfg {};
+struct target_inmem_cfg {
+  /*
+   * Memory is reserved, not allocated: pages get backed once written to and
+   * given back by discards, the untouched ones read back as zeroes
+   */
+  bool sparse;
+};
+
+/*
+ * Keeps the data in memory compressed page by page, pages of zeroes take no
+ * memory at all
+ */
+struct target_zram_cfg {};
 
 struct cache_cfg {
   uint64_t len_sectors;
   bool write_through_enable;
 };
 
+struct workers_cfg {
+  uint32_t nr;
+  /*
+   * LBA range length handed to the workers round-robin. 0 lets it be chosen
+   * to keep RAID stripes within one worker
+   */
+  uint64_t shard_len_sectors;
+};
+
+/* Turns the native io_uring engine on for the default targets */
+struct uring_cfg {
+  uint32_t sq_depth;
+  bool sqpoll;
+  uint32_t sqpoll_idle_ms;
+  bool iopoll;
+};
+
+/*
+ * Turns the thread pool engine on for the default targets instead, I/O goes
+ * down by blocking preadv2/pwritev2 of threads_nr threads, queue_depth queries
+ * queued up to each at most. 0 stands for the defaults of either
+ */
+struct psync_cfg {
+  uint32_t threads_nr;
+  uint32_t queue_depth;
+};
+
+/*
+ * Plugs queries to the default targets, LBA-adjacent ones get merged.
+ * max_sectors bounds the merged ones and splits longer ones, 0 for no bound.
+ * window_us of 0 merges the queries of a single batch of commands only
+ */
+struct plug_cfg {
+  uint64_t max_sectors;
+  uint32_t window_us;
+};
+
+/*
+ * Limits reads and writes of the target get throttled down to, 0 leaves the
+ * respective one off. The weight is the share of the backends the target gets
+ * while competing with other targets for them, 0 stands for the default of 100
+ */
+struct qos_cfg {
+  uint64_t read_iops;
+  uint64_t write_iops;
+  uint64_t read_bps;
+  uint64_t write_bps;
+  uint32_t weight;
+};
+
 struct target_default_cfg {
   std::filesystem::path path;
 };
 
+/*
+ * Serves the target out of the file mapped into memory, the data is synced
+ * back by flushes. populate prefaults the mapping at creation time, hugepages
+ * asks for transparent huge pages to back it. punch_holes lets discards give
+ * the space back, at the cost of the slave getting SIGBUS if the file system
+ * runs out of it
+ */
+struct target_mapped_cfg {
+  std::filesystem::path path;
+  bool populate;
+  bool hugepages;
+  bool punch_holes;
+};
+
+/*
+ * Concatenates the members one after another. lens_sectors are the lengths
+ * they contribute, those left 0 or not given take all of the member
+ */
+struct target_linear_cfg {
+  std::vector<std::filesystem::path> paths;
+  std::vector<uint64_t> lens_sectors;
+};
+
 struct target_raid0_cfg {
   uint64_t strip_len_sectors;
   std::vector<std::filesystem::path> paths;
+  /*
+   * Queries spanning more strips than there are members go down to a member
+   * as a single scatter-gather query instead of a query per strip
+   */
+  bool sg_coalesce;
 };
 
 struct target_raid1_cfg {
@@ -63,10 +153,16 @@ struct target_create_param {
   std::string name;
   uint64_t capacity_sectors;
   std::optional<cache_cfg> cache;
+  std::optional<workers_cfg> workers;
+  std::optional<uring_cfg> uring;
+  std::optional<psync_cfg> psync;
+  std::optional<plug_cfg> plug;
+  std::optional<qos_cfg> qos;
   std::variant<target_null_cfg, target_inmem_cfg, target_default_cfg,
                target_raid0_cfg, target_raid1_cfg, target_raid4_cfg,
                target_raid5_cfg, target_raid10_cfg, target_raid40_cfg,
-               target_raid50_cfg>
+               target_raid50_cfg, target_mapped_cfg, target_zram_cfg,
+               target_linear_cfg>
       target;
 };
 
@@ -2,8 +2,13 @@
 
 #include <cstddef>
 
+#include <vector>
+
+#include "backend_properties.hpp"
+
 namespace ublk {
 struct target_properties {
   size_t capacity_sectors;
+  std::vector<backend_properties> backends;
 };
 } // namespace ublk
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <string>
+
+#include "target_create_param.hpp"
+
+namespace ublk {
+
+struct target_qos_param {
+  std::string name;
+  qos_cfg qos;
+};
+
+} // namespace ublk
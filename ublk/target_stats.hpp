@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <type_traits>
+
+#include <linux/ublkdrv/cmd.h>
+
+namespace ublk {
+
+/*
+ * The i-th bucket counts latencies within [2^(i-1), 2^i) us, the 0th one
+ * those below 1 us and the last one everything beyond
+ */
+constexpr inline auto kLatBucketsNr{24uz};
+
+struct op_stats {
+  uint64_t ops;
+  uint64_t bytes;
+  uint64_t errs;
+  std::array<uint64_t, kLatBucketsNr> lat_us_hist;
+};
+
+/*
+ * Lives in shared memory mapped by the master before the slave is forked,
+ * the slave updates it and the master reads it while I/O is going on. Every
+ * field is accessed atomically, no locks are taken on either side
+ */
+struct target_stats {
+  struct {
+    op_stats read;
+    op_stats write;
+    op_stats flush;
+    op_stats discard;
+  } ops;
+  /* commands found in the command ring at the last kernel's notification */
+  uint64_t cmdb_occupancy;
+  /* acks not taken by the kernel out of the ack ring yet */
+  uint64_t cmdb_ack_occupancy;
+  /* commands taken out of the command ring but not acknowledged yet */
+  uint64_t cmds_inflight;
+  uint64_t cache_hits;
+  uint64_t cache_misses;
+  /* queries held back by the QoS limits and the time they have spent so */
+  uint64_t qos_throttled;
+  uint64_t qos_throttled_us;
+  /* queries held back for other targets to get their share of a backend */
+  uint64_t qos_fair_waits;
+  uint64_t qos_fair_wait_us;
+  /*
+   * Pages a zram target keeps compressed and the bytes they take, pages found
+   * to be all of zeroes and the memory taken from the system to store pages
+   */
+  uint64_t zram_pages_stored;
+  uint64_t zram_compr_bytes;
+  uint64_t zram_pages_zeroed;
+  uint64_t zram_mem_used;
+};
+
+static_assert(std::is_trivial_v<target_stats>);
+
+inline void stats_add(uint64_t &v, uint64_t n) noexcept {
+  __atomic_fetch_add(&v, n, __ATOMIC_RELAXED);
+}
+
+inline void stats_sub(uint64_t &v, uint64_t n) noexcept {
+  __atomic_fetch_sub(&v, n, __ATOMIC_RELAXED);
+}
+
+inline void stats_set(uint64_t &v, uint64_t n) noexcept {
+  __atomic_store_n(&v, n, __ATOMIC_RELAXED);
+}
+
+inline op_stats *stats_of(target_stats &stats, ublkdrv_cmd_op op) noexcept {
+  switch (op) {
+  case UBLKDRV_CMD_OP_READ:
+    return &stats.ops.read;
+  case UBLKDRV_CMD_OP_WRITE:
+    return &stats.ops.write;
+  case UBLKDRV_CMD_OP_FLUSH:
+    return &stats.ops.flush;
+  case UBLKDRV_CMD_OP_DISCARD:
+    return &stats.ops.discard;
+  default:
+    return nullptr;
+  }
+}
+
+inline void stats_account(op_stats &stats, uint64_t bytes, int err,
+                          std::chrono::nanoseconds lat) noexcept {
+  stats_add(stats.ops, 1);
+  stats_add(stats.bytes, bytes);
+  if (err) [[unlikely]]
+    stats_add(stats.errs, 1);
+
+  auto const lat_us{
+      static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::microseconds>(lat).count()),
+  };
+  stats_add(stats.lat_us_hist[std::min<size_t>(std::bit_width(lat_us),
+                                               kLatBucketsNr - 1)],
+            1);
+}
+
+/* Every field is loaded atomically, the whole is not a consistent cut */
+inline target_stats stats_snapshot(target_stats const &stats) noexcept {
+  auto out{target_stats{}};
+
+  static_assert(0 == sizeof(target_stats) % sizeof(uint64_t));
+  auto const *from{reinterpret_cast<uint64_t const *>(&stats)};
+  auto *to{reinterpret_cast<uint64_t *>(&out)};
+  for (size_t i{0}; i < sizeof(target_stats) / sizeof(uint64_t); ++i)
+    to[i] = __atomic_load_n(&from[i], __ATOMIC_RELAXED);
+
+  return out;
+}
+
+} // namespace ublk
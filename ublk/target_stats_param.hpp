@@ -0,0 +1,11 @@
+#pragma once
+
+#include <string>
+
+namespace ublk {
+
+struct target_stats_param {
+  std::string name;
+};
+
+} // namespace ublk
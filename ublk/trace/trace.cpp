@@ -0,0 +1,207 @@
+#include "trace.hpp"
+
+#include <unistd.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include <atomic>
+#include <chrono>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace {
+
+using namespace ublk::trace;
+
+constexpr auto kRingEventsNr{1uz << 14};
+
+struct event {
+  uint64_t ts_ns;
+  char const *name;
+  uint32_t id;
+  phase ph;
+};
+
+/*
+ * A flight recorder of a single thread: the owner thread overwrites the
+ * oldest events, anyone may read it concurrently. Every slot is guarded by
+ * a sequence number which is odd while the slot is being written to, the
+ * readers skip slots torn this way
+ */
+class ring final {
+public:
+  explicit ring(uint32_t tid) : tid_(tid), slots_(kRingEventsNr) {}
+
+  ring(ring const &) = delete;
+  ring &operator=(ring const &) = delete;
+
+  ring(ring &&) = delete;
+  ring &operator=(ring &&) = delete;
+
+  uint32_t tid() const noexcept { return tid_; }
+
+  void push(event const &e) noexcept {
+    auto const h{head_.load(std::memory_order_relaxed)};
+    auto &slot{slots_[h % slots_.size()]};
+
+    __atomic_store_n(&slot.seq, 2 * h + 1, __ATOMIC_RELAXED);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    __atomic_store_n(&slot.e.ts_ns, e.ts_ns, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot.e.name, e.name, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot.e.id, e.id, __ATOMIC_RELAXED);
+    __atomic_store_n(&slot.e.ph, e.ph, __ATOMIC_RELAXED);
+
+    __atomic_store_n(&slot.seq, 2 * h + 2, __ATOMIC_RELEASE);
+    head_.store(h + 1, std::memory_order_release);
+  }
+
+  void for_each(auto &&f) const {
+    auto const h{head_.load(std::memory_order_acquire)};
+    auto i{tail_.load(std::memory_order_relaxed)};
+    if (h - i > slots_.size())
+      i = h - slots_.size();
+
+    for (; i < h; ++i) {
+      auto const &slot{slots_[i % slots_.size()]};
+
+      if (__atomic_load_n(&slot.seq, __ATOMIC_ACQUIRE) != 2 * i + 2)
+        continue;
+
+      auto const e{
+          event{
+              .ts_ns = __atomic_load_n(&slot.e.ts_ns, __ATOMIC_RELAXED),
+              .name = __atomic_load_n(&slot.e.name, __ATOMIC_RELAXED),
+              .id = __atomic_load_n(&slot.e.id, __ATOMIC_RELAXED),
+              .ph = __atomic_load_n(&slot.e.ph, __ATOMIC_RELAXED),
+          },
+      };
+
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (__atomic_load_n(&slot.seq, __ATOMIC_RELAXED) != 2 * i + 2)
+        continue;
+
+      f(e);
+    }
+  }
+
+  void clear() noexcept {
+    tail_.store(head_.load(std::memory_order_acquire),
+                std::memory_order_relaxed);
+  }
+
+private:
+  struct slot {
+    uint64_t seq;
+    event e;
+  };
+
+  uint32_t tid_;
+  std::atomic<uint64_t> head_{0};
+  std::atomic<uint64_t> tail_{0};
+  std::vector<slot> slots_;
+};
+
+struct registry {
+  std::mutex mtx;
+  /* rings outlive their threads so that the events are still dumpable */
+  std::vector<std::shared_ptr<ring>> rings;
+};
+
+registry &registry_get() {
+  static registry reg;
+  return reg;
+}
+
+ring &ring_local() {
+  thread_local auto const r{[] {
+    auto &reg{registry_get()};
+    std::lock_guard lck{reg.mtx};
+    return reg.rings.emplace_back(std::make_shared<ring>(
+        static_cast<uint32_t>(reg.rings.size() + 1)));
+  }()};
+  return *r;
+}
+
+std::atomic<uint32_t> sample_every{0};
+std::atomic<uint32_t> cmds_seen{0};
+std::atomic<uint32_t> id_last{0};
+
+} // namespace
+
+namespace ublk::trace {
+
+namespace detail {
+
+void record(char const *name, uint32_t id, phase ph) noexcept {
+  ring_local().push({
+      .ts_ns = static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::nanoseconds>(
+              std::chrono::steady_clock::now().time_since_epoch())
+              .count()),
+      .name = name,
+      .id = id,
+      .ph = ph,
+  });
+}
+
+} // namespace detail
+
+void enable(uint32_t every) noexcept {
+  sample_every.store(every, std::memory_order_relaxed);
+}
+
+uint32_t sample() noexcept {
+  auto const every{sample_every.load(std::memory_order_relaxed)};
+  if (!every) [[likely]]
+    return 0;
+
+  if (cmds_seen.fetch_add(1, std::memory_order_relaxed) % every)
+    return 0;
+
+  /* 0 stands for untraced, so it is skipped when the ids wrap around */
+  auto id{id_last.fetch_add(1, std::memory_order_relaxed) + 1};
+  if (!id) [[unlikely]]
+    id = id_last.fetch_add(1, std::memory_order_relaxed) + 1;
+
+  return id;
+}
+
+void dump(std::ostream &out) {
+  auto rings{std::vector<std::shared_ptr<ring>>{}};
+  {
+    auto &reg{registry_get()};
+    std::lock_guard lck{reg.mtx};
+    rings = reg.rings;
+  }
+
+  auto const pid{getpid()};
+
+  out << R"({"displayTimeUnit":"ns","traceEvents":[)";
+
+  auto sep{""};
+  for (auto const &r : rings) {
+    r->for_each([&](event const &e) {
+      out << std::format(
+          R"({}{{"name":"{}","cat":"ublk","ph":"{}","id":{},"ts":{}.{:03},"pid":{},"tid":{}}})",
+          sep, e.name, static_cast<char>(e.ph), e.id, e.ts_ns / 1000,
+          e.ts_ns % 1000, pid, r->tid());
+      sep = ",\n";
+    });
+  }
+
+  out << "]}\n";
+}
+
+void clear() noexcept {
+  auto &reg{registry_get()};
+  std::lock_guard lck{reg.mtx};
+  for (auto const &r : reg.rings)
+    r->clear();
+}
+
+} // namespace ublk::trace
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+
+#include <ostream>
+#include <utility>
+
+namespace ublk::trace {
+
+/*
+ * Requests get traced through their lifecycle: a sampled command is given a
+ * nonzero trace id once popped out of the command ring, the id travels along
+ * with the request and its queries and every stage they pass gets recorded
+ * into a ring of the thread it happens in. Untraced requests carry 0 and
+ * cost a single branch per trace point
+ */
+
+enum class phase : char {
+  begin = 'b',
+  instant = 'n',
+  end = 'e',
+};
+
+namespace detail {
+void record(char const *name, uint32_t id, phase ph) noexcept;
+inline thread_local uint32_t current_id{0};
+} // namespace detail
+
+/*
+ * Every sample_every-th command gets traced, 0 turns tracing off. Events
+ * already recorded are kept
+ */
+void enable(uint32_t sample_every) noexcept;
+
+/* Returns a new trace id if the next command is to be traced, 0 otherwise */
+uint32_t sample() noexcept;
+
+/* name must outlive the trace, string literals are meant to be given */
+inline void record(char const *name, uint32_t id,
+                   phase ph = phase::instant) noexcept {
+  if (id) [[unlikely]]
+    detail::record(name, id, ph);
+}
+
+/* The trace id of the command the calling thread is handling at the moment */
+inline uint32_t current() noexcept { return detail::current_id; }
+
+class current_scope final {
+public:
+  explicit current_scope(uint32_t id) noexcept
+      : prev_(std::exchange(detail::current_id, id)) {}
+  ~current_scope() { detail::current_id = prev_; }
+
+  current_scope(current_scope const &) = delete;
+  current_scope &operator=(current_scope const &) = delete;
+
+  current_scope(current_scope &&) = delete;
+  current_scope &operator=(current_scope &&) = delete;
+
+private:
+  uint32_t prev_;
+};
+
+/*
+ * Writes the events of all the threads out as Chrome trace event JSON, which
+ * Perfetto opens too. Recording may go on meanwhile
+ */
+void dump(std::ostream &out);
+
+/* Drops the events recorded so far */
+void clear() noexcept;
+
+} // namespace ublk::trace
@@ -52,8 +52,11 @@ public:
       const noexcept {
     Expects(0 != buf_sz);
     Expects(!(buf_offset + buf_sz > buf_.size()));
-    return create(buf_.subspan(buf_offset, buf_sz), rq_offset,
-                  std::move(completer));
+    auto sq{create(buf_.subspan(buf_offset, buf_sz), rq_offset,
+                   std::move(completer))};
+    sq->set_trace_id(trace_id());
+    sq->set_fua(fua());
+    return sq;
   }
 
   auto subquery(uint64_t buf_offset, uint64_t buf_sz, uint64_t rq_offset,
@@ -67,12 +70,18 @@ public:
   }
 
   auto buf() const noexcept { return buf_; }
+  auto size() const noexcept { return buf_.size(); }
 
   auto offset() const noexcept { return offset_; }
 
+  /* the data must have reached the media by the time the query completes */
+  void set_fua(bool fua) noexcept { fua_ = fua; }
+  bool fua() const noexcept { return fua_; }
+
 private:
   std::span<std::byte const> buf_;
   uint64_t offset_;
+  bool fua_{false};
   std::function<void(write_query const &)> completer_;
 };
 
@@ -1,6 +1,11 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+
 #include <memory>
+#include <optional>
+#include <span>
 #include <type_traits>
 #include <utility>
 
@@ -12,6 +17,7 @@
 
 #include "cells_holder.hpp"
 #include "req.hpp"
+#include "write_query.hpp"
 
 namespace ublk {
 
@@ -24,22 +30,15 @@ public:
   }
 
   write_req() = default;
-  explicit write_req(
-      ublkdrv_cmd const &cmd, std::span<ublkdrv_celld const> cellds,
-      std::span<std::byte> cells,
-      std::function<void(write_req const &)> &&completer = {}) noexcept
-      : req(cmd), cells_holder(cellds, cells),
-        completer_(std::move(completer)) {
+  explicit write_req(ublkdrv_cmd const &cmd,
+                     std::span<ublkdrv_celld const> cellds,
+                     std::span<std::byte> cells, completion c = {}) noexcept
+      : req(cmd, c), cells_holder(cellds, cells) {
     Ensures(UBLKDRV_CMD_OP_WRITE == ublkdrv_cmd_get_op(&req::cmd()));
   }
   ~write_req() noexcept override {
-    static_assert(std::is_nothrow_destructible_v<req>);
-    if (completer_) {
-      try {
-        completer_(*this);
-      } catch (...) {
-      }
-    }
+    if (q_ && q_->err()) [[unlikely]]
+      set_err(q_->err());
   }
 
   write_req(write_req const &) = delete;
@@ -50,8 +49,26 @@ public:
 
   auto const &cmd() const noexcept { return req::cmd().u.w; }
 
+  bool fua() const noexcept {
+    return 0 != (ublkdrv_cmd_get_fl(&req::cmd()) & UBLKDRV_CMD_FL_FUA);
+  }
+
+  /*
+   * The query of a single-cell request is kept inside the request itself and
+   * shares its reference count, so neither gets allocated separately. Its
+   * error is passed to the request once all the references are gone
+   */
+  static std::shared_ptr<write_query>
+  inline_query(std::shared_ptr<write_req> req, std::span<std::byte const> buf,
+               uint64_t offset) noexcept {
+    Expects(req);
+    Expects(!req->q_);
+    auto *p_q = &req->q_.emplace(buf, offset);
+    return {std::move(req), p_q};
+  }
+
 private:
-  std::function<void(write_req const &)> completer_;
+  std::optional<write_query> q_;
 };
 
 } // namespace ublk
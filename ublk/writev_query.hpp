@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <functional>
+#include <memory>
+#include <span>
+#include <utility>
+
+#include <gsl/assert>
+
+#include "mm/pool_allocators.hpp"
+
+#include "query.hpp"
+#include "sg_bufs.hpp"
+
+namespace ublk {
+
+/* Writes a scatter-gather list into a contiguous range of the device */
+class writev_query final : public query {
+public:
+  template <typename... Args> static auto create(Args &&...args) noexcept {
+    return std::allocate_shared<writev_query>(
+        mm::allocator::pool_cache_line_aligned<writev_query>::value,
+        std::forward<Args>(args)...);
+  }
+
+  writev_query() = default;
+
+  writev_query(sg_bufs<std::byte const> bufs, uint64_t offset,
+               std::function<void(writev_query const &)> &&completer =
+                   {}) noexcept
+      : bufs_(std::move(bufs)), sz_(sg_size(bufs_)), offset_(offset),
+        completer_(std::move(completer)) {
+    Ensures(0 != sz_);
+  }
+  ~writev_query() {
+    if (completer_) {
+      try {
+        completer_(*this);
+      } catch (...) {
+      }
+    }
+  }
+
+  writev_query(writev_query const &) = delete;
+  writev_query &operator=(writev_query const &) = delete;
+
+  writev_query(writev_query &&) = default;
+  writev_query &operator=(writev_query &&) = default;
+
+  auto subquery(uint64_t buf_offset, uint64_t buf_sz, uint64_t rq_offset,
+                std::function<void(writev_query const &)> &&completer = {})
+      const noexcept {
+    Expects(0 != buf_sz);
+    Expects(!(buf_offset + buf_sz > sz_));
+    auto sq{create(sg_slice(bufs_, buf_offset, buf_sz), rq_offset,
+                   std::move(completer))};
+    sq->set_trace_id(trace_id());
+    sq->set_fua(fua());
+    return sq;
+  }
+
+  auto subquery(uint64_t buf_offset, uint64_t buf_sz, uint64_t rq_offset,
+                std::shared_ptr<writev_query> parent_wq) const noexcept {
+    return subquery(buf_offset, buf_sz, rq_offset,
+                    [parent_wq = std::move(parent_wq)](writev_query const &wq) {
+                      if (wq.err()) [[unlikely]] {
+                        parent_wq->set_err(wq.err());
+                      }
+                    });
+  }
+
+  std::span<std::span<std::byte const> const> bufs() const noexcept {
+    return {bufs_.data(), bufs_.size()};
+  }
+  auto size() const noexcept { return sz_; }
+
+  auto offset() const noexcept { return offset_; }
+
+  /* the data must have reached the media by the time the query completes */
+  void set_fua(bool fua) noexcept { fua_ = fua; }
+  bool fua() const noexcept { return fua_; }
+
+private:
+  sg_bufs<std::byte const> bufs_;
+  uint64_t sz_;
+  uint64_t offset_;
+  bool fua_{false};
+  std::function<void(writev_query const &)> completer_;
+};
+
+} // namespace ublk
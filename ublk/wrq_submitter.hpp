@@ -28,6 +28,10 @@ public:
     return rwh_->submit(std::move(wq));
   }
 
+  int submit(std::shared_ptr<writev_query> wq) noexcept override {
+    return rwh_->submit(std::move(wq));
+  }
+
 private:
   std::shared_ptr<IRWHandler> rwh_;
 };
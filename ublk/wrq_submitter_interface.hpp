@@ -2,9 +2,41 @@
 
 #include <memory>
 
+#include <gsl/assert>
+
 #include "submitter_interface.hpp"
 #include "write_query.hpp"
+#include "writev_query.hpp"
 
 namespace ublk {
-using IWRQSubmitter = ISubmitter<int(std::shared_ptr<write_query>) noexcept>;
+
+class IWRQSubmitter
+    : public ISubmitter<int(std::shared_ptr<write_query>) noexcept> {
+public:
+  using ISubmitter<int(std::shared_ptr<write_query>) noexcept>::submit;
+
+  /*
+   * Submitters unable to handle scatter-gather lists natively get a query per
+   * buffer of the list
+   */
+  virtual int submit(std::shared_ptr<writev_query> wq) noexcept {
+    Expects(wq);
+    auto offset{wq->offset()};
+    for (auto const buf : wq->bufs()) {
+      auto sq{
+          write_query::create(buf, offset, [wq](write_query const &sq) {
+            if (sq.err()) [[unlikely]]
+              wq->set_err(sq.err());
+          }),
+      };
+      sq->set_trace_id(wq->trace_id());
+      sq->set_fua(wq->fua());
+      if (auto const res{submit(std::move(sq))}) [[unlikely]]
+        return res;
+      offset += buf.size();
+    }
+    return 0;
+  }
+};
+
 } // namespace ublk
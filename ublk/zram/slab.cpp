@@ -0,0 +1,79 @@
+#include "slab.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <memory>
+#include <mutex>
+#include <new>
+
+#include <gsl/assert>
+
+#include "mm/mem.hpp"
+
+namespace ublk::zram {
+
+namespace {
+
+size_t class_of(size_t sz) noexcept {
+  Expects(sz);
+  return (sz - 1) / slab::kClassGranularity;
+}
+
+} // namespace
+
+slab::slab(size_t obj_sz_max)
+    : classes_nr_(class_of(obj_sz_max) + 1),
+      span_gen_(mm::get_unique_bytes_generator(kClassGranularity, kSpanSz)),
+      mem_used_(0) {
+  Ensures(!(obj_sz(obj_sz_max) > kSpanSz));
+  classes_ = std::make_unique<size_class[]>(classes_nr_);
+}
+
+size_t slab::obj_sz(size_t sz) noexcept {
+  return (class_of(sz) + 1) * kClassGranularity;
+}
+
+std::byte *slab::allocate(size_t sz) noexcept {
+  auto const cid{class_of(sz)};
+  Expects(cid < classes_nr_);
+
+  auto &cls{classes_[cid]};
+  auto const osz{obj_sz(sz)};
+
+  auto lck{std::unique_lock{cls.mtx}};
+
+  if (!cls.free.empty()) {
+    auto *p{cls.free.back()};
+    cls.free.pop_back();
+    return p;
+  }
+
+  if (cls.spans.empty() || !(cls.carved_nr < kSpanSz / osz)) {
+    try {
+      auto span{span_gen_()};
+      if (!span) [[unlikely]]
+        return nullptr;
+      cls.free.reserve((cls.spans.size() + 1) * (kSpanSz / osz));
+      cls.spans.push_back(std::move(span));
+    } catch (std::bad_alloc const &) {
+      return nullptr;
+    }
+    cls.carved_nr = 0;
+    mem_used_.fetch_add(kSpanSz, std::memory_order_relaxed);
+  }
+
+  return cls.spans.back().get() + osz * cls.carved_nr++;
+}
+
+void slab::free(std::byte *p, size_t sz) noexcept {
+  Expects(p);
+
+  auto &cls{classes_[class_of(sz)]};
+
+  auto lck{std::unique_lock{cls.mtx}};
+  /* there is room reserved for every object carved out of the spans */
+  cls.free.push_back(p);
+}
+
+} // namespace ublk::zram
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "mm/mem_types.hpp"
+
+namespace ublk::zram {
+
+/*
+ * Allocates objects of sizes rounded up to a class. Objects of a class are
+ * carved out of spans taken from the system, freed ones are kept in the class
+ * for the next allocation of it, the spans are never given back
+ */
+class slab final {
+public:
+  static constexpr size_t kClassGranularity{64};
+  static constexpr size_t kSpanSz{64 * 1024};
+
+  explicit slab(size_t obj_sz_max);
+  ~slab() = default;
+
+  slab(slab const &) = delete;
+  slab &operator=(slab const &) = delete;
+
+  slab(slab &&) = delete;
+  slab &operator=(slab &&) = delete;
+
+  /* nullptr once the system runs out of memory */
+  std::byte *allocate(size_t sz) noexcept;
+  void free(std::byte *p, size_t sz) noexcept;
+
+  /* the size an object of sz bytes takes, its class's one */
+  static size_t obj_sz(size_t sz) noexcept;
+
+  /* memory taken by the spans, the objects and the free room in them */
+  uint64_t mem_used() const noexcept {
+    return mem_used_.load(std::memory_order_relaxed);
+  }
+
+private:
+  struct size_class {
+    std::mutex mtx;
+    std::vector<mm::uptrwd<std::byte[]>> spans;
+    std::vector<std::byte *> free;
+    /* objects carved out of the last span so far */
+    size_t carved_nr{0};
+  };
+
+  std::unique_ptr<size_class[]> classes_;
+  size_t classes_nr_;
+  std::function<mm::uptrwd<std::byte[]>()> span_gen_;
+  std::atomic<uint64_t> mem_used_;
+};
+
+} // namespace ublk::zram
@@ -0,0 +1,230 @@
+#include "target.hpp"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <array>
+#include <mutex>
+#include <new>
+#include <span>
+#include <utility>
+
+#include <lz4.h>
+
+#include <gsl/assert>
+
+#include "mm/mem.hpp"
+#include "mm/mem_types.hpp"
+
+#include "utils/algo.hpp"
+#include "utils/utility.hpp"
+
+#include "trace/trace.hpp"
+
+namespace ublk::zram {
+
+namespace {
+
+/* compressed to more than that a page is not worth decompressing */
+constexpr size_t kComprSzMax{Target::kPageSz / 4 * 3};
+
+alignas(64) thread_local std::array<std::byte, Target::kPageSz> page_buf;
+alignas(64) thread_local std::array<std::byte,
+                                    LZ4_COMPRESSBOUND(Target::kPageSz)>
+    compr_buf;
+
+} // namespace
+
+Target::Target(uint64_t sz, std::shared_ptr<target_stats> stats)
+    : sz_(sz), slab_(kPageSz), stats_(std::move(stats)) {
+  /* entries of the pages never touched take no memory either */
+  auto const pages_nr{div_round_up(sz_, kPageSz)};
+  pages_ = mm::convert<page[], std::byte[]>(mm::make_unique_bytes(
+      mm::alloc_mode_mmap{.flags = MAP_NORESERVE}, pages_nr * sizeof(page)));
+  if (!pages_)
+    throw std::bad_alloc{};
+}
+
+int Target::page_load(page const &pg, std::span<std::byte> to) noexcept {
+  Expects(kPageSz == to.size());
+
+  if (!pg.data) {
+    algo::fill(to, std::byte{0});
+  } else if (kPageSz == pg.sz) {
+    algo::copy(std::span<std::byte const>{pg.data, kPageSz}, to);
+  } else if (auto const res{
+                 LZ4_decompress_safe(reinterpret_cast<char const *>(pg.data),
+                                     reinterpret_cast<char *>(to.data()),
+                                     static_cast<int>(pg.sz),
+                                     static_cast<int>(kPageSz)),
+             };
+             static_cast<int>(kPageSz) != res) [[unlikely]] {
+    return EIO;
+  }
+
+  return 0;
+}
+
+int Target::page_store(page &pg, std::span<std::byte const> from) noexcept {
+  Expects(kPageSz == from.size());
+
+  if (algo::is_zeroed(from)) {
+    page_drop(pg);
+    pg.zeroed = true;
+    if (stats_)
+      stats_add(stats_->zram_pages_zeroed, 1);
+    return 0;
+  }
+
+  auto const compr_sz{
+      LZ4_compress_default(reinterpret_cast<char const *>(from.data()),
+                           reinterpret_cast<char *>(compr_buf.data()),
+                           static_cast<int>(kPageSz),
+                           static_cast<int>(compr_buf.size())),
+  };
+  auto const stored{
+      compr_sz > 0 && !(static_cast<size_t>(compr_sz) > kComprSzMax)
+          ? std::span<std::byte const>{compr_buf.data(),
+                                       static_cast<size_t>(compr_sz)}
+          : from,
+  };
+
+  auto *p{slab_.allocate(stored.size())};
+  if (!p) [[unlikely]]
+    return ENOMEM;
+  algo::copy(stored, std::span{p, stored.size()});
+
+  page_drop(pg);
+  pg = {.data = p, .sz = static_cast<uint32_t>(stored.size()), .zeroed = false};
+
+  if (stats_) {
+    stats_add(stats_->zram_pages_stored, 1);
+    stats_add(stats_->zram_compr_bytes, pg.sz);
+    stats_set(stats_->zram_mem_used, slab_.mem_used());
+  }
+
+  return 0;
+}
+
+void Target::page_drop(page &pg) noexcept {
+  if (pg.data) {
+    slab_.free(pg.data, pg.sz);
+    if (stats_) {
+      stats_sub(stats_->zram_pages_stored, 1);
+      stats_sub(stats_->zram_compr_bytes, pg.sz);
+    }
+  } else if (pg.zeroed) {
+    if (stats_)
+      stats_sub(stats_->zram_pages_zeroed, 1);
+  }
+  pg = {.data = nullptr, .sz = 0, .zeroed = false};
+}
+
+int Target::process(std::shared_ptr<read_query> rq) noexcept {
+  Expects(rq);
+  Expects(!rq->buf().empty());
+
+  if (sz_ < rq->offset() + rq->buf().size()) [[unlikely]]
+    return EINVAL;
+
+  auto off{rq->offset()};
+  for (auto to{rq->buf()}; !to.empty();) {
+    auto const page_id{off / kPageSz};
+    auto const page_off{off % kPageSz};
+    auto const n{std::min(kPageSz - page_off, to.size())};
+
+    auto lck{std::unique_lock{lock_of(page_id)}};
+    /* whole pages get decompressed right into the buffer */
+    if (kPageSz == n) {
+      if (auto const res{page_load(pages_[page_id], to.first(n))})
+          [[unlikely]] {
+        return res;
+      }
+    } else {
+      if (auto const res{page_load(pages_[page_id], page_buf)}) [[unlikely]]
+        return res;
+      algo::copy(std::span<std::byte const>{page_buf}.subspan(page_off, n),
+                 to.first(n));
+    }
+    lck.unlock();
+
+    to = to.subspan(n);
+    off += n;
+  }
+  trace::record("zram", rq->trace_id());
+
+  return 0;
+}
+
+int Target::process(std::shared_ptr<write_query> wq) noexcept {
+  Expects(wq);
+  Expects(!wq->buf().empty());
+
+  if (sz_ < wq->offset() + wq->buf().size()) [[unlikely]]
+    return EINVAL;
+
+  auto off{wq->offset()};
+  for (auto from{wq->buf()}; !from.empty();) {
+    auto const page_id{off / kPageSz};
+    auto const page_off{off % kPageSz};
+    auto const n{std::min(kPageSz - page_off, from.size())};
+
+    auto lck{std::unique_lock{lock_of(page_id)}};
+    if (kPageSz == n) {
+      if (auto const res{page_store(pages_[page_id], from.first(n))})
+          [[unlikely]] {
+        return res;
+      }
+    } else {
+      /* the rest of the page gets merged in */
+      if (auto const res{page_load(pages_[page_id], page_buf)}) [[unlikely]]
+        return res;
+      algo::copy(from.first(n), std::span{page_buf}.subspan(page_off, n));
+      if (auto const res{page_store(pages_[page_id], page_buf)}) [[unlikely]]
+        return res;
+    }
+    lck.unlock();
+
+    from = from.subspan(n);
+    off += n;
+  }
+  trace::record("zram", wq->trace_id());
+
+  return 0;
+}
+
+int Target::process(std::shared_ptr<discard_query> dq) noexcept {
+  Expects(dq);
+
+  if (sz_ < dq->offset() + dq->size()) [[unlikely]]
+    return EINVAL;
+
+  for (auto off{dq->offset()}; off < dq->offset() + dq->size();) {
+    auto const page_id{off / kPageSz};
+    auto const page_off{off % kPageSz};
+    auto const n{std::min(kPageSz - page_off, dq->offset() + dq->size() - off)};
+
+    auto lck{std::unique_lock{lock_of(page_id)}};
+    if (kPageSz == n) {
+      page_drop(pages_[page_id]);
+    } else if (pages_[page_id].data) {
+      if (auto const res{page_load(pages_[page_id], page_buf)}) [[unlikely]]
+        return res;
+      algo::fill(std::span{page_buf}.subspan(page_off, n), std::byte{0});
+      if (auto const res{page_store(pages_[page_id], page_buf)}) [[unlikely]]
+        return res;
+    }
+    lck.unlock();
+
+    off += n;
+  }
+  trace::record("zram", dq->trace_id());
+
+  return 0;
+}
+
+} // namespace ublk::zram
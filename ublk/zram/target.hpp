@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <span>
+
+#include "mm/mem_types.hpp"
+
+#include "discard_query.hpp"
+#include "read_query.hpp"
+#include "target_stats.hpp"
+#include "write_query.hpp"
+
+#include "slab.hpp"
+
+namespace ublk::zram {
+
+/*
+ * Keeps the data in memory compressed page by page. Pages of zeroes take no
+ * memory but their entries, those compressing badly are stored as they are.
+ * The target may be shared by workers, every page is guarded by one of a set
+ * of locks
+ */
+class Target final {
+public:
+  static constexpr size_t kPageSz{4096};
+
+  explicit Target(uint64_t sz, std::shared_ptr<target_stats> stats = {});
+
+  int process(std::shared_ptr<read_query> rq) noexcept;
+  int process(std::shared_ptr<write_query> wq) noexcept;
+  int process(std::shared_ptr<discard_query> dq) noexcept;
+
+private:
+  static constexpr size_t kLocksNr{128};
+
+  struct page {
+    std::byte *data;
+    /* kPageSz for a page stored as it is */
+    uint32_t sz;
+    /* written all of zeroes, nothing is stored */
+    bool zeroed;
+  };
+
+  std::mutex &lock_of(uint64_t page_id) noexcept {
+    return locks_[page_id % kLocksNr];
+  }
+
+  int page_load(page const &pg, std::span<std::byte> to) noexcept;
+  int page_store(page &pg, std::span<std::byte const> from) noexcept;
+  void page_drop(page &pg) noexcept;
+
+  uint64_t sz_;
+  mm::uptrwd<page[]> pages_;
+  std::array<std::mutex, kLocksNr> locks_;
+  slab slab_;
+  std::shared_ptr<target_stats> stats_;
+};
+
+} // namespace ublk::zram
@@ -13,10 +13,15 @@
 
 #include "resources/ublksh.py.hpp"
 
+#include "ublk/backend_properties.hpp"
 #include "ublk/bdev_map_param.hpp"
 #include "ublk/bdev_unmap_param.hpp"
 #include "ublk/target_create_param.hpp"
 #include "ublk/target_destroy_param.hpp"
+#include "ublk/target_properties.hpp"
+#include "ublk/target_qos_param.hpp"
+#include "ublk/target_stats.hpp"
+#include "ublk/target_stats_param.hpp"
 
 #include "master.hpp"
 
@@ -41,6 +46,67 @@ PYBIND11_EMBEDDED_MODULE(ublk, m) {
       .def_readwrite("write_through_enable",
                      &ublk::cache_cfg::write_through_enable);
 
+  py::class_<ublk::workers_cfg>(m, "workers_cfg")
+      .def(py::init([] -> ublk::workers_cfg {
+        return {
+            .nr = 0,
+            .shard_len_sectors = 0,
+        };
+      }))
+      .def_readwrite("nr", &ublk::workers_cfg::nr)
+      .def_readwrite("shard_len_sectors",
+                     &ublk::workers_cfg::shard_len_sectors);
+
+  py::class_<ublk::uring_cfg>(m, "uring_cfg")
+      .def(py::init([] -> ublk::uring_cfg {
+        return {
+            .sq_depth = 0,
+            .sqpoll = false,
+            .sqpoll_idle_ms = 0,
+            .iopoll = false,
+        };
+      }))
+      .def_readwrite("sq_depth", &ublk::uring_cfg::sq_depth)
+      .def_readwrite("sqpoll", &ublk::uring_cfg::sqpoll)
+      .def_readwrite("sqpoll_idle_ms", &ublk::uring_cfg::sqpoll_idle_ms)
+      .def_readwrite("iopoll", &ublk::uring_cfg::iopoll);
+
+  py::class_<ublk::psync_cfg>(m, "psync_cfg")
+      .def(py::init([] -> ublk::psync_cfg {
+        return {
+            .threads_nr = 0,
+            .queue_depth = 0,
+        };
+      }))
+      .def_readwrite("threads_nr", &ublk::psync_cfg::threads_nr)
+      .def_readwrite("queue_depth", &ublk::psync_cfg::queue_depth);
+
+  py::class_<ublk::plug_cfg>(m, "plug_cfg")
+      .def(py::init([] -> ublk::plug_cfg {
+        return {
+            .max_sectors = 0,
+            .window_us = 0,
+        };
+      }))
+      .def_readwrite("max_sectors", &ublk::plug_cfg::max_sectors)
+      .def_readwrite("window_us", &ublk::plug_cfg::window_us);
+
+  py::class_<ublk::qos_cfg>(m, "qos_cfg")
+      .def(py::init([] -> ublk::qos_cfg {
+        return {
+            .read_iops = 0,
+            .write_iops = 0,
+            .read_bps = 0,
+            .write_bps = 0,
+            .weight = 0,
+        };
+      }))
+      .def_readwrite("read_iops", &ublk::qos_cfg::read_iops)
+      .def_readwrite("write_iops", &ublk::qos_cfg::write_iops)
+      .def_readwrite("read_bps", &ublk::qos_cfg::read_bps)
+      .def_readwrite("write_bps", &ublk::qos_cfg::write_bps)
+      .def_readwrite("weight", &ublk::qos_cfg::weight);
+
   py::class_<ublk::bdev_map_param>(m, "bdev_map_param")
       .def(py::init([] -> ublk::bdev_map_param {
         return {
@@ -48,12 +114,24 @@ PYBIND11_EMBEDDED_MODULE(ublk, m) {
             .target_name = {},
             .read_only = false,
             .zero_copy = false,
+            .ack_batch_max = 0,
+            .ack_delay_max_us = 0,
+            .poll_budget_us = 0,
+            .trace_sample_every = 0,
+            .trace_dir = {},
         };
       }))
       .def_readwrite("bdev_suffix", &ublk::bdev_map_param::bdev_suffix)
       .def_readwrite("target_name", &ublk::bdev_map_param::target_name)
       .def_readwrite("read_only", &ublk::bdev_map_param::read_only)
-      .def_readwrite("zero_copy", &ublk::bdev_map_param::zero_copy);
+      .def_readwrite("zero_copy", &ublk::bdev_map_param::zero_copy)
+      .def_readwrite("ack_batch_max", &ublk::bdev_map_param::ack_batch_max)
+      .def_readwrite("ack_delay_max_us",
+                     &ublk::bdev_map_param::ack_delay_max_us)
+      .def_readwrite("poll_budget_us", &ublk::bdev_map_param::poll_budget_us)
+      .def_readwrite("trace_sample_every",
+                     &ublk::bdev_map_param::trace_sample_every)
+      .def_readwrite("trace_dir", &ublk::bdev_map_param::trace_dir);
 
   py::class_<ublk::bdev_unmap_param>(m, "bdev_unmap_param")
       .def(py::init<>())
@@ -61,7 +139,15 @@ PYBIND11_EMBEDDED_MODULE(ublk, m) {
 
   py::class_<ublk::target_null_cfg>(m, "target_null").def(py::init<>());
 
-  py::class_<ublk::target_inmem_cfg>(m, "target_inmem").def(py::init<>());
+  py::class_<ublk::target_inmem_cfg>(m, "target_inmem")
+      .def(py::init([] -> ublk::target_inmem_cfg {
+        return {
+            .sparse = false,
+        };
+      }))
+      .def_readwrite("sparse", &ublk::target_inmem_cfg::sparse);
+
+  py::class_<ublk::target_zram_cfg>(m, "target_zram").def(py::init<>());
 
   py::class_<ublk::target_default_cfg>(m, "target_default")
       .def(py::init([] -> ublk::target_default_cfg {
@@ -71,16 +157,42 @@ PYBIND11_EMBEDDED_MODULE(ublk, m) {
       }))
       .def_readwrite("path", &ublk::target_default_cfg::path);
 
+  py::class_<ublk::target_mapped_cfg>(m, "target_mapped")
+      .def(py::init([] -> ublk::target_mapped_cfg {
+        return {
+            .path = {},
+            .populate = false,
+            .hugepages = false,
+            .punch_holes = false,
+        };
+      }))
+      .def_readwrite("path", &ublk::target_mapped_cfg::path)
+      .def_readwrite("populate", &ublk::target_mapped_cfg::populate)
+      .def_readwrite("hugepages", &ublk::target_mapped_cfg::hugepages)
+      .def_readwrite("punch_holes", &ublk::target_mapped_cfg::punch_holes);
+
+  py::class_<ublk::target_linear_cfg>(m, "target_linear")
+      .def(py::init([] -> ublk::target_linear_cfg {
+        return {
+            .paths = {},
+            .lens_sectors = {},
+        };
+      }))
+      .def_readwrite("paths", &ublk::target_linear_cfg::paths)
+      .def_readwrite("lens_sectors", &ublk::target_linear_cfg::lens_sectors);
+
   py::class_<ublk::target_raid0_cfg>(m, "target_raid0")
       .def(py::init([] -> ublk::target_raid0_cfg {
         return {
             .strip_len_sectors = 0,
             .paths = {},
+            .sg_coalesce = false,
         };
       }))
       .def_readwrite("strip_len_sectors",
                      &ublk::target_raid0_cfg::strip_len_sectors)
-      .def_readwrite("paths", &ublk::target_raid0_cfg::paths);
+      .def_readwrite("paths", &ublk::target_raid0_cfg::paths)
+      .def_readwrite("sg_coalesce", &ublk::target_raid0_cfg::sg_coalesce);
 
   py::class_<ublk::target_raid1_cfg>(m, "target_raid1")
       .def(py::init([] -> ublk::target_raid1_cfg {
@@ -156,6 +268,11 @@ PYBIND11_EMBEDDED_MODULE(ublk, m) {
             .name = {},
             .capacity_sectors = 0,
             .cache = {},
+            .workers = {},
+            .uring = {},
+            .psync = {},
+            .plug = {},
+            .qos = {},
             .target = ublk::target_null_cfg{},
         };
       }))
@@ -163,15 +280,80 @@ PYBIND11_EMBEDDED_MODULE(ublk, m) {
       .def_readwrite("capacity_sectors",
                      &ublk::target_create_param::capacity_sectors)
       .def_readwrite("cache", &ublk::target_create_param::cache)
+      .def_readwrite("workers", &ublk::target_create_param::workers)
+      .def_readwrite("uring", &ublk::target_create_param::uring)
+      .def_readwrite("psync", &ublk::target_create_param::psync)
+      .def_readwrite("plug", &ublk::target_create_param::plug)
+      .def_readwrite("qos", &ublk::target_create_param::qos)
       .def_readwrite("target", &ublk::target_create_param::target);
 
   py::class_<ublk::target_destroy_param>(m, "target_destroy_param")
       .def(py::init<>())
       .def_readwrite("name", &ublk::target_destroy_param::name);
 
+  py::class_<ublk::target_qos_param>(m, "target_qos_param")
+      .def(py::init<>())
+      .def_readwrite("name", &ublk::target_qos_param::name)
+      .def_readwrite("qos", &ublk::target_qos_param::qos);
+
   py::class_<ublk::targets_list_param>(m, "targets_list_param")
       .def(py::init<>());
 
+  py::class_<ublk::backend_properties>(m, "backend_properties")
+      .def_readonly("path", &ublk::backend_properties::path)
+      .def_readonly("blkdev", &ublk::backend_properties::blkdev)
+      .def_readonly("sz", &ublk::backend_properties::sz)
+      .def_readonly("logical_block_sz",
+                    &ublk::backend_properties::logical_block_sz)
+      .def_readonly("physical_block_sz",
+                    &ublk::backend_properties::physical_block_sz)
+      .def_readonly("optimal_io_sz", &ublk::backend_properties::optimal_io_sz)
+      .def_readonly("rotational", &ublk::backend_properties::rotational)
+      .def_readonly("discard_granularity",
+                    &ublk::backend_properties::discard_granularity)
+      .def_readonly("queue_depth", &ublk::backend_properties::queue_depth);
+
+  py::class_<ublk::target_properties>(m, "target_properties")
+      .def_readonly("capacity_sectors",
+                    &ublk::target_properties::capacity_sectors)
+      .def_readonly("backends", &ublk::target_properties::backends);
+
+  py::class_<ublk::target_stats_param>(m, "target_stats_param")
+      .def(py::init<>())
+      .def_readwrite("name", &ublk::target_stats_param::name);
+
+  py::class_<ublk::op_stats>(m, "op_stats")
+      .def_readonly("ops", &ublk::op_stats::ops)
+      .def_readonly("bytes", &ublk::op_stats::bytes)
+      .def_readonly("errs", &ublk::op_stats::errs)
+      .def_readonly("lat_us_hist", &ublk::op_stats::lat_us_hist);
+
+  py::class_<ublk::target_stats>(m, "target_stats")
+      .def_property_readonly(
+          "read", [](ublk::target_stats const &s) { return s.ops.read; })
+      .def_property_readonly(
+          "write", [](ublk::target_stats const &s) { return s.ops.write; })
+      .def_property_readonly(
+          "flush", [](ublk::target_stats const &s) { return s.ops.flush; })
+      .def_property_readonly(
+          "discard", [](ublk::target_stats const &s) { return s.ops.discard; })
+      .def_readonly("cmdb_occupancy", &ublk::target_stats::cmdb_occupancy)
+      .def_readonly("cmdb_ack_occupancy",
+                    &ublk::target_stats::cmdb_ack_occupancy)
+      .def_readonly("cmds_inflight", &ublk::target_stats::cmds_inflight)
+      .def_readonly("cache_hits", &ublk::target_stats::cache_hits)
+      .def_readonly("cache_misses", &ublk::target_stats::cache_misses)
+      .def_readonly("qos_throttled", &ublk::target_stats::qos_throttled)
+      .def_readonly("qos_throttled_us", &ublk::target_stats::qos_throttled_us)
+      .def_readonly("qos_fair_waits", &ublk::target_stats::qos_fair_waits)
+      .def_readonly("qos_fair_wait_us", &ublk::target_stats::qos_fair_wait_us)
+      .def_readonly("zram_pages_stored",
+                    &ublk::target_stats::zram_pages_stored)
+      .def_readonly("zram_compr_bytes", &ublk::target_stats::zram_compr_bytes)
+      .def_readonly("zram_pages_zeroed",
+                    &ublk::target_stats::zram_pages_zeroed)
+      .def_readonly("zram_mem_used", &ublk::target_stats::zram_mem_used);
+
   py::class_<ublk::Master, std::unique_ptr<ublk::Master, py::nodelete>>(
       m, "Master")
       .def(py::init([] -> std::unique_ptr<ublk::Master, py::nodelete> {
@@ -181,6 +363,8 @@ PYBIND11_EMBEDDED_MODULE(ublk, m) {
       .def("unmap", &ublk::Master::unmap, "param"_a)
       .def("create", &ublk::Master::create, "param"_a)
       .def("destroy", &ublk::Master::destroy, "param"_a)
+      .def("stats", &ublk::Master::stats, "param"_a)
+      .def("qos", &ublk::Master::qos, "param"_a)
       .def("list", &ublk::Master::list, "param"_a);
 }
 
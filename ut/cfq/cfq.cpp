@@ -0,0 +1,136 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include <array>
+#include <memory>
+#include <numeric>
+#include <ranges>
+#include <span>
+#include <vector>
+
+#include "cfq/popper.hpp"
+#include "cfq/pusher.hpp"
+
+using namespace testing;
+
+namespace {
+
+using popper_type = ublk::cfq::popper<uint64_t, uint32_t, uint32_t>;
+using pusher_type = ublk::cfq::pusher<uint64_t, uint32_t, uint32_t>;
+
+struct queue {
+  explicit queue(size_t capacity_full) : items(capacity_full) {
+    auto const nop{[]([[maybe_unused]] auto *p) {}};
+    popper = std::make_unique<popper_type>(
+        ublk::cfq::pos_t<uint32_t>{&head, nop},
+        ublk::cfq::pos_t<uint32_t const>{&tail, nop}, std::span{items});
+    pusher = std::make_unique<pusher_type>(
+        ublk::cfq::pos_t<uint32_t const>{&head, nop},
+        ublk::cfq::pos_t<uint32_t>{&tail, nop}, std::span{items});
+  }
+
+  uint32_t head{0};
+  uint32_t tail{0};
+  std::vector<uint64_t> items;
+  std::unique_ptr<popper_type> popper;
+  std::unique_ptr<pusher_type> pusher;
+};
+
+} // namespace
+
+namespace ublk::ut::cfq {
+
+TEST(CFQ, PushNPopNEmpty) {
+  queue q{8};
+
+  auto out{std::array<uint64_t, 8>{}};
+  EXPECT_EQ(q.popper->pop_n(out), 0);
+  EXPECT_EQ(q.pusher->push_n(std::span<uint64_t const>{}), 0);
+  EXPECT_EQ(q.head, 0);
+  EXPECT_EQ(q.tail, 0);
+}
+
+TEST(CFQ, PushNUpToCapacity) {
+  queue q{8};
+
+  auto in{std::vector<uint64_t>(q.pusher->capacity() + 3)};
+  std::iota(in.begin(), in.end(), 1);
+
+  EXPECT_EQ(q.pusher->push_n(in), q.pusher->capacity());
+  EXPECT_EQ(q.tail, q.pusher->capacity());
+  EXPECT_FALSE(q.pusher->push(0));
+
+  auto out{std::vector<uint64_t>(in.size())};
+  ASSERT_EQ(q.popper->pop_n(out), q.popper->capacity());
+  EXPECT_THAT(std::span{out}.first(q.popper->capacity()),
+              ElementsAreArray(std::span{in}.first(q.pusher->capacity())));
+  EXPECT_EQ(q.head, q.tail);
+}
+
+TEST(CFQ, PushNPopNWrapAround) {
+  queue q{8};
+
+  uint64_t next_in{0};
+  uint64_t next_out{0};
+
+  for (auto n : std::views::iota(1uz, 7uz)) {
+    for ([[maybe_unused]] auto _ : std::views::iota(0, 5)) {
+      auto in{std::vector<uint64_t>(n)};
+      std::iota(in.begin(), in.end(), next_in);
+      ASSERT_EQ(q.pusher->push_n(in), n);
+      next_in += n;
+
+      auto out{std::vector<uint64_t>(q.popper->capacity())};
+      ASSERT_EQ(q.popper->pop_n(out), n);
+      for (auto v : std::span{out}.first(n))
+        EXPECT_EQ(v, next_out++);
+    }
+  }
+}
+
+TEST(CFQ, PopNLimitedBySpan) {
+  queue q{16};
+
+  auto in{std::vector<uint64_t>(10)};
+  std::iota(in.begin(), in.end(), 0);
+  ASSERT_EQ(q.pusher->push_n(in), in.size());
+
+  auto out{std::array<uint64_t, 4>{}};
+  EXPECT_EQ(q.popper->pop_n(out), out.size());
+  EXPECT_THAT(out, ElementsAre(0, 1, 2, 3));
+
+  EXPECT_EQ(q.popper->pop(), 4);
+
+  EXPECT_EQ(q.popper->pop_n(out), out.size());
+  EXPECT_THAT(out, ElementsAre(5, 6, 7, 8));
+
+  EXPECT_EQ(q.popper->pop_n(out), 1);
+  EXPECT_EQ(out[0], 9);
+}
+
+TEST(CFQ, SizeTracksBothSides) {
+  queue q{8};
+
+  EXPECT_EQ(q.pusher->size(), 0);
+
+  auto in{std::vector<uint64_t>(5)};
+  std::iota(in.begin(), in.end(), 0);
+
+  for ([[maybe_unused]] auto _ : std::views::iota(0, 3)) {
+    ASSERT_EQ(q.pusher->push_n(in), in.size());
+    EXPECT_EQ(q.pusher->size(), in.size());
+    EXPECT_EQ(q.popper->size(), in.size());
+
+    auto out{std::array<uint64_t, 3>{}};
+    ASSERT_EQ(q.popper->pop_n(out), out.size());
+    EXPECT_EQ(q.popper->size(), in.size() - out.size());
+
+    ASSERT_EQ(q.popper->pop_n(out), in.size() - out.size());
+    EXPECT_EQ(q.pusher->size(), 0);
+  }
+}
+
+} // namespace ublk::ut::cfq
@@ -0,0 +1,104 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cerrno>
+#include <cstddef>
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "def/flusher.hpp"
+
+#include "flush_query.hpp"
+
+using namespace testing;
+
+namespace ublk::ut::def {
+
+namespace {
+
+class Flusher : public Test {
+protected:
+  void SetUp() override {
+    flusher_ = ublk::def::flusher::create(
+        [this](std::function<void(int err)> &&done) {
+          syncs_.push_back(std::move(done));
+        });
+  }
+
+  void TearDown() override { flusher_.reset(); }
+
+  auto flush(std::vector<int> &errs) {
+    return flusher_->submit(flush_query::create(
+        [&errs](flush_query const &fq) { errs.push_back(fq.err()); }));
+  }
+
+  /* deque, syncs get started by the completions of the ones before */
+  std::deque<std::function<void(int err)>> syncs_;
+  std::shared_ptr<ublk::def::flusher> flusher_;
+};
+
+} // namespace
+
+TEST_F(Flusher, CompletesOnceSynced) {
+  auto errs{std::vector<int>{}};
+
+  EXPECT_EQ(flush(errs), 0);
+  ASSERT_EQ(syncs_.size(), 1uz);
+  EXPECT_TRUE(errs.empty());
+
+  syncs_[0](0);
+  EXPECT_THAT(errs, ElementsAre(0));
+}
+
+TEST_F(Flusher, MergesFlushesIssuedWhileSyncing) {
+  auto errs{std::vector<int>{}};
+
+  EXPECT_EQ(flush(errs), 0);
+  EXPECT_EQ(flush(errs), 0);
+  EXPECT_EQ(flush(errs), 0);
+  EXPECT_EQ(flush(errs), 0);
+
+  /* the ones issued after the first get served by the next sync */
+  ASSERT_EQ(syncs_.size(), 1uz);
+
+  syncs_[0](0);
+  EXPECT_THAT(errs, ElementsAre(0));
+  ASSERT_EQ(syncs_.size(), 2uz);
+
+  syncs_[1](0);
+  EXPECT_THAT(errs, ElementsAre(0, 0, 0, 0));
+  EXPECT_EQ(syncs_.size(), 2uz);
+}
+
+TEST_F(Flusher, PropagatesSyncFailure) {
+  auto errs{std::vector<int>{}};
+
+  EXPECT_EQ(flush(errs), 0);
+  EXPECT_EQ(flush(errs), 0);
+  ASSERT_EQ(syncs_.size(), 1uz);
+
+  syncs_[0](EIO);
+  EXPECT_THAT(errs, ElementsAre(EIO));
+
+  ASSERT_EQ(syncs_.size(), 2uz);
+  syncs_[1](0);
+  EXPECT_THAT(errs, ElementsAre(EIO, 0));
+}
+
+TEST_F(Flusher, IdleOnceSynced) {
+  auto errs{std::vector<int>{}};
+
+  EXPECT_EQ(flush(errs), 0);
+  syncs_[0](0);
+
+  EXPECT_EQ(flush(errs), 0);
+  ASSERT_EQ(syncs_.size(), 2uz);
+  syncs_[1](0);
+
+  EXPECT_THAT(errs, ElementsAre(0, 0));
+}
+
+} // namespace ublk::ut::def
@@ -0,0 +1,176 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstddef>
+
+#include <algorithm>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+
+#include "mm/mem.hpp"
+
+#include "utils/size_units.hpp"
+
+#include "def/psync.hpp"
+
+#include "flush_query.hpp"
+#include "read_query.hpp"
+#include "readv_query.hpp"
+#include "sg_bufs.hpp"
+#include "write_query.hpp"
+#include "writev_query.hpp"
+
+using namespace testing;
+
+namespace ublk::ut::def {
+
+namespace {
+
+class PSync : public Test {
+protected:
+  void SetUp() override {
+    fd_ = ::memfd_create("psync_ut", MFD_CLOEXEC);
+    ASSERT_GE(fd_, 0);
+    engine(0, 0);
+  }
+
+  void TearDown() override {
+    io_ctx_.reset();
+    ::close(fd_);
+  }
+
+  void engine(uint32_t threads_nr, uint32_t queue_depth) {
+    io_ctx_ = std::make_unique<boost::asio::io_context>();
+    pool_ = &ublk::def::psync::attach(*io_ctx_, {
+                                                    .threads_nr = threads_nr,
+                                                    .queue_depth = queue_depth,
+                                                });
+  }
+
+  static auto bytes(std::unique_ptr<std::byte[]> const &p, size_t sz) {
+    return std::span{p.get(), sz};
+  }
+
+  int fd_{-1};
+  std::unique_ptr<boost::asio::io_context> io_ctx_;
+  ublk::def::psync *pool_{nullptr};
+};
+
+} // namespace
+
+TEST_F(PSync, WriteThenRead) {
+  auto const src{mm::make_unique_randomized_bytes(16_KiB)};
+  auto const dst{mm::make_unique_zeroed_bytes(16_KiB)};
+
+  auto errs{std::vector<int>{}};
+  EXPECT_EQ(pool_->submit(fd_, write_query::create(
+                                   bytes(src, 16_KiB), 4_KiB,
+                                   [&errs](write_query const &wq) {
+                                     errs.push_back(wq.err());
+                                   })),
+            0);
+  io_ctx_->run();
+  io_ctx_->restart();
+
+  EXPECT_EQ(pool_->submit(fd_, read_query::create(
+                                   bytes(dst, 16_KiB), 4_KiB,
+                                   [&errs](read_query const &rq) {
+                                     errs.push_back(rq.err());
+                                   })),
+            0);
+  io_ctx_->run();
+
+  EXPECT_THAT(errs, ElementsAre(0, 0));
+  EXPECT_THAT(bytes(dst, 16_KiB), ElementsAreArray(bytes(src, 16_KiB)));
+}
+
+TEST_F(PSync, ScatterGather) {
+  auto const src{mm::make_unique_randomized_bytes(12_KiB)};
+  auto const dst{mm::make_unique_zeroed_bytes(12_KiB)};
+
+  auto wbufs{sg_bufs<std::byte const>{}};
+  for (auto off{0uz}; off < 12_KiB; off += 3_KiB)
+    wbufs.push_back(bytes(src, 12_KiB).subspan(off, 3_KiB));
+  auto rbufs{sg_bufs<std::byte>{}};
+  for (auto off{0uz}; off < 12_KiB; off += 4_KiB)
+    rbufs.push_back(bytes(dst, 12_KiB).subspan(off, 4_KiB));
+
+  auto wq{writev_query::create(std::move(wbufs), 0)};
+  wq->set_fua(true);
+  EXPECT_EQ(pool_->submit(fd_, std::move(wq)), 0);
+  EXPECT_EQ(pool_->submit(fd_, flush_query::create([](flush_query const &fq) {
+              EXPECT_EQ(fq.err(), 0);
+            })),
+            0);
+  io_ctx_->run();
+  io_ctx_->restart();
+
+  auto err{-1};
+  EXPECT_EQ(pool_->submit(fd_, readv_query::create(
+                                   std::move(rbufs), 0,
+                                   [&err](readv_query const &rq) {
+                                     err = rq.err();
+                                   })),
+            0);
+  io_ctx_->run();
+
+  EXPECT_EQ(err, 0);
+  EXPECT_THAT(bytes(dst, 12_KiB), ElementsAreArray(bytes(src, 12_KiB)));
+}
+
+TEST_F(PSync, BeyondTheEndReadsAsZeroes) {
+  auto const dst{mm::make_unique_randomized_bytes(8_KiB)};
+
+  auto err{-1};
+  EXPECT_EQ(pool_->submit(fd_, read_query::create(
+                                   bytes(dst, 8_KiB), 1_MiB,
+                                   [&err](read_query const &rq) {
+                                     err = rq.err();
+                                   })),
+            0);
+  io_ctx_->run();
+
+  EXPECT_EQ(err, 0);
+  EXPECT_TRUE(std::ranges::all_of(bytes(dst, 8_KiB),
+                                  [](auto b) { return b == std::byte{0}; }));
+}
+
+TEST_F(PSync, FailurePropagates) {
+  auto const buf{mm::make_unique_zeroed_bytes(4_KiB)};
+
+  auto err{0};
+  EXPECT_EQ(pool_->submit(-1, read_query::create(
+                                  bytes(buf, 4_KiB), 0,
+                                  [&err](read_query const &rq) {
+                                    err = rq.err();
+                                  })),
+            0);
+  io_ctx_->run();
+
+  EXPECT_EQ(err, EBADF);
+}
+
+TEST_F(PSync, QueriesBeyondQueuesWait) {
+  engine(2, 1);
+
+  auto done{std::vector<int>{}};
+  for (auto i{0}; i < 8; ++i) {
+    pool_->exec([] { return 0; }, [&done, i](int err) {
+      EXPECT_EQ(err, 0);
+      done.push_back(i);
+    });
+  }
+  io_ctx_->run();
+
+  EXPECT_EQ(done.size(), 8uz);
+  EXPECT_THAT(done, UnorderedElementsAre(0, 1, 2, 3, 4, 5, 6, 7));
+}
+
+} // namespace ublk::ut::def
@@ -0,0 +1,226 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "mm/mem.hpp"
+
+#include "utils/size_units.hpp"
+#include "utils/utility.hpp"
+
+#include "helpers.hpp"
+
+#include "dio/rw_handler.hpp"
+
+#include "read_query.hpp"
+#include "readv_query.hpp"
+#include "sg_bufs.hpp"
+#include "write_query.hpp"
+#include "writev_query.hpp"
+
+using namespace testing;
+
+namespace ublk::ut::dio {
+
+namespace {
+
+class Bounce : public Test {
+protected:
+  std::span<std::byte> storage() const noexcept {
+    return {storage_.get(), kStorageSz};
+  }
+  std::span<std::byte> mem(size_t off, size_t sz) const noexcept {
+    return {mem_.get() + off, sz};
+  }
+
+  void SetUp() override {
+    h_ = std::make_shared<NiceMock<MockRWHandler>>();
+    storage_ = mm::make_unique_randomized_bytes(kStorageSz);
+    mem_ = mm::get_unique_bytes_generator(kAl.mem, kMemSz)();
+    dio_ = std::make_unique<ublk::dio::RWHandler>(h_, kAl);
+
+    /* whatever gets down must be aligned as O_DIRECT wants it */
+    ON_CALL(*h_, submit(Matcher<std::shared_ptr<read_query>>(_)))
+        .WillByDefault([this](std::shared_ptr<read_query> rq) {
+          EXPECT_TRUE(aligned(rq->offset(), rq->buf()));
+          if (held_)
+            held_rqs_.push_back(rq);
+          std::ranges::copy(storage().subspan(rq->offset(), rq->buf().size()),
+                            rq->buf().begin());
+          return 0;
+        });
+    ON_CALL(*h_, submit(Matcher<std::shared_ptr<write_query>>(_)))
+        .WillByDefault([this](std::shared_ptr<write_query> wq) {
+          EXPECT_TRUE(aligned(wq->offset(), wq->buf()));
+          std::ranges::copy(wq->buf(), storage().begin() + wq->offset());
+          if (held_)
+            held_wqs_.push_back(wq);
+          return 0;
+        });
+  }
+
+  static bool aligned(uint64_t off, auto buf) noexcept {
+    return is_aligned_to(off, uint64_t{kAl.offset}) &&
+           is_aligned_to(buf.size(), uint64_t{kAl.offset}) &&
+           is_aligned_to(reinterpret_cast<uintptr_t>(buf.data()),
+                         uint64_t{kAl.mem});
+  }
+
+  static constexpr auto kAl{ublk::dio::alignment{.mem = 4096, .offset = 4096}};
+  static constexpr auto kStorageSz{64_KiB};
+  static constexpr auto kMemSz{64_KiB};
+
+  std::shared_ptr<NiceMock<MockRWHandler>> h_;
+  std::unique_ptr<std::byte[]> storage_;
+  mm::uptrwd<std::byte[]> mem_;
+  std::unique_ptr<ublk::dio::RWHandler> dio_;
+
+  /* the queries held are completed by letting them go */
+  bool held_{false};
+  std::vector<std::shared_ptr<read_query>> held_rqs_;
+  std::vector<std::shared_ptr<write_query>> held_wqs_;
+};
+
+} // namespace
+
+TEST_F(Bounce, AlignedGoDownAsTheyAre) {
+  EXPECT_CALL(*h_, submit(Matcher<std::shared_ptr<write_query>>(_)))
+      .WillOnce([this](std::shared_ptr<write_query> wq) {
+        EXPECT_EQ(wq->buf().data(), mem(0, 8_KiB).data());
+        return 0;
+      });
+
+  auto err{-1};
+  EXPECT_EQ(dio_->submit(write_query::create(
+                mem(0, 8_KiB), 4_KiB,
+                [&err](write_query const &wq) { err = wq.err(); })),
+            0);
+  EXPECT_EQ(err, 0);
+}
+
+TEST_F(Bounce, MisalignedMemory) {
+  auto const src{mm::make_unique_randomized_bytes(8_KiB)};
+  std::ranges::copy(std::span{src.get(), 8_KiB}, mem(512, 8_KiB).begin());
+
+  EXPECT_EQ(dio_->submit(write_query::create(mem(512, 8_KiB), 8_KiB)), 0);
+  EXPECT_THAT(storage().subspan(8_KiB, 8_KiB),
+              ElementsAreArray(std::span{src.get(), 8_KiB}));
+
+  std::ranges::fill(mem(0, kMemSz), std::byte{0});
+  EXPECT_EQ(dio_->submit(read_query::create(mem(512, 8_KiB), 8_KiB)), 0);
+  EXPECT_THAT(mem(512, 8_KiB), ElementsAreArray(std::span{src.get(), 8_KiB}));
+}
+
+TEST_F(Bounce, PartialBlocksGetReadModifiedWritten) {
+  auto const before{mm::duplicate_unique(storage_, kStorageSz)};
+  auto const src{mm::make_unique_randomized_bytes(5_KiB)};
+  std::ranges::copy(std::span{src.get(), 5_KiB}, mem(0, 5_KiB).begin());
+
+  /* the head of one block, the whole of the next and the tail of another */
+  auto err{-1};
+  EXPECT_EQ(dio_->submit(write_query::create(
+                mem(0, 5_KiB), 7_KiB + 512,
+                [&err](write_query const &wq) { err = wq.err(); })),
+            0);
+  EXPECT_EQ(err, 0);
+
+  auto expected{
+      std::vector<std::byte>(before.get(), before.get() + kStorageSz),
+  };
+  std::ranges::copy(std::span{src.get(), 5_KiB},
+                    expected.begin() + 7_KiB + 512);
+  EXPECT_THAT(storage(), ElementsAreArray(expected));
+}
+
+TEST_F(Bounce, MisalignedReadv) {
+  auto bufs{sg_bufs<std::byte>{}};
+  bufs.push_back(mem(100, 1_KiB));
+  bufs.push_back(mem(4_KiB, 2_KiB + 512));
+
+  auto err{-1};
+  EXPECT_EQ(dio_->submit(readv_query::create(
+                bufs, 3_KiB,
+                [&err](readv_query const &rq) { err = rq.err(); })),
+            0);
+  EXPECT_EQ(err, 0);
+
+  EXPECT_THAT(mem(100, 1_KiB),
+              ElementsAreArray(storage().subspan(3_KiB, 1_KiB)));
+  EXPECT_THAT(mem(4_KiB, 2_KiB + 512),
+              ElementsAreArray(storage().subspan(4_KiB, 2_KiB + 512)));
+}
+
+TEST_F(Bounce, ReadModifyWritesOfABlockGetSerialized) {
+  held_ = true;
+
+  auto const a{mm::make_unique_randomized_bytes(512)};
+  auto const b{mm::make_unique_randomized_bytes(512)};
+  std::ranges::copy(std::span{a.get(), 512}, mem(0, 512).begin());
+  std::ranges::copy(std::span{b.get(), 512}, mem(4_KiB, 512).begin());
+
+  auto errs{std::vector<int>{}};
+  for (auto const &[mem_off, off] : {std::pair{0uz, 0uz}, {4_KiB, 512uz}}) {
+    EXPECT_EQ(dio_->submit(write_query::create(
+                  mem(mem_off, 512), off,
+                  [&errs](write_query const &wq) {
+                    errs.push_back(wq.err());
+                  })),
+              0);
+  }
+
+  /* the second waits for the first to have written the block */
+  ASSERT_EQ(held_rqs_.size(), 1uz);
+  held_rqs_.clear();
+  ASSERT_EQ(held_wqs_.size(), 1uz);
+  EXPECT_TRUE(held_rqs_.empty());
+  held_wqs_.clear();
+  EXPECT_THAT(errs, ElementsAre(0));
+
+  ASSERT_EQ(held_rqs_.size(), 1uz);
+  held_rqs_.clear();
+  ASSERT_EQ(held_wqs_.size(), 1uz);
+  held_wqs_.clear();
+  EXPECT_THAT(errs, ElementsAre(0, 0));
+
+  EXPECT_THAT(storage().subspan(0, 512),
+              ElementsAreArray(std::span{a.get(), 512}));
+  EXPECT_THAT(storage().subspan(512, 512),
+              ElementsAreArray(std::span{b.get(), 512}));
+}
+
+TEST_F(Bounce, ReadFailureFailsTheWrite) {
+  EXPECT_CALL(*h_, submit(Matcher<std::shared_ptr<read_query>>(_)))
+      .WillOnce([](std::shared_ptr<read_query> rq) {
+        rq->set_err(EIO);
+        return 0;
+      });
+  EXPECT_CALL(*h_, submit(Matcher<std::shared_ptr<write_query>>(_))).Times(0);
+
+  auto err{0};
+  EXPECT_EQ(dio_->submit(write_query::create(
+                mem(0, 512), 1_KiB,
+                [&err](write_query const &wq) { err = wq.err(); })),
+            0);
+  EXPECT_EQ(err, EIO);
+}
+
+TEST_F(Bounce, FUAGoesWithTheBounced) {
+  EXPECT_CALL(*h_, submit(Matcher<std::shared_ptr<write_query>>(_)))
+      .WillOnce([](std::shared_ptr<write_query> wq) {
+        EXPECT_TRUE(wq->fua());
+        return 0;
+      });
+
+  auto wq{write_query::create(mem(512, 4_KiB), 0)};
+  wq->set_fua(true);
+  EXPECT_EQ(dio_->submit(std::move(wq)), 0);
+}
+
+} // namespace ublk::ut::dio
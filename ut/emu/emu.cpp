@@ -0,0 +1,216 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <span>
+#include <vector>
+
+#include <linux/ublkdrv/cmd.h>
+#include <linux/ublkdrv/cmd_ack.h>
+
+#include <boost/asio/io_context.hpp>
+
+#include "mm/mem.hpp"
+
+#include "utils/size_units.hpp"
+
+#include "helpers.hpp"
+
+#include "emu/ring.hpp"
+#include "inmem/rdq_submitter.hpp"
+#include "inmem/target.hpp"
+#include "inmem/wrq_submitter.hpp"
+
+#include "cmd_acknowledger.hpp"
+#include "cmd_handler.hpp"
+#include "cmd_read_handler.hpp"
+#include "cmd_read_handler_adaptor.hpp"
+#include "cmd_write_handler.hpp"
+#include "cmd_write_handler_adaptor.hpp"
+#include "handler.hpp"
+#include "target_stats.hpp"
+
+using namespace testing;
+
+namespace ublk::ut::emu {
+
+namespace {
+
+class EMU : public Test {
+protected:
+  constexpr static auto kCmdsLen{8u};
+  constexpr static auto kCellSz{4_KiB};
+  constexpr static auto kStorageSz{kCellSz * kCmdsLen};
+
+  void SetUp() override {
+    ring_ = std::make_unique<ublk::emu::ring>(ublk::emu::ring_param{
+        .cmds_len = kCmdsLen,
+        .cell_sz = kCellSz,
+    });
+
+    auto storage{ut::make_unique_zeroed_storage(kStorageSz)};
+    storage_ = std::span{storage.get(), kStorageSz};
+
+    auto target{
+        std::make_shared<ublk::inmem::Target>(std::move(storage), kStorageSz),
+    };
+
+    auto const hs{
+        std::map<ublkdrv_cmd_op, std::shared_ptr<ublk::IUblkReqHandler>>{
+            {
+                UBLKDRV_CMD_OP_READ,
+                std::make_shared<ublk::CmdReadHandlerAdaptor>(
+                    std::make_shared<ublk::CmdReadHandler>(
+                        std::make_shared<ublk::inmem::RDQSubmitter>(target))),
+            },
+            {
+                UBLKDRV_CMD_OP_WRITE,
+                std::make_shared<ublk::CmdWriteHandlerAdaptor>(
+                    std::make_shared<ublk::CmdWriteHandler>(
+                        std::make_shared<ublk::inmem::WRQSubmitter>(target))),
+            },
+        },
+    };
+
+    stats_ = std::make_shared<ublk::target_stats>();
+
+    auto handler{
+        std::make_unique<ublk::CmdHandler>(
+            ring_->cellds(), ring_->cells(),
+            std::make_shared<ublk::CmdAcknowledger>(
+                io_ctx_, ring_->qcmd_ack(), ring_->fd_acks(),
+                ublk::cmd_ack_param{
+                    .batch_max = 0,
+                    .delay_max = {},
+                    .stats = stats_,
+                }),
+            hs, stats_),
+    };
+
+    ublk::async_start(ring_->fd_cmds(), io_ctx_, ring_->qcmd(),
+                      std::move(handler),
+                      ublk::handler_param{
+                          .poll_budget = {},
+                          .stats = stats_,
+                      });
+  }
+
+  auto acks_collect(size_t nr) {
+    auto acks{std::vector<ublkdrv_cmd_ack>{}};
+    auto acks_buf{std::array<ublkdrv_cmd_ack, kCmdsLen>{}};
+    while (acks.size() < nr &&
+           io_ctx_.run_one_for(std::chrono::seconds{1})) {
+      auto const n{ring_->acks_pop(acks_buf)};
+      acks.insert(acks.end(), acks_buf.begin(), acks_buf.begin() + n);
+    }
+    return acks;
+  }
+
+  std::unique_ptr<ublk::emu::ring> ring_;
+  std::span<std::byte> storage_;
+  std::shared_ptr<ublk::target_stats> stats_;
+  boost::asio::io_context io_ctx_;
+};
+
+} // namespace
+
+TEST_F(EMU, WriteThenReadBack) {
+  auto const data{mm::make_unique_randomized_bytes(kStorageSz)};
+  auto const data_span{std::span{data.get(), kStorageSz}};
+
+  constexpr auto kCmdsInFlightMax{kCmdsLen - 1};
+
+  for (uint32_t id{0}; id < kCmdsInFlightMax; ++id) {
+    std::ranges::copy(data_span.subspan(id * kCellSz, kCellSz),
+                      ring_->cell(id).begin());
+    ASSERT_EQ(ring_->write(id, id * kCellSz, kCellSz), 0);
+  }
+
+  auto acks{acks_collect(kCmdsInFlightMax)};
+  ASSERT_EQ(acks.size(), kCmdsInFlightMax);
+  for (auto const &ack : acks)
+    EXPECT_EQ(ublkdrv_cmd_ack_get_err(&ack), 0);
+
+  EXPECT_THAT(storage_.first(kCmdsInFlightMax * kCellSz),
+              ElementsAreArray(data_span.first(kCmdsInFlightMax * kCellSz)));
+
+  std::ranges::fill(ring_->cells(), std::byte{0});
+
+  for (uint32_t id{0}; id < kCmdsInFlightMax; ++id)
+    ASSERT_EQ(ring_->read(id, id * kCellSz, kCellSz), 0);
+
+  acks = acks_collect(kCmdsInFlightMax);
+  ASSERT_EQ(acks.size(), kCmdsInFlightMax);
+
+  for (auto const &ack : acks) {
+    auto const id{ublkdrv_cmd_ack_get_id(&ack)};
+    EXPECT_EQ(ublkdrv_cmd_ack_get_err(&ack), 0);
+    EXPECT_THAT(ring_->cell(id),
+                ElementsAreArray(data_span.subspan(id * kCellSz, kCellSz)));
+  }
+}
+
+TEST_F(EMU, RingsWrapAround) {
+  constexpr auto kRounds{4 * kCmdsLen};
+  constexpr auto kIOSz{512u};
+
+  for (uint32_t round{0}; round < kRounds; ++round) {
+    auto const id{round % kCmdsLen};
+    std::ranges::fill(ring_->cell(id).first(kIOSz),
+                      static_cast<std::byte>(round));
+    ASSERT_EQ(ring_->write(id, round * kIOSz, kIOSz), 0);
+
+    auto const acks{acks_collect(1)};
+    ASSERT_EQ(acks.size(), 1);
+    EXPECT_EQ(ublkdrv_cmd_ack_get_id(&acks.front()), id);
+    EXPECT_EQ(ublkdrv_cmd_ack_get_err(&acks.front()), 0);
+  }
+
+  for (uint32_t round{0}; round < kRounds; ++round) {
+    EXPECT_THAT(storage_.subspan(round * kIOSz, kIOSz),
+                Each(static_cast<std::byte>(round)));
+  }
+}
+
+TEST_F(EMU, StatsAccountCompletedCommands) {
+  constexpr auto kCmdsInFlightMax{kCmdsLen - 1};
+  constexpr auto kIOSz{1_KiB};
+
+  for (uint32_t id{0}; id < kCmdsInFlightMax; ++id)
+    ASSERT_EQ(ring_->write(id, id * kIOSz, kIOSz), 0);
+  ASSERT_EQ(acks_collect(kCmdsInFlightMax).size(), kCmdsInFlightMax);
+
+  for (uint32_t id{0}; id < 2; ++id)
+    ASSERT_EQ(ring_->read(id, id * kIOSz, kIOSz), 0);
+  ASSERT_EQ(acks_collect(2).size(), 2);
+
+  auto const stats{ublk::stats_snapshot(*stats_)};
+
+  EXPECT_EQ(stats.ops.write.ops, kCmdsInFlightMax);
+  EXPECT_EQ(stats.ops.write.bytes, kCmdsInFlightMax * kIOSz);
+  EXPECT_EQ(stats.ops.write.errs, 0);
+  EXPECT_EQ(std::accumulate(stats.ops.write.lat_us_hist.begin(),
+                            stats.ops.write.lat_us_hist.end(), 0uz),
+            kCmdsInFlightMax);
+
+  EXPECT_EQ(stats.ops.read.ops, 2);
+  EXPECT_EQ(stats.ops.read.bytes, 2 * kIOSz);
+  EXPECT_EQ(std::accumulate(stats.ops.read.lat_us_hist.begin(),
+                            stats.ops.read.lat_us_hist.end(), 0uz),
+            2);
+
+  EXPECT_EQ(stats.ops.flush.ops, 0);
+  EXPECT_EQ(stats.ops.discard.ops, 0);
+
+  EXPECT_EQ(stats.cmds_inflight, 0);
+}
+
+} // namespace ublk::ut::emu
@@ -20,9 +20,13 @@
 
 #include "mm/mem.hpp"
 
+#include "discard_handler_interface.hpp"
+#include "discard_query.hpp"
 #include "read_query.hpp"
+#include "readv_query.hpp"
 #include "rw_handler_interface.hpp"
 #include "write_query.hpp"
+#include "writev_query.hpp"
 
 namespace ublk::ut {
 
@@ -30,6 +34,13 @@ class MockRWHandler : public IRWHandler {
 public:
   MOCK_METHOD(int, submit, (std::shared_ptr<read_query>), (noexcept));
   MOCK_METHOD(int, submit, (std::shared_ptr<write_query>), (noexcept));
+  MOCK_METHOD(int, submit, (std::shared_ptr<readv_query>), (noexcept));
+  MOCK_METHOD(int, submit, (std::shared_ptr<writev_query>), (noexcept));
+};
+
+class MockDiscardHandler : public IDiscardHandler {
+public:
+  MOCK_METHOD(int, submit, (std::shared_ptr<discard_query>), (noexcept));
 };
 
 inline auto make_inmem_writer(std::span<std::byte> storage) noexcept {
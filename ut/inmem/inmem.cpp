@@ -3,14 +3,23 @@
 
 #include <cstddef>
 
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <span>
+#include <vector>
+
 #include "mm/mem.hpp"
 
+#include "sys/page.hpp"
+
 #include "utils/size_units.hpp"
 
 #include "helpers.hpp"
 
 #include "inmem/target.hpp"
 
+#include "discard_query.hpp"
 #include "read_query.hpp"
 #include "write_query.hpp"
 
@@ -18,6 +27,16 @@ using namespace testing;
 
 namespace ublk::ut::inmem {
 
+namespace {
+
+size_t resident_pages_nr(std::byte const *mem, size_t sz) {
+  auto vec{std::vector<unsigned char>(sz / sys::page_size())};
+  EXPECT_EQ(::mincore(const_cast<std::byte *>(mem), sz, vec.data()), 0);
+  return std::ranges::count_if(vec, [](auto v) { return v & 1; });
+}
+
+} // namespace
+
 TEST(INMEM, SuccessfulReadingTheWholeStorage) {
   constexpr auto kStorageSz{4_KiB};
 
@@ -94,4 +113,78 @@ TEST(INMEM, FailedOutOfRangeWritingAtTheWholeStorage) {
   EXPECT_EQ(res, EINVAL);
 }
 
+TEST(INMEM, DiscardedRangeReadsBackAsZeroes) {
+  constexpr auto kStorageSz{64_KiB};
+  /* pages are dropped within the range, its edges are zeroed */
+  constexpr auto kDiscardOffset{4_KiB + 512uz};
+  constexpr auto kDiscardSz{32_KiB + 1_KiB};
+
+  auto storage{ut::make_unique_randomized_storage(kStorageSz)};
+  auto const storage_copy{mm::make_unique_for_overwrite_bytes(kStorageSz)};
+  std::ranges::copy(std::span{storage.get(), kStorageSz}, storage_copy.get());
+  auto *p_storage{storage.get()};
+
+  auto target{ublk::inmem::Target{std::move(storage), kStorageSz}};
+
+  auto const res{
+      target.process(discard_query::create(
+          kDiscardOffset, kDiscardSz,
+          [](discard_query const &dq) { EXPECT_EQ(dq.err(), 0); })),
+  };
+  EXPECT_EQ(res, 0);
+
+  auto const storage_span{std::span{p_storage, kStorageSz}};
+  EXPECT_THAT(storage_span.first(kDiscardOffset),
+              ElementsAreArray(storage_copy.get(), kDiscardOffset));
+  EXPECT_THAT(storage_span.subspan(kDiscardOffset, kDiscardSz),
+              Each(std::byte{0}));
+  EXPECT_THAT(storage_span.subspan(kDiscardOffset + kDiscardSz),
+              ElementsAreArray(storage_copy.get() + kDiscardOffset + kDiscardSz,
+                               kStorageSz - kDiscardOffset - kDiscardSz));
+}
+
+TEST(INMEM, FailedOutOfRangeDiscard) {
+  constexpr auto kStorageSz{4_KiB};
+
+  auto storage{mm::make_unique_for_overwrite_bytes(kStorageSz)};
+
+  auto target{ublk::inmem::Target{std::move(storage), kStorageSz}};
+
+  auto const res{
+      target.process(discard_query::create(
+          kStorageSz - 512uz, 1_KiB,
+          [](discard_query const &dq) { EXPECT_EQ(dq.err(), 0); })),
+  };
+  EXPECT_EQ(res, EINVAL);
+}
+
+TEST(INMEM, SparseStorageBacksOnlyWhatIsWritten) {
+  constexpr auto kStorageSz{64_MiB};
+  constexpr auto kWriteOffset{16_MiB + 4_KiB};
+
+  auto storage{ublk::inmem::make_sparse_mem(kStorageSz)};
+  ASSERT_TRUE(storage);
+  auto const *p_storage{storage.get()};
+
+  auto target{ublk::inmem::Target{std::move(storage), kStorageSz}};
+  EXPECT_EQ(resident_pages_nr(p_storage, kStorageSz), 0uz);
+
+  auto const wbuf{mm::make_unique_randomized_bytes(4_KiB)};
+  auto const wbuf_span{std::span<std::byte const>{wbuf.get(), 4_KiB}};
+  EXPECT_EQ(target.process(write_query::create(wbuf_span, kWriteOffset)), 0);
+  EXPECT_EQ(resident_pages_nr(p_storage, kStorageSz), 4_KiB / sys::page_size());
+
+  auto const rbuf{mm::make_unique_randomized_bytes(8_KiB)};
+  auto const rbuf_span{std::span{rbuf.get(), 8_KiB}};
+  EXPECT_EQ(target.process(read_query::create(rbuf_span, kWriteOffset - 4_KiB)),
+            0);
+  EXPECT_THAT(rbuf_span.first(4_KiB), Each(std::byte{0}));
+  EXPECT_THAT(rbuf_span.subspan(4_KiB), ElementsAreArray(wbuf_span));
+
+  EXPECT_EQ(target.process(discard_query::create(kWriteOffset, 4_KiB)), 0);
+  EXPECT_EQ(target.process(read_query::create(rbuf_span, kWriteOffset - 4_KiB)),
+            0);
+  EXPECT_THAT(rbuf_span, Each(std::byte{0}));
+}
+
 } // namespace ublk::ut::inmem
@@ -0,0 +1,212 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "mm/mem.hpp"
+
+#include "utils/size_units.hpp"
+
+#include "helpers.hpp"
+
+#include "linear/target.hpp"
+
+#include "discard_query.hpp"
+#include "read_query.hpp"
+#include "readv_query.hpp"
+#include "sg_bufs.hpp"
+#include "write_query.hpp"
+#include "writev_query.hpp"
+
+using namespace testing;
+
+namespace ublk::ut::linear {
+
+namespace {
+
+class Linear : public Test {
+protected:
+  void SetUp() override {
+    auto members{std::vector<ublk::linear::member>{}};
+    for (auto const sz : {kMemberSzs[0], kMemberSzs[1], kMemberSzs[2]})
+      members.push_back(member(sz));
+    target_ = std::make_unique<ublk::linear::Target>(std::move(members));
+  }
+
+  ublk::linear::member member(uint64_t sz) {
+    auto &m{members_.emplace_back(std::make_shared<MockRWHandler>(),
+                                  std::make_shared<MockDiscardHandler>())};
+    return {.sz = sz, .h = m.first, .discarder = m.second};
+  }
+
+  MockRWHandler &h(size_t mid) { return *members_[mid].first; }
+  MockDiscardHandler &discarder(size_t mid) { return *members_[mid].second; }
+
+  /* of sizes neither equal nor powers of 2 */
+  static constexpr uint64_t kMemberSzs[]{12_KiB, 40_KiB + 512, 3_KiB};
+
+  std::vector<std::pair<std::shared_ptr<MockRWHandler>,
+                        std::shared_ptr<MockDiscardHandler>>>
+      members_;
+  std::unique_ptr<ublk::linear::Target> target_;
+};
+
+} // namespace
+
+TEST_F(Linear, SizeIsThatOfTheMembers) {
+  EXPECT_EQ(target_->size(), kMemberSzs[0] + kMemberSzs[1] + kMemberSzs[2]);
+}
+
+TEST_F(Linear, QueryWithinMemberGoesToIt) {
+  EXPECT_CALL(h(1), submit(Matcher<std::shared_ptr<read_query>>(NotNull())))
+      .WillOnce([](std::shared_ptr<read_query> rq) {
+        EXPECT_EQ(rq->offset(), 4_KiB);
+        EXPECT_EQ(rq->buf().size(), 8_KiB);
+        return 0;
+      });
+
+  auto const buf{mm::make_unique_zeroed_bytes(8_KiB)};
+  EXPECT_EQ(target_->process(read_query::create(std::span{buf.get(), 8_KiB},
+                                                kMemberSzs[0] + 4_KiB)),
+            0);
+}
+
+TEST_F(Linear, QuerySpanningMembersGetsSplit) {
+  constexpr auto kOffset{8_KiB};
+  constexpr auto kSz{kMemberSzs[1] + 6_KiB};
+
+  auto const buf{mm::make_unique_randomized_bytes(kSz)};
+  auto const buf_span{std::span<std::byte const>{buf.get(), kSz}};
+
+  auto expect{[&](size_t mid, uint64_t offset, uint64_t buf_offset,
+                  uint64_t sz) {
+    EXPECT_CALL(h(mid),
+                submit(Matcher<std::shared_ptr<write_query>>(NotNull())))
+        .WillOnce([=](std::shared_ptr<write_query> wq) {
+          EXPECT_EQ(wq->offset(), offset);
+          EXPECT_EQ(wq->buf().data(), buf_span.data() + buf_offset);
+          EXPECT_EQ(wq->buf().size(), sz);
+          EXPECT_TRUE(wq->fua());
+          return 0;
+        });
+  }};
+  expect(0, kOffset, 0, kMemberSzs[0] - kOffset);
+  expect(1, 0, kMemberSzs[0] - kOffset, kMemberSzs[1]);
+  expect(2, 0, kMemberSzs[0] - kOffset + kMemberSzs[1], 2_KiB);
+
+  auto wq{write_query::create(buf_span, kOffset)};
+  wq->set_fua(true);
+  EXPECT_EQ(target_->process(std::move(wq)), 0);
+}
+
+TEST_F(Linear, ScatterGatherSpanningMembersGetsSplit) {
+  auto const buf{mm::make_unique_zeroed_bytes(8_KiB)};
+  auto const bufs{
+      sg_bufs<std::byte>{
+          std::span{buf.get(), 3_KiB},
+          std::span{buf.get() + 3_KiB, 5_KiB},
+      },
+  };
+
+  EXPECT_CALL(h(0), submit(Matcher<std::shared_ptr<readv_query>>(NotNull())))
+      .WillOnce([](std::shared_ptr<readv_query> rq) {
+        EXPECT_EQ(rq->offset(), kMemberSzs[0] - 4_KiB);
+        EXPECT_EQ(rq->size(), 4_KiB);
+        EXPECT_EQ(rq->bufs().size(), 2uz);
+        return 0;
+      });
+  EXPECT_CALL(h(1), submit(Matcher<std::shared_ptr<readv_query>>(NotNull())))
+      .WillOnce([](std::shared_ptr<readv_query> rq) {
+        EXPECT_EQ(rq->offset(), 0uz);
+        EXPECT_EQ(rq->size(), 4_KiB);
+        EXPECT_EQ(rq->bufs().size(), 1uz);
+        return 0;
+      });
+
+  EXPECT_EQ(target_->process(readv_query::create(bufs, kMemberSzs[0] - 4_KiB)),
+            0);
+}
+
+TEST_F(Linear, MemberFailureFailsTheQuery) {
+  EXPECT_CALL(h(1), submit(Matcher<std::shared_ptr<read_query>>(NotNull())))
+      .WillOnce([](std::shared_ptr<read_query> rq) {
+        rq->set_err(EIO);
+        return 0;
+      });
+  EXPECT_CALL(h(2), submit(Matcher<std::shared_ptr<read_query>>(NotNull())))
+      .WillOnce(Return(0));
+
+  auto err{0};
+  auto const buf{mm::make_unique_zeroed_bytes(4_KiB)};
+  EXPECT_EQ(target_->process(read_query::create(
+                std::span{buf.get(), 4_KiB},
+                kMemberSzs[0] + kMemberSzs[1] - 1_KiB,
+                [&err](read_query const &rq) { err = rq.err(); })),
+            0);
+  EXPECT_EQ(err, EIO);
+}
+
+TEST_F(Linear, FailedOutOfRange) {
+  auto const buf{mm::make_unique_zeroed_bytes(1_KiB)};
+  EXPECT_EQ(target_->process(read_query::create(std::span{buf.get(), 1_KiB},
+                                                target_->size() - 512)),
+            EINVAL);
+  EXPECT_EQ(target_->process(discard_query::create(target_->size(), 512)),
+            EINVAL);
+}
+
+TEST_F(Linear, AppendedMemberGrowsTheTarget) {
+  auto const sz{target_->size()};
+  target_->append(member(16_KiB));
+  EXPECT_EQ(target_->size(), sz + 16_KiB);
+
+  EXPECT_CALL(h(2), submit(Matcher<std::shared_ptr<write_query>>(NotNull())))
+      .WillOnce([](std::shared_ptr<write_query> wq) {
+        EXPECT_EQ(wq->offset(), kMemberSzs[2] - 1_KiB);
+        return 0;
+      });
+  EXPECT_CALL(h(3), submit(Matcher<std::shared_ptr<write_query>>(NotNull())))
+      .WillOnce([](std::shared_ptr<write_query> wq) {
+        EXPECT_EQ(wq->offset(), 0uz);
+        EXPECT_EQ(wq->buf().size(), 3_KiB);
+        return 0;
+      });
+
+  auto const buf{mm::make_unique_zeroed_bytes(4_KiB)};
+  EXPECT_EQ(target_->process(write_query::create(
+                std::span<std::byte const>{buf.get(), 4_KiB}, sz - 1_KiB)),
+            0);
+}
+
+TEST_F(Linear, DiscardGetsSplit) {
+  EXPECT_CALL(discarder(0), submit(NotNull()))
+      .WillOnce([](std::shared_ptr<discard_query> dq) {
+        EXPECT_EQ(dq->offset(), 4_KiB);
+        EXPECT_EQ(dq->size(), kMemberSzs[0] - 4_KiB);
+        return 0;
+      });
+  EXPECT_CALL(discarder(1), submit(NotNull()))
+      .WillOnce([](std::shared_ptr<discard_query> dq) {
+        EXPECT_EQ(dq->offset(), 0uz);
+        EXPECT_EQ(dq->size(), kMemberSzs[1]);
+        return 0;
+      });
+  EXPECT_CALL(discarder(2), submit(NotNull()))
+      .WillOnce([](std::shared_ptr<discard_query> dq) {
+        EXPECT_EQ(dq->offset(), 0uz);
+        EXPECT_EQ(dq->size(), 1_KiB);
+        return 0;
+      });
+
+  EXPECT_EQ(target_->process(discard_query::create(
+                4_KiB, kMemberSzs[0] - 4_KiB + kMemberSzs[1] + 1_KiB)),
+            0);
+}
+
+} // namespace ublk::ut::linear
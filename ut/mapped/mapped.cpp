@@ -0,0 +1,179 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cerrno>
+#include <cstddef>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <memory>
+#include <span>
+
+#include "mm/mem.hpp"
+#include "mm/mem_types.hpp"
+
+#include "utils/size_units.hpp"
+
+#include "mapped/target.hpp"
+
+#include "discard_query.hpp"
+#include "flush_query.hpp"
+#include "read_query.hpp"
+#include "write_query.hpp"
+
+using namespace testing;
+
+namespace ublk::ut::mapped {
+
+namespace {
+
+class Mapped : public Test {
+protected:
+  void SetUp() override {
+    fd_ = ::memfd_create("mapped_ut", 0);
+    ASSERT_GE(fd_, 0);
+    target_create(false);
+  }
+
+  void TearDown() override {
+    target_.reset();
+    ::close(fd_);
+  }
+
+  void target_create(bool punch_holes) {
+    target_.reset();
+    auto mem{ublk::mapped::map(fd_, kStorageSz, false, false)};
+    target_ = std::make_unique<ublk::mapped::Target>(
+        mm::uptrwd<int const>{new int{::dup(fd_)},
+                              [](int const *fd) {
+                                ::close(*fd);
+                                delete fd;
+                              }},
+        std::move(mem), kStorageSz, punch_holes);
+  }
+
+  static blkcnt_t blocks_allocated(int fd) {
+    struct stat st;
+    EXPECT_EQ(::fstat(fd, &st), 0);
+    return st.st_blocks;
+  }
+
+  /*
+   * Returns the blocks allocated right after the discard, reading the range
+   * back through the mapping may allocate them again
+   */
+  blkcnt_t discarded_zeroes_check() {
+    constexpr auto kDiscardOffset{4_KiB + 512uz};
+    constexpr auto kDiscardSz{32_KiB + 1_KiB};
+
+    auto const wbuf{mm::make_unique_randomized_bytes(kStorageSz)};
+    auto const wbuf_span{std::span<std::byte const>{wbuf.get(), kStorageSz}};
+    EXPECT_EQ(target_->process(write_query::create(wbuf_span, 0)), 0);
+
+    EXPECT_EQ(
+        target_->process(discard_query::create(kDiscardOffset, kDiscardSz)),
+        0);
+    auto const blocks{blocks_allocated(fd_)};
+
+    auto const rbuf{mm::make_unique_zeroed_bytes(kStorageSz)};
+    auto const rbuf_span{std::span{rbuf.get(), kStorageSz}};
+    EXPECT_EQ(target_->process(read_query::create(rbuf_span, 0)), 0);
+
+    EXPECT_THAT(rbuf_span.first(kDiscardOffset),
+                ElementsAreArray(wbuf_span.first(kDiscardOffset)));
+    EXPECT_THAT(rbuf_span.subspan(kDiscardOffset, kDiscardSz),
+                Each(std::byte{0}));
+    EXPECT_THAT(
+        rbuf_span.subspan(kDiscardOffset + kDiscardSz),
+        ElementsAreArray(wbuf_span.subspan(kDiscardOffset + kDiscardSz)));
+
+    return blocks;
+  }
+
+  static constexpr auto kStorageSz{64_KiB};
+
+  int fd_{-1};
+  std::unique_ptr<ublk::mapped::Target> target_;
+};
+
+} // namespace
+
+TEST_F(Mapped, ShortFileGetsExtendedAndAllocated) {
+  struct stat st;
+  ASSERT_EQ(::fstat(fd_, &st), 0);
+  EXPECT_EQ(static_cast<size_t>(st.st_size), kStorageSz);
+  EXPECT_GE(static_cast<size_t>(st.st_blocks) * 512, kStorageSz);
+}
+
+TEST_F(Mapped, WrittenReachesTheFileAndReadsBack) {
+  constexpr auto kOffset{4_KiB + 512uz};
+  constexpr auto kSz{8_KiB};
+
+  auto const wbuf{mm::make_unique_randomized_bytes(kSz)};
+  auto const wbuf_span{std::span<std::byte const>{wbuf.get(), kSz}};
+  EXPECT_EQ(target_->process(write_query::create(
+                wbuf_span, kOffset,
+                [](write_query const &wq) { EXPECT_EQ(wq.err(), 0); })),
+            0);
+
+  auto const fbuf{mm::make_unique_zeroed_bytes(kSz)};
+  ASSERT_EQ(::pread(fd_, fbuf.get(), kSz, kOffset), static_cast<ssize_t>(kSz));
+  EXPECT_THAT(std::span(fbuf.get(), kSz), ElementsAreArray(wbuf_span));
+
+  auto const rbuf{mm::make_unique_zeroed_bytes(kSz)};
+  auto const rbuf_span{std::span{rbuf.get(), kSz}};
+  EXPECT_EQ(target_->process(read_query::create(rbuf_span, kOffset)), 0);
+  EXPECT_THAT(rbuf_span, ElementsAreArray(wbuf_span));
+}
+
+TEST_F(Mapped, FlushSyncsWhatHasBeenWritten) {
+  auto const buf{mm::make_unique_randomized_bytes(4_KiB)};
+  auto const buf_span{std::span<std::byte const>{buf.get(), 4_KiB}};
+
+  for (auto const off : {0_KiB, 2_KiB, 32_KiB, 60_KiB})
+    EXPECT_EQ(target_->process(write_query::create(buf_span, off)), 0);
+
+  auto wq{write_query::create(buf_span, 16_KiB)};
+  wq->set_fua(true);
+  EXPECT_EQ(target_->process(std::move(wq)), 0);
+
+  auto err{-1};
+  EXPECT_EQ(target_->process(flush_query::create(
+                [&err](flush_query const &fq) { err = fq.err(); })),
+            0);
+  EXPECT_EQ(err, 0);
+
+  /* nothing left to sync */
+  EXPECT_EQ(target_->process(flush_query::create(
+                [](flush_query const &fq) { EXPECT_EQ(fq.err(), 0); })),
+            0);
+}
+
+TEST_F(Mapped, DiscardedRangeReadsBackAsZeroesStayingAllocated) {
+  auto const blocks{blocks_allocated(fd_)};
+  EXPECT_EQ(discarded_zeroes_check(), blocks);
+}
+
+TEST_F(Mapped, DiscardedRangeReadsBackAsZeroesPunchedOnRequest) {
+  target_create(true);
+  auto const blocks{blocks_allocated(fd_)};
+  EXPECT_LT(discarded_zeroes_check(), blocks);
+}
+
+TEST_F(Mapped, FailedOutOfRange) {
+  auto const buf{mm::make_unique_zeroed_bytes(1_KiB)};
+  auto const buf_span{std::span{buf.get(), 1_KiB}};
+
+  EXPECT_EQ(target_->process(read_query::create(buf_span, kStorageSz - 512uz)),
+            EINVAL);
+  EXPECT_EQ(target_->process(write_query::create(
+                std::span<std::byte const>{buf_span}, kStorageSz - 512uz)),
+            EINVAL);
+  EXPECT_EQ(
+      target_->process(discard_query::create(kStorageSz - 512uz, 1_KiB)),
+      EINVAL);
+}
+
+} // namespace ublk::ut::mapped
@@ -0,0 +1,170 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstddef>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <iterator>
+#include <latch>
+#include <memory>
+#include <ranges>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "mm/mem_allocator.hpp"
+#include "mm/mem_pool_allocator.hpp"
+#include "mm/pool_allocator.hpp"
+
+using namespace testing;
+
+namespace ublk::ut::mm {
+
+namespace {
+
+/* every test gets an object type of its own, so a pool of its own */
+template <size_t Tag> struct obj {
+  std::array<std::byte, 48> data;
+};
+
+struct counting_allocator : ublk::mm::mem_allocator {
+  void *allocate_aligned(size_t alignment, size_t sz) noexcept override {
+    ++allocated_nr;
+    return ublk::mm::mem_allocator::allocate_aligned(alignment, sz);
+  }
+
+  size_t allocated_nr{0};
+};
+
+template <typename T> auto allocate(size_t nr) {
+  auto ps{std::vector<T *>{}};
+  std::generate_n(std::back_inserter(ps), nr,
+                  [] { return ublk::mm::pool_allocator<T>{}.allocate(1); });
+  return ps;
+}
+
+template <typename T> void deallocate(std::vector<T *> const &ps) {
+  for (auto *p : ps)
+    ublk::mm::pool_allocator<T>{}.deallocate(p, 1);
+}
+
+} // namespace
+
+TEST(Pool, SameThreadTrafficStaysOnItsFreeList) {
+  constexpr auto kNr{16uz};
+  constexpr auto kRoundsNr{256uz};
+
+  auto a{std::make_shared<counting_allocator>()};
+  auto pool{ublk::mm::mem_pool_allocator<obj<0>>{a}};
+
+  auto ps{std::vector<void *>(kNr)};
+  for (auto i{0uz}; i < kRoundsNr; ++i) {
+    std::ranges::generate(ps, [&pool] { return pool.allocate(); });
+    for (auto *p : ps | std::views::reverse)
+      pool.free(p);
+  }
+
+  /* a block freed is the next one handed out, nothing more gets allocated */
+  EXPECT_EQ(a->allocated_nr, kNr);
+  EXPECT_EQ(pool.allocate(), ps.front());
+  pool.free(ps.front());
+}
+
+TEST(Pool, FreedInAnotherThreadGoBackToTheOwner) {
+  constexpr auto kNr{16uz};
+
+  auto a{std::make_shared<counting_allocator>()};
+  auto owner{ublk::mm::mem_pool_allocator<obj<1>>{a}};
+  auto other{ublk::mm::mem_pool_allocator<obj<1>>{a}};
+
+  auto ps{std::vector<void *>(kNr)};
+  std::ranges::generate(ps, [&owner] { return owner.allocate(); });
+
+  std::jthread{[&] {
+    for (auto *p : ps)
+      other.free(p);
+  }}.join();
+
+  /* the other pool has kept nothing */
+  auto *p{other.allocate()};
+  EXPECT_THAT(ps, Not(Contains(p)));
+  other.free(p);
+
+  auto again{std::vector<void *>(kNr)};
+  std::ranges::generate(again, [&owner] { return owner.allocate(); });
+  EXPECT_THAT(again, UnorderedElementsAreArray(ps));
+  EXPECT_EQ(a->allocated_nr, kNr + 1);
+
+  for (auto *p : again)
+    owner.free(p);
+}
+
+TEST(Pool, PoolOfAThreadGoneGetsAdopted) {
+  using T = obj<2>;
+  constexpr auto kNr{64uz};
+
+  auto ps{std::vector<T *>{}};
+  auto allocated{std::latch{1}};
+  auto freed{std::latch{1}};
+  auto allocator{
+      std::jthread{[&] {
+        ps = allocate<T>(kNr);
+        allocated.count_down();
+        freed.wait();
+      }},
+  };
+  allocated.wait();
+
+  /* freed by a thread other than the one they have been allocated by */
+  deallocate(ps);
+  freed.count_down();
+  allocator.join();
+
+  auto again{std::vector<T *>{}};
+  std::jthread{[&again] { again = allocate<T>(kNr); }}.join();
+
+  EXPECT_THAT(again, UnorderedElementsAreArray(ps));
+  deallocate(again);
+}
+
+TEST(Pool, CrossThreadTrafficDoesNotGrowThePool) {
+  using T = obj<3>;
+  constexpr auto kNr{32uz};
+  constexpr auto kRoundsNr{256uz};
+
+  auto seen{std::set<T *>{}};
+  auto handed{std::atomic<std::vector<T *> *>{nullptr}};
+  auto done{std::atomic<bool>{false}};
+
+  /* one thread allocates, another one frees, as the ring and the workers do */
+  auto freer{
+      std::jthread{[&] {
+        while (!done.load() || handed.load()) {
+          if (auto *ps = handed.exchange(nullptr)) {
+            deallocate(*ps);
+            delete ps;
+          }
+        }
+      }},
+  };
+
+  for (auto i{0uz}; i < kRoundsNr; ++i) {
+    auto *ps{new std::vector<T *>{allocate<T>(kNr)}};
+    seen.insert(ps->begin(), ps->end());
+    while (handed.load())
+      std::this_thread::yield();
+    handed.store(ps);
+  }
+  done.store(true);
+  freer.join();
+
+  /*
+   * A batch being freed, one handed over and one just allocated are out at
+   * once at most, the rest comes back to the pool
+   */
+  EXPECT_LE(seen.size(), 3 * kNr);
+}
+
+} // namespace ublk::ut::mm
@@ -0,0 +1,214 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cerrno>
+#include <cstddef>
+
+#include <chrono>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+
+#include "mm/mem.hpp"
+
+#include "utils/size_units.hpp"
+
+#include "helpers.hpp"
+
+#include "plug/rw_handler.hpp"
+
+#include "read_query.hpp"
+#include "readv_query.hpp"
+#include "sg_bufs.hpp"
+#include "write_query.hpp"
+#include "writev_query.hpp"
+
+using namespace testing;
+
+namespace ublk::ut::plug {
+
+namespace {
+
+class Merge : public Test {
+protected:
+  void SetUp() override {
+    h_ = std::make_shared<MockRWHandler>();
+    buf_ = mm::make_unique_zeroed_bytes(kBufSz);
+    plug(0);
+  }
+
+  void plug(uint64_t max_sz, std::chrono::microseconds window = {}) {
+    plug_ = std::make_unique<ublk::plug::RWHandler>(io_ctx_, h_, max_sz,
+                                                    window);
+  }
+
+  auto buf(size_t off, size_t sz) const noexcept {
+    return std::span{buf_.get() + off, sz};
+  }
+
+  static constexpr auto kBufSz{64_KiB};
+
+  boost::asio::io_context io_ctx_;
+  std::shared_ptr<MockRWHandler> h_;
+  std::unique_ptr<ublk::plug::RWHandler> plug_;
+  std::unique_ptr<std::byte[]> buf_;
+};
+
+} // namespace
+
+TEST_F(Merge, AdjacentWritesGoDownAsOne) {
+  EXPECT_CALL(*h_, submit(Matcher<std::shared_ptr<writev_query>>(NotNull())))
+      .WillOnce([this](std::shared_ptr<writev_query> wq) {
+        EXPECT_EQ(wq->offset(), 0uz);
+        EXPECT_EQ(wq->size(), 16_KiB);
+        EXPECT_FALSE(wq->fua());
+        auto off{0uz};
+        for (auto const b : wq->bufs()) {
+          EXPECT_EQ(b.data(), buf(off, b.size()).data());
+          off += b.size();
+        }
+        return 0;
+      });
+
+  auto errs{std::vector<int>{}};
+  /* out of order, the plug sorts them by LBA */
+  for (auto const off : {8_KiB, 0_KiB, 12_KiB, 4_KiB}) {
+    EXPECT_EQ(plug_->submit(write_query::create(
+                  buf(off, 4_KiB), off,
+                  [&errs](write_query const &wq) {
+                    errs.push_back(wq.err());
+                  })),
+              0);
+  }
+
+  /* nothing goes down before the batch is over */
+  EXPECT_TRUE(errs.empty());
+  io_ctx_.run();
+  EXPECT_THAT(errs, ElementsAre(0, 0, 0, 0));
+}
+
+TEST_F(Merge, NotAdjacentGoDownAsTheyAre) {
+  EXPECT_CALL(*h_, submit(Matcher<std::shared_ptr<read_query>>(NotNull())))
+      .Times(2)
+      .WillRepeatedly(Return(0));
+
+  EXPECT_EQ(plug_->submit(read_query::create(buf(0, 4_KiB), 0)), 0);
+  EXPECT_EQ(plug_->submit(read_query::create(buf(8_KiB, 4_KiB), 8_KiB)), 0);
+  io_ctx_.run();
+}
+
+TEST_F(Merge, ReadsAndWritesDoNotMix) {
+  EXPECT_CALL(*h_, submit(Matcher<std::shared_ptr<readv_query>>(NotNull())))
+      .WillOnce([](std::shared_ptr<readv_query> rq) {
+        EXPECT_EQ(rq->offset(), 0uz);
+        EXPECT_EQ(rq->size(), 8_KiB);
+        return 0;
+      });
+  EXPECT_CALL(*h_, submit(Matcher<std::shared_ptr<write_query>>(NotNull())))
+      .WillOnce(Return(0));
+
+  EXPECT_EQ(plug_->submit(read_query::create(buf(0, 4_KiB), 0)), 0);
+  EXPECT_EQ(plug_->submit(write_query::create(buf(4_KiB, 4_KiB), 4_KiB)), 0);
+  auto const bufs{sg_bufs<std::byte>{buf(4_KiB, 4_KiB)}};
+  EXPECT_EQ(plug_->submit(readv_query::create(bufs, 4_KiB)), 0);
+  io_ctx_.run();
+}
+
+TEST_F(Merge, NoLongerThanMaxSz) {
+  plug(8_KiB);
+
+  auto szs{std::vector<size_t>{}};
+  EXPECT_CALL(*h_, submit(Matcher<std::shared_ptr<writev_query>>(NotNull())))
+      .WillRepeatedly([&szs](std::shared_ptr<writev_query> wq) {
+        szs.push_back(wq->size());
+        return 0;
+      });
+  EXPECT_CALL(*h_, submit(Matcher<std::shared_ptr<write_query>>(NotNull())))
+      .WillRepeatedly([&szs](std::shared_ptr<write_query> wq) {
+        szs.push_back(wq->buf().size());
+        return 0;
+      });
+
+  for (auto const off : {0_KiB, 4_KiB, 8_KiB})
+    EXPECT_EQ(plug_->submit(write_query::create(buf(off, 4_KiB), off)), 0);
+  io_ctx_.run();
+
+  EXPECT_THAT(szs, ElementsAre(8_KiB, 4_KiB));
+}
+
+TEST_F(Merge, LongerThanMaxSzGetSplit) {
+  plug(8_KiB);
+
+  auto offs{std::vector<uint64_t>{}};
+  EXPECT_CALL(*h_, submit(Matcher<std::shared_ptr<read_query>>(NotNull())))
+      .Times(3)
+      .WillRepeatedly([&offs](std::shared_ptr<read_query> rq) {
+        EXPECT_LE(rq->buf().size(), 8_KiB);
+        offs.push_back(rq->offset());
+        return 0;
+      });
+
+  auto err{-1};
+  EXPECT_EQ(plug_->submit(read_query::create(
+                buf(0, 20_KiB), 0,
+                [&err](read_query const &rq) { err = rq.err(); })),
+            0);
+  io_ctx_.run();
+
+  EXPECT_THAT(offs, ElementsAre(0_KiB, 8_KiB, 16_KiB));
+  EXPECT_EQ(err, 0);
+}
+
+TEST_F(Merge, FailureFansOut) {
+  EXPECT_CALL(*h_, submit(Matcher<std::shared_ptr<readv_query>>(NotNull())))
+      .WillOnce([](std::shared_ptr<readv_query> rq) {
+        rq->set_err(EIO);
+        return 0;
+      });
+
+  auto errs{std::vector<int>{}};
+  for (auto const off : {0_KiB, 4_KiB, 8_KiB}) {
+    EXPECT_EQ(plug_->submit(read_query::create(
+                  buf(off, 4_KiB), off,
+                  [&errs](read_query const &rq) {
+                    errs.push_back(rq.err());
+                  })),
+              0);
+  }
+  io_ctx_.run();
+
+  EXPECT_THAT(errs, ElementsAre(EIO, EIO, EIO));
+}
+
+TEST_F(Merge, FUAOfAnyGoesWithTheMerged) {
+  EXPECT_CALL(*h_, submit(Matcher<std::shared_ptr<writev_query>>(NotNull())))
+      .WillOnce([](std::shared_ptr<writev_query> wq) {
+        EXPECT_TRUE(wq->fua());
+        return 0;
+      });
+
+  EXPECT_EQ(plug_->submit(write_query::create(buf(0, 4_KiB), 0)), 0);
+  auto wq{write_query::create(buf(4_KiB, 4_KiB), 4_KiB)};
+  wq->set_fua(true);
+  EXPECT_EQ(plug_->submit(std::move(wq)), 0);
+  io_ctx_.run();
+}
+
+TEST_F(Merge, WindowSpansBatches) {
+  plug(0, std::chrono::milliseconds{1});
+
+  EXPECT_CALL(*h_, submit(Matcher<std::shared_ptr<writev_query>>(NotNull())))
+      .WillOnce([](std::shared_ptr<writev_query> wq) {
+        EXPECT_EQ(wq->size(), 8_KiB);
+        return 0;
+      });
+
+  EXPECT_EQ(plug_->submit(write_query::create(buf(0, 4_KiB), 0)), 0);
+  io_ctx_.poll();
+  EXPECT_EQ(plug_->submit(write_query::create(buf(4_KiB, 4_KiB), 4_KiB)), 0);
+  io_ctx_.run();
+}
+
+} // namespace ublk::ut::plug
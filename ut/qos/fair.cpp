@@ -0,0 +1,182 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstddef>
+
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+
+#include "mm/mem.hpp"
+
+#include "utils/size_units.hpp"
+
+#include "helpers.hpp"
+
+#include "qos/fair_group.hpp"
+#include "qos/fair_rw_handler.hpp"
+
+#include "target_stats.hpp"
+#include "write_query.hpp"
+
+using namespace std::chrono_literals;
+using namespace testing;
+
+namespace ublk::ut::qos {
+
+using ublk::qos::fair_flow;
+using ublk::qos::fair_group;
+
+namespace {
+
+class Fair : public testing::Test {
+protected:
+  void SetUp() override {
+    group_ = std::make_shared<fair_group>();
+    now_ = fair_flow::clock::now();
+  }
+
+  std::shared_ptr<fair_group> group_;
+  fair_flow::clock::time_point now_;
+};
+
+} // namespace
+
+TEST_F(Fair, AloneNeverWaits) {
+  auto a{fair_flow::join(group_, 0)};
+  ASSERT_TRUE(a);
+
+  a->backlog_inc(now_);
+  for (auto i{0}; i < 16; ++i) {
+    EXPECT_TRUE(a->may_dispatch(now_));
+    a->dispatched(1_MiB, now_);
+  }
+}
+
+TEST_F(Fair, AheadWaitsForBacklogged) {
+  auto a{fair_flow::join(group_, 0)};
+  auto b{fair_flow::join(group_, 0)};
+  ASSERT_TRUE(a && b);
+
+  a->backlog_inc(now_);
+  b->backlog_inc(now_);
+
+  auto dispatched{0};
+  while (a->may_dispatch(now_)) {
+    a->dispatched(1_MiB, now_);
+    ++dispatched;
+  }
+  EXPECT_GT(dispatched, 0);
+
+  /* b catches up, a may go on */
+  while (!a->may_dispatch(now_))
+    b->dispatched(1_MiB, now_);
+  EXPECT_TRUE(b->may_dispatch(now_));
+}
+
+TEST_F(Fair, IdleIsNotWaitedFor) {
+  auto a{fair_flow::join(group_, 0)};
+  auto b{fair_flow::join(group_, 0)};
+  ASSERT_TRUE(a && b);
+
+  a->backlog_inc(now_);
+  b->backlog_inc(now_);
+  b->backlog_dec(now_);
+
+  for (auto i{0}; i < 16; ++i) {
+    EXPECT_TRUE(a->may_dispatch(now_));
+    a->dispatched(1_MiB, now_);
+  }
+
+  /* b starts off a, it has not saved up the time it has been idle for */
+  b->backlog_inc(now_);
+  EXPECT_TRUE(a->may_dispatch(now_));
+}
+
+TEST_F(Fair, StuckIsNotWaitedFor) {
+  auto a{fair_flow::join(group_, 0)};
+  auto b{fair_flow::join(group_, 0)};
+  ASSERT_TRUE(a && b);
+
+  a->backlog_inc(now_);
+  b->backlog_inc(now_);
+  while (a->may_dispatch(now_))
+    a->dispatched(1_MiB, now_);
+
+  EXPECT_TRUE(a->may_dispatch(now_ + 2s));
+}
+
+TEST_F(Fair, SharesFollowWeights) {
+  auto a{fair_flow::join(group_, 300)};
+  auto b{fair_flow::join(group_, 100)};
+  ASSERT_TRUE(a && b);
+
+  a->backlog_inc(now_);
+  b->backlog_inc(now_);
+
+  auto a_mib{0};
+  auto b_mib{0};
+  for (auto i{0}; i < 4000; ++i) {
+    if (a->may_dispatch(now_)) {
+      a->dispatched(1_MiB, now_);
+      ++a_mib;
+    }
+    if (b->may_dispatch(now_) && (i % 2)) {
+      b->dispatched(1_MiB, now_);
+      ++b_mib;
+    }
+  }
+
+  EXPECT_NEAR(static_cast<double>(a_mib) / b_mib, 3.0, 0.1);
+}
+
+TEST_F(Fair, HandlerHoldsBackUntilOthersCatchUp) {
+  auto a{fair_flow::join(group_, 0)};
+  auto b{fair_flow::join(group_, 0)};
+  ASSERT_TRUE(a && b);
+
+  auto io_ctx{boost::asio::io_context{}};
+  auto h{std::make_shared<MockRWHandler>()};
+  auto stats{std::make_shared<target_stats>()};
+  auto fair_h{ublk::qos::FairRWHandler{io_ctx, h, *a, stats}};
+
+  auto const buf{mm::make_unique_zeroed_bytes(1_MiB)};
+  auto const buf_span{std::span{buf.get(), 1_MiB}};
+
+  /* the queries get completed right away, b stays backlogged meanwhile */
+  auto dispatched{0};
+  EXPECT_CALL(*h, submit(Matcher<std::shared_ptr<write_query>>(NotNull())))
+      .WillRepeatedly([&dispatched](std::shared_ptr<write_query>) {
+        ++dispatched;
+        return 0;
+      });
+
+  b->backlog_inc(fair_flow::clock::now());
+  for (auto i{0}; i < 16; ++i)
+    EXPECT_EQ(fair_h.submit(write_query::create(buf_span, 0)), 0);
+
+  EXPECT_LT(dispatched, 16);
+  EXPECT_EQ(stats->qos_fair_waits, static_cast<uint64_t>(16 - dispatched));
+
+  b->backlog_dec(fair_flow::clock::now());
+  io_ctx.run();
+  EXPECT_EQ(dispatched, 16);
+}
+
+TEST_F(Fair, NoSlotLeft) {
+  auto flows{std::vector<std::optional<fair_flow>>{}};
+  for (auto i{0uz}; i < ublk::qos::kFairFlowsNr; ++i) {
+    flows.push_back(fair_flow::join(group_, 0));
+    ASSERT_TRUE(flows.back());
+  }
+  EXPECT_FALSE(fair_flow::join(group_, 0));
+
+  flows.front()->leave();
+  EXPECT_TRUE(fair_flow::join(group_, 0));
+}
+
+} // namespace ublk::ut::qos
@@ -0,0 +1,120 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstddef>
+
+#include <chrono>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include <boost/asio/io_context.hpp>
+
+#include "mm/mem.hpp"
+
+#include "utils/size_units.hpp"
+
+#include "helpers.hpp"
+
+#include "qos/limits.hpp"
+#include "qos/rw_handler.hpp"
+
+#include "read_query.hpp"
+#include "target_stats.hpp"
+#include "write_query.hpp"
+
+using namespace testing;
+
+namespace ublk::ut::qos {
+
+namespace {
+
+class Throttle : public Test {
+protected:
+  void SetUp() override {
+    h_ = std::make_shared<MockRWHandler>();
+    lims_ = std::make_shared<ublk::qos::limits>();
+    stats_ = std::make_shared<target_stats>();
+    buf_ = mm::make_unique_zeroed_bytes(kBufSz);
+    throttle_ = std::make_unique<ublk::qos::RWHandler>(io_ctx_, h_, lims_,
+                                                       stats_);
+  }
+
+  auto buf() const noexcept { return std::span{buf_.get(), kBufSz}; }
+
+  static constexpr auto kBufSz{4_KiB};
+
+  boost::asio::io_context io_ctx_;
+  std::shared_ptr<MockRWHandler> h_;
+  std::shared_ptr<ublk::qos::limits> lims_;
+  std::shared_ptr<target_stats> stats_;
+  std::unique_ptr<ublk::qos::RWHandler> throttle_;
+  std::unique_ptr<std::byte[]> buf_;
+};
+
+} // namespace
+
+TEST_F(Throttle, NoLimitsNoWait) {
+  EXPECT_CALL(*h_, submit(Matcher<std::shared_ptr<write_query>>(NotNull())))
+      .Times(64)
+      .WillRepeatedly(Return(0));
+
+  for (auto i{0}; i < 64; ++i)
+    EXPECT_EQ(throttle_->submit(write_query::create(buf(), 0)), 0);
+
+  EXPECT_EQ(stats_->qos_throttled, 0u);
+}
+
+TEST_F(Throttle, IOPSLimitHoldsBack) {
+  lims_->read_iops = 100;
+
+  auto offs{std::vector<uint64_t>{}};
+  EXPECT_CALL(*h_, submit(Matcher<std::shared_ptr<read_query>>(NotNull())))
+      .WillRepeatedly([&offs](std::shared_ptr<read_query> rq) {
+        offs.push_back(rq->offset());
+        return 0;
+      });
+
+  /* 100ms of burst lets 11 through at once */
+  for (auto i{0uz}; i < 16; ++i)
+    EXPECT_EQ(throttle_->submit(read_query::create(buf(), i * kBufSz)), 0);
+  EXPECT_EQ(offs.size(), 11uz);
+  EXPECT_EQ(stats_->qos_throttled, 5u);
+
+  auto const start{std::chrono::steady_clock::now()};
+  io_ctx_.run();
+  EXPECT_GE(std::chrono::steady_clock::now() - start,
+            std::chrono::milliseconds{40});
+
+  /* in the order they have come in */
+  ASSERT_EQ(offs.size(), 16uz);
+  for (auto i{0uz}; i < offs.size(); ++i)
+    EXPECT_EQ(offs[i], i * kBufSz);
+  EXPECT_GT(stats_->qos_throttled_us, 0u);
+}
+
+TEST_F(Throttle, DirectionsDoNotHoldEachOther) {
+  lims_->write_bps = 4_KiB;
+
+  EXPECT_CALL(*h_, submit(Matcher<std::shared_ptr<write_query>>(NotNull())))
+      .WillOnce(Return(0));
+  EXPECT_CALL(*h_, submit(Matcher<std::shared_ptr<read_query>>(NotNull())))
+      .Times(8)
+      .WillRepeatedly(Return(0));
+
+  EXPECT_EQ(throttle_->submit(write_query::create(buf(), 0)), 0);
+  EXPECT_EQ(throttle_->submit(write_query::create(buf(), 0)), 0);
+  for (auto i{0}; i < 8; ++i)
+    EXPECT_EQ(throttle_->submit(read_query::create(buf(), 0)), 0);
+  EXPECT_EQ(stats_->qos_throttled, 1u);
+
+  Mock::VerifyAndClearExpectations(h_.get());
+
+  /* lifting the limit lets the one held through by the next check */
+  EXPECT_CALL(*h_, submit(Matcher<std::shared_ptr<write_query>>(NotNull())))
+      .WillOnce(Return(0));
+  lims_->write_bps = 0;
+  io_ctx_.run();
+}
+
+} // namespace ublk::ut::qos
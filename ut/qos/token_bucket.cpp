@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+
+#include "qos/token_bucket.hpp"
+
+using namespace std::chrono_literals;
+
+namespace ublk::ut::qos {
+
+using ublk::qos::token_bucket;
+
+TEST(TokenBucket, NoRateNoWait) {
+  auto tb{token_bucket{}};
+  auto const now{token_bucket::clock::now()};
+
+  tb.take(1'000'000, 0, now);
+  EXPECT_EQ(tb.wait(0, now), token_bucket::clock::duration::zero());
+}
+
+TEST(TokenBucket, BurstPassesAtOnce) {
+  auto tb{token_bucket{100ms}};
+  auto const now{token_bucket::clock::now()};
+
+  /* 10 per second, 100ms of burst lets 2 of them through at once */
+  for (auto i{0}; i < 2; ++i) {
+    EXPECT_EQ(tb.wait(10, now), token_bucket::clock::duration::zero());
+    tb.take(1, 10, now);
+  }
+  EXPECT_EQ(tb.wait(10, now), 100ms);
+  EXPECT_EQ(tb.wait(10, now + 100ms), token_bucket::clock::duration::zero());
+}
+
+TEST(TokenBucket, DebtOfLargeTakes) {
+  auto tb{token_bucket{100ms}};
+  auto const now{token_bucket::clock::now()};
+
+  /* a single take of 3 seconds worth passes, the ones after pay for it */
+  EXPECT_EQ(tb.wait(1024, now), token_bucket::clock::duration::zero());
+  tb.take(3 * 1024, 1024, now);
+  EXPECT_EQ(tb.wait(1024, now), 2900ms);
+}
+
+TEST(TokenBucket, RateChangeTakesEffect) {
+  auto tb{token_bucket{100ms}};
+  auto const now{token_bucket::clock::now()};
+
+  tb.take(10, 10, now);
+  EXPECT_GT(tb.wait(10, now), token_bucket::clock::duration::zero());
+  /* the limit is off now */
+  EXPECT_EQ(tb.wait(0, now), token_bucket::clock::duration::zero());
+}
+
+} // namespace ublk::ut::qos
@@ -6,6 +6,7 @@
 #include <cstddef>
 
 #include <algorithm>
+#include <functional>
 #include <memory>
 #include <ranges>
 #include <vector>
@@ -19,6 +20,7 @@ namespace ublk::ut::raid0 {
 struct backend_cfg {
   size_t strip_sz;
   size_t strips_per_stripe_nr;
+  bool sg_coalesce{false};
 };
 
 template <typename ParamType>
@@ -41,7 +43,9 @@ protected:
             std::views::transform([](auto const &hs_ctx) { return hs_ctx.h; }),
     };
 
-    be_ = std::make_unique<ublk::raid0::backend>(be_cfg.strip_sz, hs);
+    be_ = std::make_unique<ublk::raid0::backend>(be_cfg.strip_sz, hs,
+                                                 std::function<void(int)>{},
+                                                 be_cfg.sg_coalesce);
   }
 
   void TearDown() override {
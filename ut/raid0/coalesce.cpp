@@ -0,0 +1,224 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cerrno>
+#include <cstddef>
+
+#include <algorithm>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "mm/mem.hpp"
+
+#include "read_query.hpp"
+#include "readv_query.hpp"
+#include "write_query.hpp"
+#include "writev_query.hpp"
+
+#include "base.hpp"
+
+using namespace ublk;
+using namespace testing;
+
+namespace {
+
+struct coalesce_param {
+  ut::raid0::backend_cfg be_cfg;
+  size_t stripes_nr;
+  size_t off;
+  size_t sz;
+};
+
+class Coalesce : public ut::raid0::Base<coalesce_param> {
+protected:
+  /* Backends touched by the range must get a single query each */
+  void expect(size_t off, size_t sz, auto &&f) {
+    auto const &be_cfg{GetParam().be_cfg};
+    auto touched{std::vector<bool>(be_cfg.strips_per_stripe_nr)};
+    for (auto strip_id{off / be_cfg.strip_sz};
+         strip_id <= (off + sz - 1) / be_cfg.strip_sz; ++strip_id) {
+      touched[strip_id % be_cfg.strips_per_stripe_nr] = true;
+    }
+    for (auto hid{0uz}; hid < touched.size(); ++hid) {
+      if (touched[hid])
+        f(hid);
+    }
+  }
+};
+
+} // namespace
+
+TEST_P(Coalesce, WriteThenRead) {
+  auto const &param{GetParam()};
+  auto const &be_cfg{param.be_cfg};
+
+  auto const storage_sz{be_cfg.strip_sz * param.stripes_nr};
+  auto const storages{
+      ut::make_unique_zeroed_storages(storage_sz, be_cfg.strips_per_stripe_nr),
+  };
+  auto const storage_spans{ut::storages_to_spans(storages, storage_sz)};
+
+  auto const src{mm::make_unique_randomized_bytes(param.sz)};
+  auto const src_span{std::as_bytes(std::span{src.get(), param.sz})};
+
+  expect(param.off, param.sz, [&](size_t hid) {
+    EXPECT_CALL(*backend_ctxs_[hid].h,
+                submit(Matcher<std::shared_ptr<writev_query>>(NotNull())))
+        .WillOnce([to = storage_spans[hid]](std::shared_ptr<writev_query> wq) {
+          EXPECT_LE(wq->offset() + wq->size(), to.size());
+          auto off{wq->offset()};
+          for (auto const buf : wq->bufs()) {
+            std::ranges::copy(buf, to.begin() + off);
+            off += buf.size();
+          }
+          return 0;
+        });
+  });
+
+  auto err{-1};
+  EXPECT_EQ(be_->process(write_query::create(
+                src_span, param.off,
+                [&err](write_query const &wq) { err = wq.err(); })),
+            0);
+  EXPECT_EQ(err, 0);
+
+  for (auto i{0uz}; i < param.sz; ++i) {
+    auto const off{param.off + i};
+    auto const strip_id{off / be_cfg.strip_sz};
+    auto const hid{strip_id % be_cfg.strips_per_stripe_nr};
+    auto const stripe_id{strip_id / be_cfg.strips_per_stripe_nr};
+    ASSERT_EQ(storage_spans[hid][stripe_id * be_cfg.strip_sz +
+                                 off % be_cfg.strip_sz],
+              src_span[i]);
+  }
+
+  auto const dst{mm::make_unique_zeroed_bytes(param.sz)};
+  auto const dst_span{std::as_writable_bytes(std::span{dst.get(), param.sz})};
+
+  expect(param.off, param.sz, [&](size_t hid) {
+    EXPECT_CALL(*backend_ctxs_[hid].h,
+                submit(Matcher<std::shared_ptr<readv_query>>(NotNull())))
+        .WillOnce([from = storage_spans[hid]](std::shared_ptr<readv_query> rq) {
+          EXPECT_LE(rq->offset() + rq->size(), from.size());
+          auto off{rq->offset()};
+          for (auto const buf : rq->bufs()) {
+            std::ranges::copy(from.subspan(off, buf.size()), buf.begin());
+            off += buf.size();
+          }
+          return 0;
+        });
+  });
+
+  err = -1;
+  EXPECT_EQ(be_->process(read_query::create(
+                dst_span, param.off,
+                [&err](read_query const &rq) { err = rq.err(); })),
+            0);
+  EXPECT_EQ(err, 0);
+
+  EXPECT_THAT(dst_span, ElementsAreArray(src_span));
+}
+
+TEST_P(Coalesce, BackendFailure) {
+  auto const &param{GetParam()};
+
+  auto const buf{mm::make_unique_zeroed_bytes(param.sz)};
+  auto const buf_span{std::as_writable_bytes(std::span{buf.get(), param.sz})};
+
+  auto first{true};
+  expect(param.off, param.sz, [&](size_t hid) {
+    EXPECT_CALL(*backend_ctxs_[hid].h,
+                submit(Matcher<std::shared_ptr<readv_query>>(NotNull())))
+        .WillOnce([fail = std::exchange(first, false)](
+                      std::shared_ptr<readv_query> rq) {
+          /* a single backend failing fails the whole query */
+          if (fail)
+            rq->set_err(EIO);
+          return 0;
+        });
+  });
+
+  auto err{0};
+  EXPECT_EQ(be_->process(read_query::create(
+                buf_span, param.off,
+                [&err](read_query const &rq) { err = rq.err(); })),
+            0);
+  EXPECT_EQ(err, EIO);
+}
+
+TEST_P(Coalesce, FUAReachesBackends) {
+  auto const &param{GetParam()};
+
+  auto const buf{mm::make_unique_randomized_bytes(param.sz)};
+  auto const buf_span{std::as_bytes(std::span{buf.get(), param.sz})};
+
+  expect(param.off, param.sz, [&](size_t hid) {
+    EXPECT_CALL(*backend_ctxs_[hid].h,
+                submit(Matcher<std::shared_ptr<writev_query>>(NotNull())))
+        .WillOnce([](std::shared_ptr<writev_query> wq) {
+          EXPECT_TRUE(wq->fua());
+          return 0;
+        });
+  });
+
+  auto wq{write_query::create(buf_span, param.off)};
+  wq->set_fua(true);
+  EXPECT_EQ(be_->process(std::move(wq)), 0);
+}
+
+TEST_P(Coalesce, NoMoreStripsThanBackendsGoPerStrip) {
+  auto const &param{GetParam()};
+  auto const &be_cfg{param.be_cfg};
+
+  auto const sz{be_cfg.strip_sz * be_cfg.strips_per_stripe_nr};
+  auto const buf{mm::make_unique_randomized_bytes(sz)};
+  auto const buf_span{std::as_bytes(std::span{buf.get(), sz})};
+
+  for (auto const &ctx : backend_ctxs_) {
+    EXPECT_CALL(*ctx.h, submit(Matcher<std::shared_ptr<write_query>>(NotNull())))
+        .WillOnce([&be_cfg](std::shared_ptr<write_query> wq) {
+          EXPECT_EQ(wq->buf().size(), be_cfg.strip_sz);
+          return 0;
+        });
+  }
+
+  EXPECT_EQ(be_->process(write_query::create(buf_span, 0)), 0);
+}
+
+INSTANTIATE_TEST_SUITE_P(RAID0, Coalesce,
+                         Values(
+                             coalesce_param{
+                                 .be_cfg =
+                                     {
+                                         .strip_sz = 4096uz,
+                                         .strips_per_stripe_nr = 2uz,
+                                         .sg_coalesce = true,
+                                     },
+                                 .stripes_nr = 8uz,
+                                 .off = 0uz,
+                                 .sz = 8uz * 4096uz,
+                             },
+                             coalesce_param{
+                                 .be_cfg =
+                                     {
+                                         .strip_sz = 4096uz,
+                                         .strips_per_stripe_nr = 3uz,
+                                         .sg_coalesce = true,
+                                     },
+                                 .stripes_nr = 8uz,
+                                 .off = 1536uz,
+                                 .sz = 7uz * 4096uz + 512uz,
+                             },
+                             coalesce_param{
+                                 .be_cfg =
+                                     {
+                                         .strip_sz = 8192uz,
+                                         .strips_per_stripe_nr = 4uz,
+                                         .sg_coalesce = true,
+                                     },
+                                 .stripes_nr = 4uz,
+                                 .off = 512uz,
+                                 .sz = 4uz * 8192uz,
+                             }));
@@ -0,0 +1,146 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "discard_handler_interface.hpp"
+#include "discard_query.hpp"
+
+#include "raid0/discard_handler.hpp"
+
+#include "helpers.hpp"
+
+using namespace ublk;
+using namespace testing;
+
+namespace {
+
+struct discard_param {
+  size_t strip_sz;
+  size_t strips_per_stripe_nr;
+  size_t off;
+  size_t sz;
+};
+
+class Discard : public TestWithParam<discard_param> {
+protected:
+  void SetUp() override {
+    auto const &param{GetParam()};
+    hs_.resize(param.strips_per_stripe_nr);
+    std::ranges::generate(hs_, [] {
+      return std::make_shared<StrictMock<ut::MockDiscardHandler>>();
+    });
+    dh_ = std::make_unique<raid0::DiscardHandler>(param.strip_sz, hs_);
+  }
+
+  void TearDown() override {
+    dh_.reset();
+    hs_.clear();
+  }
+
+  /* Member ranges made up strip by strip, as reads and writes get split */
+  auto expected_ranges() const {
+    auto const &param{GetParam()};
+    auto ranges{
+        std::vector<std::pair<uint64_t, uint64_t>>(hs_.size(), {0, 0}),
+    };
+    for (auto off{param.off}; off < param.off + param.sz;) {
+      auto const strip_id{off / param.strip_sz};
+      auto const hid{strip_id % hs_.size()};
+      auto const strip_end{(strip_id + 1) * param.strip_sz};
+      auto const sz{std::min(strip_end, param.off + param.sz) - off};
+      auto const h_off{
+          strip_id / hs_.size() * param.strip_sz + off % param.strip_sz,
+      };
+      auto &[first, last]{ranges[hid]};
+      if (first == last)
+        first = last = h_off;
+      /* strips of a member follow each other on the member */
+      EXPECT_EQ(last, h_off);
+      last += sz;
+      off += sz;
+    }
+    return ranges;
+  }
+
+  std::vector<std::shared_ptr<ut::MockDiscardHandler>> hs_;
+  std::unique_ptr<raid0::DiscardHandler> dh_;
+};
+
+} // namespace
+
+TEST_P(Discard, SingleDiscardPerMember) {
+  auto const &param{GetParam()};
+  auto const ranges{expected_ranges()};
+
+  for (auto hid{0uz}; hid < hs_.size(); ++hid) {
+    auto const [first, last]{ranges[hid]};
+    if (first == last)
+      continue;
+    EXPECT_CALL(*hs_[hid], submit(NotNull()))
+        .WillOnce([first, last](std::shared_ptr<discard_query> dq) {
+          EXPECT_EQ(dq->offset(), first);
+          EXPECT_EQ(dq->size(), last - first);
+          return 0;
+        });
+  }
+
+  EXPECT_EQ(dh_->submit(discard_query::create(
+                param.off, param.sz,
+                [](discard_query const &dq) { EXPECT_EQ(dq.err(), 0); })),
+            0);
+}
+
+TEST_P(Discard, MemberFailure) {
+  auto const &param{GetParam()};
+
+  auto err{0};
+  for (auto const &h : hs_) {
+    EXPECT_CALL(*h, submit(NotNull()))
+        .Times(AtMost(1))
+        .WillRepeatedly([](std::shared_ptr<discard_query> dq) {
+          dq->set_err(EIO);
+          return 0;
+        });
+  }
+
+  EXPECT_EQ(dh_->submit(discard_query::create(
+                param.off, param.sz,
+                [&err](discard_query const &dq) { err = dq.err(); })),
+            0);
+  EXPECT_EQ(err, EIO);
+}
+
+INSTANTIATE_TEST_SUITE_P(RAID0, Discard,
+                         Values(
+                             discard_param{
+                                 .strip_sz = 4096uz,
+                                 .strips_per_stripe_nr = 2uz,
+                                 .off = 0uz,
+                                 .sz = 8uz * 4096uz,
+                             },
+                             discard_param{
+                                 .strip_sz = 4096uz,
+                                 .strips_per_stripe_nr = 3uz,
+                                 .off = 1536uz,
+                                 .sz = 7uz * 4096uz + 512uz,
+                             },
+                             discard_param{
+                                 .strip_sz = 8192uz,
+                                 .strips_per_stripe_nr = 4uz,
+                                 .off = 512uz,
+                                 .sz = 2048uz,
+                             },
+                             discard_param{
+                                 .strip_sz = 4096uz,
+                                 .strips_per_stripe_nr = 4uz,
+                                 .off = 3uz * 4096uz + 512uz,
+                                 .sz = 9uz * 4096uz,
+                             }));
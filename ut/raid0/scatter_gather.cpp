@@ -0,0 +1,274 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+
+#include <algorithm>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <vector>
+
+#include "mm/mem.hpp"
+
+#include "readv_query.hpp"
+#include "sg_bufs.hpp"
+#include "writev_query.hpp"
+
+#include "base.hpp"
+
+using namespace ublk;
+using namespace testing;
+
+namespace {
+
+struct scatter_gather_param {
+  ut::raid0::backend_cfg be_cfg;
+  size_t stripes_nr;
+  size_t off;
+  size_t sz;
+  size_t cell_sz;
+};
+
+class ScatterGather : public ut::raid0::Base<scatter_gather_param> {
+protected:
+  template <typename T>
+  static auto cells(std::span<T> buf, size_t cell_sz) noexcept {
+    auto bufs{sg_bufs<T>{}};
+    for (auto off{0uz}; off < buf.size(); off += cell_sz)
+      bufs.push_back(buf.subspan(off, std::min(cell_sz, buf.size() - off)));
+    return bufs;
+  }
+
+  /* Backends touched by the range must get a single query each */
+  void expect(size_t off, size_t sz, auto &&f) {
+    auto const &be_cfg{GetParam().be_cfg};
+    auto touched{std::vector<bool>(be_cfg.strips_per_stripe_nr)};
+    for (auto strip_id{off / be_cfg.strip_sz};
+         strip_id <= (off + sz - 1) / be_cfg.strip_sz; ++strip_id) {
+      touched[strip_id % be_cfg.strips_per_stripe_nr] = true;
+    }
+    for (auto hid{0uz}; hid < touched.size(); ++hid) {
+      if (touched[hid])
+        f(hid);
+    }
+  }
+};
+
+} // namespace
+
+TEST_P(ScatterGather, WriteThenRead) {
+  auto const &param{GetParam()};
+  auto const &be_cfg{param.be_cfg};
+
+  auto const storage_sz{be_cfg.strip_sz * param.stripes_nr};
+  auto const storages{
+      ut::make_unique_zeroed_storages(storage_sz, be_cfg.strips_per_stripe_nr),
+  };
+  auto const storage_spans{ut::storages_to_spans(storages, storage_sz)};
+
+  auto const src{mm::make_unique_randomized_bytes(param.sz)};
+  auto const src_span{std::as_bytes(std::span{src.get(), param.sz})};
+
+  expect(param.off, param.sz, [&](size_t hid) {
+    EXPECT_CALL(*backend_ctxs_[hid].h,
+                submit(Matcher<std::shared_ptr<writev_query>>(NotNull())))
+        .WillOnce([to = storage_spans[hid]](std::shared_ptr<writev_query> wq) {
+          EXPECT_LE(wq->offset() + wq->size(), to.size());
+          auto off{wq->offset()};
+          for (auto const buf : wq->bufs()) {
+            std::ranges::copy(buf, to.begin() + off);
+            off += buf.size();
+          }
+          return 0;
+        });
+  });
+
+  EXPECT_EQ(be_->process(writev_query::create(
+                cells(src_span, param.cell_sz), param.off,
+                [](writev_query const &wq) { EXPECT_EQ(wq.err(), 0); })),
+            0);
+
+  for (auto i{0uz}; i < param.sz; ++i) {
+    auto const off{param.off + i};
+    auto const strip_id{off / be_cfg.strip_sz};
+    auto const hid{strip_id % be_cfg.strips_per_stripe_nr};
+    auto const stripe_id{strip_id / be_cfg.strips_per_stripe_nr};
+    ASSERT_EQ(storage_spans[hid][stripe_id * be_cfg.strip_sz +
+                                 off % be_cfg.strip_sz],
+              src_span[i]);
+  }
+
+  auto const dst{mm::make_unique_zeroed_bytes(param.sz)};
+  auto const dst_span{std::as_writable_bytes(std::span{dst.get(), param.sz})};
+
+  expect(param.off, param.sz, [&](size_t hid) {
+    EXPECT_CALL(*backend_ctxs_[hid].h,
+                submit(Matcher<std::shared_ptr<readv_query>>(NotNull())))
+        .WillOnce([from = storage_spans[hid]](std::shared_ptr<readv_query> rq) {
+          EXPECT_LE(rq->offset() + rq->size(), from.size());
+          auto off{rq->offset()};
+          for (auto const buf : rq->bufs()) {
+            std::ranges::copy(from.subspan(off, buf.size()), buf.begin());
+            off += buf.size();
+          }
+          return 0;
+        });
+  });
+
+  /* cells of another size, the list is split wherever it happens to be */
+  EXPECT_EQ(be_->process(readv_query::create(
+                cells(dst_span, param.cell_sz / 2 + 1), param.off,
+                [](readv_query const &rq) { EXPECT_EQ(rq.err(), 0); })),
+            0);
+
+  EXPECT_THAT(dst_span, ElementsAreArray(src_span));
+}
+
+TEST_P(ScatterGather, ListsLongerThanAnIovecGetSplit) {
+  auto const &param{GetParam()};
+  auto const &be_cfg{param.be_cfg};
+
+  /* tiny cells give every backend more of them than an iovec holds */
+  constexpr auto kCellSz{4uz};
+
+  auto const storage_sz{be_cfg.strip_sz * param.stripes_nr};
+  auto const storages{
+      ut::make_unique_zeroed_storages(storage_sz, be_cfg.strips_per_stripe_nr),
+  };
+  auto const storage_spans{ut::storages_to_spans(storages, storage_sz)};
+
+  auto const src{mm::make_unique_randomized_bytes(param.sz)};
+  auto const src_span{std::as_bytes(std::span{src.get(), param.sz})};
+
+  auto written_bytes{0uz};
+  expect(param.off, param.sz, [&](size_t hid) {
+    EXPECT_CALL(*backend_ctxs_[hid].h,
+                submit(Matcher<std::shared_ptr<writev_query>>(NotNull())))
+        .WillRepeatedly([&written_bytes, to = storage_spans[hid]](
+                            std::shared_ptr<writev_query> wq) {
+          EXPECT_LE(wq->bufs().size(), static_cast<size_t>(IOV_MAX));
+          EXPECT_LE(wq->offset() + wq->size(), to.size());
+          auto off{wq->offset()};
+          for (auto const buf : wq->bufs()) {
+            std::ranges::copy(buf, to.begin() + off);
+            off += buf.size();
+          }
+          written_bytes += wq->size();
+          return 0;
+        });
+  });
+
+  EXPECT_EQ(be_->process(writev_query::create(
+                cells(src_span, kCellSz), param.off,
+                [](writev_query const &wq) { EXPECT_EQ(wq.err(), 0); })),
+            0);
+  EXPECT_EQ(written_bytes, param.sz);
+
+  auto const dst{mm::make_unique_zeroed_bytes(param.sz)};
+  auto const dst_span{std::as_writable_bytes(std::span{dst.get(), param.sz})};
+
+  expect(param.off, param.sz, [&](size_t hid) {
+    EXPECT_CALL(*backend_ctxs_[hid].h,
+                submit(Matcher<std::shared_ptr<readv_query>>(NotNull())))
+        .WillRepeatedly(
+            [from = storage_spans[hid]](std::shared_ptr<readv_query> rq) {
+              EXPECT_LE(rq->bufs().size(), static_cast<size_t>(IOV_MAX));
+              EXPECT_LE(rq->offset() + rq->size(), from.size());
+              auto off{rq->offset()};
+              for (auto const buf : rq->bufs()) {
+                std::ranges::copy(from.subspan(off, buf.size()), buf.begin());
+                off += buf.size();
+              }
+              return 0;
+            });
+  });
+
+  EXPECT_EQ(be_->process(readv_query::create(
+                cells(dst_span, kCellSz), param.off,
+                [](readv_query const &rq) { EXPECT_EQ(rq.err(), 0); })),
+            0);
+
+  EXPECT_THAT(dst_span, ElementsAreArray(src_span));
+}
+
+TEST_P(ScatterGather, BackendFailure) {
+  auto const &param{GetParam()};
+
+  auto const buf{mm::make_unique_zeroed_bytes(param.sz)};
+  auto const buf_span{std::as_writable_bytes(std::span{buf.get(), param.sz})};
+
+  auto err{0};
+  expect(param.off, param.sz, [&](size_t hid) {
+    EXPECT_CALL(*backend_ctxs_[hid].h,
+                submit(Matcher<std::shared_ptr<readv_query>>(NotNull())))
+        .WillOnce([](std::shared_ptr<readv_query> rq) {
+          rq->set_err(EIO);
+          return 0;
+        });
+  });
+
+  EXPECT_EQ(be_->process(readv_query::create(
+                cells(buf_span, param.cell_sz), param.off,
+                [&err](readv_query const &rq) { err = rq.err(); })),
+            0);
+  EXPECT_EQ(err, EIO);
+}
+
+TEST_P(ScatterGather, FUAReachesBackends) {
+  auto const &param{GetParam()};
+
+  auto const buf{mm::make_unique_randomized_bytes(param.sz)};
+  auto const buf_span{std::as_bytes(std::span{buf.get(), param.sz})};
+
+  expect(param.off, param.sz, [&](size_t hid) {
+    EXPECT_CALL(*backend_ctxs_[hid].h,
+                submit(Matcher<std::shared_ptr<writev_query>>(NotNull())))
+        .WillOnce([](std::shared_ptr<writev_query> wq) {
+          EXPECT_TRUE(wq->fua());
+          return 0;
+        });
+  });
+
+  auto wq{writev_query::create(cells(buf_span, param.cell_sz), param.off)};
+  wq->set_fua(true);
+  EXPECT_EQ(be_->process(std::move(wq)), 0);
+}
+
+INSTANTIATE_TEST_SUITE_P(RAID0, ScatterGather,
+                         Values(
+                             scatter_gather_param{
+                                 .be_cfg =
+                                     {
+                                         .strip_sz = 4096uz,
+                                         .strips_per_stripe_nr = 2uz,
+                                     },
+                                 .stripes_nr = 8uz,
+                                 .off = 0uz,
+                                 .sz = 8uz * 4096uz,
+                                 .cell_sz = 4096uz,
+                             },
+                             scatter_gather_param{
+                                 .be_cfg =
+                                     {
+                                         .strip_sz = 4096uz,
+                                         .strips_per_stripe_nr = 3uz,
+                                     },
+                                 .stripes_nr = 8uz,
+                                 .off = 1536uz,
+                                 .sz = 7uz * 4096uz + 512uz,
+                                 .cell_sz = 3072uz,
+                             },
+                             scatter_gather_param{
+                                 .be_cfg =
+                                     {
+                                         .strip_sz = 8192uz,
+                                         .strips_per_stripe_nr = 4uz,
+                                     },
+                                 .stripes_nr = 4uz,
+                                 .off = 512uz,
+                                 .sz = 2048uz,
+                                 .cell_sz = 1024uz,
+                             }));
@@ -8,11 +8,15 @@
 #include <memory>
 #include <ranges>
 #include <span>
+#include <vector>
 
 #include "mm/mem.hpp"
 
 #include "utils/size_units.hpp"
 
+#include "discard_handler_interface.hpp"
+#include "discard_query.hpp"
+#include "rw_handler_interface.hpp"
 #include "write_query.hpp"
 
 #include "raid4/target.hpp"
@@ -109,3 +113,52 @@ TEST_F(RAID4_StripeParity,
       EXPECT_FALSE(target_->is_stripe_parity_coherent(stripe_id_next));
   }
 }
+
+TEST_F(RAID4_StripeParity, StripeParityBecomesIncoherentAtFullStripeDiscard) {
+  auto dhs{
+      std::vector<std::shared_ptr<ut::MockDiscardHandler>>(hs_.size()),
+  };
+  std::ranges::generate(dhs, [] {
+    return std::make_shared<StrictMock<ut::MockDiscardHandler>>();
+  });
+  target_ = std::make_unique<ublk::raid4::Target>(
+      kStripSz,
+      std::vector<std::shared_ptr<IRWHandler>>{hs_.begin(), hs_.end()},
+      std::vector<std::shared_ptr<IDiscardHandler>>{dhs.begin(), dhs.end()});
+
+  auto buf{
+      std::unique_ptr<std::byte const[]>{
+          mm::make_unique_for_overwrite_bytes(this->kStripeDataSz),
+      },
+  };
+  auto buf_span{std::span{buf.get(), this->kStripeDataSz}};
+
+  for (auto const &h : hs_) {
+    EXPECT_CALL(*h, submit(Matcher<std::shared_ptr<write_query>>(NotNull())))
+        .WillOnce(Return(0));
+  }
+
+  EXPECT_EQ(target_->process(write_query::create(buf_span, kStripeDataSz)), 0);
+  EXPECT_TRUE(target_->is_stripe_parity_coherent(1));
+
+  /* Parity included, all the members get the only stripe covered entirely */
+  for (auto const &dh : dhs) {
+    EXPECT_CALL(*dh, submit(NotNull()))
+        .WillOnce([](std::shared_ptr<discard_query> dq) {
+          EXPECT_EQ(dq->offset(), kStripSz);
+          EXPECT_EQ(dq->size(), kStripSz);
+          return 0;
+        });
+  }
+
+  auto const r{
+      target_->process(discard_query::create(
+          512uz, (kStripesNr - 1) * kStripeDataSz,
+          [](discard_query const &dq) { EXPECT_EQ(dq.err(), 0); })),
+  };
+  EXPECT_EQ(r, 0);
+
+  /* members are not bound to read zeroes back once discarded */
+  for (auto stripe_id : std::views::iota(0uz, kStripesNr))
+    EXPECT_FALSE(target_->is_stripe_parity_coherent(stripe_id));
+}
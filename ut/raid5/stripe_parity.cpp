@@ -8,11 +8,16 @@
 #include <memory>
 #include <ranges>
 #include <span>
+#include <vector>
 
 #include "mm/mem.hpp"
 
 #include "utils/size_units.hpp"
 
+#include "discard_handler_interface.hpp"
+#include "discard_query.hpp"
+#include "read_query.hpp"
+#include "rw_handler_interface.hpp"
 #include "write_query.hpp"
 
 #include "raid5/target.hpp"
@@ -109,3 +114,82 @@ TEST_F(RAID5_StripeParity,
       EXPECT_FALSE(target_->is_stripe_parity_coherent(stripe_id_next));
   }
 }
+
+TEST_F(RAID5_StripeParity, PartialWriteAfterDiscardKeepsStripeRecoverable) {
+  auto const storage_sz{kStripSz * kStripesNr};
+  auto const storages{
+      ut::make_unique_randomized_storages(storage_sz, hs_.size()),
+  };
+  auto const storage_spans{ut::storages_to_spans(storages, storage_sz)};
+
+  auto dhs{
+      std::vector<std::shared_ptr<ut::MockDiscardHandler>>(hs_.size()),
+  };
+  std::ranges::generate(dhs, [] {
+    return std::make_shared<StrictMock<ut::MockDiscardHandler>>();
+  });
+  target_ = std::make_unique<ublk::raid5::Target>(
+      kStripSz,
+      std::vector<std::shared_ptr<IRWHandler>>{hs_.begin(), hs_.end()},
+      std::vector<std::shared_ptr<IDiscardHandler>>{dhs.begin(), dhs.end()});
+
+  for (auto i : std::views::iota(0uz, hs_.size())) {
+    EXPECT_CALL(*hs_[i],
+                submit(Matcher<std::shared_ptr<write_query>>(NotNull())))
+        .WillRepeatedly(ut::make_inmem_writer(storage_spans[i]));
+    EXPECT_CALL(*hs_[i],
+                submit(Matcher<std::shared_ptr<read_query>>(NotNull())))
+        .WillRepeatedly(ut::make_inmem_reader(storage_spans[i]));
+    /* like BLKDISCARD may do, the range reads back as anything */
+    EXPECT_CALL(*dhs[i], submit(NotNull()))
+        .WillOnce([to = storage_spans[i]](std::shared_ptr<discard_query> dq) {
+          auto const garbage{mm::make_unique_randomized_bytes(dq->size())};
+          std::ranges::copy(std::span{garbage.get(), dq->size()},
+                            to.begin() + dq->offset());
+          return 0;
+        });
+  }
+
+  auto const stripe_id{1uz};
+
+  auto const full{mm::make_unique_randomized_bytes(kStripeDataSz)};
+  EXPECT_EQ(target_->process(write_query::create(
+                std::as_bytes(std::span{full.get(), kStripeDataSz}),
+                stripe_id * kStripeDataSz)),
+            0);
+  EXPECT_TRUE(target_->is_stripe_parity_coherent(stripe_id));
+
+  EXPECT_EQ(target_->process(discard_query::create(stripe_id * kStripeDataSz,
+                                                   kStripeDataSz)),
+            0);
+
+  auto const part_sz{kStripSz / 2};
+  auto const part{mm::make_unique_randomized_bytes(part_sz)};
+  auto const part_span{std::as_bytes(std::span{part.get(), part_sz})};
+  EXPECT_EQ(target_->process(write_query::create(
+                part_span, stripe_id * kStripeDataSz + part_sz)),
+            0);
+
+  auto stripe_spans{std::vector<std::span<std::byte>>{}};
+  for (auto const &s : storage_spans)
+    stripe_spans.push_back(s.subspan(stripe_id * kStripSz, kStripSz));
+
+  /* Any strip of the stripe is recovered from the rest ones as they are */
+  ut::parity_verify(stripe_spans, kStripSz);
+
+  /*
+   * The member holding the first strip of the stripe is lost, read it
+   * degraded
+   */
+  auto const sid_parity{hs_.size() - (stripe_id % hs_.size()) - 1};
+  auto const sid_lost{0uz == sid_parity ? 1uz : 0uz};
+  auto recovered{std::vector<std::byte>(kStripSz)};
+  for (auto sid : std::views::iota(0uz, hs_.size())) {
+    if (sid == sid_lost)
+      continue;
+    for (auto i : std::views::iota(0uz, kStripSz))
+      recovered[i] ^= stripe_spans[sid][i];
+  }
+  EXPECT_THAT(std::span{recovered}.subspan(part_sz, part_sz),
+              ElementsAreArray(part_span));
+}
@@ -0,0 +1,118 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+
+#include <format>
+#include <ranges>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "trace/trace.hpp"
+
+using namespace testing;
+
+namespace ublk::ut::trace {
+
+namespace {
+
+class Trace : public Test {
+protected:
+  void SetUp() override { ublk::trace::clear(); }
+  void TearDown() override {
+    ublk::trace::enable(0);
+    ublk::trace::clear();
+  }
+
+  static std::string dump() {
+    auto out{std::ostringstream{}};
+    ublk::trace::dump(out);
+    return out.str();
+  }
+
+  static size_t occurrences(std::string_view s, std::string_view what) {
+    size_t n{0};
+    for (auto pos{s.find(what)}; std::string_view::npos != pos;
+         pos = s.find(what, pos + what.size()))
+      ++n;
+    return n;
+  }
+};
+
+} // namespace
+
+TEST_F(Trace, DisabledSamplesNothing) {
+  ublk::trace::enable(0);
+  for (size_t i{0}; i < 64; ++i)
+    EXPECT_EQ(ublk::trace::sample(), 0);
+}
+
+TEST_F(Trace, SamplesEveryNth) {
+  constexpr auto kSampleEvery{4u};
+  constexpr auto kCmdsNr{64u};
+
+  ublk::trace::enable(kSampleEvery);
+
+  auto ids{std::vector<uint32_t>{}};
+  for (size_t i{0}; i < kCmdsNr; ++i) {
+    if (auto const id{ublk::trace::sample()})
+      ids.push_back(id);
+  }
+
+  EXPECT_EQ(ids.size(), kCmdsNr / kSampleEvery);
+  EXPECT_EQ(std::set(ids.begin(), ids.end()).size(), ids.size());
+}
+
+TEST_F(Trace, UntracedRecordsNothing) {
+  ublk::trace::enable(1);
+  ublk::trace::record("cmd", 0, ublk::trace::phase::begin);
+  ublk::trace::record("dispatch", 0);
+
+  EXPECT_EQ(occurrences(dump(), R"("name")"), 0);
+}
+
+TEST_F(Trace, DumpsEventsOfAllThreads) {
+  ublk::trace::enable(1);
+
+  auto const id{ublk::trace::sample()};
+  ASSERT_NE(id, 0);
+
+  ublk::trace::record("cmd", id, ublk::trace::phase::begin);
+  std::jthread{[id] { ublk::trace::record("backend", id); }}.join();
+  ublk::trace::record("cmd", id, ublk::trace::phase::end);
+
+  auto const out{dump()};
+
+  EXPECT_THAT(out, StartsWith(R"({"displayTimeUnit":"ns","traceEvents":[)"));
+  EXPECT_THAT(out, EndsWith("]}\n"));
+
+  EXPECT_EQ(occurrences(out, std::format(R"("id":{},)", id)), 3);
+  EXPECT_EQ(occurrences(out, R"("name":"cmd","cat":"ublk","ph":"b")"), 1);
+  EXPECT_EQ(occurrences(out, R"("name":"backend","cat":"ublk","ph":"n")"), 1);
+  EXPECT_EQ(occurrences(out, R"("name":"cmd","cat":"ublk","ph":"e")"), 1);
+
+  auto tids{std::set<std::string>{}};
+  for (auto pos{out.find(R"("tid":)")}; std::string::npos != pos;
+       pos = out.find(R"("tid":)", pos + 1))
+    tids.insert(out.substr(pos, out.find('}', pos) - pos));
+  EXPECT_EQ(tids.size(), 2);
+}
+
+TEST_F(Trace, ClearDropsEventsRecorded) {
+  ublk::trace::enable(1);
+
+  auto const id{ublk::trace::sample()};
+  ublk::trace::record("cmd", id, ublk::trace::phase::begin);
+  ublk::trace::clear();
+  ublk::trace::record("cmd", id, ublk::trace::phase::end);
+
+  auto const out{dump()};
+  EXPECT_EQ(occurrences(out, R"("ph":"b")"), 0);
+  EXPECT_EQ(occurrences(out, R"("ph":"e")"), 1);
+}
+
+} // namespace ublk::ut::trace
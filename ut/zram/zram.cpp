@@ -0,0 +1,185 @@
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cerrno>
+#include <cstddef>
+
+#include <algorithm>
+#include <memory>
+#include <span>
+
+#include "mm/mem.hpp"
+
+#include "utils/size_units.hpp"
+
+#include "zram/slab.hpp"
+#include "zram/target.hpp"
+
+#include "discard_query.hpp"
+#include "read_query.hpp"
+#include "target_stats.hpp"
+#include "write_query.hpp"
+
+using namespace testing;
+
+namespace ublk::ut::zram {
+
+namespace {
+
+class ZRAM : public Test {
+protected:
+  void SetUp() override {
+    stats_ = std::make_shared<target_stats>();
+    target_ = std::make_unique<ublk::zram::Target>(kStorageSz, stats_);
+  }
+
+  int write(std::span<std::byte const> buf, uint64_t off) {
+    return target_->process(write_query::create(
+        buf, off, [](write_query const &wq) { EXPECT_EQ(wq.err(), 0); }));
+  }
+
+  int read(std::span<std::byte> buf, uint64_t off) {
+    return target_->process(read_query::create(
+        buf, off, [](read_query const &rq) { EXPECT_EQ(rq.err(), 0); }));
+  }
+
+  static constexpr auto kStorageSz{1_MiB};
+
+  std::shared_ptr<target_stats> stats_;
+  std::unique_ptr<ublk::zram::Target> target_;
+};
+
+} // namespace
+
+TEST_F(ZRAM, UntouchedReadsBackAsZeroes) {
+  auto const buf{mm::make_unique_randomized_bytes(64_KiB)};
+  auto const buf_span{std::span{buf.get(), 64_KiB}};
+
+  EXPECT_EQ(read(buf_span, 512_KiB + 512uz), 0);
+  EXPECT_THAT(buf_span, Each(std::byte{0}));
+  EXPECT_EQ(stats_->zram_mem_used, 0uz);
+}
+
+TEST_F(ZRAM, WrittenReadsBack) {
+  /* neither end falls on a page boundary */
+  constexpr auto kOffset{4_KiB + 1536uz};
+  constexpr auto kSz{32_KiB + 1_KiB};
+
+  auto const wbuf{mm::make_unique_randomized_bytes(kSz)};
+  auto const wbuf_span{std::span<std::byte const>{wbuf.get(), kSz}};
+  EXPECT_EQ(write(wbuf_span, kOffset), 0);
+
+  auto const rbuf{mm::make_unique_zeroed_bytes(kSz + 8_KiB)};
+  auto const rbuf_span{std::span{rbuf.get(), kSz + 8_KiB}};
+  EXPECT_EQ(read(rbuf_span, kOffset - 4_KiB), 0);
+
+  EXPECT_THAT(rbuf_span.first(4_KiB), Each(std::byte{0}));
+  EXPECT_THAT(rbuf_span.subspan(4_KiB, kSz), ElementsAreArray(wbuf_span));
+  EXPECT_THAT(rbuf_span.subspan(4_KiB + kSz), Each(std::byte{0}));
+}
+
+TEST_F(ZRAM, ZeroPagesTakeNoMemory) {
+  auto const buf{mm::make_unique_zeroed_bytes(64_KiB)};
+  EXPECT_EQ(write(std::span<std::byte const>{buf.get(), 64_KiB}, 0), 0);
+
+  EXPECT_EQ(stats_->zram_pages_zeroed, 16uz);
+  EXPECT_EQ(stats_->zram_pages_stored, 0uz);
+  EXPECT_EQ(stats_->zram_mem_used, 0uz);
+}
+
+TEST_F(ZRAM, CompressibleTakesLessMemory) {
+  constexpr auto kSz{kStorageSz};
+
+  auto const wbuf{mm::make_unique_zeroed_bytes(kSz)};
+  auto const wbuf_span{std::span{wbuf.get(), kSz}};
+  for (auto i{0uz}; i < kSz; ++i)
+    wbuf_span[i] = static_cast<std::byte>(i % 7 + (i / 4_KiB) % 3);
+  EXPECT_EQ(write(wbuf_span, 0), 0);
+
+  EXPECT_EQ(stats_->zram_pages_stored, kSz / 4_KiB);
+  EXPECT_LT(stats_->zram_compr_bytes, kSz / 8);
+  EXPECT_LT(stats_->zram_mem_used, kSz / 4);
+
+  auto const rbuf{mm::make_unique_zeroed_bytes(kSz)};
+  auto const rbuf_span{std::span{rbuf.get(), kSz}};
+  EXPECT_EQ(read(rbuf_span, 0), 0);
+  EXPECT_THAT(rbuf_span, ElementsAreArray(wbuf_span));
+}
+
+TEST_F(ZRAM, IncompressibleIsStoredAsItIs) {
+  auto const buf{mm::make_unique_randomized_bytes(8_KiB)};
+  EXPECT_EQ(write(std::span<std::byte const>{buf.get(), 8_KiB}, 8_KiB), 0);
+
+  EXPECT_EQ(stats_->zram_pages_stored, 2uz);
+  EXPECT_EQ(stats_->zram_compr_bytes, 8_KiB);
+}
+
+TEST_F(ZRAM, OverwrittenGivesStorageBack) {
+  auto const buf{mm::make_unique_randomized_bytes(4_KiB)};
+  auto const buf_span{std::span<std::byte const>{buf.get(), 4_KiB}};
+  for (auto i{0}; i < 64; ++i)
+    EXPECT_EQ(write(buf_span, 0), 0);
+
+  EXPECT_EQ(stats_->zram_pages_stored, 1uz);
+  EXPECT_EQ(stats_->zram_compr_bytes, 4_KiB);
+  EXPECT_EQ(stats_->zram_mem_used, ublk::zram::slab::kSpanSz);
+}
+
+TEST_F(ZRAM, DiscardedRangeReadsBackAsZeroes) {
+  constexpr auto kDiscardOffset{4_KiB + 512uz};
+  constexpr auto kDiscardSz{32_KiB + 1_KiB};
+
+  auto const wbuf{mm::make_unique_randomized_bytes(64_KiB)};
+  auto const wbuf_span{std::span<std::byte const>{wbuf.get(), 64_KiB}};
+  EXPECT_EQ(write(wbuf_span, 0), 0);
+
+  EXPECT_EQ(target_->process(discard_query::create(
+                kDiscardOffset, kDiscardSz,
+                [](discard_query const &dq) { EXPECT_EQ(dq.err(), 0); })),
+            0);
+  /* whole pages within the range are gone */
+  EXPECT_EQ(stats_->zram_pages_stored, 16uz - 7uz);
+
+  auto const rbuf{mm::make_unique_zeroed_bytes(64_KiB)};
+  auto const rbuf_span{std::span{rbuf.get(), 64_KiB}};
+  EXPECT_EQ(read(rbuf_span, 0), 0);
+
+  EXPECT_THAT(rbuf_span.first(kDiscardOffset),
+              ElementsAreArray(wbuf_span.first(kDiscardOffset)));
+  EXPECT_THAT(rbuf_span.subspan(kDiscardOffset, kDiscardSz),
+              Each(std::byte{0}));
+  EXPECT_THAT(rbuf_span.subspan(kDiscardOffset + kDiscardSz),
+              ElementsAreArray(wbuf_span.subspan(kDiscardOffset + kDiscardSz)));
+}
+
+TEST_F(ZRAM, FailedOutOfRange) {
+  auto const buf{mm::make_unique_zeroed_bytes(1_KiB)};
+  auto const buf_span{std::span{buf.get(), 1_KiB}};
+
+  EXPECT_EQ(read(buf_span, kStorageSz - 512uz), EINVAL);
+  EXPECT_EQ(write(buf_span, kStorageSz - 512uz), EINVAL);
+  EXPECT_EQ(
+      target_->process(discard_query::create(kStorageSz - 512uz, 1_KiB)),
+      EINVAL);
+}
+
+TEST(ZRAMSlab, FreedObjectsGetReused) {
+  auto slab{ublk::zram::slab{4_KiB}};
+
+  auto *const p0{slab.allocate(100)};
+  auto *const p1{slab.allocate(128)};
+  ASSERT_NE(p0, nullptr);
+  ASSERT_NE(p1, nullptr);
+  /* both fall into the same class */
+  EXPECT_EQ(p1 - p0, 128);
+  EXPECT_EQ(slab.mem_used(), ublk::zram::slab::kSpanSz);
+
+  slab.free(p0, 100);
+  EXPECT_EQ(slab.allocate(120), p0);
+
+  /* another class takes another span */
+  EXPECT_NE(slab.allocate(4_KiB), nullptr);
+  EXPECT_EQ(slab.mem_used(), 2 * ublk::zram::slab::kSpanSz);
+}
+
+} // namespace ublk::ut::zram
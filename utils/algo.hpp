@@ -111,4 +111,35 @@ void fill(std::span<T> range, T value) noexcept {
 #endif
 }
 
+/*
+ * Words of a cache line are OR-ed together before being checked, the inner
+ * loop has no exit in it and gets vectorized
+ */
+inline bool is_zeroed(std::span<std::byte const> range) noexcept {
+  if (!is_aligned_to(reinterpret_cast<uintptr_t>(range.data()),
+                     sizeof(uint64_t)) ||
+      !is_aligned_to(range.size(), sizeof(uint64_t))) [[unlikely]] {
+    return std::ranges::all_of(range,
+                               [](std::byte b) { return std::byte{0} == b; });
+  }
+
+  constexpr auto kWordsPerLineNr{64uz / sizeof(uint64_t)};
+
+  auto const words{to_span_of<uint64_t const>(range)};
+  auto i{0uz};
+  for (; i + kWordsPerLineNr <= words.size(); i += kWordsPerLineNr) {
+    auto acc{uint64_t{0}};
+    for (auto j{0uz}; j < kWordsPerLineNr; ++j)
+      acc |= words[i + j];
+    if (acc)
+      return false;
+  }
+  for (; i < words.size(); ++i) {
+    if (words[i])
+      return false;
+  }
+
+  return true;
+}
+
 } // namespace ublk::algo